@@ -0,0 +1,105 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "../src/core/debouncer.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+/* Shared helpers for the benchmark executables */
+
+static inline uint64_t bench_now_ns(void)
+{
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+    if (freq.QuadPart == 0)
+        QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (uint64_t)((double)now.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static inline void bench_sleep_ms(uint32_t ms)
+{
+#ifdef _WIN32
+    Sleep(ms);
+#else
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (long)(ms % 1000) * 1000000;
+    nanosleep(&ts, NULL);
+#endif
+}
+
+/* Keeps the optimizer from discarding benchmarked results */
+static volatile uint64_t bench_sink;
+
+static inline void bench_consume(uint64_t value)
+{
+    bench_sink += value;
+}
+
+/* Small deterministic PRNG (xorshift64) so runs are reproducible */
+static inline uint64_t bench_rand(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+#define BENCH_ALL_BUTTONS ((1u << MOUSE_BUTTON_COUNT) - 1)
+
+/* Fresh engine debouncing the buttons in monitored_mask: 50ms buttons, 30ms wheel */
+static inline void bench_configure(DebounceManager *manager, uint32_t monitored_mask)
+{
+    debounce_init(manager);
+    for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
+    {
+        debounce_set_monitored(manager, i, (monitored_mask >> i) & 1);
+        debounce_set_threshold(manager, i, i == MOUSE_BUTTON_WHEEL ? 30 : 50, 1, 200);
+    }
+}
+
+/* Clicks on every button, bounces and wheel reversals, about one in three events a wheel notch */
+static inline void bench_build_mixed(MouseEvent *events, size_t count, uint64_t seed)
+{
+    uint64_t rng = seed;
+    uint64_t now = 1000000;
+    bool down[MOUSE_BUTTON_COUNT] = {false};
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t r = bench_rand(&rng);
+        MouseEvent *e = &events[i];
+        memset(e, 0, sizeof(*e));
+
+        e->button = (r & 3) == 0 ? MOUSE_BUTTON_WHEEL : (MouseButton)((r >> 2) % MOUSE_BUTTON_WHEEL);
+        if (e->button == MOUSE_BUTTON_WHEEL)
+        {
+            e->data = ((r >> 8) & 7) == 0 ? -120 : 120;
+        }
+        else
+        {
+            down[e->button] = !down[e->button];
+            e->is_down = down[e->button];
+        }
+
+        now += (((r >> 12) & 7) == 0 ? 2 + (r >> 16) % 8 : 40 + (r >> 16) % 160) * 1000;
+        e->timestamp = now;
+        e->x = 500 + (long)((r >> 24) % 8);
+        e->y = 500;
+    }
+}
@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench_common.h"
+#include "../src/core/debouncer.h"
+
+/*
+ * Per-event latency of debounce_process_event while another thread hammers
+ * the UI getters/setters and the deferred-release check.
+ *
+ * "locked" reproduces the previous design, where the hook path and every
+ * UI call entered the same critical section, by wrapping both sides in one
+ * MfLock. "lock-free" runs the engine as shipped.
+ */
+
+#define EVENT_COUNT (1u << 20)
+
+typedef struct
+{
+    DebounceManager *manager;
+    MfLock *lock;
+    MfAtomic32 stop;
+    uint64_t calls;
+} ReaderContext;
+
+static void reader_thread(void *arg)
+{
+    ReaderContext *ctx = (ReaderContext *)arg;
+    uint64_t calls = 0;
+
+    while (!mf_atomic_load32(&ctx->stop))
+    {
+        if (ctx->lock)
+            mf_lock_enter(ctx->lock);
+        bench_consume(debounce_get_total_blocks(ctx->manager));
+        bench_consume(debounce_is_any_monitored(ctx->manager));
+        debounce_set_threshold(ctx->manager, MOUSE_BUTTON_RIGHT, 50 + (uint32_t)(calls & 1), 1, 200);
+        bench_consume(debounce_collect_deferred_releases(ctx->manager, 0));
+        if (ctx->lock)
+            mf_lock_leave(ctx->lock);
+        calls++;
+    }
+    ctx->calls = calls;
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void build_events(MouseEvent *events, size_t count)
+{
+    uint64_t rng = 0x2545F4914F6CDD1Dull;
+    uint64_t now = 1000000;
+    bool down = false;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t r = bench_rand(&rng);
+        MouseEvent *e = &events[i];
+        e->button = MOUSE_BUTTON_LEFT;
+        down = !down;
+        e->is_down = down;
+        now += (((r & 7) == 0) ? 3 : 80 + (r >> 8) % 100) * 1000;
+        e->timestamp = now;
+        e->x = 200;
+        e->y = 200;
+    }
+}
+
+static void run(const char *label, bool locked, const MouseEvent *events, uint32_t *samples)
+{
+    DebounceManager manager;
+    MfLock lock;
+    debounce_init(&manager);
+    mf_lock_init(&lock);
+    for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
+    {
+        debounce_set_monitored(&manager, i, true);
+        debounce_set_threshold(&manager, i, 50, 1, 200);
+    }
+
+    ReaderContext ctx = {&manager, locked ? &lock : NULL, 0, 0};
+    MfThread reader;
+    if (!mf_thread_start(&reader, reader_thread, &ctx))
+    {
+        printf("failed to start reader thread\n");
+        exit(1);
+    }
+
+    for (size_t i = 0; i < EVENT_COUNT; i++)
+    {
+        uint64_t start = bench_now_ns();
+        if (locked)
+            mf_lock_enter(&lock);
+        bool blocked = debounce_process_event(&manager, &events[i]);
+        if (locked)
+            mf_lock_leave(&lock);
+        uint64_t elapsed = bench_now_ns() - start;
+        samples[i] = elapsed > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed;
+        bench_consume(blocked);
+    }
+
+    mf_atomic_store32(&ctx.stop, 1);
+    mf_thread_join(&reader);
+
+    qsort(samples, EVENT_COUNT, sizeof(uint32_t), compare_u32);
+    printf("%-10s p50 %6u ns  p99 %6u ns  p99.9 %8u ns  max %9u ns  (reader calls: %llu)\n",
+           label,
+           samples[EVENT_COUNT / 2],
+           samples[(size_t)(EVENT_COUNT * 0.99)],
+           samples[(size_t)(EVENT_COUNT * 0.999)],
+           samples[EVENT_COUNT - 1],
+           (unsigned long long)ctx.calls);
+
+    mf_lock_destroy(&lock);
+    debounce_cleanup(&manager);
+}
+
+int main(void)
+{
+    MouseEvent *events = calloc(EVENT_COUNT, sizeof(MouseEvent));
+    uint32_t *samples = calloc(EVENT_COUNT, sizeof(uint32_t));
+    if (!events || !samples)
+        return 1;
+
+    build_events(events, EVENT_COUNT);
+
+    printf("debounce_process_event latency with a concurrent reader/writer thread (%u events)\n", EVENT_COUNT);
+    run("locked", true, events, samples);
+    run("lock-free", false, events, samples);
+
+    free(samples);
+    free(events);
+    return 0;
+}
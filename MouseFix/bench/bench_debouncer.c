@@ -0,0 +1,581 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench_common.h"
+#include "../src/core/debouncer.h"
+
+/*
+ * Scenario suite for the debounce engine (timestamps in microseconds).
+ *
+ * Each scenario is a synthetic stream run through debounce_process_event
+ * with Smart Drag off and on; pending releases are collected at their
+ * deadlines the way the release scheduler would. The moves_* scenarios
+ * are 8kHz pointer streams (an event with MOUSE_BUTTON_UNKNOWN is a move
+ * for debounce_process_move) with a few button edges mixed in. The
+ * deferred-release check and the batch entry point are measured on their
+ * own. Results are best-of-N ns per event (or per call).
+ *
+ * Usage: bench_debouncer [--iterations N] [--output FILE]
+ *                        [--baseline FILE] [--threshold PCT]
+ *
+ * --output writes "name ns" lines, which is also the --baseline format.
+ * With a baseline, any scenario slower than baseline by more than PCT
+ * percent (default 10) is reported and the exit code is 2.
+ */
+
+#define EVENT_COUNT        (1u << 17)
+#define DEFAULT_ITERATIONS 16
+#define DEFAULT_THRESHOLD  10.0
+#define MAX_RESULTS        32
+#define NAME_SIZE          48
+#define CHECK_CALLS        (1u << 16)
+
+typedef struct
+{
+    char name[NAME_SIZE];
+    double ns;
+} BenchResult;
+
+typedef void (*StreamBuilder)(MouseEvent *events, size_t count, uint64_t *rng);
+
+typedef struct
+{
+    const char *name;
+    StreamBuilder build;
+} Scenario;
+
+static BenchResult results[MAX_RESULTS];
+static int result_count;
+
+static void add_result(const char *name, const char *variant, double ns)
+{
+    if (result_count >= MAX_RESULTS)
+        return;
+
+    BenchResult *r = &results[result_count++];
+    if (variant)
+        snprintf(r->name, NAME_SIZE, "%s/%s", name, variant);
+    else
+        snprintf(r->name, NAME_SIZE, "%s", name);
+    r->ns = ns;
+    printf("  %-32s %8.2f ns\n", r->name, ns);
+}
+
+/* Fills in one button edge */
+static void push(MouseEvent *e, MouseButton button, bool down, uint64_t now, long x, long y)
+{
+    memset(e, 0, sizeof(*e));
+    e->button = button;
+    e->is_down = down;
+    e->timestamp = now;
+    e->x = x;
+    e->y = y;
+}
+
+/* Human-paced clicks on left and right, no bounces */
+static void build_clean_clicks(MouseEvent *events, size_t count, uint64_t *rng)
+{
+    uint64_t now = 1000000;
+    for (size_t i = 0; i + 1 < count; i += 2)
+    {
+        uint64_t r = bench_rand(rng);
+        MouseButton button = (r & 3) == 0 ? MOUSE_BUTTON_RIGHT : MOUSE_BUTTON_LEFT;
+        now += 150000 + (r >> 8) % 400000;
+        push(&events[i], button, true, now, 100, 100);
+        now += 60000 + (r >> 24) % 60000;
+        push(&events[i + 1], button, false, now, 101, 100);
+    }
+    if (count & 1)
+        push(&events[count - 1], MOUSE_BUTTON_LEFT, true, now + 500000, 100, 100);
+}
+
+/* Clicks where half the edges chatter 1-3 times within the threshold */
+static void build_bounce_bursts(MouseEvent *events, size_t count, uint64_t *rng)
+{
+    uint64_t now = 1000000;
+    bool down = false;
+    size_t i = 0;
+    while (i < count)
+    {
+        uint64_t r = bench_rand(rng);
+        down = !down;
+        now += 60000 + (r >> 8) % 200000;
+        push(&events[i++], MOUSE_BUTTON_LEFT, down, now, 100, 100);
+
+        if (r & 1)
+        {
+            int bounces = 2 * (1 + (int)((r >> 1) % 2));
+            for (int b = 0; b < bounces && i < count; b++)
+            {
+                now += 1000 + (r >> (32 + b * 4)) % 8000;
+                push(&events[i++], MOUSE_BUTTON_LEFT, b % 2 == 0 ? !down : down, now, 100, 100);
+            }
+        }
+    }
+}
+
+/* Worn switch: two buttons, three edges in four land 1-6ms apart, no burst pattern to learn */
+static void build_chatter(MouseEvent *events, size_t count, uint64_t *rng)
+{
+    uint64_t now = 1000000;
+    bool down[2] = {false, false};
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t r = bench_rand(rng);
+        MouseButton button = (r >> 50) & 1 ? MOUSE_BUTTON_RIGHT : MOUSE_BUTTON_LEFT;
+        down[button] = !down[button];
+        now += ((r >> 8) & 3) ? 1000 + r % 5000 : 100000;
+        push(&events[i], button, down[button], now, 100, 100);
+    }
+}
+
+/* Long holds with travel (CONFIRMING when hybrid), a quarter re-pressed inside the confirm window */
+static void build_drags(MouseEvent *events, size_t count, uint64_t *rng)
+{
+    uint64_t now = 1000000;
+    size_t i = 0;
+    while (i + 1 < count)
+    {
+        uint64_t r = bench_rand(rng);
+        now += 300000 + (r >> 8) % 300000;
+        push(&events[i++], MOUSE_BUTTON_LEFT, true, now, 100, 100);
+        now += 250000 + (r >> 20) % 350000;
+        push(&events[i++], MOUSE_BUTTON_LEFT, false, now, 100 + 10 + (long)((r >> 40) % 200), 120);
+
+        if ((r & 3) == 0 && i + 1 < count)
+        {
+            now += 20000 + (r >> 44) % 80000;
+            push(&events[i++], MOUSE_BUTTON_LEFT, true, now, 300, 120);
+            now += 300000;
+            push(&events[i++], MOUSE_BUTTON_LEFT, false, now, 350, 120);
+        }
+    }
+    if (i < count)
+        push(&events[i], MOUSE_BUTTON_LEFT, true, now + 500000, 100, 100);
+}
+
+/* Wheel notches with occasional direction flips, some inside the threshold */
+static void build_wheel_reversals(MouseEvent *events, size_t count, uint64_t *rng)
+{
+    uint64_t now = 1000000;
+    int32_t direction = 120;
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t r = bench_rand(rng);
+        if ((r & 3) == 0)
+            direction = -direction;
+        now += 8000 + (r >> 8) % 40000;
+        push(&events[i], MOUSE_BUTTON_WHEEL, false, now, 100, 100);
+        events[i].data = direction;
+    }
+}
+
+/* Half the clicks on X2, which is left unmonitored */
+static void build_unmonitored(MouseEvent *events, size_t count, uint64_t *rng)
+{
+    build_bounce_bursts(events, count, rng);
+    for (size_t i = 0; i < count; i++)
+    {
+        if ((i / 64) & 1)
+            events[i].button = MOUSE_BUTTON_X2;
+    }
+}
+
+/* Half the events injected by software (passed through before any state is touched) */
+static void build_injected(MouseEvent *events, size_t count, uint64_t *rng)
+{
+    build_bounce_bursts(events, count, rng);
+    for (size_t i = 0; i < count; i++)
+        events[i].is_injected = ((i / 64) & 1) != 0;
+}
+
+/* Office-style mix: mostly clicks on left, one in eight edges a bounce, some wheel */
+static void build_mixed(MouseEvent *events, size_t count, uint64_t *rng)
+{
+    uint64_t now = 1000000;
+    bool down = false;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        MouseEvent *e = &events[i];
+        uint64_t r = bench_rand(rng);
+        memset(e, 0, sizeof(*e));
+
+        if ((r & 15) == 0)
+        {
+            e->button = MOUSE_BUTTON_WHEEL;
+            e->data = (r & 16) ? 120 : -120;
+            now += (8 + (r >> 8) % 40) * 1000;
+        }
+        else
+        {
+            e->button = MOUSE_BUTTON_LEFT;
+            down = !down;
+            e->is_down = down;
+            now += (((r >> 4) & 7) == 0 ? 2 + (r >> 12) % 8 : 60 + (r >> 12) % 200) * 1000;
+        }
+        e->timestamp = now;
+        e->x = 100 + (long)((r >> 20) % 8);
+        e->y = 100;
+    }
+}
+
+#define MOVE_PERIOD_US 125 /* 8kHz polling */
+
+/* Fills in one pointer move */
+static void push_move(MouseEvent *e, uint64_t now, long x, long y)
+{
+    push(e, MOUSE_BUTTON_UNKNOWN, false, now, x, y);
+}
+
+/* Pointer travel only, no button ever held: the early-out path */
+static void build_moves_hover(MouseEvent *events, size_t count, uint64_t *rng)
+{
+    uint64_t now = 1000000;
+    long x = 500, y = 500;
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t r = bench_rand(rng);
+        x += (long)(r % 5) - 2;
+        y += (long)((r >> 8) % 5) - 2;
+        now += MOVE_PERIOD_US;
+        push_move(&events[i], now, x, y);
+    }
+}
+
+/*
+ * Clicks held 150ms while the hand jitters within 2px, so every move in
+ * the hold is tracked (worst case), separated by 100ms of hover
+ */
+static void build_moves_held(MouseEvent *events, size_t count, uint64_t *rng)
+{
+    uint64_t now = 1000000;
+    size_t i = 0;
+    while (i < count)
+    {
+        push(&events[i++], MOUSE_BUTTON_LEFT, true, now, 500, 500);
+        for (int m = 0; m < 1200 && i + 1 < count; m++)
+        {
+            uint64_t r = bench_rand(rng);
+            now += MOVE_PERIOD_US;
+            push_move(&events[i++], now, 500 + (long)(r % 3) - 1, 500 + (long)((r >> 8) % 3) - 1);
+        }
+        if (i < count)
+            push(&events[i++], MOUSE_BUTTON_LEFT, false, now, 500, 500);
+        for (int m = 0; m < 800 && i < count; m++)
+        {
+            now += MOVE_PERIOD_US;
+            push_move(&events[i++], now, 500, 500 + m / 8);
+        }
+    }
+}
+
+/* 300ms drags travelling 1px per move out and back, then 200ms of hover */
+static void build_moves_drag(MouseEvent *events, size_t count, uint64_t *rng)
+{
+    uint64_t now = 1000000;
+    size_t i = 0;
+    while (i < count)
+    {
+        uint64_t r = bench_rand(rng);
+        long y = 300 + (long)(r % 200);
+        push(&events[i++], MOUSE_BUTTON_LEFT, true, now, 500, y);
+        for (int m = 0; m < 2400 && i + 1 < count; m++)
+        {
+            now += MOVE_PERIOD_US;
+            push_move(&events[i++], now, 500 + (m < 1200 ? m : 2400 - m) / 8, y);
+        }
+        if (i < count)
+            push(&events[i++], MOUSE_BUTTON_LEFT, false, now, 500, y);
+        for (int m = 0; m < 1600 && i < count; m++)
+        {
+            now += MOVE_PERIOD_US;
+            push_move(&events[i++], now, 500 - m / 16, y);
+        }
+    }
+}
+
+static const Scenario SCENARIOS[] = {
+    {"clean_clicks", build_clean_clicks},
+    {"bounce_bursts", build_bounce_bursts},
+    {"chatter", build_chatter},
+    {"drags", build_drags},
+    {"wheel_reversals", build_wheel_reversals},
+    {"unmonitored", build_unmonitored},
+    {"injected", build_injected},
+    {"moves_hover", build_moves_hover},
+    {"moves_held", build_moves_held},
+    {"moves_drag", build_moves_drag},
+    /* Last: also feeds the batch measurement */
+    {"mixed", build_mixed},
+};
+
+static void configure(DebounceManager *manager, bool hybrid)
+{
+    bench_configure(manager, BENCH_ALL_BUTTONS & ~(1u << MOUSE_BUTTON_X2));
+    debounce_set_hybrid_heuristic(manager, hybrid);
+}
+
+/* One pass over the stream, collecting releases at their deadlines like the release scheduler */
+static uint64_t run_stream(DebounceManager *manager, const MouseEvent *events, size_t count)
+{
+    uint64_t blocked = 0;
+    uint64_t deadline = UINT64_MAX;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const MouseEvent *e = &events[i];
+        if (e->timestamp >= deadline)
+        {
+            blocked += debounce_collect_deferred_releases(manager, e->timestamp);
+            if (!debounce_get_next_deadline(manager, &deadline))
+                deadline = UINT64_MAX;
+        }
+
+        if (e->button == MOUSE_BUTTON_UNKNOWN)
+        {
+            debounce_process_move(manager, e->x, e->y);
+            continue;
+        }
+
+        bool verdict = debounce_process_event(manager, e);
+        blocked += verdict;
+
+        /* A blocked UP may have opened a confirm window */
+        if (verdict && !e->is_down && deadline == UINT64_MAX)
+        {
+            if (!debounce_get_next_deadline(manager, &deadline))
+                deadline = UINT64_MAX;
+        }
+    }
+    return blocked;
+}
+
+/* One timed pass of a stream through a fresh manager, in ns */
+static uint64_t time_stream(const MouseEvent *events, size_t count, bool hybrid)
+{
+    DebounceManager manager;
+    configure(&manager, hybrid);
+
+    uint64_t start = bench_now_ns();
+    bench_consume(run_stream(&manager, events, count));
+    uint64_t elapsed = bench_now_ns() - start;
+
+    debounce_cleanup(&manager);
+    return elapsed;
+}
+
+static uint64_t time_batch(const MouseEvent *events, size_t count, bool *verdicts)
+{
+    DebounceManager manager;
+    configure(&manager, false);
+
+    uint64_t start = bench_now_ns();
+    bench_consume(debounce_process_batch(&manager, events, count, verdicts));
+    uint64_t elapsed = bench_now_ns() - start;
+
+    debounce_cleanup(&manager);
+    return elapsed;
+}
+
+/* Leaves a release pending on every button, confirm window starting now */
+static void arm_releases(DebounceManager *manager)
+{
+    uint64_t now = debounce_get_timestamp(manager);
+    for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
+    {
+        if (i == MOUSE_BUTTON_WHEEL)
+            continue;
+
+        MouseEvent e;
+        push(&e, (MouseButton)i, true, now - 400000, 100, 100);
+        debounce_process_event(manager, &e);
+        push(&e, (MouseButton)i, false, now, 200, 100);
+        debounce_process_event(manager, &e);
+    }
+}
+
+/* CHECK_CALLS calls of debounce_check_deferred_releases, with nothing pending or every button pending but not due */
+static uint64_t time_check_deferred(bool pending)
+{
+    DebounceManager manager;
+    configure(&manager, true);
+    for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
+        debounce_set_monitored(&manager, i, true);
+
+    /* Armed outside the timed region; the window outlasts the loop by far */
+    if (pending)
+        arm_releases(&manager);
+
+    uint32_t released = 0;
+    uint64_t start = bench_now_ns();
+    for (uint32_t call = 0; call < CHECK_CALLS; call++)
+        released |= debounce_check_deferred_releases(&manager, NULL);
+    uint64_t elapsed = bench_now_ns() - start;
+
+    bench_consume(released);
+    debounce_cleanup(&manager);
+    return elapsed;
+}
+
+static bool write_results(const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (!file)
+    {
+        fprintf(stderr, "bench_debouncer: cannot write %s\n", path);
+        return false;
+    }
+
+    fprintf(file, "# bench_debouncer ns/event\n");
+    for (int i = 0; i < result_count; i++)
+        fprintf(file, "%s %.3f\n", results[i].name, results[i].ns);
+    fclose(file);
+    return true;
+}
+
+/* Returns the number of regressed scenarios, or -1 if the baseline cannot be read */
+static int compare_baseline(const char *path, double threshold)
+{
+    FILE *file = fopen(path, "r");
+    if (!file)
+    {
+        fprintf(stderr, "bench_debouncer: cannot read %s\n", path);
+        return -1;
+    }
+
+    printf("\nAgainst %s (threshold %.1f%%):\n", path, threshold);
+
+    int regressions = 0;
+    char line[128];
+    while (fgets(line, sizeof(line), file))
+    {
+        char name[NAME_SIZE];
+        double baseline;
+        if (line[0] == '#' || sscanf(line, "%47s %lf", name, &baseline) != 2 || baseline <= 0.0)
+            continue;
+
+        for (int i = 0; i < result_count; i++)
+        {
+            if (strcmp(results[i].name, name) != 0)
+                continue;
+
+            double delta = (results[i].ns - baseline) * 100.0 / baseline;
+            bool regressed = delta > threshold;
+            printf("  %-32s %8.2f -> %8.2f ns (%+6.1f%%)%s\n",
+                   name, baseline, results[i].ns, delta, regressed ? "  REGRESSION" : "");
+            regressions += regressed;
+            break;
+        }
+    }
+    fclose(file);
+    return regressions;
+}
+
+int main(int argc, char **argv)
+{
+    int iterations = DEFAULT_ITERATIONS;
+    double threshold = DEFAULT_THRESHOLD;
+    const char *output = NULL;
+    const char *baseline = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+            iterations = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+            output = argv[++i];
+        else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+            baseline = argv[++i];
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+            threshold = atof(argv[++i]);
+        else
+        {
+            fprintf(stderr, "usage: %s [--iterations N] [--output FILE] [--baseline FILE] [--threshold PCT]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (iterations < 1)
+        iterations = 1;
+
+    size_t scenario_count = sizeof(SCENARIOS) / sizeof(SCENARIOS[0]);
+    MouseEvent *streams[sizeof(SCENARIOS) / sizeof(SCENARIOS[0])];
+    bool *verdicts = calloc(EVENT_COUNT, sizeof(bool));
+    if (!verdicts)
+        return 1;
+    for (size_t s = 0; s < scenario_count; s++)
+    {
+        uint64_t rng = 0x9E3779B97F4A7C15ull;
+        streams[s] = calloc(EVENT_COUNT, sizeof(MouseEvent));
+        if (!streams[s])
+            return 1;
+        SCENARIOS[s].build(streams[s], EVENT_COUNT, &rng);
+    }
+
+    /*
+     * Round-robin over every measurement and keep the best pass of each,
+     * so slow drift on a shared machine hits all scenarios alike instead
+     * of whichever happened to run during it.
+     */
+    size_t slot_count = scenario_count * 2 + 3;
+    uint64_t best[MAX_RESULTS];
+    for (size_t m = 0; m < slot_count; m++)
+        best[m] = UINT64_MAX;
+
+    for (int iter = 0; iter < iterations; iter++)
+    {
+        size_t m = 0;
+        for (size_t s = 0; s < scenario_count; s++)
+        {
+            for (int hybrid = 0; hybrid < 2; hybrid++, m++)
+            {
+                uint64_t elapsed = time_stream(streams[s], EVENT_COUNT, hybrid != 0);
+                if (elapsed < best[m])
+                    best[m] = elapsed;
+            }
+        }
+
+        uint64_t elapsed = time_batch(streams[scenario_count - 1], EVENT_COUNT, verdicts);
+        if (elapsed < best[m])
+            best[m] = elapsed;
+        m++;
+        for (int pending = 0; pending < 2; pending++, m++)
+        {
+            elapsed = time_check_deferred(pending != 0);
+            if (elapsed < best[m])
+                best[m] = elapsed;
+        }
+    }
+
+    printf("bench_debouncer (%u events per stream, best of %d):\n", EVENT_COUNT, iterations);
+    size_t m = 0;
+    for (size_t s = 0; s < scenario_count; s++)
+    {
+        add_result(SCENARIOS[s].name, "hybrid_off", (double)best[m++] / EVENT_COUNT);
+        add_result(SCENARIOS[s].name, "hybrid_on", (double)best[m++] / EVENT_COUNT);
+    }
+    add_result("batch", SCENARIOS[scenario_count - 1].name, (double)best[m++] / EVENT_COUNT);
+    add_result("check_deferred", "idle", (double)best[m++] / CHECK_CALLS);
+    add_result("check_deferred", "pending", (double)best[m++] / CHECK_CALLS);
+
+    for (size_t s = 0; s < scenario_count; s++)
+        free(streams[s]);
+    free(verdicts);
+
+    if (output && !write_results(output))
+        return 1;
+
+    if (baseline)
+    {
+        int regressions = compare_baseline(baseline, threshold);
+        if (regressions < 0)
+            return 1;
+        if (regressions > 0)
+        {
+            printf("%d scenario(s) regressed by more than %.1f%%\n", regressions, threshold);
+            return 2;
+        }
+        printf("No regressions\n");
+    }
+    return 0;
+}
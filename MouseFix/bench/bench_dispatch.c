@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench_common.h"
+#include "../src/core/debouncer.h"
+
+/*
+ * debounce_process_event (a handler per button, picked when the
+ * configuration changes) against debounce_process_event_generic (the
+ * configuration re-read and branched on per event), on one mixed stream
+ * under the configurations the handlers specialise for.
+ */
+
+#define EVENT_COUNT (1u << 18)
+#define ITERATIONS  16
+
+#define WHEEL_BIT    (1u << MOUSE_BUTTON_WHEEL)
+
+typedef struct
+{
+    const char *name;
+    uint32_t monitored_mask;
+    bool hybrid;
+    bool adaptive;
+} Setup;
+
+static const Setup SETUPS[] = {
+    {"all_hybrid", BENCH_ALL_BUTTONS, true, false},
+    {"all_plain", BENCH_ALL_BUTTONS, false, false},
+    {"all_adaptive", BENCH_ALL_BUTTONS, true, true},
+    {"buttons_only", BENCH_ALL_BUTTONS & ~WHEEL_BIT, true, false},
+    {"wheel_only", WHEEL_BIT, true, false},
+    {"left_only", 1u << MOUSE_BUTTON_LEFT, true, false},
+};
+
+#define SETUP_COUNT (sizeof(SETUPS) / sizeof(SETUPS[0]))
+
+static void configure(DebounceManager *manager, const Setup *setup)
+{
+    bench_configure(manager, setup->monitored_mask);
+    debounce_set_hybrid_heuristic(manager, setup->hybrid);
+    AdaptiveParams adaptive = {setup->adaptive, 0, 0};
+    debounce_set_adaptive(manager, &adaptive);
+}
+
+/* One timed pass in ns */
+static uint64_t time_pass(const MouseEvent *events, const Setup *setup, bool specialized)
+{
+    DebounceManager manager;
+    configure(&manager, setup);
+
+    uint64_t blocked = 0;
+    uint64_t start = bench_now_ns();
+    if (specialized)
+    {
+        for (size_t i = 0; i < EVENT_COUNT; i++)
+            blocked += debounce_process_event(&manager, &events[i]);
+    }
+    else
+    {
+        for (size_t i = 0; i < EVENT_COUNT; i++)
+            blocked += debounce_process_event_generic(&manager, &events[i]);
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    bench_consume(blocked);
+    return elapsed;
+}
+
+int main(void)
+{
+    MouseEvent *events = calloc(EVENT_COUNT, sizeof(MouseEvent));
+    if (!events)
+        return 1;
+    bench_build_mixed(events, EVENT_COUNT, 0xBB67AE8584CAA73Bull);
+
+    uint64_t best[SETUP_COUNT][2];
+    for (size_t s = 0; s < SETUP_COUNT; s++)
+        best[s][0] = best[s][1] = UINT64_MAX;
+
+    /* Round-robin so drift on a shared machine hits every measurement alike */
+    for (int iter = 0; iter < ITERATIONS; iter++)
+    {
+        for (size_t s = 0; s < SETUP_COUNT; s++)
+        {
+            for (int v = 0; v < 2; v++)
+            {
+                uint64_t elapsed = time_pass(events, &SETUPS[s], v == 1);
+                if (elapsed < best[s][v])
+                    best[s][v] = elapsed;
+            }
+        }
+    }
+
+    printf("bench_dispatch (%u events, best of %d), ns/event:\n", EVENT_COUNT, ITERATIONS);
+    printf("  %-14s %9s %12s %8s\n", "setup", "generic", "specialized", "change");
+    for (size_t s = 0; s < SETUP_COUNT; s++)
+    {
+        double generic = (double)best[s][0] / EVENT_COUNT;
+        double specialized = (double)best[s][1] / EVENT_COUNT;
+        printf("  %-14s %9.2f %12.2f %+7.1f%%\n", SETUPS[s].name, generic, specialized,
+               100.0 * (specialized - generic) / generic);
+    }
+
+    free(events);
+    return 0;
+}
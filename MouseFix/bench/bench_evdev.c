@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "bench_common.h"
+#include "../src/linux/evdev_daemon.h"
+
+/*
+ * The headless daemon on a live 1 kHz stream: a writer thread feeds one
+ * report per millisecond into a pipe, stamped on the engine clock as a
+ * device node would be, the daemon runs live on its own thread, and this
+ * thread reads the filtered frames back. Prints the delay from a frame's
+ * stamp to its arrival at the reader (deferred releases count from their
+ * deadline), the daemon thread's CPU time per event and its syscalls.
+ */
+
+#define DURATION_MS 5000
+#define MAX_SAMPLES (DURATION_MS * 4)
+
+typedef struct
+{
+    int fd;
+    uint32_t reports;
+} Writer;
+
+typedef struct
+{
+    EvdevDaemon *daemon;
+    int out_fd;
+    uint64_t cpu_ns;
+    int status;
+} DaemonThread;
+
+static uint64_t thread_cpu_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void stamp(struct input_event *frames, size_t count, uint16_t type, uint16_t code, int32_t value)
+{
+    struct input_event *e = &frames[count];
+    memset(e, 0, sizeof(*e));
+    evdev_frame_set_time(e, time_manager_now_us());
+    e->type = type;
+    e->code = code;
+    e->value = value;
+}
+
+/* Moves every millisecond; a click every 250ms, every third held 210ms (a drag), every other one with chatter */
+static void writer_thread(void *arg)
+{
+    Writer *writer = (Writer *)arg;
+    uint64_t rng = 0x9E3779B97F4A7C15ull;
+
+    for (uint32_t ms = 0; ms < writer->reports; ms++)
+    {
+        struct input_event frames[8];
+        size_t count = 0;
+        uint64_t r = bench_rand(&rng);
+        uint32_t phase = ms % 250;
+        uint32_t click = ms / 250;
+        uint32_t up = click % 3 == 0 ? 210 : 60;
+
+        stamp(frames, count++, EV_REL, REL_X, (int32_t)(r % 3) - 1);
+        if (phase == 0 || phase == up)
+            stamp(frames, count++, EV_KEY, BTN_LEFT, phase == 0);
+        else if (click % 2 == 1 && up == 60 && (phase == 64 || phase == 67))
+            stamp(frames, count++, EV_KEY, BTN_LEFT, phase == 64);
+        stamp(frames, count++, EV_SYN, SYN_REPORT, 0);
+
+        ssize_t ignored = write(writer->fd, frames, count * sizeof(struct input_event));
+        (void)ignored;
+        bench_sleep_ms(1);
+    }
+    close(writer->fd);
+}
+
+static void daemon_thread(void *arg)
+{
+    DaemonThread *ctx = (DaemonThread *)arg;
+    uint64_t start = thread_cpu_ns();
+    ctx->status = evdev_daemon_run(ctx->daemon);
+    ctx->cpu_ns = thread_cpu_ns() - start;
+    close(ctx->out_fd);
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static uint64_t percentile(const uint64_t *sorted, size_t count, double p)
+{
+    size_t index = (size_t)(p * (double)(count - 1));
+    return sorted[index];
+}
+
+int main(void)
+{
+    int in[2], out[2];
+    if (pipe(in) != 0 || pipe(out) != 0)
+        return 1;
+
+    static EvdevDaemon daemon;
+    if (!evdev_daemon_init(&daemon, in[0], out[1], EVDEV_CLOCK_FRAME, false))
+        return 1;
+    bench_configure(&daemon.stream.filter.pipeline.debounce, BENCH_ALL_BUTTONS);
+
+    uint64_t *samples = calloc(MAX_SAMPLES, sizeof(uint64_t));
+    if (!samples)
+        return 1;
+
+    Writer writer = {in[1], DURATION_MS};
+    DaemonThread ctx = {&daemon, out[1], 0, -1};
+    MfThread writer_handle, daemon_handle;
+    mf_thread_start(&daemon_handle, daemon_thread, &ctx);
+    mf_thread_start(&writer_handle, writer_thread, &writer);
+
+    /* One sample per report: the stamp of its SYN against when it was read */
+    size_t count = 0;
+    uint64_t keys = 0;
+    struct input_event frames[64];
+    ssize_t got;
+    while ((got = read(out[0], frames, sizeof(frames))) > 0)
+    {
+        uint64_t arrived = time_manager_now_us();
+        for (size_t i = 0; i < (size_t)got / sizeof(struct input_event); i++)
+        {
+            keys += frames[i].type == EV_KEY;
+            if (frames[i].type != EV_SYN || count == MAX_SAMPLES)
+                continue;
+            uint64_t at = evdev_frame_time(&frames[i]);
+            samples[count++] = arrived > at ? arrived - at : 0;
+        }
+    }
+
+    mf_thread_join(&writer_handle);
+    mf_thread_join(&daemon_handle);
+    close(in[0]);
+    close(out[0]);
+
+    if (ctx.status != 0 || count == 0)
+    {
+        free(samples);
+        evdev_daemon_cleanup(&daemon);
+        return 1;
+    }
+
+    qsort(samples, count, sizeof(uint64_t), compare_u64);
+    const EvdevFilterStats *stats = &daemon.stream.filter.stats;
+    printf("reports out:   %zu (%llu key frames; %llu blocked, %llu deferred releases)\n", count,
+           (unsigned long long)keys, (unsigned long long)stats->blocked, (unsigned long long)stats->releases);
+    printf("stamp to read: p50 %llu us  p99 %llu us  p99.9 %llu us  max %llu us\n",
+           (unsigned long long)percentile(samples, count, 0.50),
+           (unsigned long long)percentile(samples, count, 0.99),
+           (unsigned long long)percentile(samples, count, 0.999), (unsigned long long)samples[count - 1]);
+    printf("daemon CPU:    %.2f us/frame over %llu frames\n", (double)ctx.cpu_ns / 1000.0 / (double)stats->frames_in,
+           (unsigned long long)stats->frames_in);
+    printf("syscalls:      %llu reads, %llu writes, %llu wakeups (%.2f per report)\n",
+           (unsigned long long)daemon.stream.stats.reads, (unsigned long long)daemon.stream.stats.writes,
+           (unsigned long long)daemon.wakeups,
+           (double)(daemon.stream.stats.reads + daemon.stream.stats.writes + daemon.wakeups) / DURATION_MS);
+
+    free(samples);
+    evdev_daemon_cleanup(&daemon);
+    return 0;
+}
@@ -0,0 +1,228 @@
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "bench_common.h"
+#include "../src/linux/evdev_loop.h"
+
+/*
+ * The multi-device loop under load: 16 devices, each fed one report per
+ * millisecond through its own pipe, all filtered on one thread. A click
+ * every 250ms per device, every third one a drag, keeps the shared
+ * timerfd busy. A reader thread polls the 16 outputs. Prints the delay
+ * from a report's stamp to its arrival at the reader (deferred releases
+ * count from their deadline), the loop thread's CPU time per frame,
+ * syscalls per 1000 input frames, wakeups and timer re-arms. Runs once on
+ * epoll with plain read/write and once on io_uring, where available.
+ */
+
+#define DEVICES     16
+#define DURATION_MS 3000
+#define MAX_SAMPLES (DEVICES * DURATION_MS * 2)
+
+typedef struct
+{
+    int in[DEVICES][2];
+    int out[DEVICES][2];
+} Pipes;
+
+typedef struct
+{
+    EvdevLoop *loop;
+    uint64_t cpu_ns;
+    int status;
+} LoopThread;
+
+typedef struct
+{
+    Pipes *pipes;
+    uint64_t *samples;
+    size_t count;
+} Reader;
+
+static uint64_t thread_cpu_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void stamp(struct input_event *e, uint64_t now, uint16_t type, uint16_t code, int32_t value)
+{
+    memset(e, 0, sizeof(*e));
+    evdev_frame_set_time(e, now);
+    e->type = type;
+    e->code = code;
+    e->value = value;
+}
+
+/* Devices are staggered so their clicks and deadlines do not line up */
+static void writer_thread(void *arg)
+{
+    Pipes *pipes = (Pipes *)arg;
+    uint64_t rng = 0x9E3779B97F4A7C15ull;
+
+    for (uint32_t ms = 0; ms < DURATION_MS; ms++)
+    {
+        uint64_t now = time_manager_now_us();
+        for (int d = 0; d < DEVICES; d++)
+        {
+            struct input_event frames[4];
+            size_t count = 0;
+            uint32_t t = ms + (uint32_t)d * 13;
+            uint32_t phase = t % 250;
+            uint32_t up = (t / 250) % 3 == 0 ? 210 : 60;
+
+            stamp(&frames[count++], now, EV_REL, REL_X, (int32_t)(bench_rand(&rng) % 3) - 1);
+            if (phase == 0 || phase == up)
+                stamp(&frames[count++], now, EV_KEY, BTN_LEFT, phase == 0);
+            stamp(&frames[count++], now, EV_SYN, SYN_REPORT, 0);
+
+            ssize_t ignored = write(pipes->in[d][1], frames, count * sizeof(struct input_event));
+            (void)ignored;
+        }
+        bench_sleep_ms(1);
+    }
+    for (int d = 0; d < DEVICES; d++)
+        close(pipes->in[d][1]);
+}
+
+static void loop_thread(void *arg)
+{
+    LoopThread *ctx = (LoopThread *)arg;
+    uint64_t start = thread_cpu_ns();
+    ctx->status = evdev_loop_run(ctx->loop);
+    ctx->cpu_ns = thread_cpu_ns() - start;
+}
+
+/* One sample per report: the stamp of its SYN against when it was read */
+static void reader_thread(void *arg)
+{
+    Reader *reader = (Reader *)arg;
+    struct pollfd fds[DEVICES];
+    int open = DEVICES;
+    for (int d = 0; d < DEVICES; d++)
+    {
+        fds[d].fd = reader->pipes->out[d][0];
+        fds[d].events = POLLIN;
+    }
+
+    while (open > 0 && poll(fds, DEVICES, -1) > 0)
+    {
+        for (int d = 0; d < DEVICES; d++)
+        {
+            if (!(fds[d].revents & (POLLIN | POLLHUP)))
+                continue;
+
+            struct input_event frames[64];
+            ssize_t got = read(fds[d].fd, frames, sizeof(frames));
+            uint64_t arrived = time_manager_now_us();
+            if (got <= 0)
+            {
+                fds[d].fd = -1;
+                open--;
+                continue;
+            }
+            for (size_t i = 0; i < (size_t)got / sizeof(struct input_event); i++)
+            {
+                if (frames[i].type != EV_SYN || reader->count == MAX_SAMPLES)
+                    continue;
+                uint64_t at = evdev_frame_time(&frames[i]);
+                reader->samples[reader->count++] = arrived > at ? arrived - at : 0;
+            }
+        }
+    }
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static uint64_t percentile(const uint64_t *sorted, size_t count, double p)
+{
+    return sorted[(size_t)(p * (double)(count - 1))];
+}
+
+static int run_load(EvdevIo io)
+{
+    static Pipes pipes;
+    static EvdevLoop loop;
+    if (!evdev_loop_init(&loop, io))
+    {
+        printf("%s: unavailable\n\n", evdev_io_name(io));
+        return 0;
+    }
+
+    for (int d = 0; d < DEVICES; d++)
+    {
+        if (pipe(pipes.in[d]) != 0 || pipe(pipes.out[d]) != 0)
+            return 1;
+        int id = evdev_loop_add(&loop, pipes.in[d][0], pipes.out[d][1], EVDEV_CLOCK_FRAME);
+        if (id < 0)
+            return 1;
+        bench_configure(&evdev_loop_filter(&loop, id)->pipeline.debounce, BENCH_ALL_BUTTONS);
+    }
+
+    Reader reader = {&pipes, calloc(MAX_SAMPLES, sizeof(uint64_t)), 0};
+    if (!reader.samples)
+        return 1;
+
+    LoopThread ctx = {&loop, 0, -1};
+    MfThread loop_handle, writer_handle, reader_handle;
+    mf_thread_start(&reader_handle, reader_thread, &reader);
+    mf_thread_start(&loop_handle, loop_thread, &ctx);
+    mf_thread_start(&writer_handle, writer_thread, &pipes);
+    mf_thread_join(&writer_handle);
+    mf_thread_join(&loop_handle);
+    /* The loop is done writing: end the reader's inputs */
+    for (int d = 0; d < DEVICES; d++)
+        close(pipes.out[d][1]);
+    mf_thread_join(&reader_handle);
+
+    if (ctx.status != 0 || reader.count == 0)
+        return 1;
+
+    uint64_t frames_in = 0, releases = 0;
+    for (int d = 0; d < DEVICES; d++)
+    {
+        const EvdevStream *stream = evdev_loop_stream(&loop, d);
+        frames_in += stream->filter.stats.frames_in;
+        releases += stream->filter.stats.releases;
+        close(pipes.in[d][0]);
+        close(pipes.out[d][0]);
+    }
+
+    uint64_t *samples = reader.samples;
+    size_t count = reader.count;
+    uint64_t syscalls = evdev_loop_syscalls(&loop);
+    qsort(samples, count, sizeof(uint64_t), compare_u64);
+    printf("%s: %d devices x 1 kHz, %d ms: %zu reports out, %llu deferred releases\n", evdev_io_name(loop.io),
+           DEVICES, DURATION_MS, count, (unsigned long long)releases);
+    printf("stamp to read: p50 %llu us  p99 %llu us  p99.9 %llu us  max %llu us\n",
+           (unsigned long long)percentile(samples, count, 0.50),
+           (unsigned long long)percentile(samples, count, 0.99),
+           (unsigned long long)percentile(samples, count, 0.999), (unsigned long long)samples[count - 1]);
+    printf("loop CPU:      %.2f us/frame over %llu frames (%.1f%% of one core)\n",
+           (double)ctx.cpu_ns / 1000.0 / (double)frames_in, (unsigned long long)frames_in,
+           (double)ctx.cpu_ns / 1e7 / (DURATION_MS / 1000.0));
+    printf("syscalls:      %llu, %.1f per 1000 frames; %llu wakeups (%.2f reports per wakeup)\n",
+           (unsigned long long)syscalls, (double)syscalls * 1000.0 / (double)frames_in,
+           (unsigned long long)loop.stats.wakeups, (double)DEVICES * DURATION_MS / (double)loop.stats.wakeups);
+    printf("timerfd:       %llu fires, %llu re-arms\n\n", (unsigned long long)loop.stats.timer_fires,
+           (unsigned long long)loop.stats.timer_sets);
+
+    free(samples);
+    evdev_loop_cleanup(&loop);
+    return 0;
+}
+
+int main(void)
+{
+    if (run_load(EVDEV_IO_EPOLL) != 0)
+        return 1;
+    return run_load(EVDEV_IO_URING);
+}
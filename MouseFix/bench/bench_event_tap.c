@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench_common.h"
+#include "../src/core/event_tap.h"
+
+/*
+ * Producer-side cost of event_tap_publish on the hook path.
+ *
+ * Bursts of BURST events go through debounce_process_event, alone and
+ * followed by event_tap_publish, and each burst is timed as a whole; the
+ * difference is what the tap adds per event. Bursts stay below the ring
+ * capacity and the ring is emptied between them, so the numbers are for
+ * the accepted path (drops are cheaper still).
+ *
+ *   drained inline   the bench drains between bursts, outside the timing
+ *   consumer thread  the real setup, doorbell included; on a single core
+ *                    the consumer may be scheduled inside a burst
+ */
+
+#define BURST  1024
+#define ROUNDS 2000
+
+static void consume(const EventTapRecord *records, size_t count, void *user_data)
+{
+    uint64_t *sum = user_data;
+    for (size_t i = 0; i < count; i++)
+        *sum += packed_event_time(&records[i].event) + records[i].blocked;
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void build_events(MouseEvent *events, size_t count)
+{
+    uint64_t rng = 0x6A09E667F3BCC908ull;
+    uint64_t now = 1000000;
+    bool down = false;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t r = bench_rand(&rng);
+        down = !down;
+        now += (((r >> 4) & 7) == 0 ? 2 + (r >> 12) % 8 : 60 + (r >> 12) % 200) * 1000;
+        events[i].button = MOUSE_BUTTON_LEFT;
+        events[i].timestamp = now;
+        events[i].is_down = down;
+        events[i].x = 100 + (long)(r >> 40) % 8;
+        events[i].y = 100;
+        events[i].is_injected = false;
+        events[i].data = 0;
+    }
+}
+
+typedef enum
+{
+    MODE_NO_TAP,
+    MODE_DRAINED_INLINE,
+    MODE_CONSUMER_THREAD
+} Mode;
+
+/* Per-burst ns, sorted */
+static void run(DebounceManager *manager, EventTap *tap, Mode mode, const MouseEvent *events, uint64_t *samples)
+{
+    static EventTapRecord scratch[EVENT_TAP_CAPACITY];
+
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        uint64_t start = bench_now_ns();
+        for (size_t i = 0; i < BURST; i++)
+        {
+            bool blocked = debounce_process_event(manager, &events[i]);
+            if (mode == MODE_NO_TAP)
+                bench_consume(blocked);
+            else
+                event_tap_publish(tap, &events[i], blocked);
+        }
+        samples[round] = bench_now_ns() - start;
+
+        if (mode == MODE_DRAINED_INLINE)
+        {
+            bench_consume(event_tap_drain(tap, scratch, EVENT_TAP_CAPACITY));
+        }
+        else if (mode == MODE_CONSUMER_THREAD)
+        {
+            event_tap_kick(tap);
+            while (mf_atomic_load32(&tap->tail) != mf_atomic_load32(&tap->head))
+                mf_thread_yield();
+        }
+    }
+    qsort(samples, ROUNDS, sizeof(uint64_t), compare_u64);
+}
+
+static double per_event(const uint64_t *samples, double quantile)
+{
+    return (double)samples[(size_t)(quantile * (ROUNDS - 1))] / BURST;
+}
+
+static void report(const char *name, const uint64_t *samples, const uint64_t *base)
+{
+    printf("%-20s %8.2f %8.2f %8.2f", name, per_event(samples, 0.5), per_event(samples, 0.9), per_event(samples, 0.99));
+    if (base)
+        printf("   +%.2f", per_event(samples, 0.5) - per_event(base, 0.5));
+    printf("\n");
+}
+
+int main(void)
+{
+    static MouseEvent events[BURST];
+    static uint64_t base[ROUNDS], inline_drain[ROUNDS], threaded[ROUNDS];
+    build_events(events, BURST);
+
+    DebounceManager manager;
+    debounce_init(&manager);
+    debounce_set_monitored(&manager, MOUSE_BUTTON_LEFT, true);
+    debounce_set_threshold(&manager, MOUSE_BUTTON_LEFT, 50, 1, 200);
+
+    EventTap *tap = malloc(sizeof(EventTap));
+    uint64_t sum = 0;
+    if (!tap)
+        return 1;
+
+    printf("slot size %zu bytes, ring %zu KB\n", sizeof(tap->records[0]), sizeof(tap->records) / 1024);
+
+    run(&manager, NULL, MODE_NO_TAP, events, base);
+
+    event_tap_init(tap);
+    run(&manager, tap, MODE_DRAINED_INLINE, events, inline_drain);
+
+    if (!event_tap_start(tap, consume, &sum))
+        return 1;
+    run(&manager, tap, MODE_CONSUMER_THREAD, events, threaded);
+    event_tap_stop(tap);
+
+    printf("%-20s %8s %8s %8s   publish (p50)\n", "ns/event", "p50", "p90", "p99");
+    report("process only", base, NULL);
+    report("+ drained inline", inline_drain, base);
+    report("+ consumer thread", threaded, base);
+    printf("dropped: %u\n", event_tap_get_dropped(tap));
+
+    bench_consume(sum);
+    free(tap);
+    return 0;
+}
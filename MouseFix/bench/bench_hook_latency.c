@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench_common.h"
+#include "../src/core/debouncer.h"
+#include "../src/core/hook_latency.h"
+
+/*
+ * Cost of always-on hook latency accounting: ns/event for
+ * debounce_process_event alone versus the full hook callback sequence
+ * (state before and after, two mf_ticks reads and hook_latency_record).
+ * Also prints the measured decision-path percentiles.
+ */
+
+#define EVENT_COUNT (1u << 20)
+#define ITERATIONS  8
+
+static MouseEvent *build_events(size_t count)
+{
+    MouseEvent *events = calloc(count, sizeof(MouseEvent));
+    if (!events)
+        return NULL;
+
+    uint64_t rng = 0x9E3779B97F4A7C15ull;
+    uint64_t now = 1000000;
+    bool down[MOUSE_BUTTON_COUNT] = {false};
+
+    for (size_t i = 0; i < count; i++)
+    {
+        MouseEvent *e = &events[i];
+        uint64_t r = bench_rand(&rng);
+
+        e->button = (r & 3) == 0 ? MOUSE_BUTTON_RIGHT : MOUSE_BUTTON_LEFT;
+        down[e->button] = !down[e->button];
+        e->is_down = down[e->button];
+        now += (((r >> 4) & 7) == 0 ? 2 + (r >> 12) % 8 : 60 + (r >> 12) % 200) * 1000;
+        e->timestamp = now;
+        e->x = 100 + (long)((r >> 20) % 8);
+        e->y = 100;
+    }
+    return events;
+}
+
+int main(void)
+{
+    static HookLatency latency;
+    DebounceManager manager;
+    bench_configure(&manager, BENCH_ALL_BUTTONS);
+    hook_latency_init(&latency);
+
+    MouseEvent *events = build_events(EVENT_COUNT);
+    if (!events)
+        return 1;
+
+    uint64_t best_plain = UINT64_MAX;
+    uint64_t best_timed = UINT64_MAX;
+    for (int iter = 0; iter < ITERATIONS; iter++)
+    {
+        debounce_reset_statistics(&manager);
+        uint64_t blocked = 0;
+        uint64_t start = bench_now_ns();
+        for (size_t i = 0; i < EVENT_COUNT; i++)
+            blocked += debounce_process_event(&manager, &events[i]);
+        uint64_t elapsed = bench_now_ns() - start;
+        bench_consume(blocked);
+        if (elapsed < best_plain)
+            best_plain = elapsed;
+
+        debounce_reset_statistics(&manager);
+        hook_latency_reset(&latency);
+        blocked = 0;
+        start = bench_now_ns();
+        for (size_t i = 0; i < EVENT_COUNT; i++)
+        {
+            uint64_t entry = mf_ticks();
+            const MouseEvent *e = &events[i];
+            ButtonState from = debounce_get_button_state(&manager, e->button);
+            blocked += debounce_process_event(&manager, e);
+            hook_latency_record(&latency, e->button, from,
+                                debounce_get_button_state(&manager, e->button),
+                                mf_ticks() - entry);
+        }
+        elapsed = bench_now_ns() - start;
+        bench_consume(blocked);
+        if (elapsed < best_timed)
+            best_timed = elapsed;
+    }
+
+    printf("debounce_process_event:          %.2f ns/event\n", (double)best_plain / EVENT_COUNT);
+    printf("with hook latency accounting:    %.2f ns/event (+%.2f)\n",
+           (double)best_timed / EVENT_COUNT, ((double)best_timed - (double)best_plain) / EVENT_COUNT);
+
+    LatencySummary summary;
+    for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
+    {
+        if (!hook_latency_get_button(&latency, (MouseButton)i, &summary) || summary.count == 0)
+            continue;
+        printf("%-6s p50 %llu ns  p99 %llu ns  p99.9 %llu ns  max %llu ns (%u samples)\n",
+               debounce_get_button_name((MouseButton)i),
+               (unsigned long long)summary.p50_ns, (unsigned long long)summary.p99_ns,
+               (unsigned long long)summary.p999_ns, (unsigned long long)summary.max_ns, summary.count);
+    }
+
+    free(events);
+    debounce_cleanup(&manager);
+    return 0;
+}
@@ -0,0 +1,269 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench_common.h"
+#include "../src/core/debouncer.h"
+#include "../src/core/input_decode.h"
+#include "../src/core/time_manager.h"
+
+/*
+ * Per-record cost of the hook path at 8kHz polling: raw records through
+ * input_dispatch (decode, clock, dispatch) into debounce_process_event or
+ * debounce_process_move, next to the engine alone on the same stream
+ * pre-decoded. "dispatch" stamps events from the stream's own clock so
+ * the engine sees realistic gaps; "dispatch_clock" reads the real clock
+ * like the hook does (verdicts then differ, the cost is what counts).
+ */
+
+#define RECORD_COUNT   (1u << 18)
+#define ITERATIONS     16
+#define MOVE_PERIOD_US 125
+
+typedef struct
+{
+    RawMouseRecord *raw;
+    uint64_t *times;
+    MouseEvent *events; /* button == MOUSE_BUTTON_UNKNOWN for moves */
+} Stream;
+
+typedef void (*StreamBuilder)(Stream *stream, uint64_t *rng);
+
+static uint64_t stream_now;
+
+static uint64_t stream_clock(void)
+{
+    return stream_now;
+}
+
+static void put(Stream *stream, size_t i, uint64_t now, uint32_t message, uint32_t mouse_data, int32_t x, int32_t y)
+{
+    RawMouseRecord *raw = &stream->raw[i];
+    raw->message = message;
+    raw->mouse_data = mouse_data;
+    raw->flags = 0;
+    raw->x = x;
+    raw->y = y;
+    stream->times[i] = now;
+
+    MouseEvent *e = &stream->events[i];
+    memset(e, 0, sizeof(*e));
+    e->button = MOUSE_BUTTON_UNKNOWN;
+    e->x = x;
+    e->y = y;
+    if (input_decode_event(raw, e))
+        e->timestamp = now;
+}
+
+/* Moves only: what every hook call costs while nobody clicks */
+static void build_hover(Stream *stream, uint64_t *rng)
+{
+    uint64_t now = 1000000;
+    int32_t x = 500, y = 500;
+    for (size_t i = 0; i < RECORD_COUNT; i++)
+    {
+        uint64_t r = bench_rand(rng);
+        x += (int32_t)(r % 5) - 2;
+        y += (int32_t)((r >> 8) % 5) - 2;
+        now += MOVE_PERIOD_US;
+        put(stream, i, now, INPUT_MSG_MOUSEMOVE, 0, x, y);
+    }
+}
+
+/*
+ * Game-like: continuous 8kHz motion, a click every 150-550ms held 60ms
+ * (one in eight chattering), a right-button drag now and then, wheel notches
+ */
+static void build_gaming(Stream *stream, uint64_t *rng)
+{
+    uint64_t now = 1000000;
+    uint64_t next_action = now + 200000;
+    uint64_t release = 0;
+    uint32_t release_message = 0;
+    int32_t x = 500, y = 500;
+
+    for (size_t i = 0; i < RECORD_COUNT; i++)
+    {
+        uint64_t r = bench_rand(rng);
+        now += MOVE_PERIOD_US;
+
+        if (release && now >= release)
+        {
+            put(stream, i, now, release_message, 0, x, y);
+            release = 0;
+            continue;
+        }
+        if (!release && now >= next_action)
+        {
+            next_action = now + 150000 + (r >> 8) % 400000;
+            switch ((r >> 40) & 15)
+            {
+            case 0:
+                put(stream, i, now, INPUT_MSG_RBUTTONDOWN, 0, x, y);
+                release = now + 400000;
+                release_message = INPUT_MSG_RBUTTONUP;
+                break;
+            case 1:
+            case 2:
+                put(stream, i, now, INPUT_MSG_MOUSEWHEEL, (uint32_t)(uint16_t)((r & 1) ? 120 : -120) << 16, x, y);
+                break;
+            case 3:
+                /* Chatter a few ms after the previous release */
+                put(stream, i, now, INPUT_MSG_LBUTTONDOWN, 0, x, y);
+                release = now + 2000;
+                release_message = INPUT_MSG_LBUTTONUP;
+                next_action = now + 5000;
+                break;
+            default:
+                put(stream, i, now, INPUT_MSG_LBUTTONDOWN, 0, x, y);
+                release = now + 60000;
+                release_message = INPUT_MSG_LBUTTONUP;
+                break;
+            }
+            continue;
+        }
+
+        x += (int32_t)(r % 7) - 3;
+        y += (int32_t)((r >> 8) % 7) - 3;
+        put(stream, i, now, INPUT_MSG_MOUSEMOVE, 0, x, y);
+    }
+}
+
+/* Button and wheel records only: the decode path without the move early-out */
+static void build_buttons(Stream *stream, uint64_t *rng)
+{
+    static const uint32_t messages[][2] = {
+        {INPUT_MSG_LBUTTONDOWN, INPUT_MSG_LBUTTONUP},
+        {INPUT_MSG_RBUTTONDOWN, INPUT_MSG_RBUTTONUP},
+        {INPUT_MSG_XBUTTONDOWN, INPUT_MSG_XBUTTONUP},
+    };
+    uint64_t now = 1000000;
+    for (size_t i = 0; i + 1 < RECORD_COUNT; i += 2)
+    {
+        uint64_t r = bench_rand(rng);
+        int kind = (int)((r >> 4) & 3);
+        now += (((r >> 8) & 7) == 0 ? 2 + (r >> 12) % 8 : 60 + (r >> 12) % 200) * 1000;
+        if (kind == 3)
+        {
+            put(stream, i, now, INPUT_MSG_MOUSEWHEEL, 120u << 16, 500, 500);
+            now += 20000;
+            put(stream, i + 1, now, INPUT_MSG_MOUSEWHEEL, (uint32_t)(uint16_t)-120 << 16, 500, 500);
+            continue;
+        }
+        uint32_t x_button = kind == 2 ? (uint32_t)INPUT_XBUTTON1 << 16 : 0;
+        put(stream, i, now, messages[kind][0], x_button, 500, 500);
+        now += 60000;
+        put(stream, i + 1, now, messages[kind][1], x_button, 500, 500);
+    }
+}
+
+static const struct
+{
+    const char *name;
+    StreamBuilder build;
+} SCENARIOS[] = {
+    {"hover_8khz", build_hover},
+    {"gaming_8khz", build_gaming},
+    {"buttons", build_buttons},
+};
+
+#define SCENARIO_COUNT (sizeof(SCENARIOS) / sizeof(SCENARIOS[0]))
+#define VARIANT_COUNT  3
+
+static bool on_event(const MouseEvent *event, void *user_data)
+{
+    return debounce_process_event((DebounceManager *)user_data, event);
+}
+
+static void on_move(long x, long y, void *user_data)
+{
+    debounce_process_move((DebounceManager *)user_data, x, y);
+}
+
+/* One timed pass in ns: 0 = engine on pre-decoded events, 1 = dispatch, 2 = dispatch with the real clock */
+static uint64_t time_pass(const Stream *stream, int variant)
+{
+    DebounceManager manager;
+    bench_configure(&manager, BENCH_ALL_BUTTONS);
+
+    InputDispatcher dispatcher;
+    input_dispatcher_init(&dispatcher, on_event, &manager);
+    dispatcher.on_move = on_move;
+    if (variant == 1)
+        dispatcher.clock = stream_clock;
+
+    uint64_t blocked = 0;
+    uint64_t start = bench_now_ns();
+    if (variant == 0)
+    {
+        for (size_t i = 0; i < RECORD_COUNT; i++)
+        {
+            const MouseEvent *e = &stream->events[i];
+            if (e->button == MOUSE_BUTTON_UNKNOWN)
+                debounce_process_move(&manager, e->x, e->y);
+            else
+                blocked += debounce_process_event(&manager, e);
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < RECORD_COUNT; i++)
+        {
+            stream_now = stream->times[i];
+            blocked += input_dispatch(&dispatcher, &stream->raw[i]);
+        }
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    bench_consume(blocked);
+    debounce_cleanup(&manager);
+    return elapsed;
+}
+
+int main(void)
+{
+    static const char *const VARIANTS[VARIANT_COUNT] = {"engine", "dispatch", "dispatch_clock"};
+    Stream streams[SCENARIO_COUNT];
+    uint64_t best[SCENARIO_COUNT][VARIANT_COUNT];
+
+    for (size_t s = 0; s < SCENARIO_COUNT; s++)
+    {
+        uint64_t rng = 0x9E3779B97F4A7C15ull;
+        streams[s].raw = calloc(RECORD_COUNT, sizeof(RawMouseRecord));
+        streams[s].times = calloc(RECORD_COUNT, sizeof(uint64_t));
+        streams[s].events = calloc(RECORD_COUNT, sizeof(MouseEvent));
+        if (!streams[s].raw || !streams[s].times || !streams[s].events)
+            return 1;
+        SCENARIOS[s].build(&streams[s], &rng);
+        for (int v = 0; v < VARIANT_COUNT; v++)
+            best[s][v] = UINT64_MAX;
+    }
+
+    /* Round-robin so drift on a shared machine hits every measurement alike */
+    for (int iter = 0; iter < ITERATIONS; iter++)
+    {
+        for (size_t s = 0; s < SCENARIO_COUNT; s++)
+        {
+            for (int v = 0; v < VARIANT_COUNT; v++)
+            {
+                uint64_t elapsed = time_pass(&streams[s], v);
+                if (elapsed < best[s][v])
+                    best[s][v] = elapsed;
+            }
+        }
+    }
+
+    printf("bench_input_decode (%u records per stream, best of %d):\n", RECORD_COUNT, ITERATIONS);
+    for (size_t s = 0; s < SCENARIO_COUNT; s++)
+    {
+        for (int v = 0; v < VARIANT_COUNT; v++)
+            printf("  %-12s %-15s %8.2f ns/record\n", SCENARIOS[s].name, VARIANTS[v], (double)best[s][v] / RECORD_COUNT);
+    }
+
+    for (size_t s = 0; s < SCENARIO_COUNT; s++)
+    {
+        free(streams[s].raw);
+        free(streams[s].times);
+        free(streams[s].events);
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#include "bench_common.h"
+#include "../src/linux/evdev_sink.h"
+
+/*
+ * Deferred releases reaching a sink: every tick releases all five buttons,
+ * as when a drag with every button held ends. Compares a sink call per
+ * release (the old SendInput per button) with one batched flush per tick,
+ * into memory and through the evdev sink to /dev/null, where each sink
+ * call is a write. Prints ns per tick and writes per tick.
+ */
+
+#define TICKS          200000
+#define BUTTONS_MASK   ((1u << MOUSE_BUTTON_WHEEL) - 1)
+#define MEMORY_EVENTS  (OUTPUT_BATCH_CAPACITY)
+
+static void run(const char *label, OutputSink sink, bool batched, const uint64_t *writes)
+{
+    OutputBatch batch;
+    output_batch_init(&batch, sink);
+    uint64_t writes_before = writes ? *writes : 0;
+
+    uint64_t start = bench_now_ns();
+    for (uint64_t tick = 0; tick < TICKS; tick++)
+    {
+        uint64_t now = 1000000 + tick * 1000;
+        if (batched)
+        {
+            output_batch_push_releases(&batch, BUTTONS_MASK, now);
+            output_batch_flush(&batch);
+            continue;
+        }
+        for (int b = 0; b < MOUSE_BUTTON_WHEEL; b++)
+        {
+            output_batch_push_releases(&batch, 1u << b, now);
+            output_batch_flush(&batch);
+        }
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    bench_consume((uint32_t)batch.events_out);
+    printf("%-24s %8.1f ns/tick  %5.2f sink calls/tick", label, (double)elapsed / TICKS,
+           (double)batch.flushes / TICKS);
+    if (writes)
+        printf("  %5.2f writes/tick", (double)(*writes - writes_before) / TICKS);
+    printf("\n");
+}
+
+/* Keeps only the latest batch so the store never fills */
+static bool memory_flush(const PackedEvent *events, size_t count, void *user_data)
+{
+    PackedEvent *last = (PackedEvent *)user_data;
+    for (size_t i = 0; i < count && i < MEMORY_EVENTS; i++)
+        last[i] = events[i];
+    return true;
+}
+
+int main(void)
+{
+    printf("Deferred releases to a sink: %d ticks, 5 buttons released per tick\n", TICKS);
+
+    static PackedEvent last[MEMORY_EVENTS];
+    OutputSink memory = {memory_flush, last};
+    run("memory, per release", memory, false, NULL);
+    run("memory, batched", memory, true, NULL);
+
+    int fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    if (fd < 0)
+        return 1;
+    EvdevSink evdev;
+    OutputSink sink = evdev_sink(&evdev, fd);
+    run("evdev, per release", sink, false, &evdev.writes);
+    run("evdev, batched", sink, true, &evdev.writes);
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,152 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench_common.h"
+#include "../src/core/filter_pipeline.h"
+
+/*
+ * Cost of running the engine as a pipeline stage. "direct" calls
+ * debounce_process_event, "pipeline" runs the stock MousePipeline,
+ * "pipeline_4" adds three pass-through stages around the engine, and
+ * "pointers_4" calls the same four stages through a table of function
+ * pointers, which is what the static chain avoids.
+ */
+
+#define EVENT_COUNT (1u << 18)
+#define ITERATIONS  16
+
+/* Pass-through stage with a counter, so the call cannot be dropped */
+typedef struct
+{
+    uint32_t seen;
+} TallyState;
+
+static inline void tally_stage_init(TallyState *state)
+{
+    state->seen = 0;
+}
+
+static inline bool tally_stage_process(TallyState *state, const MouseEvent *event)
+{
+    state->seen += event->is_down;
+    return false;
+}
+
+MF_STAGE_NO_MOVE(tally, TallyState)
+MF_STAGE_NO_TIME(tally, TallyState)
+
+#define BENCH_STAGES(X)                    \
+    X(first, tally, TallyState)            \
+    X(debounce, debounce, DebounceManager) \
+    X(second, tally, TallyState)           \
+    X(third, tally, TallyState)
+
+MF_PIPELINE_DEFINE(BenchPipeline, bench_pipeline, BENCH_STAGES)
+
+/* The same chain through function pointers */
+typedef bool (*StageProcess)(void *state, const MouseEvent *event);
+
+static bool tally_indirect(void *state, const MouseEvent *event)
+{
+    return tally_stage_process((TallyState *)state, event);
+}
+
+static bool debounce_indirect(void *state, const MouseEvent *event)
+{
+    return debounce_process_event((DebounceManager *)state, event);
+}
+
+#define VARIANT_COUNT 4
+
+/* Pipelines are large and cache-line aligned; keep them off the stack */
+static DebounceManager direct_manager;
+static MousePipeline stock_pipeline;
+static BenchPipeline bench_pipeline;
+
+/* One timed pass in ns */
+static uint64_t time_pass(const MouseEvent *events, int variant)
+{
+    uint64_t blocked = 0;
+    uint64_t start = 0;
+
+    switch (variant)
+    {
+    case 0:
+        bench_configure(&direct_manager, BENCH_ALL_BUTTONS);
+        start = bench_now_ns();
+        for (size_t i = 0; i < EVENT_COUNT; i++)
+            blocked += debounce_process_event(&direct_manager, &events[i]);
+        break;
+    case 1:
+        mouse_pipeline_init(&stock_pipeline);
+        bench_configure(&stock_pipeline.debounce, BENCH_ALL_BUTTONS);
+        start = bench_now_ns();
+        for (size_t i = 0; i < EVENT_COUNT; i++)
+            blocked += mouse_pipeline_process(&stock_pipeline, &events[i]);
+        break;
+    case 2:
+        bench_pipeline_init(&bench_pipeline);
+        bench_configure(&bench_pipeline.debounce, BENCH_ALL_BUTTONS);
+        start = bench_now_ns();
+        for (size_t i = 0; i < EVENT_COUNT; i++)
+            blocked += bench_pipeline_process(&bench_pipeline, &events[i]);
+        break;
+    default:
+    {
+        bench_pipeline_init(&bench_pipeline);
+        bench_configure(&bench_pipeline.debounce, BENCH_ALL_BUTTONS);
+        /* volatile so the compiler cannot resolve the pointers back into direct calls */
+        StageProcess volatile stages[4] = {tally_indirect, debounce_indirect, tally_indirect, tally_indirect};
+        void *states[4] = {&bench_pipeline.first, &bench_pipeline.debounce, &bench_pipeline.second, &bench_pipeline.third};
+        start = bench_now_ns();
+        for (size_t i = 0; i < EVENT_COUNT; i++)
+        {
+            bool block = false;
+            for (int s = 0; s < 4 && !block; s++)
+                block = stages[s](states[s], &events[i]);
+            blocked += block;
+        }
+        break;
+    }
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    bench_consume(blocked + bench_pipeline.first.seen + bench_pipeline.third.seen);
+    return elapsed;
+}
+
+int main(void)
+{
+    static const char *const VARIANTS[VARIANT_COUNT] = {"direct", "pipeline", "pipeline_4", "pointers_4"};
+
+    MouseEvent *events = calloc(EVENT_COUNT, sizeof(MouseEvent));
+    if (!events)
+        return 1;
+    bench_build_mixed(events, EVENT_COUNT, 0x3C6EF372FE94F82Bull);
+
+    uint64_t best[VARIANT_COUNT];
+    for (int v = 0; v < VARIANT_COUNT; v++)
+        best[v] = UINT64_MAX;
+
+    /* Round-robin so drift on a shared machine hits every measurement alike */
+    for (int iter = 0; iter < ITERATIONS; iter++)
+    {
+        for (int v = 0; v < VARIANT_COUNT; v++)
+        {
+            uint64_t elapsed = time_pass(events, v);
+            if (elapsed < best[v])
+                best[v] = elapsed;
+        }
+    }
+
+    printf("bench_pipeline (%u events, best of %d), ns/event:\n", EVENT_COUNT, ITERATIONS);
+    double direct = (double)best[0] / EVENT_COUNT;
+    for (int v = 0; v < VARIANT_COUNT; v++)
+    {
+        double ns = (double)best[v] / EVENT_COUNT;
+        printf("  %-12s %8.2f %+7.1f%%\n", VARIANTS[v], ns, 100.0 * (ns - direct) / direct);
+    }
+
+    free(events);
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include "bench_common.h"
+#include "../src/core/debouncer.h"
+#include "../src/core/release_scheduler.h"
+
+/*
+ * Smart Drag release lateness (actual release time minus deadline) and idle
+ * wakeups per minute, for the old fixed 15ms polling timer and for the
+ * deadline-driven ReleaseScheduler. Runs in real time (~15s).
+ */
+
+#define POLL_INTERVAL_MS 15
+#define IDLE_MS          3000
+#define DRAG_COUNT       20
+#define RELEASE_EVENTS   64
+
+typedef struct
+{
+    DebounceManager *debounce;
+    MfAtomic32 stop;
+    MfAtomic64 deadline;
+    MfAtomic32 wakeups;
+    uint32_t releases;
+    uint64_t lateness_total_us;
+    uint64_t lateness_max_us;
+} PollingContext;
+
+static void polling_thread(void *arg)
+{
+    PollingContext *ctx = (PollingContext *)arg;
+
+    while (!mf_atomic_load32(&ctx->stop))
+    {
+        bench_sleep_ms(POLL_INTERVAL_MS);
+        mf_atomic_store32(&ctx->wakeups, mf_atomic_load32(&ctx->wakeups) + 1);
+
+        uint64_t now = time_manager_now_us();
+        if (debounce_collect_deferred_releases(ctx->debounce, now))
+        {
+            uint64_t lateness = now - mf_atomic_load64(&ctx->deadline);
+            ctx->releases++;
+            ctx->lateness_total_us += lateness;
+            if (lateness > ctx->lateness_max_us)
+                ctx->lateness_max_us = lateness;
+        }
+    }
+}
+
+static void setup(DebounceManager *debounce)
+{
+    debounce_init(debounce);
+    debounce_set_monitored(debounce, MOUSE_BUTTON_LEFT, true);
+    debounce_set_threshold(debounce, MOUSE_BUTTON_LEFT, 50, 1, 200);
+}
+
+/* A 300ms press released in place: blocked, confirm deadline 150ms later */
+static uint64_t start_drag(DebounceManager *debounce)
+{
+    uint64_t now = time_manager_now_us();
+    MouseEvent down = {MOUSE_BUTTON_LEFT, now - 300000, true, 10, 10, false, 0};
+    MouseEvent up = {MOUSE_BUTTON_LEFT, now, false, 10, 10, false, 0};
+    debounce_process_event(debounce, &down);
+    debounce_process_event(debounce, &up);
+
+    uint64_t deadline = 0;
+    debounce_get_next_deadline(debounce, &deadline);
+    return deadline;
+}
+
+static void report(const char *label, uint32_t idle_wakeups, uint32_t releases, uint64_t total, uint64_t max)
+{
+    printf("%-10s idle wakeups %6.0f/min  releases %2u  lateness mean %7.1f us  max %6llu us\n",
+           label,
+           idle_wakeups * 60000.0 / IDLE_MS,
+           releases,
+           releases ? (double)total / releases : 0.0,
+           (unsigned long long)max);
+}
+
+int main(void)
+{
+    printf("Smart Drag deferred release: polling vs deadline scheduler\n");
+
+    /* Before: fixed 15ms polling */
+    {
+        DebounceManager debounce;
+        setup(&debounce);
+        PollingContext ctx = {&debounce, 0, 0, 0, 0, 0, 0};
+        MfThread thread;
+        if (!mf_thread_start(&thread, polling_thread, &ctx))
+            return 1;
+
+        bench_sleep_ms(IDLE_MS);
+        uint32_t idle_wakeups = mf_atomic_load32(&ctx.wakeups);
+
+        for (int i = 0; i < DRAG_COUNT; i++)
+        {
+            mf_atomic_store64(&ctx.deadline, start_drag(&debounce));
+            bench_sleep_ms(200 + (i * 7) % 50);
+        }
+
+        mf_atomic_store32(&ctx.stop, 1);
+        mf_thread_join(&thread);
+        report("polling", idle_wakeups, ctx.releases, ctx.lateness_total_us, ctx.lateness_max_us);
+    }
+
+    /* After: one-shot deadline */
+    {
+        DebounceManager debounce;
+        ReleaseScheduler scheduler;
+        PackedEvent released[RELEASE_EVENTS];
+        OutputMemorySink memory;
+        setup(&debounce);
+        if (!release_scheduler_start(&scheduler, &debounce, output_memory_sink(&memory, released, RELEASE_EVENTS)))
+            return 1;
+
+        bench_sleep_ms(IDLE_MS);
+        uint32_t idle_wakeups = mf_atomic_load32(&scheduler.wakeups);
+
+        for (int i = 0; i < DRAG_COUNT; i++)
+        {
+            start_drag(&debounce);
+            release_scheduler_notify(&scheduler);
+            bench_sleep_ms(200 + (i * 7) % 50);
+        }
+
+        release_scheduler_stop(&scheduler);
+        report("deadline", idle_wakeups,
+               mf_atomic_load32(&scheduler.releases),
+               mf_atomic_load64(&scheduler.lateness_total_us),
+               mf_atomic_load64(&scheduler.lateness_max_us));
+        printf("%-10s %zu releases reached the sink in %llu flushes\n", "", memory.count,
+               (unsigned long long)memory.flushes);
+    }
+
+    return 0;
+}
@@ -0,0 +1,244 @@
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "bench_common.h"
+#include "../src/linux/evdev_loop.h"
+#include "../src/linux/rt_mode.h"
+
+/*
+ * Input latency under a CPU-saturating background load, with and without
+ * the low-latency mode. Two spinning threads per CPU, each sweeping an 8MB
+ * buffer so caches and TLBs stay cold, compete with the loop thread while
+ * a writer feeds one report per millisecond through a pipe and a reader
+ * takes the filtered frames back. Prints p50/p99/p99.9/max from a
+ * report's stamp to its arrival at the reader, and the loop thread's page
+ * faults while running.
+ *
+ * The writer and reader stand in for the kernel and the compositor, so
+ * both runs give them SCHED_FIFO above the loop where the system allows;
+ * only the loop thread's mode changes between runs.
+ */
+
+#define DURATION_MS    3000
+#define MAX_SAMPLES    (DURATION_MS * 2)
+#define LOAD_PER_CPU   2
+#define LOAD_BYTES     (8 * 1024 * 1024)
+#define HARNESS_PRIO   60
+
+typedef struct
+{
+    int in[2];
+    int out[2];
+    MfAtomic32 stop_load;
+    bool harness_rt;
+} Rig;
+
+typedef struct
+{
+    EvdevLoop *loop;
+    bool rt;
+    RtModeReport report;
+    uint64_t faults;
+    int status;
+} LoopThread;
+
+typedef struct
+{
+    Rig *rig;
+    uint64_t *samples;
+    size_t count;
+} Reader;
+
+static bool harness_realtime(void)
+{
+    RtModeOptions options;
+    RtModeReport report;
+    rt_mode_defaults(&options);
+    options.priority = HARNESS_PRIO;
+    options.lock_memory = false;
+    options.stack_bytes = 0;
+    return rt_mode_apply(&options, &report);
+}
+
+static void load_thread(void *arg)
+{
+    Rig *rig = (Rig *)arg;
+    volatile uint8_t *buffer = malloc(LOAD_BYTES);
+    if (!buffer)
+        return;
+
+    uint64_t sum = 0;
+    while (!mf_atomic_load32(&rig->stop_load))
+    {
+        for (size_t i = 0; i < LOAD_BYTES; i += 64)
+        {
+            buffer[i] = (uint8_t)(buffer[i] + 1);
+            sum += buffer[i];
+        }
+    }
+    bench_consume((uint32_t)sum);
+    free((void *)buffer);
+}
+
+static void stamp(struct input_event *e, uint64_t now, uint16_t type, uint16_t code, int32_t value)
+{
+    memset(e, 0, sizeof(*e));
+    evdev_frame_set_time(e, now);
+    e->type = type;
+    e->code = code;
+    e->value = value;
+}
+
+static void writer_thread(void *arg)
+{
+    Rig *rig = (Rig *)arg;
+    rig->harness_rt = harness_realtime();
+
+    for (uint32_t ms = 0; ms < DURATION_MS; ms++)
+    {
+        struct input_event frames[3];
+        size_t count = 0;
+        uint64_t now = time_manager_now_us();
+        uint32_t phase = ms % 250;
+
+        stamp(&frames[count++], now, EV_REL, REL_X, 1);
+        if (phase == 0 || phase == 60)
+            stamp(&frames[count++], now, EV_KEY, BTN_LEFT, phase == 0);
+        stamp(&frames[count++], now, EV_SYN, SYN_REPORT, 0);
+
+        ssize_t ignored = write(rig->in[1], frames, count * sizeof(struct input_event));
+        (void)ignored;
+        bench_sleep_ms(1);
+    }
+    close(rig->in[1]);
+}
+
+static void loop_thread(void *arg)
+{
+    LoopThread *ctx = (LoopThread *)arg;
+    if (ctx->rt)
+    {
+        RtModeOptions options;
+        rt_mode_defaults(&options);
+        evdev_loop_prefault(ctx->loop);
+        rt_mode_apply(&options, &ctx->report);
+    }
+
+    uint64_t faults = rt_mode_page_faults();
+    ctx->status = evdev_loop_run(ctx->loop);
+    ctx->faults = rt_mode_page_faults() - faults;
+}
+
+static void reader_thread(void *arg)
+{
+    Reader *reader = (Reader *)arg;
+    harness_realtime();
+
+    struct pollfd fd = {reader->rig->out[0], POLLIN, 0};
+    while (poll(&fd, 1, -1) > 0)
+    {
+        struct input_event frames[64];
+        ssize_t got = read(fd.fd, frames, sizeof(frames));
+        uint64_t arrived = time_manager_now_us();
+        if (got <= 0)
+            break;
+        for (size_t i = 0; i < (size_t)got / sizeof(struct input_event); i++)
+        {
+            if (frames[i].type != EV_SYN || reader->count == MAX_SAMPLES)
+                continue;
+            uint64_t at = evdev_frame_time(&frames[i]);
+            reader->samples[reader->count++] = arrived > at ? arrived - at : 0;
+        }
+    }
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static uint64_t percentile(const uint64_t *sorted, size_t count, double p)
+{
+    return sorted[(size_t)(p * (double)(count - 1))];
+}
+
+static int run(bool rt)
+{
+    static Rig rig;
+    static EvdevLoop loop;
+    memset(&rig, 0, sizeof(rig));
+    if (pipe(rig.in) != 0 || pipe(rig.out) != 0 || !evdev_loop_init(&loop, EVDEV_IO_AUTO))
+        return 1;
+    int id = evdev_loop_add(&loop, rig.in[0], rig.out[1], EVDEV_CLOCK_FRAME);
+    if (id < 0)
+        return 1;
+    DebounceManager *debounce = &evdev_loop_filter(&loop, id)->pipeline.debounce;
+    debounce_set_monitored(debounce, MOUSE_BUTTON_LEFT, true);
+    debounce_set_threshold(debounce, MOUSE_BUTTON_LEFT, 50, 1, 200);
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int load_count = (int)(cpus > 0 ? cpus : 1) * LOAD_PER_CPU;
+    MfThread *load = calloc((size_t)load_count, sizeof(MfThread));
+    Reader reader = {&rig, calloc(MAX_SAMPLES, sizeof(uint64_t)), 0};
+    if (!load || !reader.samples)
+        return 1;
+
+    for (int i = 0; i < load_count; i++)
+        mf_thread_start(&load[i], load_thread, &rig);
+    bench_sleep_ms(200);
+
+    LoopThread ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.loop = &loop;
+    ctx.rt = rt;
+    ctx.status = -1;
+    MfThread loop_handle, writer_handle, reader_handle;
+    mf_thread_start(&reader_handle, reader_thread, &reader);
+    mf_thread_start(&loop_handle, loop_thread, &ctx);
+    mf_thread_start(&writer_handle, writer_thread, &rig);
+    mf_thread_join(&writer_handle);
+    mf_thread_join(&loop_handle);
+    close(rig.out[1]);
+    mf_thread_join(&reader_handle);
+
+    mf_atomic_store32(&rig.stop_load, 1);
+    for (int i = 0; i < load_count; i++)
+        mf_thread_join(&load[i]);
+    free(load);
+
+    if (ctx.status != 0 || reader.count == 0)
+        return 1;
+
+    uint64_t *samples = reader.samples;
+    size_t count = reader.count;
+    qsort(samples, count, sizeof(uint64_t), compare_u64);
+    printf("%s loop, %d load threads on %ld CPU(s), %s:\n", rt ? "low-latency" : "default", load_count, cpus,
+           evdev_io_name(loop.io));
+    if (!rig.harness_rt)
+        printf("note: no SCHED_FIFO for the writer and reader; their own scheduling shows in the numbers\n");
+    if (rt)
+        rt_mode_print(&ctx.report, stdout);
+    printf("stamp to read: p50 %llu us  p99 %llu us  p99.9 %llu us  max %llu us  (%zu reports)\n",
+           (unsigned long long)percentile(samples, count, 0.50),
+           (unsigned long long)percentile(samples, count, 0.99),
+           (unsigned long long)percentile(samples, count, 0.999), (unsigned long long)samples[count - 1], count);
+    printf("loop faults:   %llu while running\n\n", (unsigned long long)ctx.faults);
+
+    free(samples);
+    close(rig.in[0]);
+    close(rig.out[0]);
+    evdev_loop_cleanup(&loop);
+    return 0;
+}
+
+/* Threads inherit their creator's policy, so main stays on SCHED_OTHER or the load would too */
+int main(void)
+{
+    /* The default run goes first: the low-latency one locks memory for the rest of the process */
+    if (run(false) != 0)
+        return 1;
+    return run(true);
+}
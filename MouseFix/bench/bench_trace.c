@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench_common.h"
+#include "../src/trace/trace_reader.h"
+#include "../src/trace/trace_writer.h"
+
+/*
+ * Trace size and cost over a synthetic office workload: clicks with the
+ * pointer travelling between them, double clicks, short drags and wheel
+ * bursts, timestamps in microseconds.
+ *
+ * Reports bytes/event, writer ns/event (encode plus buffered fwrite) and
+ * reader ns/event (fread plus decode).
+ */
+
+#define EVENT_COUNT (1u << 20)
+#define ITERATIONS  5
+#define TRACE_PATH  "bench_trace.mft"
+
+static void push(MouseEvent *events, size_t *n, MouseButton button, uint64_t now, bool down, long x, long y, int32_t data)
+{
+    MouseEvent *e = &events[(*n)++];
+    e->button = button;
+    e->timestamp = now;
+    e->is_down = down;
+    e->x = x;
+    e->y = y;
+    e->is_injected = false;
+    e->data = data;
+}
+
+static MouseEvent *build_events(size_t count)
+{
+    MouseEvent *events = calloc(count + 16, sizeof(MouseEvent));
+    if (!events)
+        return NULL;
+
+    uint64_t rng = 0xD1B54A32D192ED03ull;
+    uint64_t now = 1000000;
+    long x = 960, y = 540;
+    size_t n = 0;
+
+    while (n < count)
+    {
+        uint64_t r = bench_rand(&rng);
+        now += 300000 + (r >> 8) % 3000000;
+
+        switch (r & 7)
+        {
+        case 0: /* wheel burst, pointer still */
+            for (int i = 0; i < 4; i++)
+            {
+                now += 20000 + (r >> 20) % 40000;
+                push(events, &n, MOUSE_BUTTON_WHEEL, now, false, x, y, (r & 8) ? 120 : -120);
+            }
+            break;
+
+        case 1: /* short drag */
+            x += (long)((r >> 24) % 601) - 300;
+            y += (long)((r >> 34) % 401) - 200;
+            push(events, &n, MOUSE_BUTTON_LEFT, now, true, x, y, 0);
+            now += 300000 + (r >> 44) % 700000;
+            x += (long)((r >> 40) % 201) - 100;
+            push(events, &n, MOUSE_BUTTON_LEFT, now, false, x, y, 0);
+            break;
+
+        default: /* click or double click after moving to a target */
+            x += (long)((r >> 24) % 601) - 300;
+            y += (long)((r >> 34) % 401) - 200;
+            for (int i = 0; i < ((r & 7) == 2 ? 2 : 1); i++)
+            {
+                MouseButton button = ((r >> 50) & 7) == 0 ? MOUSE_BUTTON_RIGHT : MOUSE_BUTTON_LEFT;
+                push(events, &n, button, now, true, x, y, 0);
+                now += 60000 + (r >> 44) % 60000;
+                push(events, &n, button, now, false, x, y, 0);
+                now += 80000;
+            }
+            break;
+        }
+    }
+    return events;
+}
+
+int main(void)
+{
+    MouseEvent *events = build_events(EVENT_COUNT);
+    TraceWriter *writer = malloc(sizeof(TraceWriter));
+    TraceReader *reader = malloc(sizeof(TraceReader));
+    if (!events || !writer || !reader)
+        return 1;
+
+    uint64_t best_write = UINT64_MAX;
+    uint64_t bytes = 0;
+    for (int iter = 0; iter < ITERATIONS; iter++)
+    {
+        if (!trace_writer_open(writer, TRACE_PATH, events[0].timestamp))
+            return 1;
+        uint64_t start = bench_now_ns();
+        for (size_t i = 0; i < EVENT_COUNT; i++)
+            trace_writer_event(writer, &events[i]);
+        trace_writer_flush(writer);
+        uint64_t elapsed = bench_now_ns() - start;
+        bytes = writer->bytes_written - TRACE_HEADER_SIZE;
+        trace_writer_close(writer);
+        if (elapsed < best_write)
+            best_write = elapsed;
+    }
+
+    uint64_t best_read = UINT64_MAX;
+    for (int iter = 0; iter < ITERATIONS; iter++)
+    {
+        if (!trace_reader_open(reader, TRACE_PATH))
+            return 1;
+        TraceRecord record;
+        uint64_t sum = 0;
+        uint64_t start = bench_now_ns();
+        while (trace_reader_next(reader, &record) == 1)
+            sum += record.event.timestamp;
+        uint64_t elapsed = bench_now_ns() - start;
+        trace_reader_close(reader);
+        bench_consume(sum);
+        if (elapsed < best_read)
+            best_read = elapsed;
+    }
+
+    size_t buttons = 0;
+    for (size_t i = 0; i < EVENT_COUNT; i++)
+        buttons += events[i].button != MOUSE_BUTTON_WHEEL;
+
+    printf("trace size:   %.2f bytes/event (%.2f MB for %u events, %.0f%% button edges)\n",
+           (double)bytes / EVENT_COUNT, bytes / 1e6, EVENT_COUNT, 100.0 * buttons / EVENT_COUNT);
+    printf("trace writer: %.2f ns/event (best of %d)\n", (double)best_write / EVENT_COUNT, ITERATIONS);
+    printf("trace reader: %.2f ns/event (best of %d)\n", (double)best_read / EVENT_COUNT, ITERATIONS);
+
+    remove(TRACE_PATH);
+    free(reader);
+    free(writer);
+    free(events);
+    return 0;
+}
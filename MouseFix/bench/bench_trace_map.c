@@ -0,0 +1,186 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench_common.h"
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+#include "../src/trace/trace_map.h"
+#include "../src/trace/trace_reader.h"
+#include "../src/trace/trace_replay.h"
+#include "../src/trace/trace_writer.h"
+
+/*
+ * Throughput of the trace readers on a large synthetic capture:
+ *
+ *   bench_trace_map [size_mb] [smart_drag]     (defaults 1024, 1)
+ *
+ * Writes a trace of roughly size_mb megabytes of mixed clicks, bounces,
+ * drags and wheel bursts, then reports events/s and GB/s for decoding
+ * with the stdio and the memory-mapped reader, and for a full replay
+ * through the engine (record at a time vs mapped and batched). Smart Drag
+ * bounds how long a batch may run, so pass 0 to see the plain debounce
+ * case where batches fill up. The file
+ * is read back warm from the page cache; drop caches first for cold
+ * numbers.
+ */
+
+#define TRACE_PATH "bench_trace_map.mft"
+
+static bool write_trace(uint64_t target_bytes, bool smart_drag, uint64_t *event_count)
+{
+    TraceWriter *writer = malloc(sizeof(TraceWriter));
+    if (!writer || !trace_writer_open(writer, TRACE_PATH, 1000000))
+        return false;
+
+    DebounceManager manager;
+    bench_configure(&manager, BENCH_ALL_BUTTONS);
+    debounce_set_hybrid_heuristic(&manager, smart_drag);
+    DebounceConfig config;
+    debounce_get_config(&manager, &config);
+    trace_writer_config(writer, 1000000, &config);
+
+    uint64_t rng = 0xA0761D6478BD642Full;
+    uint64_t now = 1000000;
+    long x = 960, y = 540;
+    bool down[MOUSE_BUTTON_COUNT] = {false};
+    uint64_t count = 0;
+
+    while (writer->bytes_written + writer->used < target_bytes)
+    {
+        uint64_t r = bench_rand(&rng);
+        MouseEvent e = {0};
+
+        e.button = (r & 7) == 0 ? MOUSE_BUTTON_WHEEL : (r & 7) == 1 ? MOUSE_BUTTON_RIGHT : MOUSE_BUTTON_LEFT;
+        if (e.button == MOUSE_BUTTON_WHEEL)
+        {
+            e.data = (r & 8) ? 120 : -120;
+        }
+        else
+        {
+            down[e.button] = !down[e.button];
+            e.is_down = down[e.button];
+        }
+
+        switch ((r >> 4) & 7)
+        {
+        case 0:
+            now += 1000 + (r >> 16) % 8000; /* bounce */
+            break;
+        case 1:
+            now += 250000 + (r >> 16) % 500000; /* hold or drag */
+            x += (long)((r >> 32) % 41) - 20;
+            break;
+        default:
+            now += 60000 + (r >> 16) % 2000000;
+            if (e.is_down)
+            {
+                x += (long)((r >> 32) % 601) - 300;
+                y += (long)((r >> 44) % 401) - 200;
+            }
+            break;
+        }
+
+        e.timestamp = now;
+        e.x = x;
+        e.y = y;
+        trace_writer_event(writer, &e);
+        count++;
+    }
+
+    bool ok = trace_writer_close(writer);
+    free(writer);
+    *event_count = count;
+    return ok;
+}
+
+static void report(const char *name, uint64_t events, uint64_t bytes, uint64_t elapsed_ns)
+{
+    printf("%-28s %8.1f M events/s  %6.2f GB/s  (%.2fs)\n",
+           name, events * 1e3 / (double)elapsed_ns, bytes / (double)elapsed_ns, elapsed_ns / 1e9);
+}
+
+static void replay_init(TraceReplayer *replayer, DebounceManager *manager)
+{
+    debounce_init(manager);
+    trace_replayer_init(replayer, manager, NULL);
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t size_mb = argc > 1 ? strtoull(argv[1], NULL, 10) : 1024;
+    bool smart_drag = argc > 2 ? atoi(argv[2]) != 0 : true;
+    uint64_t events = 0;
+
+    uint64_t start = bench_now_ns();
+    if (!write_trace(size_mb * 1000000, smart_drag, &events))
+    {
+        fprintf(stderr, "failed to write %s\n", TRACE_PATH);
+        return 1;
+    }
+    printf("wrote %llu events, %llu MB in %.2fs, Smart Drag %s\n",
+           (unsigned long long)events, (unsigned long long)size_mb, (bench_now_ns() - start) / 1e9,
+           smart_drag ? "on" : "off");
+
+    TraceReader *reader = malloc(sizeof(TraceReader));
+    TraceRecord record;
+    TraceMap map;
+    DebounceManager manager;
+    TraceReplayer replayer;
+    uint64_t sum = 0, n = 0, bytes = 0;
+    if (!reader)
+        return 1;
+
+    /* Warm the page cache so both readers start from the same place */
+    if (!trace_map_open(&map, TRACE_PATH, 0))
+        return 1;
+    while (trace_map_next(&map, &record) == 1)
+        sum += record.timestamp;
+    bytes = map.file_size;
+    trace_map_close(&map);
+
+    trace_reader_open(reader, TRACE_PATH);
+    start = bench_now_ns();
+    for (n = 0; trace_reader_next(reader, &record) == 1; n++)
+        sum += record.timestamp;
+    report("decode, stdio reader", n, bytes, bench_now_ns() - start);
+    trace_reader_close(reader);
+
+    trace_map_open(&map, TRACE_PATH, 0);
+    start = bench_now_ns();
+    for (n = 0; trace_map_next(&map, &record) == 1; n++)
+        sum += record.timestamp;
+    report("decode, mapped reader", n, bytes, bench_now_ns() - start);
+    trace_map_close(&map);
+
+    replay_init(&replayer, &manager);
+    trace_reader_open(reader, TRACE_PATH);
+    start = bench_now_ns();
+    while (trace_reader_next(reader, &record) == 1)
+        trace_replayer_apply(&replayer, &record);
+    trace_replayer_finish(&replayer);
+    report("replay, stdio + per record", replayer.stats.events, bytes, bench_now_ns() - start);
+    trace_reader_close(reader);
+    sum += replayer.stats.blocked;
+
+    replay_init(&replayer, &manager);
+    trace_map_open(&map, TRACE_PATH, 0);
+    start = bench_now_ns();
+    trace_map_replay(&map, &replayer);
+    trace_replayer_finish(&replayer);
+    report("replay, mapped + batched", replayer.stats.events, bytes, bench_now_ns() - start);
+    trace_map_close(&map);
+    sum += replayer.stats.blocked;
+
+    bench_consume(sum);
+
+#ifndef _WIN32
+    /* Stays flat regardless of trace size: decoded pages are released as the window advances */
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    printf("peak RSS: %.1f MB\n", usage.ru_maxrss / 1024.0);
+#endif
+
+    remove(TRACE_PATH);
+    free(reader);
+    return 0;
+}
@@ -20,6 +20,10 @@
 #include "src/core/mouse_hook.h"
 #include "src/core/debouncer.h"
 #include "src/core/time_manager.h"
+#include "src/core/release_scheduler.h"
+#include "src/core/event_tap.h"
+#include "src/core/hook_latency.h"
+#include "src/trace/trace_writer.h"
 #include "src/ui/tray_icon.h"
 #include "src/ui/context_menu.h"
 #include "src/utils/logger.h"
@@ -35,6 +39,10 @@ typedef struct
 	// Modules
 	MouseHookManager mouse_hook;
 	DebounceManager debounce;
+	ReleaseScheduler release_scheduler;
+	EventTap event_tap;
+	HookLatency hook_latency;
+	TraceWriter trace_writer;
 	TimeManager time_manager;
 	TrayIconManager tray_icon;
 	ContextMenuManager context_menu;
@@ -78,7 +86,8 @@ static const PresetConfig PRESET_STRICT = {40, 40, 40, 40, 40, 20};
 
 // Function declarations
 static LRESULT CALLBACK WindowProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
-static LRESULT CALLBACK OnMouseHookCallback(const MouseEvent *event, void *user_data);
+static bool OnMouseHookCallback(const MouseEvent *event, void *user_data);
+static void OnMouseMove(long x, long y, void *user_data);
 static bool RegisterInvisibleClass(const HINSTANCE hInstance);
 static bool InitializeApp(void);
 static void ShutdownApp(void);
@@ -88,26 +97,53 @@ static void ToggleEnableAll(void);
 static void ToggleButton(MouseButton button);
 static void ToggleWheel(void);
 static void ToggleHybridHeuristic(void);
+static void ToggleAdaptiveThresholds(void);
 static void ApplyPreset(const PresetConfig *preset);
 static void SetButtonThreshold(MouseButton button, int threshold_ms);
 static bool InputBox(LPCWSTR prompt, LPWSTR buffer, int buffer_size);
 static void SaveSettings(void);
 static void LoadSettings(void);
+static void StartTraceRecording(void);
+static void RecordTraceConfig(void);
+static void OnEventTapRecords(const EventTapRecord *records, size_t count, void *user_data);
 
-// Mouse hook callback
-static LRESULT CALLBACK OnMouseHookCallback(const MouseEvent *event, void *user_data)
+// Mouse hook callback; returns true to block the event
+static bool OnMouseHookCallback(const MouseEvent *event, void *user_data)
 {
 	AppState *app = (AppState *)user_data;
 
+	ButtonState from = debounce_get_button_state(&app->debounce, event->button);
+
 	// Process event directly - avoid creating intermediate structure
-	if (debounce_process_event(&app->debounce, event))
+	bool blocked = debounce_process_event(&app->debounce, event);
+
+	// Time from hook entry to verdict, per button and state transition
+	hook_latency_record(&app->hook_latency, event->button, from,
+						debounce_get_button_state(&app->debounce, event->button),
+						mf_ticks() - app->mouse_hook.entry_ticks);
+
+	// Hand the event and verdict to the background consumer (trace recording)
+	if (app->event_tap.running)
+		event_tap_publish(&app->event_tap, event, blocked);
+
+	if (blocked)
 	{
+		// A blocked release may have started a Smart Drag confirm window
+		release_scheduler_notify(&app->release_scheduler);
+
 		// Event should be blocked
-		return 1;
+		return true;
 	}
 
 	// Event should pass through
-	return CallNextHookEx(NULL, 0, 0, 0);
+	return false;
+}
+
+// Pointer move callback: returns at once unless a held button is being tracked
+static void OnMouseMove(long x, long y, void *user_data)
+{
+	AppState *app = (AppState *)user_data;
+	debounce_process_move(&app->debounce, x, y);
 }
 
 // Initialize application
@@ -151,18 +187,33 @@ static bool InitializeApp(void)
 		return false;
 	}
 
+	hook_latency_init(&g_app.hook_latency);
+
 	// Apply Default Preset (50ms for buttons, 30ms for wheel)
 	// We use a silent version of ApplyPreset for initialization to avoid redundant SaveSettings
-	g_app.debounce.buttons[MOUSE_BUTTON_LEFT].thresholdMs = PRESET_DEFAULT.left;
-	g_app.debounce.buttons[MOUSE_BUTTON_RIGHT].thresholdMs = PRESET_DEFAULT.right;
-	g_app.debounce.buttons[MOUSE_BUTTON_MIDDLE].thresholdMs = PRESET_DEFAULT.middle;
-	g_app.debounce.buttons[MOUSE_BUTTON_X1].thresholdMs = PRESET_DEFAULT.x1;
-	g_app.debounce.buttons[MOUSE_BUTTON_X2].thresholdMs = PRESET_DEFAULT.x2;
-	g_app.debounce.buttons[MOUSE_BUTTON_WHEEL].thresholdMs = PRESET_DEFAULT.wheel;
+	debounce_set_threshold(&g_app.debounce, MOUSE_BUTTON_LEFT, PRESET_DEFAULT.left, THRESHOLD_MIN_VALUE, THRESHOLD_MAX_VALUE);
+	debounce_set_threshold(&g_app.debounce, MOUSE_BUTTON_RIGHT, PRESET_DEFAULT.right, THRESHOLD_MIN_VALUE, THRESHOLD_MAX_VALUE);
+	debounce_set_threshold(&g_app.debounce, MOUSE_BUTTON_MIDDLE, PRESET_DEFAULT.middle, THRESHOLD_MIN_VALUE, THRESHOLD_MAX_VALUE);
+	debounce_set_threshold(&g_app.debounce, MOUSE_BUTTON_X1, PRESET_DEFAULT.x1, THRESHOLD_MIN_VALUE, THRESHOLD_MAX_VALUE);
+	debounce_set_threshold(&g_app.debounce, MOUSE_BUTTON_X2, PRESET_DEFAULT.x2, THRESHOLD_MIN_VALUE, THRESHOLD_MAX_VALUE);
+	debounce_set_threshold(&g_app.debounce, MOUSE_BUTTON_WHEEL, PRESET_DEFAULT.wheel, THRESHOLD_MIN_VALUE, THRESHOLD_MAX_VALUE);
 
 	// Load saved settings from Registry (overwrites defaults if they exist)
 	LoadSettings();
 
+	// Start input trace recording if a TracePath is configured
+	StartTraceRecording();
+
+	// Start deferred release scheduler (Hybrid Heuristic)
+	// Sleeps until the next Smart Drag deadline instead of polling
+	if (!release_scheduler_start(&g_app.release_scheduler, &g_app.debounce, output_sendinput_sink()))
+	{
+#ifndef NDEBUG
+		LOG_ERROR(&g_app.logger, "Failed to start release scheduler");
+#endif
+		return false;
+	}
+
 	// Initialize mouse hook
 	if (!mouse_hook_init(&g_app.mouse_hook, OnMouseHookCallback, &g_app))
 	{
@@ -172,6 +223,9 @@ static bool InitializeApp(void)
 		return false;
 	}
 
+	// Pointer travel while a button is held feeds Smart Drag
+	mouse_hook_set_move_callback(&g_app.mouse_hook, OnMouseMove);
+
 	// Install mouse hook
 	if (!mouse_hook_install(&g_app.mouse_hook))
 	{
@@ -206,9 +260,6 @@ static bool InitializeApp(void)
 #ifndef NDEBUG
 	LOG_INFO(&g_app.logger, "Application initialized successfully");
 #endif
-	// Set timer for checking deferred releases (Hybrid Heuristic)
-	// Check every 15ms (approx 66Hz) to ensure timely release of dragged items
-	SetTimer(g_app.hWnd, 1, 15, NULL);
 	return true;
 }
 
@@ -219,15 +270,31 @@ static void ShutdownApp(void)
 	LOG_INFO(&g_app.logger, "Shutting down application...");
 #endif
 
-	// Stop the hybrid heuristic timer
-	KillTimer(g_app.hWnd, 1);
-
 	// Remove tray icon
 	tray_icon_remove(&g_app.tray_icon);
 
 	// Uninstall mouse hook
 	mouse_hook_uninstall(&g_app.mouse_hook);
 
+	// Keep what adaptive thresholds learned this session
+	AdaptiveParams adaptive;
+	debounce_get_adaptive(&g_app.debounce, &adaptive);
+	if (adaptive.enabled)
+		SaveSettings();
+
+	// Stop the hybrid heuristic scheduler
+	release_scheduler_stop(&g_app.release_scheduler);
+
+	// Drain the event tap, then flush and close the input trace
+	event_tap_stop(&g_app.event_tap);
+	if (g_app.trace_writer.file)
+	{
+#ifndef NDEBUG
+		LOG_INFO(&g_app.logger, "Input trace closed, %u records dropped", event_tap_get_dropped(&g_app.event_tap));
+#endif
+		trace_writer_close(&g_app.trace_writer);
+	}
+
 	// Cleanup modules
 	debounce_cleanup(&g_app.debounce);
 #ifndef NDEBUG
@@ -244,7 +311,7 @@ static void ShutdownApp(void)
 // Toggle hybrid heuristic
 static void ToggleHybridHeuristic(void)
 {
-	bool new_state = !g_app.debounce.use_hybrid_heuristic;
+	bool new_state = !debounce_get_hybrid_heuristic(&g_app.debounce);
 	debounce_set_hybrid_heuristic(&g_app.debounce, new_state);
 	SaveSettings();
 #ifndef NDEBUG
@@ -252,6 +319,19 @@ static void ToggleHybridHeuristic(void)
 #endif
 }
 
+// Toggle adaptive thresholds (learning starts from the current thresholds)
+static void ToggleAdaptiveThresholds(void)
+{
+	AdaptiveParams adaptive;
+	debounce_get_adaptive(&g_app.debounce, &adaptive);
+	adaptive.enabled = !adaptive.enabled;
+	debounce_set_adaptive(&g_app.debounce, &adaptive);
+	SaveSettings();
+#ifndef NDEBUG
+	LOG_INFO(&g_app.logger, "Adaptive thresholds set to %s", adaptive.enabled ? "Enabled" : "Disabled");
+#endif
+}
+
 static void ToggleEnableAll(void)
 {
 	bool is_enabled = debounce_is_any_monitored(&g_app.debounce);
@@ -275,7 +355,7 @@ static void ToggleButton(MouseButton button)
 	if (button < 0 || button >= MOUSE_BUTTON_COUNT)
 		return;
 
-	bool current_state = g_app.debounce.buttons[button].isMonitored;
+	bool current_state = debounce_is_monitored(&g_app.debounce, button);
 	debounce_set_monitored(&g_app.debounce, button, !current_state);
 
 	SaveSettings();
@@ -290,7 +370,7 @@ static void ToggleButton(MouseButton button)
 // Toggle wheel scrolling
 static void ToggleWheel(void)
 {
-	bool current_state = g_app.debounce.buttons[MOUSE_BUTTON_WHEEL].isMonitored;
+	bool current_state = debounce_is_monitored(&g_app.debounce, MOUSE_BUTTON_WHEEL);
 	debounce_set_monitored(&g_app.debounce, MOUSE_BUTTON_WHEEL, !current_state);
 
 	SaveSettings();
@@ -456,24 +536,49 @@ static void SaveSettings(void)
 	if (RegCreateKeyExW(HKEY_CURRENT_USER, REG_SETTINGS_KEY, 0, NULL, REG_OPTION_NON_VOLATILE, KEY_WRITE, NULL, &hKey, NULL) == ERROR_SUCCESS)
 	{
 		// Save hybrid heuristic setting
-		DWORD hybrid = g_app.debounce.use_hybrid_heuristic ? 1 : 0;
+		DWORD hybrid = debounce_get_hybrid_heuristic(&g_app.debounce) ? 1 : 0;
 		RegSetValueExW(hKey, L"HybridHeuristic", 0, REG_DWORD, (BYTE *)&hybrid, sizeof(DWORD));
 
+		// Save Smart Drag tuning (ms / px, as written by mousefix_tune presets)
+		SmartDragParams drag;
+		debounce_get_smart_drag(&g_app.debounce, &drag);
+		DWORD hold_ms = drag.hold_us / 1000;
+		DWORD dist_px = 0;
+		while ((dist_px + 1) * (dist_px + 1) <= drag.dist_sq)
+			dist_px++;
+		DWORD confirm_ms = drag.confirm_us / 1000;
+		RegSetValueExW(hKey, L"SmartDragHoldMs", 0, REG_DWORD, (BYTE *)&hold_ms, sizeof(DWORD));
+		RegSetValueExW(hKey, L"SmartDragDistancePx", 0, REG_DWORD, (BYTE *)&dist_px, sizeof(DWORD));
+		RegSetValueExW(hKey, L"SmartDragConfirmMs", 0, REG_DWORD, (BYTE *)&confirm_ms, sizeof(DWORD));
+
+		// Save adaptive thresholds; the learned values are the Btn%d_Threshold below
+		AdaptiveParams adaptive;
+		debounce_get_adaptive(&g_app.debounce, &adaptive);
+		DWORD adaptive_on = adaptive.enabled ? 1 : 0;
+		DWORD adaptive_min_ms = adaptive.min_us / 1000;
+		DWORD adaptive_max_ms = adaptive.max_us / 1000;
+		RegSetValueExW(hKey, L"AdaptiveThresholds", 0, REG_DWORD, (BYTE *)&adaptive_on, sizeof(DWORD));
+		RegSetValueExW(hKey, L"AdaptiveMinMs", 0, REG_DWORD, (BYTE *)&adaptive_min_ms, sizeof(DWORD));
+		RegSetValueExW(hKey, L"AdaptiveMaxMs", 0, REG_DWORD, (BYTE *)&adaptive_max_ms, sizeof(DWORD));
+
 		for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
 		{
 			wchar_t valName[64];
 			// Save threshold
 			StringCchPrintfW(valName, 64, L"Btn%d_Threshold", i);
-			DWORD threshold = (DWORD)g_app.debounce.buttons[i].thresholdMs;
+			DWORD threshold = (DWORD)debounce_get_threshold(&g_app.debounce, i);
 			RegSetValueExW(hKey, valName, 0, REG_DWORD, (BYTE *)&threshold, sizeof(DWORD));
 
 			// Save enabled state
 			StringCchPrintfW(valName, 64, L"Btn%d_Enabled", i);
-			DWORD enabled = g_app.debounce.buttons[i].isMonitored ? 1 : 0;
+			DWORD enabled = debounce_is_monitored(&g_app.debounce, i) ? 1 : 0;
 			RegSetValueExW(hKey, valName, 0, REG_DWORD, (BYTE *)&enabled, sizeof(DWORD));
 		}
 		RegCloseKey(hKey);
 	}
+
+	// Every configuration change ends up here
+	RecordTraceConfig();
 }
 
 static void LoadSettings(void)
@@ -490,6 +595,37 @@ static void LoadSettings(void)
 			debounce_set_hybrid_heuristic(&g_app.debounce, hybrid != 0);
 		}
 
+		// Load Smart Drag tuning; missing values keep the defaults
+		SmartDragParams drag;
+		DWORD value;
+		debounce_get_smart_drag(&g_app.debounce, &drag);
+		size = sizeof(DWORD);
+		if (RegQueryValueExW(hKey, L"SmartDragHoldMs", NULL, NULL, (BYTE *)&value, &size) == ERROR_SUCCESS && value > 0)
+			drag.hold_us = value * 1000;
+		size = sizeof(DWORD);
+		if (RegQueryValueExW(hKey, L"SmartDragDistancePx", NULL, NULL, (BYTE *)&value, &size) == ERROR_SUCCESS && value > 0)
+			drag.dist_sq = value * value;
+		size = sizeof(DWORD);
+		if (RegQueryValueExW(hKey, L"SmartDragConfirmMs", NULL, NULL, (BYTE *)&value, &size) == ERROR_SUCCESS && value > 0)
+			drag.confirm_us = value * 1000;
+		debounce_set_smart_drag(&g_app.debounce, &drag);
+
+		// Load adaptive thresholds; bounds must stay within the manual range
+		AdaptiveParams adaptive;
+		debounce_get_adaptive(&g_app.debounce, &adaptive);
+		size = sizeof(DWORD);
+		if (RegQueryValueExW(hKey, L"AdaptiveThresholds", NULL, NULL, (BYTE *)&value, &size) == ERROR_SUCCESS)
+			adaptive.enabled = value != 0;
+		size = sizeof(DWORD);
+		if (RegQueryValueExW(hKey, L"AdaptiveMinMs", NULL, NULL, (BYTE *)&value, &size) == ERROR_SUCCESS &&
+			value >= THRESHOLD_MIN_VALUE && value <= THRESHOLD_MAX_VALUE)
+			adaptive.min_us = value * 1000;
+		size = sizeof(DWORD);
+		if (RegQueryValueExW(hKey, L"AdaptiveMaxMs", NULL, NULL, (BYTE *)&value, &size) == ERROR_SUCCESS &&
+			value >= THRESHOLD_MIN_VALUE && value <= THRESHOLD_MAX_VALUE)
+			adaptive.max_us = value * 1000;
+		debounce_set_adaptive(&g_app.debounce, &adaptive);
+
 		for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
 		{
 			wchar_t valName[64];
@@ -516,6 +652,88 @@ static void LoadSettings(void)
 	}
 }
 
+// Open the trace file named by the TracePath registry value (REG_SZ), if any.
+// Events, settings changes and resets are all published to the event tap
+// from the UI thread (which also runs the hook), and the tap's consumer
+// thread is the only one touching the writer.
+static void StartTraceRecording(void)
+{
+	HKEY hKey;
+	wchar_t path[MAX_PATH];
+	DWORD size = sizeof(path) - sizeof(wchar_t);
+	DWORD type;
+
+	if (RegOpenKeyExW(HKEY_CURRENT_USER, REG_SETTINGS_KEY, 0, KEY_READ, &hKey) != ERROR_SUCCESS)
+		return;
+
+	ZeroMemory(path, sizeof(path));
+	LSTATUS status = RegQueryValueExW(hKey, L"TracePath", NULL, &type, (BYTE *)path, &size);
+	RegCloseKey(hKey);
+	if (status != ERROR_SUCCESS || type != REG_SZ || path[0] == L'\0')
+		return;
+
+	FILE *file = NULL;
+	if (_wfopen_s(&file, path, L"wb") != 0 || !file)
+	{
+#ifndef NDEBUG
+		LOG_ERROR(&g_app.logger, "Failed to open trace file %S", path);
+#endif
+		return;
+	}
+
+	trace_writer_open_file(&g_app.trace_writer, file, time_manager_now_us());
+	if (!event_tap_start(&g_app.event_tap, OnEventTapRecords, &g_app))
+	{
+		trace_writer_close(&g_app.trace_writer);
+		return;
+	}
+	RecordTraceConfig();
+
+#ifndef NDEBUG
+	LOG_INFO(&g_app.logger, "Recording input trace to %S", path);
+#endif
+}
+
+// Snapshot the current configuration into the trace
+static void RecordTraceConfig(void)
+{
+	if (!g_app.event_tap.running)
+		return;
+
+	DebounceConfig config;
+	debounce_get_config(&g_app.debounce, &config);
+	event_tap_publish_config(&g_app.event_tap, time_manager_now_us(), &config);
+	// Drain now: the config side ring is small and settings changes can outpace the doorbell
+	event_tap_kick(&g_app.event_tap);
+}
+
+// Event tap consumer thread: write drained records to the trace
+static void OnEventTapRecords(const EventTapRecord *records, size_t count, void *user_data)
+{
+	AppState *app = (AppState *)user_data;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const EventTapRecord *record = &records[i];
+		switch (record->type)
+		{
+		case EVENT_TAP_EVENT:
+			trace_writer_packed_event(&app->trace_writer, &record->event);
+			break;
+		case EVENT_TAP_CONFIG:
+			trace_writer_config(&app->trace_writer, record->mark.timestamp, &record->mark.config);
+			break;
+		case EVENT_TAP_RESET:
+			trace_writer_reset(&app->trace_writer, record->mark.timestamp);
+			break;
+		}
+	}
+
+	// Drains come at most once per doorbell or EVENT_TAP_FLUSH_MS, so push each to disk; a crash loses little
+	if (trace_writer_flush(&app->trace_writer))
+		fflush(app->trace_writer.file);
+}
+
 // Set threshold for a specific button
 static void SetButtonThreshold(MouseButton button, int threshold_ms)
 {
@@ -557,13 +775,6 @@ static LRESULT CALLBACK WindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM l
 
 		return 0;
 
-	case WM_TIMER:
-		if (wParam == 1)
-		{
-			debounce_check_deferred_releases(&g_app.debounce);
-		}
-		return 0;
-
 	case WM_NOTIFYICON:
 		if (LOWORD(lParam) == WM_CONTEXTMENU)
 		{
@@ -593,9 +804,20 @@ static LRESULT CALLBACK WindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM l
 			ToggleHybridHeuristic();
 			return 0;
 		}
+		if (LOWORD(wParam) == IDM_TOGGLE_ADAPTIVE)
+		{
+			ToggleAdaptiveThresholds();
+			return 0;
+		}
 		if (LOWORD(wParam) == IDM_RESET_STATS)
 		{
 			debounce_reset_statistics(&g_app.debounce);
+			hook_latency_reset(&g_app.hook_latency);
+			if (g_app.event_tap.running)
+			{
+				event_tap_publish_reset(&g_app.event_tap, time_manager_now_us());
+				event_tap_kick(&g_app.event_tap);
+			}
 #ifndef NDEBUG
 			LOG_INFO(&g_app.logger, "Statistics reset");
 #endif
@@ -726,7 +948,7 @@ static LRESULT CALLBACK WindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM l
 static void ShowContextMenu(const HWND hWnd, const int x, const int y)
 {
 	SetForegroundWindow(hWnd);
-	context_menu_show(&g_app.context_menu, hWnd, x, y, &g_app.debounce);
+	context_menu_show(&g_app.context_menu, hWnd, x, y, &g_app.debounce, &g_app.hook_latency);
 }
 
 // Show error message box
@@ -6,6 +6,7 @@
 #define IDM_TOGGLE_ENABLE (WM_USER + 11)
 #define IDM_RESET_STATS (WM_USER + 12)
 #define IDM_TOGGLE_HYBRID (WM_USER + 13)
+#define IDM_TOGGLE_ADAPTIVE (WM_USER + 14)
 
 // Preset menu IDs
 #define IDM_PRESET_DEFAULT (WM_USER + 20)
@@ -0,0 +1,206 @@
+#include "debounce_algo.h"
+#include <string.h>
+
+#define DEFAULT_SAMPLE_US 1000
+
+static const char *const ALGO_NAMES[DEBOUNCE_ALGO_COUNT] = {
+    "lockout", "asymmetric", "trailing", "integrator", "hysteresis",
+};
+
+void debounce_filter_init(DebounceFilter *filter, const DebounceAlgoParams *params)
+{
+    if (!filter || !params)
+        return;
+
+    memset(filter, 0, sizeof(DebounceFilter));
+    filter->params = *params;
+    if (filter->params.sample_us == 0)
+        filter->params.sample_us = DEFAULT_SAMPLE_US;
+}
+
+static uint32_t window_for(const DebounceFilter *filter, bool down)
+{
+    return down ? filter->params.press_us : filter->params.release_us;
+}
+
+/* The engine's rule with Smart Drag off: see BUTTON_TRANSITIONS in debouncer.c */
+static bool lockout_edge(DebounceFilter *filter, bool down, uint64_t now)
+{
+    uint64_t elapsed = now - filter->since;
+    filter->since = now;
+    filter->raw = down;
+
+    if (!down)
+    {
+        if (filter->blocked)
+        {
+            filter->blocked = false;
+            return false;
+        }
+        filter->out = false;
+        return true;
+    }
+
+    if (filter->blocked)
+        return false;
+    if (elapsed <= filter->params.press_us)
+    {
+        filter->blocked = true;
+        return false;
+    }
+    filter->out = true;
+    return true;
+}
+
+/* Samples at multiples of sample_us in [from, to) */
+static uint64_t ticks_between(uint64_t from, uint64_t to, uint64_t period)
+{
+    return (to + period - 1) / period - (from + period - 1) / period;
+}
+
+/* Integrator: take the samples of the current level since the last update */
+static void sample_to(DebounceFilter *filter, uint64_t now)
+{
+    uint64_t ticks = ticks_between(filter->since, now, filter->params.sample_us);
+    if (ticks > 0)
+    {
+        if (filter->run_down == filter->raw)
+        {
+            filter->count += ticks;
+        }
+        else
+        {
+            filter->run_down = filter->raw;
+            filter->count = ticks;
+        }
+    }
+    filter->since = now;
+}
+
+/* Hysteresis: count the time at the current level since the last update */
+static void integrate_to(DebounceFilter *filter, uint64_t now)
+{
+    uint64_t elapsed = now - filter->since;
+    uint64_t top = filter->params.press_us ? filter->params.press_us : 1;
+
+    if (filter->raw)
+        filter->count = filter->count + elapsed < top ? filter->count + elapsed : top;
+    else
+        filter->count = filter->count > elapsed ? filter->count - elapsed : 0;
+    filter->since = now;
+}
+
+/* When the output takes the current switch level, for the delaying algorithms */
+static uint64_t schedule(const DebounceFilter *filter, uint64_t now)
+{
+    if (filter->raw == filter->out)
+        return 0;
+
+    switch (filter->params.algo)
+    {
+    case DEBOUNCE_ALGO_TRAILING:
+        return now + window_for(filter, filter->raw);
+    case DEBOUNCE_ALGO_INTEGRATOR:
+    {
+        uint64_t period = filter->params.sample_us;
+        uint64_t needed = window_for(filter, filter->raw) / period;
+        if (needed == 0)
+            needed = 1;
+        uint64_t have = filter->run_down == filter->raw ? filter->count : 0;
+        if (have >= needed)
+            return now;
+        uint64_t next_tick = (now + period - 1) / period * period;
+        return next_tick + (needed - have - 1) * period;
+    }
+    case DEBOUNCE_ALGO_HYSTERESIS:
+    {
+        uint64_t top = filter->params.press_us ? filter->params.press_us : 1;
+        return filter->raw ? now + (top - filter->count) : now + filter->count;
+    }
+    default:
+        return 0;
+    }
+}
+
+bool debounce_filter_edge(DebounceFilter *filter, bool down, uint64_t now)
+{
+    if (filter->params.algo == DEBOUNCE_ALGO_LOCKOUT)
+        return lockout_edge(filter, down, now);
+
+    /* A change the caller did not collect still happened at its time */
+    bool ignored;
+    debounce_filter_advance(filter, now, &ignored);
+
+    if (down == filter->raw)
+        return false;
+
+    if (filter->params.algo == DEBOUNCE_ALGO_INTEGRATOR)
+        sample_to(filter, now);
+    else if (filter->params.algo == DEBOUNCE_ALGO_HYSTERESIS)
+        integrate_to(filter, now);
+    filter->raw = down;
+
+    if (filter->params.algo == DEBOUNCE_ALGO_ASYMMETRIC)
+    {
+        if (now >= filter->lockout_until)
+        {
+            filter->out = down;
+            filter->lockout_until = now + window_for(filter, down);
+            filter->due = 0;
+            return true;
+        }
+        filter->due = down != filter->out ? filter->lockout_until : 0;
+        return false;
+    }
+
+    filter->due = schedule(filter, now);
+    if (filter->due != 0 && filter->due <= now)
+    {
+        filter->out = down;
+        filter->due = 0;
+        return true;
+    }
+    return false;
+}
+
+bool debounce_filter_deadline(const DebounceFilter *filter, uint64_t *deadline)
+{
+    if (!filter || filter->due == 0)
+        return false;
+
+    *deadline = filter->due;
+    return true;
+}
+
+bool debounce_filter_advance(DebounceFilter *filter, uint64_t now, bool *down)
+{
+    if (filter->due == 0 || now < filter->due)
+        return false;
+
+    uint64_t at = filter->due;
+    if (filter->params.algo == DEBOUNCE_ALGO_HYSTERESIS)
+        integrate_to(filter, at);
+
+    filter->out = filter->raw;
+    filter->due = 0;
+    if (filter->params.algo == DEBOUNCE_ALGO_ASYMMETRIC)
+        filter->lockout_until = at + window_for(filter, filter->out);
+
+    *down = filter->out;
+    return true;
+}
+
+const char *debounce_algo_name(DebounceAlgo algo)
+{
+    return (unsigned)algo < DEBOUNCE_ALGO_COUNT ? ALGO_NAMES[algo] : "unknown";
+}
+
+DebounceAlgo debounce_algo_from_name(const char *name)
+{
+    for (int i = 0; i < DEBOUNCE_ALGO_COUNT; i++)
+    {
+        if (name && strcmp(name, ALGO_NAMES[i]) == 0)
+            return (DebounceAlgo)i;
+    }
+    return DEBOUNCE_ALGO_COUNT;
+}
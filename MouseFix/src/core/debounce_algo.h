@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Button debounce algorithms behind one interface, one filter per button.
+ *
+ * The engine's own algorithm is DEBOUNCE_ALGO_LOCKOUT: pass an edge at once
+ * and block an edge within the window of the previous one. The others
+ * trade latency for different bounce rejection:
+ *
+ *   ASYMMETRIC  pass an edge at once, then ignore the switch for press_us
+ *               after a press and release_us after a release; a level
+ *               that changed meanwhile is emitted when the window ends
+ *   TRAILING    follow the switch once it has been stable for press_us
+ *               (going down) or release_us (going up)
+ *   INTEGRATOR  shift register sampling the switch every sample_us; the
+ *               output changes after press_us / sample_us (or release_us /
+ *               sample_us) equal samples, so a glitch between two samples
+ *               is never seen
+ *   HYSTERESIS  counter that counts up while the switch is down and down
+ *               while it is up, saturating at press_us; the output goes
+ *               down at the top and up at zero, so a bounce delays the
+ *               output change instead of restarting it
+ *
+ * Everything runs on event timestamps (microseconds), with no sampling
+ * timer: the samples and counts the classic versions would take are
+ * derived from the time between edges. An edge either passes when it
+ * arrives (debounce_filter_edge returns true) or the output change comes
+ * later, at the time debounce_filter_deadline reports. The caller runs
+ * debounce_filter_advance at that time, and always before the next edge.
+ *
+ * LOCKOUT matches the engine with Smart Drag off for button edges, so the
+ * harness in src/tune/algo_compare.h can compare against it directly.
+ */
+
+typedef enum
+{
+    DEBOUNCE_ALGO_LOCKOUT = 0,
+    DEBOUNCE_ALGO_ASYMMETRIC,
+    DEBOUNCE_ALGO_TRAILING,
+    DEBOUNCE_ALGO_INTEGRATOR,
+    DEBOUNCE_ALGO_HYSTERESIS,
+    DEBOUNCE_ALGO_COUNT
+} DebounceAlgo;
+
+/* Windows are microseconds; LOCKOUT and HYSTERESIS use press_us only */
+typedef struct
+{
+    DebounceAlgo algo;
+    uint32_t press_us;
+    uint32_t release_us;
+    uint32_t sample_us; /* INTEGRATOR only; 0 selects 1000 (1kHz) */
+} DebounceAlgoParams;
+
+/* Per-button filter state */
+typedef struct
+{
+    DebounceAlgoParams params;
+    uint64_t since;         /* previous edge (LOCKOUT), sampled up to (INTEGRATOR), counted up to (HYSTERESIS) */
+    uint64_t lockout_until; /* ASYMMETRIC */
+    uint64_t due;           /* time the output takes the switch level, 0 when nothing is pending */
+    uint64_t count;         /* HYSTERESIS count, INTEGRATOR run of equal samples */
+    bool raw;               /* switch level, true = down */
+    bool out;               /* output level */
+    bool run_down;          /* INTEGRATOR: level of the current run */
+    bool blocked;           /* LOCKOUT: inside a bounce */
+} DebounceFilter;
+
+void debounce_filter_init(DebounceFilter *filter, const DebounceAlgoParams *params);
+
+/* One switch edge at now; true when the output takes the edge right away */
+bool debounce_filter_edge(DebounceFilter *filter, bool down, uint64_t now);
+
+/* Time of the pending output change; false when there is none */
+bool debounce_filter_deadline(const DebounceFilter *filter, uint64_t *deadline);
+
+/* Applies the pending output change if it is due at now; true and *down set when it was */
+bool debounce_filter_advance(DebounceFilter *filter, uint64_t now, bool *down);
+
+const char *debounce_algo_name(DebounceAlgo algo);
+/* DEBOUNCE_ALGO_COUNT when the name is unknown */
+DebounceAlgo debounce_algo_from_name(const char *name);
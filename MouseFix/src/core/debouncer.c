@@ -9,26 +9,14 @@
  *                |                       ^
  *              BLOCKED -----------------+
  *                  (bounce down cancels confirm)
+ *
+ * The full transition function is BUTTON_TRANSITIONS below.
  */
 
-#define SMART_DRAG_HOLD_THRESHOLD_MS  200
-#define SMART_DRAG_DIST_THRESHOLD_SQ  25   /* 5px */
-#define SMART_DRAG_CONFIRM_TIMEOUT_MS 150
-
 uint64_t debounce_get_timestamp(DebounceManager *manager)
 {
-    if (manager && manager->qpc_available)
-    {
-        LARGE_INTEGER now;
-        QueryPerformanceCounter(&now);
-        return (uint64_t)(now.QuadPart * 1000000 / manager->qpc_frequency);
-    }
-    return GetTickCount64() * 1000;
-}
-
-static uint64_t timestamp_to_ms(uint64_t timestamp, bool qpc_available)
-{
-    return timestamp / 1000;
+    (void)manager;
+    return time_manager_now_us();
 }
 
 bool debounce_init(DebounceManager *manager)
@@ -38,241 +26,550 @@ bool debounce_init(DebounceManager *manager)
 
     memset(manager, 0, sizeof(DebounceManager));
     manager->use_hybrid_heuristic = true;
-
-    LARGE_INTEGER freq;
-    manager->qpc_available = QueryPerformanceFrequency(&freq) != 0;
-    manager->qpc_frequency = manager->qpc_available ? freq.QuadPart : 0;
-
-    InitializeCriticalSection(&manager->cs);
+    manager->drag_hold_us = SMART_DRAG_HOLD_THRESHOLD_US;
+    manager->drag_dist_sq = SMART_DRAG_DIST_THRESHOLD_SQ;
+    manager->drag_confirm_us = SMART_DRAG_CONFIRM_TIMEOUT_US;
+    manager->adaptive_min_us = ADAPTIVE_MIN_THRESHOLD_US;
+    manager->adaptive_max_us = ADAPTIVE_MAX_THRESHOLD_US;
+    /* Forces handler selection on the first event */
+    manager->config_epoch = 1;
     return true;
 }
 
 void debounce_cleanup(DebounceManager *manager)
 {
-    if (!manager)
+    (void)manager;
+}
+
+/* Apply a reset requested by debounce_reset_statistics to hook-owned state */
+static void apply_pending_reset(DebounceManager *manager)
+{
+    uint32_t epoch = mf_atomic_load32(&manager->reset_epoch);
+    if (epoch == mf_atomic_load32(&manager->applied_reset_epoch))
         return;
-    DeleteCriticalSection(&manager->cs);
+
+    manager->move_mask = 0;
+    for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
+    {
+        manager->buttons[i].state = BTN_STATE_IDLE;
+        manager->buttons[i].wheelDirection = 0;
+        for (int k = 0; k < ADDED_LATENCY_KIND_COUNT; k++)
+        {
+            latency_histogram_reset(&manager->added_latency[i][k].histogram);
+            mf_atomic_store64(&manager->added_latency[i][k].total_us, 0);
+        }
+    }
+    /* Last, so a getter that sees the epoch applied sees the zeroed state */
+    mf_atomic_store32(&manager->applied_reset_epoch, epoch);
 }
 
-bool debounce_process_event(DebounceManager *manager, const MouseEvent *event)
+/* Single writer, so a plain load/store pair is enough */
+static void count_block(ButtonDebounceData *data)
 {
-    if (!manager || !event)
-        return false;
+    mf_atomic_store32(&data->blocks, mf_atomic_load32(&data->blocks) + 1);
+}
 
-    EnterCriticalSection(&manager->cs);
+/* Hook thread or collector; see AddedLatency */
+static void record_added_latency(DebounceManager *manager, int button, AddedLatencyKind kind, uint64_t us)
+{
+    AddedLatency *added = &manager->added_latency[button][kind];
+    latency_histogram_record_shared(&added->histogram, us);
+    mf_atomic_fetch_add64(&added->total_us, us);
+}
 
-    ButtonDebounceData *data = &manager->buttons[event->button];
+/*
+ * One step of a fixed-step quantile estimate: 9 steps up for every step
+ * down tracks the 90th percentile, the mirror image the 10th. Steps scale
+ * with the estimate and never overshoot the sample.
+ */
+static MF_FORCE_INLINE uint32_t quantile_step(uint32_t estimate, uint32_t sample, bool upper)
+{
+    uint32_t step = (estimate >> 7) + 1;
+    uint32_t up = upper ? 9 * step : step;
+    uint32_t down = upper ? step : 9 * step;
+
+    if (sample > estimate)
+        return sample - estimate < up ? sample : estimate + up;
+    if (sample < estimate)
+        return estimate - sample < down ? sample : estimate - down;
+    return estimate;
+}
 
-    if (event->is_injected)
+/*
+ * Feed one inter-edge gap to the adaptive threshold of a button. A threshold
+ * this thread did not store was set from outside, so learning restarts
+ * from it; the store is a compare-exchange so a concurrent manual setting
+ * is never overwritten.
+ */
+static MF_FORCE_INLINE void adapt_threshold(const DebounceManager *manager, ButtonDebounceData *data, uint64_t gap, uint32_t *threshold)
+{
+    uint32_t current = *threshold;
+    if (current != data->adaptedUs)
     {
-        LeaveCriticalSection(&manager->cs);
-        return false;
+        data->bounceGapUs = current / 2;
+        data->clickGapUs = current + current / 2;
+        data->adaptedUs = current;
     }
 
-    if (!data->isMonitored)
+    uint32_t sample = gap > UINT32_MAX ? UINT32_MAX : (uint32_t)gap;
+    if (sample <= current)
+        data->bounceGapUs = quantile_step(data->bounceGapUs, sample, true);
+    else
+        data->clickGapUs = quantile_step(data->clickGapUs, sample, false);
+
+    uint32_t target = data->bounceGapUs / 2 + data->clickGapUs / 2;
+    uint32_t min_us = mf_atomic_load32(&manager->adaptive_min_us);
+    uint32_t max_us = mf_atomic_load32(&manager->adaptive_max_us);
+    if (target < min_us)
+        target = min_us;
+    if (target > max_us)
+        target = max_us;
+
+    if (target != current && mf_atomic_cas32(&data->thresholdUs, current, target))
     {
-        LeaveCriticalSection(&manager->cs);
-        return false;
+        data->adaptedUs = target;
+        *threshold = target;
     }
+}
 
+/* Wheel reversal filter */
+static MF_FORCE_INLINE bool process_wheel(DebounceManager *manager, ButtonDebounceData *data, const MouseEvent *event, uint32_t *threshold, bool adaptive)
+{
     bool should_block = false;
 
-    /* Wheel handling */
-    if (event->button == MOUSE_BUTTON_WHEEL)
-    {
-        int32_t wheel_delta = event->data;
-        int32_t direction_sign = (wheel_delta > 0) ? 1 : (wheel_delta < 0) ? -1 : 0;
+    int32_t wheel_delta = event->data;
+    int32_t direction_sign = (wheel_delta > 0) ? 1 : (wheel_delta < 0) ? -1 : 0;
 
-        if (direction_sign == 0)
-        {
-            LeaveCriticalSection(&manager->cs);
-            return false;
-        }
+    if (direction_sign == 0)
+        return false;
 
-        if (data->wheelDirection != 0 && data->wheelDirection != direction_sign)
+    if (data->wheelDirection != 0 && data->wheelDirection != direction_sign)
+    {
+        uint64_t elapsed_time = event->timestamp - data->previousTime;
+        if (elapsed_time <= *threshold)
         {
-            uint64_t elapsed_time = event->timestamp - data->previousTime;
-            if (elapsed_time <= data->thresholdMs)
-            {
-                data->blocks++;
-                should_block = true;
-            }
+            count_block(data);
+            should_block = true;
         }
+        if (adaptive)
+            adapt_threshold(manager, data, elapsed_time, threshold);
+    }
+
+    data->wheelDirection = direction_sign;
+    data->previousTime = event->timestamp;
+
+    return should_block;
+}
 
-        data->wheelDirection = direction_sign;
-        data->previousTime = event->timestamp;
+/*
+ * Smart Drag transition tables for button edges, one with Smart Drag off
+ * and one with it on, indexed by (state << 3) | (down << 2) | (within << 1) | far:
+ *   within  the gap since the previous edge is within the threshold
+ *           (read on down edges only)
+ *   far     the press was held longer than drag_hold_us or travelled
+ *           further than drag_dist_sq (up edges with Smart Drag on only)
+ * Each entry is the next state in the low bits plus BTN_ACT_* actions.
+ * Neither input depends on the state, so the state is the only value
+ * carried from one edge to the next.
+ */
+#define BTN_NEXT_MASK   0x007
+#define BTN_ACT_BLOCK   0x008 /* verdict */
+#define BTN_ACT_COUNT   0x010 /* counts toward the block statistics */
+#define BTN_ACT_STAMP   0x020 /* new press: downTime and downPoint */
+#define BTN_ACT_TRACK   0x040 /* fresh press: reset travel, track moves with Smart Drag on */
+#define BTN_ACT_CONFIRM 0x080 /* defer the release: open the confirm window */
+#define BTN_ACT_ADAPT   0x100 /* release-to-press gap feeds adaptive thresholds */
+
+/* Table entries */
+#define BTN_T_IDLE    BTN_STATE_IDLE
+#define BTN_T_PRESS   (BTN_STATE_PRESSED | BTN_ACT_STAMP | BTN_ACT_TRACK | BTN_ACT_ADAPT)
+#define BTN_T_BOUNCE  (BTN_STATE_BLOCKED | BTN_ACT_BLOCK | BTN_ACT_COUNT | BTN_ACT_ADAPT)
+#define BTN_T_DEFER   (BTN_STATE_CONFIRMING | BTN_ACT_BLOCK | BTN_ACT_CONFIRM)
+#define BTN_T_HELD    (BTN_STATE_BLOCKED | BTN_ACT_BLOCK | BTN_ACT_COUNT)    /* repeated down while BLOCKED */
+#define BTN_T_UNBLOCK (BTN_STATE_IDLE | BTN_ACT_BLOCK | BTN_ACT_COUNT)       /* the bounce's own up */
+#define BTN_T_REPEAT  (BTN_STATE_CONFIRMING | BTN_ACT_BLOCK | BTN_ACT_COUNT) /* up inside the confirm window */
+#define BTN_T_CANCEL  (BTN_STATE_DRAGGING | BTN_ACT_BLOCK | BTN_ACT_COUNT | BTN_ACT_STAMP)
+
+static const uint16_t BUTTON_TRANSITIONS[2][BTN_STATE_COUNT * 8] = {
+    {
+        /* Smart Drag off */
+        /*                up             far            within         within+far     down           far            within         within+far */
+        /* IDLE */       BTN_T_IDLE,    BTN_T_IDLE,    BTN_T_IDLE,    BTN_T_IDLE,    BTN_T_PRESS,   BTN_T_PRESS,   BTN_T_BOUNCE,  BTN_T_BOUNCE,
+        /* PRESSED */    BTN_T_IDLE,    BTN_T_IDLE,    BTN_T_IDLE,    BTN_T_IDLE,    BTN_T_PRESS,   BTN_T_PRESS,   BTN_T_BOUNCE,  BTN_T_BOUNCE,
+        /* DRAGGING */   BTN_T_IDLE,    BTN_T_IDLE,    BTN_T_IDLE,    BTN_T_IDLE,    BTN_T_PRESS,   BTN_T_PRESS,   BTN_T_BOUNCE,  BTN_T_BOUNCE,
+        /* CONFIRMING */ BTN_T_REPEAT,  BTN_T_REPEAT,  BTN_T_REPEAT,  BTN_T_REPEAT,  BTN_T_CANCEL,  BTN_T_CANCEL,  BTN_T_CANCEL,  BTN_T_CANCEL,
+        /* BLOCKED */    BTN_T_UNBLOCK, BTN_T_UNBLOCK, BTN_T_UNBLOCK, BTN_T_UNBLOCK, BTN_T_HELD,    BTN_T_HELD,    BTN_T_HELD,    BTN_T_HELD,
+    },
+    {
+        /* Smart Drag on: a far release from PRESSED, or any release from DRAGGING, is deferred */
+        /*                up             far            within         within+far     down           far            within         within+far */
+        /* IDLE */       BTN_T_IDLE,    BTN_T_IDLE,    BTN_T_IDLE,    BTN_T_IDLE,    BTN_T_PRESS,   BTN_T_PRESS,   BTN_T_BOUNCE,  BTN_T_BOUNCE,
+        /* PRESSED */    BTN_T_IDLE,    BTN_T_DEFER,   BTN_T_IDLE,    BTN_T_DEFER,   BTN_T_PRESS,   BTN_T_PRESS,   BTN_T_BOUNCE,  BTN_T_BOUNCE,
+        /* DRAGGING */   BTN_T_DEFER,   BTN_T_DEFER,   BTN_T_DEFER,   BTN_T_DEFER,   BTN_T_PRESS,   BTN_T_PRESS,   BTN_T_BOUNCE,  BTN_T_BOUNCE,
+        /* CONFIRMING */ BTN_T_REPEAT,  BTN_T_REPEAT,  BTN_T_REPEAT,  BTN_T_REPEAT,  BTN_T_CANCEL,  BTN_T_CANCEL,  BTN_T_CANCEL,  BTN_T_CANCEL,
+        /* BLOCKED */    BTN_T_UNBLOCK, BTN_T_UNBLOCK, BTN_T_UNBLOCK, BTN_T_UNBLOCK, BTN_T_HELD,    BTN_T_HELD,    BTN_T_HELD,    BTN_T_HELD,
+    },
+};
+
+/* Button debounce and the Smart Drag state machine */
+static MF_FORCE_INLINE bool process_button(DebounceManager *manager, ButtonDebounceData *data, const MouseEvent *event, uint32_t *threshold, bool hybrid, bool adaptive)
+{
+    uint64_t now = event->timestamp;
+    uint64_t elapsed = now - data->previousTime;
+    uint32_t move_bit = 1u << event->button;
+
+    /*
+     * The deferred-release timer or a settings change may have taken the
+     * pending release since the last event. A down edge cancels it here;
+     * whichever side clears confirmPending first owns the outcome.
+     */
+    if (data->state == BTN_STATE_CONFIRMING)
+    {
+        uint64_t pending = event->is_down ? mf_atomic_exchange64(&data->confirmPending, 0)
+                                          : mf_atomic_load64(&data->confirmPending);
+        if (pending == 0)
+            data->state = BTN_STATE_IDLE;
+        else if (event->is_down)
+            record_added_latency(manager, event->button, ADDED_LATENCY_CANCELLED, now - (pending >> 1));
     }
-    /* Button handling - state machine */
-    else
+
+    /* Only up edges read far, and only the Smart Drag table has a column for it */
+    bool far = false;
+    if (hybrid && !event->is_down)
     {
-        uint64_t now = event->timestamp;
-        uint64_t elapsed = now - data->previousTime;
+        int64_t dx = (int64_t)event->x - data->downPoint.x;
+        int64_t dy = (int64_t)event->y - data->downPoint.y;
+        uint64_t distSq = (uint64_t)(dx * dx + dy * dy);
+
+        /* A drag that came back near its origin still travelled maxDistSq */
+        uint64_t travel = distSq > data->maxDistSq ? distSq : data->maxDistSq;
+        far = (now - data->downTime > mf_atomic_load32(&manager->drag_hold_us)) |
+              (travel > mf_atomic_load32(&manager->drag_dist_sq));
+    }
 
-        if (event->is_down)
-        {
-            switch (data->state)
-            {
-            case BTN_STATE_IDLE:
-            case BTN_STATE_PRESSED:
-            case BTN_STATE_DRAGGING:
-                if (elapsed <= data->thresholdMs)
-                {
-                    data->state = BTN_STATE_BLOCKED;
-                    data->blocks++;
-                    should_block = true;
-                }
-                else
-                {
-                    data->state = BTN_STATE_PRESSED;
-                    data->downTime = now;
-                    data->downPoint.x = event->x;
-                    data->downPoint.y = event->y;
-                }
-                break;
-
-            case BTN_STATE_CONFIRMING:
-                /* Bounce down during confirm: cancel, back to DRAGGING */
-                data->state = BTN_STATE_DRAGGING;
-                data->downTime = now;
-                data->downPoint.x = event->x;
-                data->downPoint.y = event->y;
-                data->blocks++;
-                should_block = true;
-                break;
-
-            case BTN_STATE_BLOCKED:
-                data->blocks++;
-                should_block = true;
-                break;
-            }
-        }
-        else
-        {
-            switch (data->state)
-            {
-            case BTN_STATE_IDLE:
-                break;
-
-            case BTN_STATE_BLOCKED:
-                data->state = BTN_STATE_IDLE;
-                data->blocks++;
-                should_block = true;
-                break;
-
-            case BTN_STATE_PRESSED:
-                if (manager->use_hybrid_heuristic)
-                {
-                    uint64_t holdTime = now - data->downTime;
-                    long dx = event->x - data->downPoint.x;
-                    long dy = event->y - data->downPoint.y;
-                    long distSq = dx * dx + dy * dy;
-
-                    if (holdTime > SMART_DRAG_HOLD_THRESHOLD_MS || distSq > SMART_DRAG_DIST_THRESHOLD_SQ)
-                    {
-                        data->state = BTN_STATE_CONFIRMING;
-                        data->confirmStartTime = now;
-                        should_block = true;
-                    }
-                    else
-                    {
-                        data->state = BTN_STATE_IDLE;
-                    }
-                }
-                else
-                {
-                    data->state = BTN_STATE_IDLE;
-                }
-                break;
-
-            case BTN_STATE_DRAGGING:
-                if (manager->use_hybrid_heuristic)
-                {
-                    data->state = BTN_STATE_CONFIRMING;
-                    data->confirmStartTime = now;
-                    should_block = true;
-                }
-                else
-                {
-                    data->state = BTN_STATE_IDLE;
-                }
-                break;
-
-            case BTN_STATE_CONFIRMING:
-                data->blocks++;
-                should_block = true;
-                break;
-            }
-        }
+    uint32_t index = ((uint32_t)data->state << 3) | ((uint32_t)event->is_down << 2) |
+                     ((uint32_t)(elapsed <= *threshold) << 1) | (uint32_t)far;
+    uint32_t action = BUTTON_TRANSITIONS[hybrid][index];
+
+    data->state = (ButtonState)(action & BTN_NEXT_MASK);
+    mf_atomic_store32(&data->blocks, mf_atomic_load32(&data->blocks) + ((action & BTN_ACT_COUNT) != 0));
 
-        data->previousTime = now;
+    /* Only a button entering PRESSED is tracked, and only with Smart Drag on */
+    bool track = hybrid && (action & BTN_ACT_TRACK);
+    manager->move_mask = (manager->move_mask & ~move_bit) | (track ? move_bit : 0);
+    data->maxDistSq = (action & BTN_ACT_TRACK) ? 0 : data->maxDistSq;
+
+    if (action & BTN_ACT_STAMP)
+    {
+        data->downTime = now;
+        data->downPoint.x = event->x;
+        data->downPoint.y = event->y;
     }
+    if (action & BTN_ACT_CONFIRM)
+        mf_atomic_store64(&data->confirmPending, (now << 1) | 1);
+    if (adaptive && (action & BTN_ACT_ADAPT) && data->previousTime != 0)
+        adapt_threshold(manager, data, elapsed, threshold);
 
-    LeaveCriticalSection(&manager->cs);
-    return should_block;
+    data->previousTime = now;
+    return (action & BTN_ACT_BLOCK) != 0;
+}
+
+/*
+ * Decision for one event on a monitored button, shared by the generic and
+ * batch entry points. Configuration is passed in so the batch path can
+ * read it once per batch; an adapted threshold is written back through
+ * threshold. The verdict always uses the threshold in force when the event
+ * arrived.
+ */
+static MF_FORCE_INLINE bool process_core(DebounceManager *manager, ButtonDebounceData *data, const MouseEvent *event, uint32_t *threshold, bool hybrid, bool adaptive)
+{
+    if (event->button == MOUSE_BUTTON_WHEEL)
+        return process_wheel(manager, data, event, threshold, adaptive);
+    return process_button(manager, data, event, threshold, hybrid, adaptive);
+}
+
+/*
+ * Specialised handlers: process_wheel and process_button with the switches
+ * fixed at compile time, so the per-event path carries no configuration
+ * branches. Each loads its own threshold; monitoring is folded into
+ * handle_pass.
+ */
+static bool handle_pass(DebounceManager *manager, ButtonDebounceData *data, const MouseEvent *event)
+{
+    (void)manager;
+    (void)data;
+    (void)event;
+    return false;
+}
+
+#define DEFINE_WHEEL_HANDLER(name, adaptive)                                                      \
+    static bool name(DebounceManager *manager, ButtonDebounceData *data, const MouseEvent *event) \
+    {                                                                                             \
+        uint32_t threshold = mf_atomic_load32(&data->thresholdUs);                                \
+        return process_wheel(manager, data, event, &threshold, adaptive);                         \
+    }
+
+#define DEFINE_BUTTON_HANDLER(name, hybrid, adaptive)                                             \
+    static bool name(DebounceManager *manager, ButtonDebounceData *data, const MouseEvent *event) \
+    {                                                                                             \
+        uint32_t threshold = mf_atomic_load32(&data->thresholdUs);                                \
+        return process_button(manager, data, event, &threshold, hybrid, adaptive);                \
+    }
+
+DEFINE_WHEEL_HANDLER(handle_wheel, false)
+DEFINE_WHEEL_HANDLER(handle_wheel_adaptive, true)
+DEFINE_BUTTON_HANDLER(handle_button, false, false)
+DEFINE_BUTTON_HANDLER(handle_button_hybrid, true, false)
+DEFINE_BUTTON_HANDLER(handle_button_adaptive, false, true)
+DEFINE_BUTTON_HANDLER(handle_button_hybrid_adaptive, true, true)
+
+/* Indexed by [hybrid][adaptive] */
+static const DebounceHandler BUTTON_HANDLERS[2][2] = {
+    {handle_button, handle_button_adaptive},
+    {handle_button_hybrid, handle_button_hybrid_adaptive},
+};
+
+/* Re-pick the handlers after a setter bumped config_epoch; hook thread only */
+static MF_FORCE_INLINE void apply_pending_config(DebounceManager *manager)
+{
+    uint32_t epoch = mf_atomic_load32(&manager->config_epoch);
+    if (epoch == manager->applied_config_epoch)
+        return;
+
+    /* Recorded first: a setter racing with the reads below bumps it again */
+    manager->applied_config_epoch = epoch;
+    bool hybrid = mf_atomic_load32(&manager->use_hybrid_heuristic) != 0;
+    bool adaptive = mf_atomic_load32(&manager->adaptive) != 0;
+    for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
+    {
+        if (!mf_atomic_load32(&manager->buttons[i].isMonitored))
+            manager->handlers[i] = handle_pass;
+        else if (i == MOUSE_BUTTON_WHEEL)
+            manager->handlers[i] = adaptive ? handle_wheel_adaptive : handle_wheel;
+        else
+            manager->handlers[i] = BUTTON_HANDLERS[hybrid][adaptive];
+    }
+}
+
+static void bump_config_epoch(DebounceManager *manager)
+{
+    mf_atomic_fetch_add32(&manager->config_epoch, 1);
+}
+
+bool debounce_process_event(DebounceManager *manager, const MouseEvent *event)
+{
+    if (!manager || !event)
+        return false;
+
+    if (event->is_injected)
+        return false;
+
+    apply_pending_reset(manager);
+    apply_pending_config(manager);
+
+    return manager->handlers[event->button](manager, &manager->buttons[event->button], event);
+}
+
+bool debounce_process_event_generic(DebounceManager *manager, const MouseEvent *event)
+{
+    if (!manager || !event)
+        return false;
+
+    if (event->is_injected)
+        return false;
+
+    apply_pending_reset(manager);
+
+    ButtonDebounceData *data = &manager->buttons[event->button];
+
+    if (!mf_atomic_load32(&data->isMonitored))
+        return false;
+
+    uint32_t threshold = mf_atomic_load32(&data->thresholdUs);
+    return process_core(manager, data, event, &threshold,
+                        mf_atomic_load32(&manager->use_hybrid_heuristic) != 0,
+                        mf_atomic_load32(&manager->adaptive) != 0);
 }
 
-void debounce_check_deferred_releases(DebounceManager *manager)
+/* debounce_process_event on a packed event */
+bool debounce_process_packed(DebounceManager *manager, const PackedEvent *event)
+{
+    if (!event)
+        return false;
+
+    MouseEvent unpacked;
+    mouse_event_unpack(event, &unpacked);
+    return debounce_process_event(manager, &unpacked);
+}
+
+/*
+ * Slow path of debounce_process_move: fold one pointer position into the
+ * running travel of every tracked button. Once a button has travelled past
+ * the drag distance its release is decided, so it stops being tracked.
+ * Coordinates are widened before squaring; screen spans fit easily.
+ */
+void debounce_track_move(DebounceManager *manager, long x, long y)
 {
     if (!manager)
         return;
 
-    struct
+    apply_pending_reset(manager);
+
+    uint32_t limit = mf_atomic_load32(&manager->drag_dist_sq);
+    uint32_t mask = manager->move_mask;
+    for (int i = 0; mask != 0; i++, mask >>= 1)
     {
-        bool inject;
-        DWORD flags;
-        DWORD mouseData;
-    } actions[MOUSE_BUTTON_COUNT] = {0};
+        if (!(mask & 1))
+            continue;
 
-    EnterCriticalSection(&manager->cs);
-    uint64_t now = debounce_get_timestamp(manager);
+        ButtonDebounceData *data = &manager->buttons[i];
+        int64_t dx = (int64_t)x - data->downPoint.x;
+        int64_t dy = (int64_t)y - data->downPoint.y;
+        uint64_t distSq = (uint64_t)(dx * dx + dy * dy);
+
+        if (distSq > data->maxDistSq)
+            data->maxDistSq = distSq > UINT32_MAX ? UINT32_MAX : (uint32_t)distSq;
+        if (data->maxDistSq > limit)
+            manager->move_mask &= ~(1u << i);
+    }
+}
+
+/* Shared by both batch entry points; exactly one of events and packed is set */
+static MF_FORCE_INLINE size_t process_batch(DebounceManager *manager, const MouseEvent *events, const PackedEvent *packed,
+                                            size_t count, bool *verdicts)
+{
+    apply_pending_reset(manager);
+
+    uint32_t thresholds[MOUSE_BUTTON_COUNT];
+    bool monitored[MOUSE_BUTTON_COUNT];
+    for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
+    {
+        thresholds[i] = mf_atomic_load32(&manager->buttons[i].thresholdUs);
+        monitored[i] = mf_atomic_load32(&manager->buttons[i].isMonitored) != 0;
+    }
+    bool hybrid = mf_atomic_load32(&manager->use_hybrid_heuristic) != 0;
+    bool adaptive = mf_atomic_load32(&manager->adaptive) != 0;
+
+    size_t blocked = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        MouseEvent unpacked;
+        const MouseEvent *event = &unpacked;
+        if (packed)
+            mouse_event_unpack(&packed[i], &unpacked);
+        else
+            event = &events[i];
+
+        MouseButton button = event->button;
+        bool verdict = false;
+
+        if (!event->is_injected && monitored[button])
+            verdict = process_core(manager, &manager->buttons[button], event, &thresholds[button], hybrid, adaptive);
+
+        verdicts[i] = verdict;
+        blocked += verdict;
+    }
+    return blocked;
+}
+
+/*
+ * Process a contiguous array of events in order, writing one verdict per
+ * event (true = block). Pending resets and configuration are picked up once
+ * at the start of the batch; settings changed while it runs take effect on
+ * the next call. Same single-writer rules as debounce_process_event.
+ * Returns the number of blocked events.
+ */
+size_t debounce_process_batch(DebounceManager *manager, const MouseEvent *events, size_t count, bool *verdicts)
+{
+    if (!manager || !events || !verdicts)
+        return 0;
+
+    return process_batch(manager, events, NULL, count, verdicts);
+}
+
+size_t debounce_process_packed_batch(DebounceManager *manager, const PackedEvent *events, size_t count, bool *verdicts)
+{
+    if (!manager || !events || !verdicts)
+        return 0;
+
+    return process_batch(manager, NULL, events, count, verdicts);
+}
+
+/*
+ * Claim every pending release whose confirm window has expired.
+ * Returns a bitmask (1 << MouseButton) of releases the host must synthesize.
+ * Safe to call from any thread; the hook thread observes the claim on its
+ * next event for that button.
+ */
+uint32_t debounce_collect_deferred_releases(DebounceManager *manager, uint64_t now)
+{
+    if (!manager)
+        return 0;
+
+    uint32_t released = 0;
+    uint32_t timeout = mf_atomic_load32(&manager->drag_confirm_us);
 
     for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
     {
         ButtonDebounceData *data = &manager->buttons[i];
-        if (data->state == BTN_STATE_CONFIRMING)
+        uint64_t pending = mf_atomic_load64(&data->confirmPending);
+        if (pending == 0)
+            continue;
+
+        uint64_t elapsed = now - (pending >> 1);
+        if (elapsed >= timeout && mf_atomic_cas64(&data->confirmPending, pending, 0))
         {
-            uint64_t elapsed_ms = timestamp_to_ms(now - data->confirmStartTime, manager->qpc_available);
-            if (elapsed_ms >= SMART_DRAG_CONFIRM_TIMEOUT_MS)
-            {
-                data->state = BTN_STATE_IDLE;
-                actions[i].inject = true;
-
-                switch (i)
-                {
-                case MOUSE_BUTTON_LEFT:
-                    actions[i].flags = MOUSEEVENTF_LEFTUP;
-                    break;
-                case MOUSE_BUTTON_RIGHT:
-                    actions[i].flags = MOUSEEVENTF_RIGHTUP;
-                    break;
-                case MOUSE_BUTTON_MIDDLE:
-                    actions[i].flags = MOUSEEVENTF_MIDDLEUP;
-                    break;
-                case MOUSE_BUTTON_X1:
-                    actions[i].flags = MOUSEEVENTF_XUP;
-                    actions[i].mouseData = XBUTTON1;
-                    break;
-                case MOUSE_BUTTON_X2:
-                    actions[i].flags = MOUSEEVENTF_XUP;
-                    actions[i].mouseData = XBUTTON2;
-                    break;
-                }
-            }
+            released |= 1u << i;
+            record_added_latency(manager, i, ADDED_LATENCY_DEFERRED, elapsed);
         }
     }
-    LeaveCriticalSection(&manager->cs);
+
+    return released;
+}
+
+/*
+ * Earliest pending Smart Drag release deadline, so the host can sleep until
+ * exactly then instead of polling. At most one release per button can be
+ * pending, so the per-button handoff words are scanned directly rather than
+ * mirrored into a separate heap. Returns false when nothing is pending.
+ */
+bool debounce_get_next_deadline(DebounceManager *manager, uint64_t *deadline)
+{
+    if (!manager || !deadline)
+        return false;
+
+    bool found = false;
+    uint64_t earliest = UINT64_MAX;
+    uint32_t timeout = mf_atomic_load32(&manager->drag_confirm_us);
 
     for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
     {
-        if (actions[i].inject && actions[i].flags)
-        {
-            INPUT input = {0};
-            input.type = INPUT_MOUSE;
-            input.mi.dwFlags = actions[i].flags;
-            input.mi.mouseData = actions[i].mouseData;
-            SendInput(1, &input, sizeof(INPUT));
-        }
+        uint64_t pending = mf_atomic_load64(&manager->buttons[i].confirmPending);
+        if (pending == 0)
+            continue;
+
+        uint64_t due = (pending >> 1) + timeout;
+        if (due < earliest)
+            earliest = due;
+        found = true;
     }
+
+    if (found)
+        *deadline = earliest;
+    return found;
+}
+
+/* Claim expired releases and queue a button-up for each to batch; returns the released mask */
+uint32_t debounce_check_deferred_releases(DebounceManager *manager, OutputBatch *batch)
+{
+    if (!manager)
+        return 0;
+
+    uint64_t now = debounce_get_timestamp(manager);
+    uint32_t released = debounce_collect_deferred_releases(manager, now);
+    if (released && batch)
+        output_batch_push_releases(batch, released, now);
+    return released;
 }
 
 void debounce_set_threshold(DebounceManager *manager, MouseButton button, uint32_t threshold_ms, uint32_t min_threshold_ms, uint32_t max_threshold_ms)
@@ -282,9 +579,32 @@ void debounce_set_threshold(DebounceManager *manager, MouseButton button, uint32
     if (threshold_ms < min_threshold_ms || threshold_ms > max_threshold_ms)
         return;
 
-    EnterCriticalSection(&manager->cs);
-    manager->buttons[button].thresholdMs = threshold_ms;
-    LeaveCriticalSection(&manager->cs);
+    mf_atomic_store32(&manager->buttons[button].thresholdUs, threshold_ms * 1000);
+}
+
+uint32_t debounce_get_threshold(DebounceManager *manager, MouseButton button)
+{
+    if (!manager || button < 0 || button >= MOUSE_BUTTON_COUNT)
+        return 0;
+
+    return mf_atomic_load32(&manager->buttons[button].thresholdUs) / 1000;
+}
+
+/* Unbounded microsecond variants for replay and tuning tools */
+void debounce_set_threshold_us(DebounceManager *manager, MouseButton button, uint32_t threshold_us)
+{
+    if (!manager || button < 0 || button >= MOUSE_BUTTON_COUNT)
+        return;
+
+    mf_atomic_store32(&manager->buttons[button].thresholdUs, threshold_us);
+}
+
+uint32_t debounce_get_threshold_us(DebounceManager *manager, MouseButton button)
+{
+    if (!manager || button < 0 || button >= MOUSE_BUTTON_COUNT)
+        return 0;
+
+    return mf_atomic_load32(&manager->buttons[button].thresholdUs);
 }
 
 void debounce_set_hybrid_heuristic(DebounceManager *manager, bool use_hybrid)
@@ -292,18 +612,107 @@ void debounce_set_hybrid_heuristic(DebounceManager *manager, bool use_hybrid)
     if (!manager)
         return;
 
-    EnterCriticalSection(&manager->cs);
-    manager->use_hybrid_heuristic = use_hybrid;
+    mf_atomic_store32(&manager->use_hybrid_heuristic, use_hybrid);
+    bump_config_epoch(manager);
 
+    /* Drop pending releases; the hook thread falls back to IDLE on its next event */
     if (!use_hybrid)
     {
         for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
-        {
-            if (manager->buttons[i].state == BTN_STATE_CONFIRMING)
-                manager->buttons[i].state = BTN_STATE_IDLE;
-        }
+            mf_atomic_exchange64(&manager->buttons[i].confirmPending, 0);
     }
-    LeaveCriticalSection(&manager->cs);
+}
+
+bool debounce_get_hybrid_heuristic(DebounceManager *manager)
+{
+    if (!manager)
+        return false;
+
+    return mf_atomic_load32(&manager->use_hybrid_heuristic) != 0;
+}
+
+void debounce_get_config(DebounceManager *manager, DebounceConfig *config)
+{
+    if (!manager || !config)
+        return;
+
+    memset(config, 0, sizeof(DebounceConfig));
+    config->hybrid = debounce_get_hybrid_heuristic(manager);
+    for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
+    {
+        if (debounce_is_monitored(manager, i))
+            config->monitored_mask |= 1u << i;
+        config->threshold_us[i] = debounce_get_threshold_us(manager, i);
+    }
+    debounce_get_smart_drag(manager, &config->smart_drag);
+    debounce_get_adaptive(manager, &config->adaptive);
+}
+
+void debounce_set_config(DebounceManager *manager, const DebounceConfig *config)
+{
+    if (!manager || !config)
+        return;
+
+    debounce_set_hybrid_heuristic(manager, config->hybrid);
+    for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
+    {
+        debounce_set_monitored(manager, i, (config->monitored_mask >> i) & 1);
+        debounce_set_threshold_us(manager, i, config->threshold_us[i]);
+    }
+    debounce_set_smart_drag(manager, &config->smart_drag);
+    debounce_set_adaptive(manager, &config->adaptive);
+}
+
+/*
+ * Zero fields keep the default, so a config from an older trace that never
+ * carried Smart Drag tuning restores the stock behaviour. A new confirm
+ * timeout also moves the deadline of a release that is already pending.
+ */
+void debounce_set_smart_drag(DebounceManager *manager, const SmartDragParams *params)
+{
+    if (!manager || !params)
+        return;
+
+    mf_atomic_store32(&manager->drag_hold_us, params->hold_us ? params->hold_us : SMART_DRAG_HOLD_THRESHOLD_US);
+    mf_atomic_store32(&manager->drag_dist_sq, params->dist_sq ? params->dist_sq : SMART_DRAG_DIST_THRESHOLD_SQ);
+    mf_atomic_store32(&manager->drag_confirm_us, params->confirm_us ? params->confirm_us : SMART_DRAG_CONFIRM_TIMEOUT_US);
+}
+
+void debounce_get_smart_drag(DebounceManager *manager, SmartDragParams *params)
+{
+    if (!manager || !params)
+        return;
+
+    params->hold_us = mf_atomic_load32(&manager->drag_hold_us);
+    params->dist_sq = mf_atomic_load32(&manager->drag_dist_sq);
+    params->confirm_us = mf_atomic_load32(&manager->drag_confirm_us);
+}
+
+/* Zero bounds keep the defaults, as for Smart Drag */
+void debounce_set_adaptive(DebounceManager *manager, const AdaptiveParams *params)
+{
+    if (!manager || !params)
+        return;
+
+    uint32_t min_us = params->min_us ? params->min_us : ADAPTIVE_MIN_THRESHOLD_US;
+    uint32_t max_us = params->max_us ? params->max_us : ADAPTIVE_MAX_THRESHOLD_US;
+    if (max_us < min_us)
+        max_us = min_us;
+
+    mf_atomic_store32(&manager->adaptive_min_us, min_us);
+    mf_atomic_store32(&manager->adaptive_max_us, max_us);
+    mf_atomic_store32(&manager->adaptive, params->enabled);
+    bump_config_epoch(manager);
+}
+
+void debounce_get_adaptive(DebounceManager *manager, AdaptiveParams *params)
+{
+    if (!manager || !params)
+        return;
+
+    params->enabled = mf_atomic_load32(&manager->adaptive) != 0;
+    params->min_us = mf_atomic_load32(&manager->adaptive_min_us);
+    params->max_us = mf_atomic_load32(&manager->adaptive_max_us);
 }
 
 void debounce_set_monitored(DebounceManager *manager, MouseButton button, bool monitored)
@@ -311,9 +720,16 @@ void debounce_set_monitored(DebounceManager *manager, MouseButton button, bool m
     if (!manager || button < 0 || button >= MOUSE_BUTTON_COUNT)
         return;
 
-    EnterCriticalSection(&manager->cs);
-    manager->buttons[button].isMonitored = monitored;
-    LeaveCriticalSection(&manager->cs);
+    mf_atomic_store32(&manager->buttons[button].isMonitored, monitored);
+    bump_config_epoch(manager);
+}
+
+bool debounce_is_monitored(DebounceManager *manager, MouseButton button)
+{
+    if (!manager || button < 0 || button >= MOUSE_BUTTON_COUNT)
+        return false;
+
+    return mf_atomic_load32(&manager->buttons[button].isMonitored) != 0;
 }
 
 uint32_t debounce_get_total_blocks(DebounceManager *manager)
@@ -321,11 +737,9 @@ uint32_t debounce_get_total_blocks(DebounceManager *manager)
     if (!manager)
         return 0;
 
-    EnterCriticalSection(&manager->cs);
     uint32_t total = 0;
     for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
-        total += manager->buttons[i].blocks;
-    LeaveCriticalSection(&manager->cs);
+        total += debounce_get_button_blocks(manager, i);
     return total;
 }
 
@@ -334,10 +748,49 @@ uint32_t debounce_get_button_blocks(DebounceManager *manager, MouseButton button
     if (!manager || button < 0 || button >= MOUSE_BUTTON_COUNT)
         return 0;
 
-    EnterCriticalSection(&manager->cs);
-    uint32_t blocks = manager->buttons[button].blocks;
-    LeaveCriticalSection(&manager->cs);
-    return blocks;
+    ButtonDebounceData *data = &manager->buttons[button];
+    return mf_atomic_load32(&data->blocks) - mf_atomic_load32(&data->blocksBase);
+}
+
+bool debounce_get_added_latency(DebounceManager *manager, MouseButton button, AddedLatencyKind kind, AddedLatencySummary *summary)
+{
+    if (!manager || !summary || button < 0 || button >= MOUSE_BUTTON_COUNT || (unsigned)kind >= ADDED_LATENCY_KIND_COUNT)
+        return false;
+
+    memset(summary, 0, sizeof(AddedLatencySummary));
+
+    /* A reset the hook thread has not applied yet reads as empty */
+    if (mf_atomic_load32(&manager->reset_epoch) != mf_atomic_load32(&manager->applied_reset_epoch))
+        return true;
+
+    const AddedLatency *added = &manager->added_latency[button][kind];
+    summary->count = latency_histogram_count(&added->histogram);
+    if (summary->count == 0)
+        return true;
+
+    summary->total_us = mf_atomic_load64(&added->total_us);
+    summary->p50_us = latency_histogram_percentile(&added->histogram, 0.50);
+    summary->p99_us = latency_histogram_percentile(&added->histogram, 0.99);
+    summary->max_us = latency_histogram_max(&added->histogram);
+    return true;
+}
+
+/*
+ * State as the hook thread will see it on its next event. From other
+ * threads this is a diagnostic snapshot, not a synchronization point.
+ */
+ButtonState debounce_get_button_state(DebounceManager *manager, MouseButton button)
+{
+    if (!manager || button < 0 || button >= MOUSE_BUTTON_COUNT)
+        return BTN_STATE_IDLE;
+
+    if (mf_atomic_load32(&manager->reset_epoch) != mf_atomic_load32(&manager->applied_reset_epoch))
+        return BTN_STATE_IDLE;
+
+    ButtonDebounceData *data = &manager->buttons[button];
+    if (data->state == BTN_STATE_CONFIRMING && mf_atomic_load64(&data->confirmPending) == 0)
+        return BTN_STATE_IDLE;
+    return data->state;
 }
 
 const char *debounce_get_button_name(MouseButton button)
@@ -359,18 +812,12 @@ bool debounce_is_any_monitored(DebounceManager *manager)
     if (!manager)
         return false;
 
-    EnterCriticalSection(&manager->cs);
-    bool any = false;
     for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
     {
-        if (manager->buttons[i].isMonitored)
-        {
-            any = true;
-            break;
-        }
+        if (mf_atomic_load32(&manager->buttons[i].isMonitored))
+            return true;
     }
-    LeaveCriticalSection(&manager->cs);
-    return any;
+    return false;
 }
 
 void debounce_reset_statistics(DebounceManager *manager)
@@ -378,12 +825,13 @@ void debounce_reset_statistics(DebounceManager *manager)
     if (!manager)
         return;
 
-    EnterCriticalSection(&manager->cs);
     for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
     {
-        manager->buttons[i].blocks = 0;
-        manager->buttons[i].state = BTN_STATE_IDLE;
-        manager->buttons[i].wheelDirection = 0;
+        ButtonDebounceData *data = &manager->buttons[i];
+        mf_atomic_store32(&data->blocksBase, mf_atomic_load32(&data->blocks));
+        mf_atomic_exchange64(&data->confirmPending, 0);
     }
-    LeaveCriticalSection(&manager->cs);
+
+    /* State, wheel direction and added latency are reset by the hook thread on its next event */
+    mf_atomic_fetch_add32(&manager->reset_epoch, 1);
 }
@@ -1,9 +1,37 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
-#include <windows.h>
-#include "mouse_hook.h"
+#include "platform.h"
+#include "latency_histogram.h"
+#include "mouse_event.h"
+#include "output_sink.h"
+#include "time_manager.h"
+
+/*
+ * Threading model
+ *
+ * debounce_process_event is the single writer of all per-button state and
+ * must only be called from one thread at a time (the hook thread). It never
+ * blocks: configuration is read from atomics, counters are single-writer
+ * atomics, and the deferred-release timer claims a pending Smart Drag
+ * release through a compare-exchange on confirmPending instead of a lock.
+ * Every other function may be called from any thread.
+ *
+ * Event timestamps, thresholds and deadlines are microseconds on the
+ * time_manager_now_us clock. The setters and getters below keep taking
+ * milliseconds because that is what the UI and saved settings speak.
+ */
+
+/* Smart Drag defaults; a deferred release fires CONFIRM_TIMEOUT after the blocked UP */
+#define SMART_DRAG_HOLD_THRESHOLD_US  (200 * 1000)
+#define SMART_DRAG_DIST_THRESHOLD_SQ  25   /* 5px */
+#define SMART_DRAG_CONFIRM_TIMEOUT_US (150 * 1000)
+
+/* Default bounds for adaptive thresholds */
+#define ADAPTIVE_MIN_THRESHOLD_US (10 * 1000)
+#define ADAPTIVE_MAX_THRESHOLD_US (100 * 1000)
 
 /* Button state for Smart Drag state machine */
 typedef enum
@@ -12,46 +40,196 @@ typedef enum
     BTN_STATE_PRESSED,
     BTN_STATE_DRAGGING,
     BTN_STATE_CONFIRMING,
-    BTN_STATE_BLOCKED
+    BTN_STATE_BLOCKED,
+    BTN_STATE_COUNT
 } ButtonState;
 
 /* Per-button debounce data, aligned to cache line */
 typedef struct
 {
+    /* Owned by the hook thread */
     uint64_t previousTime;
     uint64_t downTime;
-    uint64_t confirmStartTime;
-    POINT downPoint;
-    uint32_t thresholdMs;
-    uint32_t blocks;
+    MfPoint downPoint;
+    uint32_t maxDistSq; /* furthest pointer travel from downPoint while PRESSED */
     int32_t wheelDirection;
     ButtonState state;
-    bool isMonitored;
-    uint8_t _padding[3];
-} __declspec(align(64)) ButtonDebounceData;
 
-/* Debounce manager */
+    /* Adaptive thresholds: gap quantile estimates and the threshold last stored */
+    uint32_t bounceGapUs;
+    uint32_t clickGapUs;
+    uint32_t adaptedUs;
+
+    /* Pending Smart Drag release: (confirmStartTime << 1) | 1, or 0 when none */
+    MfAtomic64 confirmPending;
+
+    /* Written by the hook thread, read anywhere; blocksBase is moved by resets */
+    MfAtomic32 blocks;
+    MfAtomic32 blocksBase;
+
+    /* Configuration, written by the UI and read by the hook thread */
+    MfAtomic32 thresholdUs;
+    MfAtomic32 isMonitored;
+} MF_ALIGN(MF_CACHE_LINE) ButtonDebounceData;
+
+/*
+ * Smart Drag tuning: an UP after a hold longer than hold_us or a travel
+ * further than sqrt(dist_sq) pixels is deferred by confirm_us
+ */
 typedef struct
+{
+    uint32_t hold_us;
+    uint32_t dist_sq;
+    uint32_t confirm_us;
+} SmartDragParams;
+
+/*
+ * Adaptive thresholds. Every release-to-press gap (or wheel reversal gap)
+ * on a monitored button is classified against the current threshold and
+ * nudges one of two streaming quantile estimates: the 90th percentile of
+ * bounce gaps or the 10th percentile of click gaps. The threshold follows
+ * the midpoint between them, clamped to [min_us, max_us]. Each estimate is
+ * a fixed-step stochastic approximation (steps of 1/128 of the estimate,
+ * nine times larger on the rare side), so an update is a few integer ops
+ * with no state beyond two words per button.
+ *
+ * The learned value is stored in the button's threshold, so it shows in
+ * the UI and is saved with the other settings. Setting a threshold by hand
+ * restarts learning from it.
+ */
+typedef struct
+{
+    bool enabled;
+    uint32_t min_us;
+    uint32_t max_us;
+} AdaptiveParams;
+
+/* Snapshot of the user-facing configuration */
+typedef struct
+{
+    uint32_t monitored_mask;
+    bool hybrid;
+    uint32_t threshold_us[MOUSE_BUTTON_COUNT];
+    SmartDragParams smart_drag;
+    AdaptiveParams adaptive;
+} DebounceConfig;
+
+/*
+ * Added latency: how much later a logical event reaches the system than
+ * the physical edge behind it, per button, in microseconds.
+ *
+ *   DEFERRED   a Smart Drag release, from the blocked UP to the moment
+ *              debounce_collect_deferred_releases claimed it: confirm_us
+ *              plus however late the collector ran
+ *   CANCELLED  a deferred release that a new press cancelled; the release
+ *              never happens, and the value is how long it had been held
+ *
+ * Blocked bounces have no logical event and show up in blocks only.
+ * Both the hook thread and the collector record here, which happens once
+ * per drag at most, so updates are atomic adds. Resets follow the same
+ * epoch handoff as the hook-owned state: the hook thread zeroes these
+ * while a collector may be recording, so a release collected as a reset
+ * is applied may survive it, in some of count, total and max but not all.
+ */
+typedef enum
+{
+    ADDED_LATENCY_DEFERRED = 0,
+    ADDED_LATENCY_CANCELLED,
+    ADDED_LATENCY_KIND_COUNT
+} AddedLatencyKind;
+
+typedef struct
+{
+    LatencyHistogram histogram;
+    MfAtomic64 total_us;
+} AddedLatency;
+
+typedef struct
+{
+    uint32_t count;
+    uint64_t total_us;
+    uint64_t p50_us;
+    uint64_t p99_us;
+    uint64_t max_us;
+} AddedLatencySummary;
+
+struct DebounceManager;
+
+/*
+ * One specialisation of the engine for a button: wheel or button, Smart
+ * Drag and adaptive thresholds on or off, or pass-through when the button
+ * is not monitored. Chosen per button whenever the configuration changes.
+ */
+typedef bool (*DebounceHandler)(struct DebounceManager *manager, ButtonDebounceData *data, const MouseEvent *event);
+
+/* Debounce manager */
+typedef struct DebounceManager
 {
     ButtonDebounceData buttons[MOUSE_BUTTON_COUNT];
-    bool use_hybrid_heuristic;
-    uint8_t _padding1[7];
-    CRITICAL_SECTION cs;
-    uint8_t _padding2[16];
-    int64_t qpc_frequency;
-    bool qpc_available;
-} __declspec(align(64)) DebounceManager;
+    MfAtomic32 use_hybrid_heuristic;
+    MfAtomic32 drag_hold_us;
+    MfAtomic32 drag_dist_sq;
+    MfAtomic32 drag_confirm_us;
+    MfAtomic32 adaptive;
+    MfAtomic32 adaptive_min_us;
+    MfAtomic32 adaptive_max_us;
+    MfAtomic32 reset_epoch;
+    MfAtomic32 config_epoch; /* bumped by every setter the handlers depend on */
+    MfAtomic32 applied_reset_epoch; /* hook thread writes, getters compare */
+    uint32_t move_mask; /* hook thread: buttons whose travel is still tracked */
+
+    /* Hook thread: handler per button, rebuilt when config_epoch moves */
+    uint32_t applied_config_epoch;
+    DebounceHandler handlers[MOUSE_BUTTON_COUNT];
+
+    /* Cold: written when a deferred release is collected or cancelled */
+    AddedLatency added_latency[MOUSE_BUTTON_COUNT][ADDED_LATENCY_KIND_COUNT];
+} MF_ALIGN(MF_CACHE_LINE) DebounceManager;
 
 bool debounce_init(DebounceManager *manager);
 void debounce_cleanup(DebounceManager *manager);
 bool debounce_process_event(DebounceManager *manager, const MouseEvent *event);
+/* Unspecialised reference for debounce_process_event, for tests and benchmarks */
+bool debounce_process_event_generic(DebounceManager *manager, const MouseEvent *event);
+size_t debounce_process_batch(DebounceManager *manager, const MouseEvent *events, size_t count, bool *verdicts);
+/* Same as the two above for PackedEvent buffers, unpacked on the fly */
+bool debounce_process_packed(DebounceManager *manager, const PackedEvent *event);
+size_t debounce_process_packed_batch(DebounceManager *manager, const PackedEvent *events, size_t count, bool *verdicts);
 void debounce_set_threshold(DebounceManager *manager, MouseButton button, uint32_t threshold_ms, uint32_t min_threshold_ms, uint32_t max_threshold_ms);
+uint32_t debounce_get_threshold(DebounceManager *manager, MouseButton button);
+void debounce_set_threshold_us(DebounceManager *manager, MouseButton button, uint32_t threshold_us);
+uint32_t debounce_get_threshold_us(DebounceManager *manager, MouseButton button);
 void debounce_set_monitored(DebounceManager *manager, MouseButton button, bool monitored);
+bool debounce_is_monitored(DebounceManager *manager, MouseButton button);
 uint32_t debounce_get_total_blocks(DebounceManager *manager);
 uint32_t debounce_get_button_blocks(DebounceManager *manager, MouseButton button);
+bool debounce_get_added_latency(DebounceManager *manager, MouseButton button, AddedLatencyKind kind, AddedLatencySummary *summary);
+ButtonState debounce_get_button_state(DebounceManager *manager, MouseButton button);
 const char *debounce_get_button_name(MouseButton button);
 bool debounce_is_any_monitored(DebounceManager *manager);
 void debounce_reset_statistics(DebounceManager *manager);
 void debounce_set_hybrid_heuristic(DebounceManager *manager, bool use_hybrid);
-void debounce_check_deferred_releases(DebounceManager *manager);
+bool debounce_get_hybrid_heuristic(DebounceManager *manager);
+void debounce_set_smart_drag(DebounceManager *manager, const SmartDragParams *params);
+void debounce_get_smart_drag(DebounceManager *manager, SmartDragParams *params);
+void debounce_set_adaptive(DebounceManager *manager, const AdaptiveParams *params);
+void debounce_get_adaptive(DebounceManager *manager, AdaptiveParams *params);
+void debounce_get_config(DebounceManager *manager, DebounceConfig *config);
+void debounce_set_config(DebounceManager *manager, const DebounceConfig *config);
+void debounce_track_move(DebounceManager *manager, long x, long y);
+
+/*
+ * Pointer movement, hook thread only. Travel matters only while a button
+ * is PRESSED with Smart Drag on and has not yet moved far enough to count
+ * as a drag, so the usual move costs one load and a branch.
+ */
+static inline void debounce_process_move(DebounceManager *manager, long x, long y)
+{
+    if (manager->move_mask != 0)
+        debounce_track_move(manager, x, y);
+}
+
+uint32_t debounce_check_deferred_releases(DebounceManager *manager, OutputBatch *batch);
+uint32_t debounce_collect_deferred_releases(DebounceManager *manager, uint64_t now);
+bool debounce_get_next_deadline(DebounceManager *manager, uint64_t *deadline);
 uint64_t debounce_get_timestamp(DebounceManager *manager);
@@ -0,0 +1,209 @@
+#include "event_tap.h"
+#include <string.h>
+#ifndef _WIN32
+#include <time.h>
+#endif
+
+/* Copy out up to max records and hand their slots back to the producer */
+size_t event_tap_drain(EventTap *tap, EventTapRecord *out, size_t max)
+{
+    if (!tap || !out)
+        return 0;
+
+    uint32_t tail = tap->tail;
+    uint32_t config_tail = tap->config_tail;
+    uint32_t available = mf_atomic_load32(&tap->head) - tail;
+    size_t count = available < max ? available : max;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const PackedEvent *slot = &tap->records[(tail + i) & (EVENT_TAP_CAPACITY - 1)];
+        EventTapRecord *record = &out[i];
+        record->type = slot->tag & EVENT_TAP_TAG_TYPE;
+        record->blocked = (slot->tag & EVENT_TAP_TAG_BLOCKED) != 0;
+
+        if (record->type == EVENT_TAP_EVENT)
+        {
+            record->event = *slot;
+            record->event.tag = 0;
+            continue;
+        }
+
+        record->mark.timestamp = packed_event_time(slot);
+        if (record->type == EVENT_TAP_CONFIG)
+            record->mark.config = tap->configs[config_tail++ & (EVENT_TAP_CONFIG_SLOTS - 1)];
+    }
+
+    mf_atomic_store32(&tap->config_tail, config_tail);
+    mf_atomic_store32(&tap->tail, tail + (uint32_t)count);
+    return count;
+}
+
+/* Drain everything currently published, in EVENT_TAP_BATCH sized callbacks */
+static void drain_all(EventTap *tap, EventTapRecord *batch)
+{
+    size_t count;
+    while ((count = event_tap_drain(tap, batch, EVENT_TAP_BATCH)) > 0)
+        tap->consumer(batch, count, tap->user_data);
+}
+
+static void tap_thread(void *arg)
+{
+    EventTap *tap = (EventTap *)arg;
+    EventTapRecord batch[EVENT_TAP_BATCH];
+
+    while (!mf_atomic_load32(&tap->stop))
+    {
+        drain_all(tap, batch);
+
+        /* Bounded, so a slow trickle of records is still drained between doorbells */
+#ifdef _WIN32
+        WaitForSingleObject(tap->wake_event, EVENT_TAP_FLUSH_MS);
+#else
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += EVENT_TAP_FLUSH_MS / 1000;
+        deadline.tv_nsec += (long)(EVENT_TAP_FLUSH_MS % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+
+        pthread_mutex_lock(&tap->mutex);
+        while (!tap->signaled && pthread_cond_timedwait(&tap->cond, &tap->mutex, &deadline) == 0)
+            ;
+        tap->signaled = false;
+        pthread_mutex_unlock(&tap->mutex);
+#endif
+    }
+
+    /* The producer has stopped; take whatever it left behind */
+    drain_all(tap, batch);
+}
+
+void event_tap_init(EventTap *tap)
+{
+    if (!tap)
+        return;
+
+    /* The slot arrays are left alone: slots are written before they are published */
+    memset(tap, 0, offsetof(EventTap, configs));
+}
+
+bool event_tap_start(EventTap *tap, EventTapConsumer consumer, void *user_data)
+{
+    if (!tap || !consumer)
+        return false;
+
+    event_tap_init(tap);
+    tap->consumer = consumer;
+    tap->user_data = user_data;
+
+#ifdef _WIN32
+    tap->wake_event = CreateEventW(NULL, FALSE, FALSE, NULL);
+    if (!tap->wake_event)
+        return false;
+#else
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&tap->mutex, NULL);
+    pthread_cond_init(&tap->cond, &attr);
+    pthread_condattr_destroy(&attr);
+#endif
+
+    if (!mf_thread_start(&tap->thread, tap_thread, tap))
+    {
+#ifdef _WIN32
+        CloseHandle(tap->wake_event);
+#else
+        pthread_cond_destroy(&tap->cond);
+        pthread_mutex_destroy(&tap->mutex);
+#endif
+        return false;
+    }
+
+    tap->running = true;
+    return true;
+}
+
+void event_tap_ring_doorbell(EventTap *tap)
+{
+    if (!tap->running)
+        return;
+
+#ifdef _WIN32
+    SetEvent(tap->wake_event);
+#else
+    pthread_mutex_lock(&tap->mutex);
+    tap->signaled = true;
+    pthread_cond_signal(&tap->cond);
+    pthread_mutex_unlock(&tap->mutex);
+#endif
+}
+
+void event_tap_kick(EventTap *tap)
+{
+    if (!tap)
+        return;
+
+    event_tap_ring_doorbell(tap);
+}
+
+void event_tap_stop(EventTap *tap)
+{
+    if (!tap || !tap->running)
+        return;
+
+    mf_atomic_store32(&tap->stop, 1);
+    event_tap_ring_doorbell(tap);
+    mf_thread_join(&tap->thread);
+    tap->running = false;
+
+#ifdef _WIN32
+    CloseHandle(tap->wake_event);
+#else
+    pthread_cond_destroy(&tap->cond);
+    pthread_mutex_destroy(&tap->mutex);
+#endif
+}
+
+bool event_tap_publish_config(EventTap *tap, uint64_t timestamp, const DebounceConfig *config)
+{
+    if (!tap || !config)
+        return false;
+
+    if (tap->config_head - mf_atomic_load32(&tap->config_tail) >= EVENT_TAP_CONFIG_SLOTS)
+    {
+        mf_atomic_store32(&tap->dropped, mf_atomic_load32(&tap->dropped) + 1);
+        return false;
+    }
+
+    uint32_t head = tap->head;
+    PackedEvent *record = event_tap_claim(tap, head);
+    if (!record)
+        return false;
+
+    tap->configs[tap->config_head++ & (EVENT_TAP_CONFIG_SLOTS - 1)] = *config;
+    record->bits = timestamp & PACKED_TIME_MASK;
+    record->tag = EVENT_TAP_CONFIG;
+    event_tap_commit(tap, head);
+    return true;
+}
+
+bool event_tap_publish_reset(EventTap *tap, uint64_t timestamp)
+{
+    if (!tap)
+        return false;
+
+    uint32_t head = tap->head;
+    PackedEvent *record = event_tap_claim(tap, head);
+    if (!record)
+        return false;
+
+    record->bits = timestamp & PACKED_TIME_MASK;
+    record->tag = EVENT_TAP_RESET;
+    event_tap_commit(tap, head);
+    return true;
+}
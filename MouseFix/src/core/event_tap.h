@@ -0,0 +1,156 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "platform.h"
+#include "debouncer.h"
+
+/*
+ * Single-producer/single-consumer tap from the hook path to a background
+ * consumer.
+ *
+ * The producer (the hook thread, which in MouseFix is also the UI thread)
+ * publishes an event together with the engine's verdict, or a configuration
+ * or reset marker, into a fixed ring with plain stores and one release
+ * store of the head index. It never blocks and never makes a system call on
+ * the common path: when the ring is full the record is dropped and counted,
+ * and the consumer is only woken once every EVENT_TAP_DOORBELL records, on
+ * an explicit event_tap_kick, or at the latest every EVENT_TAP_FLUSH_MS.
+ * A background thread drains the ring in batches and hands them to the
+ * consumer callback, so tracing, statistics and telemetry stay off the
+ * hook path. Markers are rare and the config side ring is small, so
+ * publish them with an event_tap_kick.
+ *
+ * Ring slots are 16-byte PackedEvents with the record type and verdict in
+ * the tag. Markers carry only their timestamp there; configuration
+ * snapshots are too large for a slot and go through a small side ring of
+ * EVENT_TAP_CONFIG_SLOTS, in the same order, joined up again on drain.
+ */
+
+#define EVENT_TAP_CAPACITY     4096 /* power of two */
+#define EVENT_TAP_DOORBELL     1024 /* records between consumer wakeups */
+#define EVENT_TAP_BATCH        256  /* records per consumer callback */
+#define EVENT_TAP_FLUSH_MS     1000 /* longest the consumer sleeps between drains */
+#define EVENT_TAP_CONFIG_SLOTS 16   /* undrained config markers; power of two */
+
+/* PackedEvent tag of a ring slot: record type in the low bits, then the verdict */
+#define EVENT_TAP_TAG_TYPE    0x03
+#define EVENT_TAP_TAG_BLOCKED 0x04
+
+typedef enum
+{
+    EVENT_TAP_EVENT = 0,
+    EVENT_TAP_CONFIG,
+    EVENT_TAP_RESET
+} EventTapRecordType;
+
+/* A drained record */
+typedef struct
+{
+    uint8_t type; /* EventTapRecordType */
+    bool blocked; /* verdict, EVENT_TAP_EVENT only */
+    union
+    {
+        PackedEvent event; /* EVENT_TAP_EVENT; tag is 0 */
+        struct
+        {
+            uint64_t timestamp;    /* when the marker was published */
+            DebounceConfig config; /* EVENT_TAP_CONFIG only */
+        } mark;
+    };
+} EventTapRecord;
+
+typedef void (*EventTapConsumer)(const EventTapRecord *records, size_t count, void *user_data);
+
+typedef struct
+{
+    /* Producer side */
+    MfAtomic32 head;
+    uint32_t cached_tail;
+    MfAtomic32 dropped;
+    uint32_t config_head;
+    uint8_t producer_pad[MF_CACHE_LINE - 4 * sizeof(uint32_t)];
+
+    /* Consumer side */
+    MfAtomic32 tail;
+    MfAtomic32 config_tail;
+    uint8_t consumer_pad[MF_CACHE_LINE - 2 * sizeof(uint32_t)];
+
+    EventTapConsumer consumer;
+    void *user_data;
+    MfThread thread;
+    MfAtomic32 stop;
+    bool running;
+
+#ifdef _WIN32
+    HANDLE wake_event;
+#else
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool signaled;
+#endif
+
+    DebounceConfig configs[EVENT_TAP_CONFIG_SLOTS];
+    PackedEvent records[EVENT_TAP_CAPACITY];
+} MF_ALIGN(MF_CACHE_LINE) EventTap;
+
+/* Empties the ring; for consumers that call event_tap_drain themselves */
+void event_tap_init(EventTap *tap);
+/* Initializes the ring and starts the consumer thread */
+bool event_tap_start(EventTap *tap, EventTapConsumer consumer, void *user_data);
+/* Drains what is left, then stops the consumer thread */
+void event_tap_stop(EventTap *tap);
+/* Wake the consumer now instead of at the next doorbell */
+void event_tap_kick(EventTap *tap);
+
+/* Producer calls; one thread only. Return false if the ring (or the config side ring) was full. */
+bool event_tap_publish_config(EventTap *tap, uint64_t timestamp, const DebounceConfig *config);
+bool event_tap_publish_reset(EventTap *tap, uint64_t timestamp);
+
+/* Copies up to max records out of the ring; consumer side only */
+size_t event_tap_drain(EventTap *tap, EventTapRecord *out, size_t max);
+
+static inline uint32_t event_tap_get_dropped(EventTap *tap)
+{
+    return mf_atomic_load32(&tap->dropped);
+}
+
+/* Reserve the next slot, or count a drop; producer only */
+static MF_FORCE_INLINE PackedEvent *event_tap_claim(EventTap *tap, uint32_t head)
+{
+    if (head - tap->cached_tail >= EVENT_TAP_CAPACITY)
+    {
+        tap->cached_tail = mf_atomic_load32(&tap->tail);
+        if (head - tap->cached_tail >= EVENT_TAP_CAPACITY)
+        {
+            mf_atomic_store32(&tap->dropped, mf_atomic_load32(&tap->dropped) + 1);
+            return NULL;
+        }
+    }
+    return &tap->records[head & (EVENT_TAP_CAPACITY - 1)];
+}
+
+void event_tap_ring_doorbell(EventTap *tap);
+
+/* Make a claimed record visible to the consumer */
+static MF_FORCE_INLINE void event_tap_commit(EventTap *tap, uint32_t head)
+{
+    mf_atomic_store32(&tap->head, head + 1);
+    if (((head + 1) & (EVENT_TAP_DOORBELL - 1)) == 0)
+        event_tap_ring_doorbell(tap);
+}
+
+/* Hook path: publish an event and its verdict */
+static MF_FORCE_INLINE bool event_tap_publish(EventTap *tap, const MouseEvent *event, bool blocked)
+{
+    uint32_t head = tap->head;
+    PackedEvent *record = event_tap_claim(tap, head);
+    if (!record)
+        return false;
+
+    *record = mouse_event_pack(event);
+    record->tag = EVENT_TAP_EVENT | (blocked ? EVENT_TAP_TAG_BLOCKED : 0);
+    event_tap_commit(tap, head);
+    return true;
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "debouncer.h"
+#include "mouse_event.h"
+
+/*
+ * Filter pipeline
+ *
+ * A pipeline is a chain of stages fixed at compile time. Each stage keeps
+ * its state in a block embedded in the pipeline struct, so building one
+ * allocates nothing and running one allocates nothing. A stage named foo
+ * with state type FooState provides five functions, normally static
+ * inline in its own header:
+ *
+ *   void foo_stage_init(FooState *state);
+ *   bool foo_stage_process(FooState *state, const MouseEvent *event);
+ *   void foo_stage_move(FooState *state, long x, long y);
+ *   uint32_t foo_stage_advance(FooState *state, uint64_t now);
+ *   bool foo_stage_deadline(FooState *state, uint64_t *deadline);
+ *
+ * process returns true to block the event, and later stages do not see a
+ * blocked event. advance runs when time passes without an event and
+ * returns a mask of buttons whose deferred release is due at now.
+ * deadline lowers *deadline to the stage's earliest pending deadline and
+ * returns false when it has none. MF_STAGE_NO_MOVE and MF_STAGE_NO_TIME
+ * define the trivial versions for stages that ignore moves or time.
+ *
+ * MF_PIPELINE_DEFINE takes an X-macro listing the stages in order as
+ * X(member, stage, State) and generates the struct, with each state block
+ * in its member, and the prefix_init/process/move/advance/deadline
+ * functions. A stage may appear more than once under different members.
+ * Every stage call is direct, so the compiler sees the whole chain and
+ * there is no function pointer per stage. Same threading rules as the
+ * engine: process, move and advance belong to one thread.
+ */
+
+#define MF_STAGE_NO_MOVE(name, State)                                         \
+    static inline void name##_stage_move(State *state, long x, long y)       \
+    {                                                                         \
+        (void)state;                                                          \
+        (void)x;                                                              \
+        (void)y;                                                              \
+    }
+
+#define MF_STAGE_NO_TIME(name, State)                                         \
+    static inline uint32_t name##_stage_advance(State *state, uint64_t now)   \
+    {                                                                         \
+        (void)state;                                                          \
+        (void)now;                                                            \
+        return 0;                                                             \
+    }                                                                         \
+    static inline bool name##_stage_deadline(State *state, uint64_t *deadline) \
+    {                                                                         \
+        (void)state;                                                          \
+        (void)deadline;                                                       \
+        return false;                                                         \
+    }
+
+/* Per-stage expansions used by MF_PIPELINE_DEFINE */
+#define MF_PIPELINE_MEMBER(member, stage, State)   State member;
+#define MF_PIPELINE_INIT(member, stage, State)     stage##_stage_init(&pipeline->member);
+#define MF_PIPELINE_PROCESS(member, stage, State)  \
+    if (stage##_stage_process(&pipeline->member, event)) \
+        return true;
+#define MF_PIPELINE_MOVE(member, stage, State)     stage##_stage_move(&pipeline->member, x, y);
+#define MF_PIPELINE_ADVANCE(member, stage, State)  released |= stage##_stage_advance(&pipeline->member, now);
+#define MF_PIPELINE_DEADLINE(member, stage, State) found |= stage##_stage_deadline(&pipeline->member, deadline);
+
+#define MF_PIPELINE_DEFINE(Pipeline, prefix, STAGES)                                \
+    typedef struct                                                                  \
+    {                                                                               \
+        STAGES(MF_PIPELINE_MEMBER)                                                  \
+    } Pipeline;                                                                     \
+                                                                                    \
+    static inline void prefix##_init(Pipeline *pipeline)                            \
+    {                                                                               \
+        STAGES(MF_PIPELINE_INIT)                                                    \
+    }                                                                               \
+                                                                                    \
+    static inline bool prefix##_process(Pipeline *pipeline, const MouseEvent *event) \
+    {                                                                               \
+        STAGES(MF_PIPELINE_PROCESS)                                                 \
+        return false;                                                               \
+    }                                                                               \
+                                                                                    \
+    static inline void prefix##_move(Pipeline *pipeline, long x, long y)            \
+    {                                                                               \
+        STAGES(MF_PIPELINE_MOVE)                                                    \
+    }                                                                               \
+                                                                                    \
+    static inline uint32_t prefix##_advance(Pipeline *pipeline, uint64_t now)       \
+    {                                                                               \
+        uint32_t released = 0;                                                      \
+        STAGES(MF_PIPELINE_ADVANCE)                                                 \
+        return released;                                                            \
+    }                                                                               \
+                                                                                    \
+    /* *out is only written when some stage has a deadline */                     \
+    static inline bool prefix##_deadline(Pipeline *pipeline, uint64_t *out)         \
+    {                                                                               \
+        uint64_t earliest = UINT64_MAX;                                             \
+        uint64_t *deadline = &earliest;                                             \
+        bool found = false;                                                         \
+        STAGES(MF_PIPELINE_DEADLINE)                                                \
+        if (found)                                                                  \
+            *out = earliest;                                                        \
+        return found;                                                               \
+    }
+
+/*
+ * The debounce engine as a stage: wheel reversals, button debounce and
+ * Smart Drag, which share per-button state and stay one stage. Configure
+ * it through the debounce_* setters on &pipeline->debounce.
+ */
+static inline void debounce_stage_init(DebounceManager *state)
+{
+    debounce_init(state);
+}
+
+static inline bool debounce_stage_process(DebounceManager *state, const MouseEvent *event)
+{
+    return debounce_process_event(state, event);
+}
+
+static inline void debounce_stage_move(DebounceManager *state, long x, long y)
+{
+    debounce_process_move(state, x, y);
+}
+
+static inline uint32_t debounce_stage_advance(DebounceManager *state, uint64_t now)
+{
+    return debounce_collect_deferred_releases(state, now);
+}
+
+static inline bool debounce_stage_deadline(DebounceManager *state, uint64_t *deadline)
+{
+    uint64_t next;
+    if (!debounce_get_next_deadline(state, &next))
+        return false;
+    if (next < *deadline)
+        *deadline = next;
+    return true;
+}
+
+/* The stock pipeline; new stages go in this list */
+#define MOUSE_PIPELINE_STAGES(X) \
+    X(debounce, debounce, DebounceManager)
+
+MF_PIPELINE_DEFINE(MousePipeline, mouse_pipeline, MOUSE_PIPELINE_STAGES)
@@ -0,0 +1,91 @@
+#include "hook_latency.h"
+
+bool hook_latency_init(HookLatency *latency)
+{
+    if (!latency)
+        return false;
+
+    for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
+        latency_histogram_reset(&latency->buttons[i]);
+    for (int from = 0; from < BTN_STATE_COUNT; from++)
+    {
+        for (int to = 0; to < BTN_STATE_COUNT; to++)
+            latency_histogram_reset(&latency->transitions[from][to]);
+    }
+
+    latency->ticks_per_second = mf_ticks_per_second();
+    mf_atomic_store32(&latency->reset_epoch, 0);
+    mf_atomic_store32(&latency->applied_reset_epoch, 0);
+    return true;
+}
+
+/* Safe from any thread; takes effect on the hook thread's next record */
+void hook_latency_reset(HookLatency *latency)
+{
+    if (!latency)
+        return;
+
+    mf_atomic_fetch_add32(&latency->reset_epoch, 1);
+}
+
+/* Hook thread only */
+void hook_latency_apply_reset(HookLatency *latency)
+{
+    uint32_t epoch = mf_atomic_load32(&latency->reset_epoch);
+
+    for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
+        latency_histogram_reset(&latency->buttons[i]);
+    for (int from = 0; from < BTN_STATE_COUNT; from++)
+    {
+        for (int to = 0; to < BTN_STATE_COUNT; to++)
+            latency_histogram_reset(&latency->transitions[from][to]);
+    }
+
+    mf_atomic_store32(&latency->applied_reset_epoch, epoch);
+}
+
+static uint64_t ticks_to_ns(const HookLatency *latency, uint64_t ticks)
+{
+    if (latency->ticks_per_second == 1000000000ull)
+        return ticks;
+    return (uint64_t)((double)ticks * 1e9 / (double)latency->ticks_per_second);
+}
+
+static bool summarize(const HookLatency *latency, const LatencyHistogram *histogram, LatencySummary *summary)
+{
+    summary->count = 0;
+    summary->p50_ns = 0;
+    summary->p99_ns = 0;
+    summary->p999_ns = 0;
+    summary->max_ns = 0;
+
+    /* A reset the hook thread has not applied yet reads as empty */
+    if (mf_atomic_load32(&latency->reset_epoch) != mf_atomic_load32(&latency->applied_reset_epoch))
+        return true;
+
+    summary->count = latency_histogram_count(histogram);
+    if (summary->count == 0)
+        return true;
+
+    summary->p50_ns = ticks_to_ns(latency, latency_histogram_percentile(histogram, 0.50));
+    summary->p99_ns = ticks_to_ns(latency, latency_histogram_percentile(histogram, 0.99));
+    summary->p999_ns = ticks_to_ns(latency, latency_histogram_percentile(histogram, 0.999));
+    summary->max_ns = ticks_to_ns(latency, latency_histogram_max(histogram));
+    return true;
+}
+
+bool hook_latency_get_button(HookLatency *latency, MouseButton button, LatencySummary *summary)
+{
+    if (!latency || !summary || (unsigned)button >= MOUSE_BUTTON_COUNT)
+        return false;
+
+    return summarize(latency, &latency->buttons[button], summary);
+}
+
+bool hook_latency_get_transition(HookLatency *latency, ButtonState from, ButtonState to, LatencySummary *summary)
+{
+    if (!latency || !summary || (unsigned)from >= BTN_STATE_COUNT || (unsigned)to >= BTN_STATE_COUNT)
+        return false;
+
+    return summarize(latency, &latency->transitions[from][to], summary);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "platform.h"
+#include "latency_histogram.h"
+#include "debouncer.h"
+
+/*
+ * Hook decision-path latency, from LowLevelMouseProc entry to the verdict,
+ * bucketed per button and per Smart Drag state transition.
+ *
+ * hook_latency_record is called by the hook thread only and costs a
+ * couple of stores. Resets follow the debouncer's epoch handoff: any
+ * thread bumps reset_epoch and the hook thread zeroes the histograms on
+ * its next record, so it never races a memset. Summaries read a pending
+ * reset as empty.
+ */
+
+typedef struct
+{
+    uint32_t count;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+    uint64_t p999_ns;
+    uint64_t max_ns;
+} LatencySummary;
+
+typedef struct
+{
+    LatencyHistogram buttons[MOUSE_BUTTON_COUNT];
+    LatencyHistogram transitions[BTN_STATE_COUNT][BTN_STATE_COUNT];
+    uint64_t ticks_per_second;
+    MfAtomic32 reset_epoch;
+    MfAtomic32 applied_reset_epoch; /* hook thread writes, summaries compare */
+} HookLatency;
+
+bool hook_latency_init(HookLatency *latency);
+void hook_latency_reset(HookLatency *latency);
+void hook_latency_apply_reset(HookLatency *latency);
+bool hook_latency_get_button(HookLatency *latency, MouseButton button, LatencySummary *summary);
+bool hook_latency_get_transition(HookLatency *latency, ButtonState from, ButtonState to, LatencySummary *summary);
+
+/* Hook thread only; ticks are mf_ticks() units */
+static MF_FORCE_INLINE void hook_latency_record(HookLatency *latency, MouseButton button, ButtonState from, ButtonState to, uint64_t ticks)
+{
+    if (mf_atomic_load32(&latency->reset_epoch) != mf_atomic_load32(&latency->applied_reset_epoch))
+        hook_latency_apply_reset(latency);
+
+    if ((unsigned)button < MOUSE_BUTTON_COUNT)
+        latency_histogram_record(&latency->buttons[button], ticks);
+    if ((unsigned)from < BTN_STATE_COUNT && (unsigned)to < BTN_STATE_COUNT)
+        latency_histogram_record(&latency->transitions[from][to], ticks);
+}
@@ -0,0 +1,83 @@
+#include "input_decode.h"
+#include <stddef.h>
+#include "time_manager.h"
+
+MouseButton input_decode_button(uint32_t message, uint32_t mouse_data)
+{
+    switch (message)
+    {
+    case INPUT_MSG_LBUTTONDOWN:
+    case INPUT_MSG_LBUTTONUP:
+        return MOUSE_BUTTON_LEFT;
+    case INPUT_MSG_RBUTTONDOWN:
+    case INPUT_MSG_RBUTTONUP:
+        return MOUSE_BUTTON_RIGHT;
+    case INPUT_MSG_MBUTTONDOWN:
+    case INPUT_MSG_MBUTTONUP:
+        return MOUSE_BUTTON_MIDDLE;
+    case INPUT_MSG_XBUTTONDOWN:
+    case INPUT_MSG_XBUTTONUP:
+        return (mouse_data >> 16) == INPUT_XBUTTON1 ? MOUSE_BUTTON_X1 : MOUSE_BUTTON_X2;
+    case INPUT_MSG_MOUSEWHEEL:
+        return MOUSE_BUTTON_WHEEL;
+    default:
+        return MOUSE_BUTTON_UNKNOWN;
+    }
+}
+
+bool input_decode_is_down(uint32_t message)
+{
+    return message == INPUT_MSG_LBUTTONDOWN || message == INPUT_MSG_RBUTTONDOWN ||
+           message == INPUT_MSG_MBUTTONDOWN || message == INPUT_MSG_XBUTTONDOWN;
+}
+
+bool input_decode_is_injected(uint32_t flags)
+{
+    return (flags & (INPUT_FLAG_INJECTED | INPUT_FLAG_LOWER_IL_INJECTED)) != 0;
+}
+
+bool input_decode_event(const RawMouseRecord *raw, MouseEvent *event)
+{
+    MouseButton button = input_decode_button(raw->message, raw->mouse_data);
+    if (button == MOUSE_BUTTON_UNKNOWN)
+        return false;
+
+    event->button = button;
+    event->is_down = input_decode_is_down(raw->message);
+    event->x = raw->x;
+    event->y = raw->y;
+    event->is_injected = input_decode_is_injected(raw->flags);
+
+    /* Wheel delta is the signed high word, as GET_WHEEL_DELTA_WPARAM reads it */
+    event->data = button == MOUSE_BUTTON_WHEEL ? (int16_t)(raw->mouse_data >> 16) : 0;
+    return true;
+}
+
+void input_dispatcher_init(InputDispatcher *dispatcher, InputEventHandler on_event, void *user_data)
+{
+    if (!dispatcher)
+        return;
+
+    dispatcher->on_event = on_event;
+    dispatcher->on_move = NULL;
+    dispatcher->clock = time_manager_now_us;
+    dispatcher->user_data = user_data;
+}
+
+bool input_dispatch(const InputDispatcher *dispatcher, const RawMouseRecord *raw)
+{
+    /* Moves are most of the stream at high polling rates: test them first */
+    if (raw->message == INPUT_MSG_MOUSEMOVE)
+    {
+        if (dispatcher->on_move && !input_decode_is_injected(raw->flags))
+            dispatcher->on_move(raw->x, raw->y, dispatcher->user_data);
+        return false;
+    }
+
+    MouseEvent event;
+    if (!input_decode_event(raw, &event))
+        return false;
+
+    event.timestamp = dispatcher->clock();
+    return dispatcher->on_event(&event, dispatcher->user_data);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "mouse_event.h"
+
+/*
+ * Portable half of the mouse hook: translation of a low-level hook record
+ * into a MouseEvent and dispatch to the engine.
+ *
+ * mouse_hook.c copies the fields it needs from MSLLHOOKSTRUCT into a
+ * RawMouseRecord and hands it to input_dispatch; tests and benchmarks
+ * build records directly. Message and flag values are the Win32 ones, so
+ * the hook copies them unchanged (mouse_hook.c checks they match).
+ */
+
+/* WM_* mouse messages */
+#define INPUT_MSG_MOUSEMOVE   0x0200
+#define INPUT_MSG_LBUTTONDOWN 0x0201
+#define INPUT_MSG_LBUTTONUP   0x0202
+#define INPUT_MSG_RBUTTONDOWN 0x0204
+#define INPUT_MSG_RBUTTONUP   0x0205
+#define INPUT_MSG_MBUTTONDOWN 0x0207
+#define INPUT_MSG_MBUTTONUP   0x0208
+#define INPUT_MSG_MOUSEWHEEL  0x020A
+#define INPUT_MSG_XBUTTONDOWN 0x020B
+#define INPUT_MSG_XBUTTONUP   0x020C
+
+/* High word of mouse_data for X button messages */
+#define INPUT_XBUTTON1 0x0001
+#define INPUT_XBUTTON2 0x0002
+
+/* LLMHF_* flags */
+#define INPUT_FLAG_INJECTED          0x00000001
+#define INPUT_FLAG_LOWER_IL_INJECTED 0x00000002
+
+/* The fields of MSLLHOOKSTRUCT the engine needs, plus the message */
+typedef struct
+{
+    uint32_t message;    /* INPUT_MSG_* */
+    uint32_t mouse_data; /* wheel delta or X button in the high word */
+    uint32_t flags;      /* INPUT_FLAG_* */
+    int32_t x;
+    int32_t y;
+} RawMouseRecord;
+
+/* Returns true to block the event */
+typedef bool (*InputEventHandler)(const MouseEvent *event, void *user_data);
+/* Pointer moves are never blocked */
+typedef void (*InputMoveHandler)(long x, long y, void *user_data);
+/* Microsecond clock for event timestamps */
+typedef uint64_t (*InputClock)(void);
+
+typedef struct
+{
+    InputEventHandler on_event;
+    InputMoveHandler on_move; /* optional; injected moves are dropped */
+    InputClock clock;
+    void *user_data;
+} InputDispatcher;
+
+/* Button for a message, MOUSE_BUTTON_UNKNOWN for moves and anything unhandled */
+MouseButton input_decode_button(uint32_t message, uint32_t mouse_data);
+bool input_decode_is_down(uint32_t message);
+bool input_decode_is_injected(uint32_t flags);
+
+/* Fills everything but the timestamp; false when the record is not a button or wheel event */
+bool input_decode_event(const RawMouseRecord *raw, MouseEvent *event);
+
+/* Clock defaults to time_manager_now_us */
+void input_dispatcher_init(InputDispatcher *dispatcher, InputEventHandler on_event, void *user_data);
+
+/*
+ * Route one record: moves to on_move, button and wheel events to on_event
+ * (stamped with the clock only once they are known to matter), everything
+ * else nowhere. Returns true when the record must be blocked.
+ */
+bool input_dispatch(const InputDispatcher *dispatcher, const RawMouseRecord *raw);
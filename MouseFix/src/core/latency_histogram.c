@@ -0,0 +1,60 @@
+#include "latency_histogram.h"
+#include <string.h>
+
+void latency_histogram_reset(LatencyHistogram *histogram)
+{
+    if (!histogram)
+        return;
+
+    for (int i = 0; i < LATENCY_BUCKET_COUNT; i++)
+        mf_atomic_store32(&histogram->counts[i], 0);
+    mf_atomic_store32(&histogram->total, 0);
+    mf_atomic_store64(&histogram->max, 0);
+}
+
+/* Largest value that maps to bucket index */
+static uint64_t bucket_upper_bound(uint32_t index)
+{
+    if (index < 2 * LATENCY_SUB_BUCKETS)
+        return index;
+
+    uint32_t shift = index / LATENCY_SUB_BUCKETS - 1;
+    uint64_t mantissa = index % LATENCY_SUB_BUCKETS + LATENCY_SUB_BUCKETS;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+uint64_t latency_histogram_percentile(const LatencyHistogram *histogram, double q)
+{
+    if (!histogram)
+        return 0;
+
+    /* Sum the buckets rather than trusting total, which a concurrent writer may be ahead of */
+    uint64_t total = 0;
+    for (int i = 0; i < LATENCY_BUCKET_COUNT; i++)
+        total += mf_atomic_load32(&histogram->counts[i]);
+    if (total == 0)
+        return 0;
+
+    if (q < 0.0)
+        q = 0.0;
+    if (q > 1.0)
+        q = 1.0;
+
+    /* Rank of the q-quantile, 1-based, rounded up */
+    uint64_t rank = (uint64_t)(q * (double)total + 0.999999);
+    if (rank == 0)
+        rank = 1;
+
+    uint64_t max = latency_histogram_max(histogram);
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < LATENCY_BUCKET_COUNT; i++)
+    {
+        seen += mf_atomic_load32(&histogram->counts[i]);
+        if (seen >= rank)
+        {
+            uint64_t bound = bucket_upper_bound(i);
+            return bound < max ? bound : max;
+        }
+    }
+    return max;
+}
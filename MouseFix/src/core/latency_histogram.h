@@ -0,0 +1,99 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "platform.h"
+
+/*
+ * Log-linear latency histogram in the style of HdrHistogram.
+ *
+ * Values below 32 get a bucket each; above that every power of two is
+ * split into 16 sub-buckets, so any recorded value is reported within
+ * 1/16 (6.25%) of itself. Values past 2^40 units land in the last bucket;
+ * the exact maximum is kept separately. The unit is up to the caller
+ * (ticks, ns, us).
+ *
+ * Recording is allocation-free and lock-free for a single writer: counts
+ * are bumped with a plain load and store, and readers on other threads
+ * get a consistent-enough snapshot for percentiles. Histograms written
+ * from more than one thread use latency_histogram_record_shared.
+ */
+
+#define LATENCY_SUB_BUCKET_BITS 4
+#define LATENCY_SUB_BUCKETS     (1 << LATENCY_SUB_BUCKET_BITS)
+#define LATENCY_MAX_MAGNITUDE   40
+#define LATENCY_BUCKET_COUNT    ((LATENCY_MAX_MAGNITUDE - LATENCY_SUB_BUCKET_BITS + 2) * LATENCY_SUB_BUCKETS)
+
+typedef struct
+{
+    MfAtomic32 counts[LATENCY_BUCKET_COUNT];
+    MfAtomic32 total;
+    MfAtomic64 max;
+} LatencyHistogram;
+
+void latency_histogram_reset(LatencyHistogram *histogram);
+
+/* Value at quantile q (0..1), as the upper bound of its bucket clamped to max; 0 if empty */
+uint64_t latency_histogram_percentile(const LatencyHistogram *histogram, double q);
+
+static inline uint32_t latency_histogram_count(const LatencyHistogram *histogram)
+{
+    return mf_atomic_load32(&histogram->total);
+}
+
+static inline uint64_t latency_histogram_max(const LatencyHistogram *histogram)
+{
+    return mf_atomic_load64(&histogram->max);
+}
+
+static MF_FORCE_INLINE uint32_t latency_bucket_index(uint64_t value)
+{
+    if (value < 2 * LATENCY_SUB_BUCKETS)
+        return (uint32_t)value;
+
+#if defined(_MSC_VER)
+    unsigned long msb;
+#if defined(_M_X64) || defined(_M_ARM64)
+    _BitScanReverse64(&msb, value);
+#else
+    if (value >> 32)
+    {
+        _BitScanReverse(&msb, (unsigned long)(value >> 32));
+        msb += 32;
+    }
+    else
+    {
+        _BitScanReverse(&msb, (unsigned long)value);
+    }
+#endif
+#else
+    uint32_t msb = 63 - (uint32_t)__builtin_clzll(value);
+#endif
+
+    if (msb > LATENCY_MAX_MAGNITUDE)
+        return LATENCY_BUCKET_COUNT - 1;
+
+    uint32_t shift = (uint32_t)msb - LATENCY_SUB_BUCKET_BITS;
+    return (shift + 1) * LATENCY_SUB_BUCKETS + (uint32_t)(value >> shift) - LATENCY_SUB_BUCKETS;
+}
+
+/* Single writer only */
+static MF_FORCE_INLINE void latency_histogram_record(LatencyHistogram *histogram, uint64_t value)
+{
+    MfAtomic32 *count = &histogram->counts[latency_bucket_index(value)];
+    mf_atomic_store32(count, mf_atomic_load32(count) + 1);
+    mf_atomic_store32(&histogram->total, mf_atomic_load32(&histogram->total) + 1);
+    if (value > mf_atomic_load64(&histogram->max))
+        mf_atomic_store64(&histogram->max, value);
+}
+
+/* Any number of writers; atomic adds, so keep it off paths that run per event */
+static inline void latency_histogram_record_shared(LatencyHistogram *histogram, uint64_t value)
+{
+    mf_atomic_fetch_add32(&histogram->counts[latency_bucket_index(value)], 1);
+    mf_atomic_fetch_add32(&histogram->total, 1);
+
+    uint64_t max = mf_atomic_load64(&histogram->max);
+    while (value > max && !mf_atomic_cas64(&histogram->max, max, value))
+        max = mf_atomic_load64(&histogram->max);
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Mouse button types
+typedef enum
+{
+	MOUSE_BUTTON_UNKNOWN = -1,
+	MOUSE_BUTTON_LEFT,
+	MOUSE_BUTTON_RIGHT,
+	MOUSE_BUTTON_MIDDLE,
+	MOUSE_BUTTON_X1,
+	MOUSE_BUTTON_X2,
+	MOUSE_BUTTON_WHEEL,
+	MOUSE_BUTTON_COUNT
+} MouseButton;
+
+// Mouse event structure
+typedef struct
+{
+	MouseButton button;
+	uint64_t timestamp;
+	bool is_down;
+	long x;
+	long y;
+	bool is_injected;
+	int32_t data;
+} MouseEvent;
+
+// Packed 16-byte event for batches, rings and replay buffers.
+// bits holds the timestamp in its low 48 bits (microseconds, ~8.9 years),
+// then the button (3 bits, 7 = unknown), is_down and is_injected.
+// Coordinates and the wheel delta are clamped to 16 bits, which covers the
+// virtual desktop and every delta the hook reports.
+typedef struct
+{
+	uint64_t bits;
+	int16_t x;
+	int16_t y;
+	int16_t data;
+	uint16_t tag; // not used by the engine; free for whatever holds the event
+} PackedEvent;
+
+#define PACKED_TIME_MASK     ((1ull << 48) - 1)
+#define PACKED_BUTTON_SHIFT  48
+#define PACKED_BUTTON_MASK   7ull
+#define PACKED_DOWN_BIT      (1ull << 51)
+#define PACKED_INJECTED_BIT  (1ull << 52)
+
+static inline int16_t packed_clamp16(long value)
+{
+	return (int16_t)(value < INT16_MIN ? INT16_MIN : value > INT16_MAX ? INT16_MAX : value);
+}
+
+static inline PackedEvent mouse_event_pack(const MouseEvent *event)
+{
+	PackedEvent packed;
+	packed.bits = (event->timestamp & PACKED_TIME_MASK) |
+	              (((uint64_t)event->button & PACKED_BUTTON_MASK) << PACKED_BUTTON_SHIFT) |
+	              (event->is_down ? PACKED_DOWN_BIT : 0) |
+	              (event->is_injected ? PACKED_INJECTED_BIT : 0);
+	packed.x = packed_clamp16(event->x);
+	packed.y = packed_clamp16(event->y);
+	packed.data = packed_clamp16(event->data);
+	packed.tag = 0;
+	return packed;
+}
+
+static inline uint64_t packed_event_time(const PackedEvent *packed)
+{
+	return packed->bits & PACKED_TIME_MASK;
+}
+
+static inline MouseButton packed_event_button(const PackedEvent *packed)
+{
+	uint32_t button = (uint32_t)(packed->bits >> PACKED_BUTTON_SHIFT) & PACKED_BUTTON_MASK;
+	return button == PACKED_BUTTON_MASK ? MOUSE_BUTTON_UNKNOWN : (MouseButton)button;
+}
+
+static inline bool packed_event_is_down(const PackedEvent *packed)
+{
+	return (packed->bits & PACKED_DOWN_BIT) != 0;
+}
+
+static inline bool packed_event_is_injected(const PackedEvent *packed)
+{
+	return (packed->bits & PACKED_INJECTED_BIT) != 0;
+}
+
+static inline void mouse_event_unpack(const PackedEvent *packed, MouseEvent *event)
+{
+	event->button = packed_event_button(packed);
+	event->timestamp = packed_event_time(packed);
+	event->is_down = packed_event_is_down(packed);
+	event->x = packed->x;
+	event->y = packed->y;
+	event->is_injected = packed_event_is_injected(packed);
+	event->data = packed->data;
+}
@@ -2,63 +2,71 @@
 #include <stdint.h>
 #include <windows.h>
 
+// input_decode.h mirrors the Win32 values so records are copied unchanged
+typedef char input_values_match_win32[(INPUT_MSG_MOUSEMOVE == WM_MOUSEMOVE &&
+									   INPUT_MSG_LBUTTONDOWN == WM_LBUTTONDOWN && INPUT_MSG_LBUTTONUP == WM_LBUTTONUP &&
+									   INPUT_MSG_RBUTTONDOWN == WM_RBUTTONDOWN && INPUT_MSG_RBUTTONUP == WM_RBUTTONUP &&
+									   INPUT_MSG_MBUTTONDOWN == WM_MBUTTONDOWN && INPUT_MSG_MBUTTONUP == WM_MBUTTONUP &&
+									   INPUT_MSG_MOUSEWHEEL == WM_MOUSEWHEEL &&
+									   INPUT_MSG_XBUTTONDOWN == WM_XBUTTONDOWN && INPUT_MSG_XBUTTONUP == WM_XBUTTONUP &&
+									   INPUT_XBUTTON1 == XBUTTON1 && INPUT_XBUTTON2 == XBUTTON2 &&
+									   INPUT_FLAG_INJECTED == LLMHF_INJECTED &&
+									   INPUT_FLAG_LOWER_IL_INJECTED == LLMHF_LOWER_IL_INJECTED)
+										  ? 1
+										  : -1];
+
+// Low-level hooks are called on the thread that installed them, which is
+// also the only thread that sets g_manager, so it is read without a barrier
 static MouseHookManager *g_manager = NULL;
 
 // Low-level mouse hook callback
 static LRESULT CALLBACK LowLevelMouseProc(int nCode, WPARAM wParam, LPARAM lParam)
 {
-	// Read g_manager atomically to avoid race condition
-	MouseHookManager *manager = (MouseHookManager *)InterlockedExchangePointer((PVOID *)&g_manager, g_manager);
+	MouseHookManager *manager = g_manager;
 
-	if (nCode == HC_ACTION && manager && manager->callback)
+	if (nCode == HC_ACTION && manager)
 	{
+		PMSLLHOOKSTRUCT pdata = (PMSLLHOOKSTRUCT)lParam;
+
 		if (wParam != WM_MOUSEMOVE)
-		{
-			PMSLLHOOKSTRUCT pdata = (PMSLLHOOKSTRUCT)lParam;
-			MouseButton button = mouse_hook_get_button(wParam, pdata);
-
-			if (button >= 0)
-			{
-				MouseEvent event;
-				event.button = button;
-				event.timestamp = GetTickCount64();
-				event.data = 0;
-
-				// For wheel events, store delta in data field
-				if (wParam == WM_MOUSEWHEEL)
-				{
-					event.data = (int32_t)GET_WHEEL_DELTA_WPARAM(pdata->mouseData);
-				}
-
-				event.is_down = mouse_hook_is_button_down(wParam);
-				event.x = pdata->pt.x;
-				event.y = pdata->pt.y;
-				event.is_injected = (pdata->flags & LLMHF_INJECTED) || (pdata->flags & LLMHF_LOWER_IL_INJECTED);
-
-				LRESULT result = g_manager->callback(&event, g_manager->user_data);
-				if (result != 0)
-					return result;
-			}
-		}
+			manager->entry_ticks = mf_ticks();
+
+		RawMouseRecord raw;
+		raw.message = (uint32_t)wParam;
+		raw.mouse_data = pdata->mouseData;
+		raw.flags = pdata->flags;
+		raw.x = pdata->pt.x;
+		raw.y = pdata->pt.y;
+
+		if (input_dispatch(&manager->dispatcher, &raw))
+			return 1;
 	}
-	return CallNextHookEx(g_manager ? g_manager->hook : NULL, nCode, wParam, lParam);
+	return CallNextHookEx(manager ? manager->hook : NULL, nCode, wParam, lParam);
 }
 
 // Initialize mouse hook manager
-bool mouse_hook_init(MouseHookManager *manager, MouseHookCallback callback, void *user_data)
+bool mouse_hook_init(MouseHookManager *manager, InputEventHandler callback, void *user_data)
 {
 	if (!manager || !callback)
 		return false;
 
 	manager->hook = NULL;
-	manager->callback = callback;
-	manager->user_data = user_data;
+	input_dispatcher_init(&manager->dispatcher, callback, user_data);
 	manager->installed = false;
 	g_manager = manager;
 
 	return true;
 }
 
+// Set the pointer move callback
+void mouse_hook_set_move_callback(MouseHookManager *manager, InputMoveHandler move_callback)
+{
+	if (!manager)
+		return;
+
+	manager->dispatcher.on_move = move_callback;
+}
+
 // Install mouse hook
 bool mouse_hook_install(MouseHookManager *manager)
 {
@@ -87,28 +95,4 @@ void mouse_hook_uninstall(MouseHookManager *manager)
 
 	manager->installed = false;
 	g_manager = NULL;
-}
-
-// Get button from WPARAM and MSLLHOOKSTRUCT
-MouseButton mouse_hook_get_button(WPARAM wParam, PMSLLHOOKSTRUCT pdata)
-{
-	if (wParam == WM_LBUTTONDOWN || wParam == WM_LBUTTONUP)
-		return MOUSE_BUTTON_LEFT;
-	if (wParam == WM_RBUTTONDOWN || wParam == WM_RBUTTONUP)
-		return MOUSE_BUTTON_RIGHT;
-	if (wParam == WM_MBUTTONDOWN || wParam == WM_MBUTTONUP)
-		return MOUSE_BUTTON_MIDDLE;
-	if (wParam == WM_XBUTTONDOWN || wParam == WM_XBUTTONUP)
-		return HIWORD(pdata->mouseData) == XBUTTON1 ? MOUSE_BUTTON_X1 : MOUSE_BUTTON_X2;
-	if (wParam == WM_MOUSEWHEEL)
-		return MOUSE_BUTTON_WHEEL;
-
-	return MOUSE_BUTTON_UNKNOWN;
-}
-
-// Check if button is pressed
-bool mouse_hook_is_button_down(WPARAM wParam)
-{
-	return (wParam == WM_LBUTTONDOWN || wParam == WM_RBUTTONDOWN ||
-			wParam == WM_MBUTTONDOWN || wParam == WM_XBUTTONDOWN);
 }
\ No newline at end of file
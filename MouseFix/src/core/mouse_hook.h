@@ -3,55 +3,30 @@
 #include <windows.h>
 #include <stdbool.h>
 #include <stdint.h>
-
-// Mouse button types
-typedef enum
-{
-	MOUSE_BUTTON_UNKNOWN = -1,
-	MOUSE_BUTTON_LEFT,
-	MOUSE_BUTTON_RIGHT,
-	MOUSE_BUTTON_MIDDLE,
-	MOUSE_BUTTON_X1,
-	MOUSE_BUTTON_X2,
-	MOUSE_BUTTON_WHEEL,
-	MOUSE_BUTTON_COUNT
-} MouseButton;
-
-// Mouse event structure
-typedef struct
-{
-	MouseButton button;
-	uint64_t timestamp;
-	bool is_down;
-	long x;
-	long y;
-	bool is_injected;
-	int32_t data;
-} MouseEvent;
-
-// Mouse hook callback function type
-typedef LRESULT(CALLBACK *MouseHookCallback)(const MouseEvent *event, void *user_data);
+#include "mouse_event.h"
+#include "input_decode.h"
+#include "platform.h"
 
 // Mouse hook manager
+//
+// The hook only copies MSLLHOOKSTRUCT into a RawMouseRecord; decoding and
+// dispatch live in the portable input_decode.c.
 typedef struct
 {
 	HHOOK hook;
-	MouseHookCallback callback;
-	void *user_data;
+	InputDispatcher dispatcher;
 	bool installed;
+	uint64_t entry_ticks; // mf_ticks() at hook entry, for latency accounting in the callback
 } MouseHookManager;
 
-// Initialize mouse hook manager
-bool mouse_hook_init(MouseHookManager *manager, MouseHookCallback callback, void *user_data);
+// Initialize mouse hook manager; callback returns true to block the event
+bool mouse_hook_init(MouseHookManager *manager, InputEventHandler callback, void *user_data);
+
+// Set the pointer move callback (NULL to ignore moves)
+void mouse_hook_set_move_callback(MouseHookManager *manager, InputMoveHandler move_callback);
 
 // Install mouse hook
 bool mouse_hook_install(MouseHookManager *manager);
 
 // Uninstall mouse hook
-void mouse_hook_uninstall(MouseHookManager *manager);
-
-// Get button from WPARAM and MSLLHOOKSTRUCT
-MouseButton mouse_hook_get_button(WPARAM wParam, PMSLLHOOKSTRUCT pdata);
-
-// Check if button is pressed
-bool mouse_hook_is_button_down(WPARAM wParam);
\ No newline at end of file
+void mouse_hook_uninstall(MouseHookManager *manager);
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include "output_sink.h"
+#include <string.h>
+#include "platform.h"
+
+void output_batch_init(OutputBatch *batch, OutputSink sink)
+{
+    if (!batch)
+        return;
+
+    memset(batch, 0, sizeof(OutputBatch));
+    batch->sink = sink;
+}
+
+void output_batch_push(OutputBatch *batch, const PackedEvent *event)
+{
+    if (batch->count == OUTPUT_BATCH_CAPACITY)
+        output_batch_flush(batch);
+    batch->events[batch->count++] = *event;
+}
+
+void output_batch_push_releases(OutputBatch *batch, uint32_t mask, uint64_t timestamp)
+{
+    for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
+    {
+        if (!(mask & (1u << i)))
+            continue;
+
+        MouseEvent up = {(MouseButton)i, timestamp, false, 0, 0, true, 0};
+        PackedEvent packed = mouse_event_pack(&up);
+        output_batch_push(batch, &packed);
+    }
+}
+
+bool output_batch_flush(OutputBatch *batch)
+{
+    if (!batch || batch->count == 0)
+        return true;
+
+    bool ok = !batch->sink.flush || batch->sink.flush(batch->events, batch->count, batch->sink.user_data);
+    batch->flushes++;
+    batch->events_out += batch->count;
+    if (!ok)
+        batch->failed += batch->count;
+    batch->count = 0;
+    return ok;
+}
+
+static bool memory_flush(const PackedEvent *events, size_t count, void *user_data)
+{
+    OutputMemorySink *memory = (OutputMemorySink *)user_data;
+    size_t room = memory->capacity - memory->count;
+    size_t kept = count < room ? count : room;
+
+    memcpy(memory->events + memory->count, events, kept * sizeof(PackedEvent));
+    memory->count += kept;
+    memory->dropped += count - kept;
+    memory->flushes++;
+    return kept == count;
+}
+
+OutputSink output_memory_sink(OutputMemorySink *memory, PackedEvent *events, size_t capacity)
+{
+    memset(memory, 0, sizeof(OutputMemorySink));
+    memory->events = events;
+    memory->capacity = capacity;
+
+    OutputSink sink = {memory_flush, memory};
+    return sink;
+}
+
+#ifdef _WIN32
+
+static bool sendinput_flush(const PackedEvent *events, size_t count, void *user_data)
+{
+    (void)user_data;
+    INPUT inputs[OUTPUT_BATCH_CAPACITY];
+    UINT used = 0;
+
+    for (size_t i = 0; i < count && used < OUTPUT_BATCH_CAPACITY; i++)
+    {
+        bool down = packed_event_is_down(&events[i]);
+        INPUT *input = &inputs[used];
+        memset(input, 0, sizeof(INPUT));
+        input->type = INPUT_MOUSE;
+
+        switch (packed_event_button(&events[i]))
+        {
+        case MOUSE_BUTTON_LEFT:
+            input->mi.dwFlags = down ? MOUSEEVENTF_LEFTDOWN : MOUSEEVENTF_LEFTUP;
+            break;
+        case MOUSE_BUTTON_RIGHT:
+            input->mi.dwFlags = down ? MOUSEEVENTF_RIGHTDOWN : MOUSEEVENTF_RIGHTUP;
+            break;
+        case MOUSE_BUTTON_MIDDLE:
+            input->mi.dwFlags = down ? MOUSEEVENTF_MIDDLEDOWN : MOUSEEVENTF_MIDDLEUP;
+            break;
+        case MOUSE_BUTTON_X1:
+            input->mi.dwFlags = down ? MOUSEEVENTF_XDOWN : MOUSEEVENTF_XUP;
+            input->mi.mouseData = XBUTTON1;
+            break;
+        case MOUSE_BUTTON_X2:
+            input->mi.dwFlags = down ? MOUSEEVENTF_XDOWN : MOUSEEVENTF_XUP;
+            input->mi.mouseData = XBUTTON2;
+            break;
+        default:
+            continue;
+        }
+        used++;
+    }
+
+    return used == 0 || SendInput(used, inputs, sizeof(INPUT)) == used;
+}
+
+OutputSink output_sendinput_sink(void)
+{
+    OutputSink sink = {sendinput_flush, NULL};
+    return sink;
+}
+
+#endif
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mouse_event.h"
+
+/*
+ * Batched output for events the engine synthesizes (Smart Drag's deferred
+ * releases) or a driver forwards.
+ *
+ * Events are queued as PackedEvents in a fixed OutputBatch and handed to
+ * its sink in one call per output_batch_flush, which the driver makes once
+ * per tick: a tick that releases three buttons costs one SendInput or one
+ * write, not three. A full batch flushes on its own before taking more.
+ *
+ * Sinks are a callback and its user_data. This file has an in-memory sink
+ * for tests and benchmarks and, on Windows, SendInput; the evdev sink
+ * (src/linux) writes uinput-style frames to an fd, and the trace sink
+ * (src/trace) records them to a trace file. A batch and its sink belong to
+ * one thread.
+ */
+
+#define OUTPUT_BATCH_CAPACITY 32
+
+/* Takes count > 0 events in order; false if they did not all go out */
+typedef bool (*OutputSinkFlush)(const PackedEvent *events, size_t count, void *user_data);
+
+typedef struct
+{
+    OutputSinkFlush flush;
+    void *user_data;
+} OutputSink;
+
+typedef struct
+{
+    PackedEvent events[OUTPUT_BATCH_CAPACITY];
+    size_t count;
+    OutputSink sink;
+
+    uint64_t flushes; /* sink calls */
+    uint64_t events_out;
+    uint64_t failed;  /* events in sink calls that returned false */
+} OutputBatch;
+
+/* A sink with no flush just counts and discards */
+void output_batch_init(OutputBatch *batch, OutputSink sink);
+void output_batch_push(OutputBatch *batch, const PackedEvent *event);
+
+/* Queues an injected button-up at timestamp for every button in mask */
+void output_batch_push_releases(OutputBatch *batch, uint32_t mask, uint64_t timestamp);
+
+/* Hands what is queued to the sink; true when empty or the sink took it all */
+bool output_batch_flush(OutputBatch *batch);
+
+/* Keeps up to capacity events and counts the rest as dropped */
+typedef struct
+{
+    PackedEvent *events;
+    size_t capacity;
+    size_t count;
+    uint64_t flushes;
+    uint64_t dropped;
+} OutputMemorySink;
+
+OutputSink output_memory_sink(OutputMemorySink *memory, PackedEvent *events, size_t capacity);
+
+#ifdef _WIN32
+/* The whole batch in one SendInput call */
+OutputSink output_sendinput_sink(void);
+#endif
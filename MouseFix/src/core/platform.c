@@ -0,0 +1,92 @@
+#include "platform.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+uint64_t mf_clock_now_us(void)
+{
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    if (freq.QuadPart == 0 && !QueryPerformanceFrequency(&freq))
+        return GetTickCount64() * 1000;
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+
+    /* Split to keep counter * 1000000 from overflowing on long uptimes */
+    uint64_t seconds = (uint64_t)(now.QuadPart / freq.QuadPart);
+    uint64_t remainder = (uint64_t)(now.QuadPart % freq.QuadPart);
+    return seconds * 1000000 + remainder * 1000000 / (uint64_t)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+#endif
+}
+
+uint64_t mf_ticks_per_second(void)
+{
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    if (freq.QuadPart == 0)
+        QueryPerformanceFrequency(&freq);
+    return (uint64_t)freq.QuadPart;
+#else
+    return 1000000000ull;
+#endif
+}
+
+int mf_cpu_count(void)
+{
+#ifdef _WIN32
+    DWORD count = GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+    return count > 0 ? (int)count : 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif
+}
+
+#ifdef _WIN32
+static DWORD WINAPI thread_trampoline(LPVOID param)
+{
+    MfThread *thread = (MfThread *)param;
+    thread->func(thread->arg);
+    return 0;
+}
+#else
+static void *thread_trampoline(void *param)
+{
+    MfThread *thread = (MfThread *)param;
+    thread->func(thread->arg);
+    return NULL;
+}
+#endif
+
+bool mf_thread_start(MfThread *thread, MfThreadFunc func, void *arg)
+{
+    if (!thread || !func)
+        return false;
+
+    thread->func = func;
+    thread->arg = arg;
+#ifdef _WIN32
+    thread->handle = CreateThread(NULL, 0, thread_trampoline, thread, 0, NULL);
+    return thread->handle != NULL;
+#else
+    return pthread_create(&thread->handle, NULL, thread_trampoline, thread) == 0;
+#endif
+}
+
+void mf_thread_join(MfThread *thread)
+{
+    if (!thread)
+        return;
+#ifdef _WIN32
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+#else
+    pthread_join(thread->handle, NULL);
+#endif
+}
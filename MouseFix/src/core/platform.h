@@ -0,0 +1,248 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Thin platform layer for the portable core (debouncer and friends).
+ *
+ * Only the handful of primitives the engine needs live here: a cache line
+ * alignment macro, a plain point type, a mutual exclusion lock, a few
+ * atomics, threads and a monotonic microsecond clock. The Windows host
+ * still talks to Win32 directly; everything under src/core that is not
+ * mouse_hook.c must build against this header alone.
+ */
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#endif
+
+/* Alignment for cache line sized structures */
+#if defined(_MSC_VER)
+#define MF_ALIGN(n) __declspec(align(n))
+#else
+#define MF_ALIGN(n) __attribute__((aligned(n)))
+#endif
+
+#define MF_CACHE_LINE 64
+
+/* Inlining hint for hot-path helpers shared by several entry points */
+#if defined(_MSC_VER)
+#define MF_FORCE_INLINE __forceinline
+#else
+#define MF_FORCE_INLINE inline __attribute__((always_inline))
+#endif
+
+/* Screen point, layout compatible with Win32 POINT */
+typedef struct
+{
+    long x;
+    long y;
+} MfPoint;
+
+/* Mutual exclusion lock */
+#ifdef _WIN32
+typedef CRITICAL_SECTION MfLock;
+#else
+typedef pthread_mutex_t MfLock;
+#endif
+
+static inline void mf_lock_init(MfLock *lock)
+{
+#ifdef _WIN32
+    InitializeCriticalSection(lock);
+#else
+    pthread_mutex_init(lock, NULL);
+#endif
+}
+
+static inline void mf_lock_destroy(MfLock *lock)
+{
+#ifdef _WIN32
+    DeleteCriticalSection(lock);
+#else
+    pthread_mutex_destroy(lock);
+#endif
+}
+
+static inline void mf_lock_enter(MfLock *lock)
+{
+#ifdef _WIN32
+    EnterCriticalSection(lock);
+#else
+    pthread_mutex_lock(lock);
+#endif
+}
+
+static inline void mf_lock_leave(MfLock *lock)
+{
+#ifdef _WIN32
+    LeaveCriticalSection(lock);
+#else
+    pthread_mutex_unlock(lock);
+#endif
+}
+
+/*
+ * Atomics. Loads have acquire and stores release semantics; exchange,
+ * compare-exchange and fetch-add are full barriers. On MSVC this relies on
+ * /volatile:ms for aligned 32/64-bit accesses, which holds for the x86 and
+ * x64 targets in MouseFix.vcxproj (64-bit values on x86 go through
+ * Interlocked* to stay untorn).
+ */
+typedef volatile uint32_t MfAtomic32;
+typedef volatile uint64_t MfAtomic64;
+
+static inline uint32_t mf_atomic_load32(const MfAtomic32 *p)
+{
+#ifdef _MSC_VER
+    return *p;
+#else
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static inline void mf_atomic_store32(MfAtomic32 *p, uint32_t value)
+{
+#ifdef _MSC_VER
+    *p = value;
+#else
+    __atomic_store_n(p, value, __ATOMIC_RELEASE);
+#endif
+}
+
+static inline uint32_t mf_atomic_exchange32(MfAtomic32 *p, uint32_t value)
+{
+#ifdef _MSC_VER
+    return (uint32_t)InterlockedExchange((volatile LONG *)p, (LONG)value);
+#else
+    return __atomic_exchange_n(p, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline uint32_t mf_atomic_fetch_add32(MfAtomic32 *p, uint32_t value)
+{
+#ifdef _MSC_VER
+    return (uint32_t)InterlockedExchangeAdd((volatile LONG *)p, (LONG)value);
+#else
+    return __atomic_fetch_add(p, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/* Returns true and stores desired if *p == expected */
+static inline bool mf_atomic_cas32(MfAtomic32 *p, uint32_t expected, uint32_t desired)
+{
+#ifdef _MSC_VER
+    return (uint32_t)InterlockedCompareExchange((volatile LONG *)p, (LONG)desired, (LONG)expected) == expected;
+#else
+    return __atomic_compare_exchange_n(p, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline uint64_t mf_atomic_load64(const MfAtomic64 *p)
+{
+#if defined(_MSC_VER) && defined(_M_IX86)
+    return (uint64_t)InterlockedCompareExchange64((volatile LONG64 *)p, 0, 0);
+#elif defined(_MSC_VER)
+    return *p;
+#else
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static inline void mf_atomic_store64(MfAtomic64 *p, uint64_t value)
+{
+#if defined(_MSC_VER) && defined(_M_IX86)
+    InterlockedExchange64((volatile LONG64 *)p, (LONG64)value);
+#elif defined(_MSC_VER)
+    *p = value;
+#else
+    __atomic_store_n(p, value, __ATOMIC_RELEASE);
+#endif
+}
+
+static inline uint64_t mf_atomic_exchange64(MfAtomic64 *p, uint64_t value)
+{
+#ifdef _MSC_VER
+    return (uint64_t)InterlockedExchange64((volatile LONG64 *)p, (LONG64)value);
+#else
+    return __atomic_exchange_n(p, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline uint64_t mf_atomic_fetch_add64(MfAtomic64 *p, uint64_t value)
+{
+#ifdef _MSC_VER
+    return (uint64_t)InterlockedExchangeAdd64((volatile LONG64 *)p, (LONG64)value);
+#else
+    return __atomic_fetch_add(p, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/* Returns true and stores desired if *p == expected */
+static inline bool mf_atomic_cas64(MfAtomic64 *p, uint64_t expected, uint64_t desired)
+{
+#ifdef _MSC_VER
+    return (uint64_t)InterlockedCompareExchange64((volatile LONG64 *)p, (LONG64)desired, (LONG64)expected) == expected;
+#else
+    return __atomic_compare_exchange_n(p, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/* Threads */
+typedef void (*MfThreadFunc)(void *arg);
+
+typedef struct
+{
+#ifdef _WIN32
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+    MfThreadFunc func;
+    void *arg;
+} MfThread;
+
+/* The MfThread must stay alive until mf_thread_join returns */
+bool mf_thread_start(MfThread *thread, MfThreadFunc func, void *arg);
+void mf_thread_join(MfThread *thread);
+
+/* Number of logical processors available to the process, at least 1 */
+int mf_cpu_count(void);
+
+/* Give up the rest of the time slice */
+static inline void mf_thread_yield(void)
+{
+#ifdef _WIN32
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+/* Monotonic clock in microseconds (QPC on Windows, CLOCK_MONOTONIC elsewhere) */
+uint64_t mf_clock_now_us(void);
+
+/*
+ * Raw tick counter for timing short intervals: the QPC counter on Windows,
+ * CLOCK_MONOTONIC nanoseconds elsewhere. Cheaper than mf_clock_now_us
+ * because nothing is converted; divide by mf_ticks_per_second when reading.
+ */
+static inline uint64_t mf_ticks(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return (uint64_t)now.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+uint64_t mf_ticks_per_second(void);
@@ -0,0 +1,194 @@
+#include "release_scheduler.h"
+#include "time_manager.h"
+#include <string.h>
+
+#ifdef _WIN32
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#else
+#include <time.h>
+#endif
+
+/* Run the release check for an expired deadline and account its lateness */
+static void fire_due(ReleaseScheduler *scheduler, uint64_t deadline, uint64_t now)
+{
+    uint32_t released = debounce_check_deferred_releases(scheduler->debounce, &scheduler->output);
+    if (!released)
+        return;
+    output_batch_flush(&scheduler->output);
+
+    uint32_t count = 0;
+    for (uint32_t mask = released; mask; mask &= mask - 1)
+        count++;
+
+    uint64_t lateness = now - deadline;
+    mf_atomic_store32(&scheduler->releases, mf_atomic_load32(&scheduler->releases) + count);
+    mf_atomic_store64(&scheduler->lateness_total_us, mf_atomic_load64(&scheduler->lateness_total_us) + lateness * count);
+    if (lateness > mf_atomic_load64(&scheduler->lateness_max_us))
+        mf_atomic_store64(&scheduler->lateness_max_us, lateness);
+}
+
+static void count_wakeup(ReleaseScheduler *scheduler)
+{
+    mf_atomic_store32(&scheduler->wakeups, mf_atomic_load32(&scheduler->wakeups) + 1);
+}
+
+#ifdef _WIN32
+
+static void scheduler_thread(void *arg)
+{
+    ReleaseScheduler *scheduler = (ReleaseScheduler *)arg;
+    HANDLE handles[2] = {scheduler->wake_event, scheduler->timer};
+
+    while (!mf_atomic_load32(&scheduler->stop))
+    {
+        uint64_t deadline;
+        if (debounce_get_next_deadline(scheduler->debounce, &deadline))
+        {
+            uint64_t now = time_manager_now_us();
+            if (deadline <= now)
+            {
+                fire_due(scheduler, deadline, now);
+                continue;
+            }
+
+            /* Relative due time in 100ns units */
+            LARGE_INTEGER due;
+            due.QuadPart = -(LONGLONG)((deadline - now) * 10);
+            SetWaitableTimer(scheduler->timer, &due, 0, NULL, NULL, FALSE);
+        }
+        else
+        {
+            CancelWaitableTimer(scheduler->timer);
+        }
+
+        WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+        count_wakeup(scheduler);
+    }
+}
+
+#else
+
+static void scheduler_thread(void *arg)
+{
+    ReleaseScheduler *scheduler = (ReleaseScheduler *)arg;
+
+    pthread_mutex_lock(&scheduler->mutex);
+    while (!mf_atomic_load32(&scheduler->stop))
+    {
+        uint64_t deadline;
+        bool armed = debounce_get_next_deadline(scheduler->debounce, &deadline);
+        uint64_t now = time_manager_now_us();
+
+        if (armed && deadline <= now)
+        {
+            pthread_mutex_unlock(&scheduler->mutex);
+            fire_due(scheduler, deadline, now);
+            pthread_mutex_lock(&scheduler->mutex);
+            continue;
+        }
+
+        if (!scheduler->signaled)
+        {
+            if (armed)
+            {
+                /* time_manager_now_us is CLOCK_MONOTONIC, the clock the condition waits on */
+                struct timespec due;
+                due.tv_sec = (time_t)(deadline / 1000000);
+                due.tv_nsec = (long)(deadline % 1000000) * 1000;
+                pthread_cond_timedwait(&scheduler->cond, &scheduler->mutex, &due);
+            }
+            else
+            {
+                pthread_cond_wait(&scheduler->cond, &scheduler->mutex);
+            }
+            count_wakeup(scheduler);
+        }
+        scheduler->signaled = false;
+    }
+    pthread_mutex_unlock(&scheduler->mutex);
+}
+
+#endif
+
+bool release_scheduler_start(ReleaseScheduler *scheduler, DebounceManager *debounce, OutputSink sink)
+{
+    if (!scheduler || !debounce)
+        return false;
+
+    memset(scheduler, 0, sizeof(ReleaseScheduler));
+    scheduler->debounce = debounce;
+    output_batch_init(&scheduler->output, sink);
+
+#ifdef _WIN32
+    scheduler->timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (!scheduler->timer)
+        scheduler->timer = CreateWaitableTimerW(NULL, FALSE, NULL);
+    scheduler->wake_event = CreateEventW(NULL, FALSE, FALSE, NULL);
+    if (!scheduler->timer || !scheduler->wake_event)
+    {
+        if (scheduler->timer)
+            CloseHandle(scheduler->timer);
+        if (scheduler->wake_event)
+            CloseHandle(scheduler->wake_event);
+        return false;
+    }
+#else
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&scheduler->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&scheduler->mutex, NULL);
+#endif
+
+    if (!mf_thread_start(&scheduler->thread, scheduler_thread, scheduler))
+    {
+#ifdef _WIN32
+        CloseHandle(scheduler->timer);
+        CloseHandle(scheduler->wake_event);
+#else
+        pthread_cond_destroy(&scheduler->cond);
+        pthread_mutex_destroy(&scheduler->mutex);
+#endif
+        return false;
+    }
+
+    scheduler->running = true;
+    return true;
+}
+
+void release_scheduler_notify(ReleaseScheduler *scheduler)
+{
+    if (!scheduler || !scheduler->running)
+        return;
+
+#ifdef _WIN32
+    SetEvent(scheduler->wake_event);
+#else
+    pthread_mutex_lock(&scheduler->mutex);
+    scheduler->signaled = true;
+    pthread_cond_signal(&scheduler->cond);
+    pthread_mutex_unlock(&scheduler->mutex);
+#endif
+}
+
+void release_scheduler_stop(ReleaseScheduler *scheduler)
+{
+    if (!scheduler || !scheduler->running)
+        return;
+
+    mf_atomic_store32(&scheduler->stop, 1);
+    release_scheduler_notify(scheduler);
+    mf_thread_join(&scheduler->thread);
+    scheduler->running = false;
+
+#ifdef _WIN32
+    CloseHandle(scheduler->timer);
+    CloseHandle(scheduler->wake_event);
+#else
+    pthread_cond_destroy(&scheduler->cond);
+    pthread_mutex_destroy(&scheduler->mutex);
+#endif
+}
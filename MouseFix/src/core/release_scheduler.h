@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "platform.h"
+#include "debouncer.h"
+#include "output_sink.h"
+
+/*
+ * Deadline-driven driver for Smart Drag deferred releases.
+ *
+ * A background thread sleeps until the earliest deadline reported by
+ * debounce_get_next_deadline and runs debounce_check_deferred_releases when
+ * it expires. The releases due at one wakeup reach the sink as one batch,
+ * so one SendInput call on Windows. With nothing pending it sleeps
+ * indefinitely, so an idle process takes no timer wakeups. The hook path
+ * calls release_scheduler_notify after an event that may have started a
+ * confirm window so the thread can re-arm for the new deadline.
+ *
+ * Windows uses a high-resolution waitable timer where available (falling
+ * back to a standard one), other platforms a condition variable on
+ * CLOCK_MONOTONIC.
+ */
+
+typedef struct
+{
+    DebounceManager *debounce;
+    OutputBatch output; /* scheduler thread only */
+    MfThread thread;
+    MfAtomic32 stop;
+    bool running;
+
+#ifdef _WIN32
+    HANDLE timer;
+    HANDLE wake_event;
+#else
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool signaled;
+#endif
+
+    /* Statistics, written by the scheduler thread only */
+    MfAtomic32 wakeups;
+    MfAtomic32 releases;
+    MfAtomic64 lateness_total_us;
+    MfAtomic64 lateness_max_us;
+} ReleaseScheduler;
+
+bool release_scheduler_start(ReleaseScheduler *scheduler, DebounceManager *debounce, OutputSink sink);
+void release_scheduler_stop(ReleaseScheduler *scheduler);
+void release_scheduler_notify(ReleaseScheduler *scheduler);
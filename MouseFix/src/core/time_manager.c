@@ -1,5 +1,9 @@
 #include "time_manager.h"
-#include <windows.h>
+#include "platform.h"
+
+#ifndef _WIN32
+#include <time.h>
+#endif
 
 // Initialize time manager
 bool time_manager_init(TimeManager *manager)
@@ -11,36 +15,62 @@ bool time_manager_init(TimeManager *manager)
 	return true;
 }
 
-// Get current time
+// Current monotonic time in microseconds
+uint64_t time_manager_now_us(void)
+{
+	return mf_clock_now_us();
+}
+
+// Get current time in microseconds
 uint64_t time_manager_get_current_time(const TimeManager *manager)
 {
 	if (!manager || !manager->initialized)
 		return 0;
 
-	return GetTickCount64();
+	return time_manager_now_us();
 }
 
-// Convert milliseconds to time units
+// Convert milliseconds to time units (microseconds)
 uint64_t time_manager_ms_to_time(const TimeManager *manager, uint32_t ms)
 {
 	if (!manager || !manager->initialized)
 		return 0;
 
-	return (uint64_t)ms;
+	return (uint64_t)ms * 1000;
 }
 
 // Check if QPC is available
 bool time_manager_is_qpc_available(void)
 {
+#ifdef _WIN32
 	LARGE_INTEGER freq;
 	return QueryPerformanceFrequency(&freq) != 0;
+#else
+	return false;
+#endif
 }
 
-// Get time resolution in nanoseconds
+// Get resolution of time_manager_now_us in nanoseconds
+// This is the coarser of the underlying counter and the 1us timestamp unit.
 double time_manager_get_resolution_ns(const TimeManager *manager)
 {
 	if (!manager || !manager->initialized)
 		return 0.0;
 
-	return 15.6e6; // ~15.6ms for GetTickCount
-}
\ No newline at end of file
+	double native_ns;
+#ifdef _WIN32
+	LARGE_INTEGER freq;
+	if (QueryPerformanceFrequency(&freq) && freq.QuadPart > 0)
+		native_ns = 1e9 / (double)freq.QuadPart;
+	else
+		native_ns = 15.6e6; // GetTickCount64 fallback
+#else
+	struct timespec res;
+	if (clock_getres(CLOCK_MONOTONIC, &res) == 0)
+		native_ns = (double)res.tv_sec * 1e9 + (double)res.tv_nsec;
+	else
+		native_ns = 1.0;
+#endif
+
+	return native_ns > 1000.0 ? native_ns : 1000.0;
+}
@@ -4,6 +4,10 @@
 #include <stdint.h>
 
 // Time manager for high-precision timing
+//
+// All timestamps in MouseFix (hook events, debounce thresholds, Smart Drag
+// deadlines) are microseconds from the one monotonic clock returned by
+// time_manager_now_us.
 typedef struct
 {
 	bool initialized;
@@ -12,14 +16,17 @@ typedef struct
 // Initialize time manager
 bool time_manager_init(TimeManager *manager);
 
-// Get current time
+// Current monotonic time in microseconds
+uint64_t time_manager_now_us(void);
+
+// Get current time in microseconds
 uint64_t time_manager_get_current_time(const TimeManager *manager);
 
-// Convert milliseconds to time units
+// Convert milliseconds to time units (microseconds)
 uint64_t time_manager_ms_to_time(const TimeManager *manager, uint32_t ms);
 
 // Check if QPC is available
 bool time_manager_is_qpc_available(void);
 
-// Get time resolution in nanoseconds
-double time_manager_get_resolution_ns(const TimeManager *manager);
\ No newline at end of file
+// Get resolution of time_manager_now_us in nanoseconds
+double time_manager_get_resolution_ns(const TimeManager *manager);
@@ -0,0 +1,107 @@
+/* ppoll */
+#define _GNU_SOURCE
+#include "evdev_daemon.h"
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+bool evdev_daemon_init(EvdevDaemon *daemon, int in_fd, int out_fd, EvdevClock clock, bool replay)
+{
+    if (!daemon)
+        return false;
+
+    memset(daemon, 0, sizeof(EvdevDaemon));
+    evdev_stream_init(&daemon->stream, in_fd, out_fd, clock);
+    daemon->replay = replay;
+
+    daemon->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    return daemon->wake_fd >= 0;
+}
+
+void evdev_daemon_cleanup(EvdevDaemon *daemon)
+{
+    if (!daemon || daemon->wake_fd < 0)
+        return;
+
+    close(daemon->wake_fd);
+    daemon->wake_fd = -1;
+}
+
+bool evdev_daemon_use_monotonic(int fd)
+{
+    int clock = CLOCK_MONOTONIC;
+    return ioctl(fd, EVIOCSCLOCKID, &clock) == 0;
+}
+
+void evdev_daemon_stop(EvdevDaemon *daemon)
+{
+    uint64_t one = 1;
+    mf_atomic_store32(&daemon->stop, 1);
+    /* Only to wake ppoll; a full counter already does */
+    ssize_t ignored = write(daemon->wake_fd, &one, sizeof(one));
+    (void)ignored;
+}
+
+int evdev_daemon_run(EvdevDaemon *daemon)
+{
+    EvdevStream *stream = &daemon->stream;
+    struct pollfd fds[2];
+    fds[0].fd = stream->in_fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = daemon->wake_fd;
+    fds[1].events = POLLIN;
+
+    while (!mf_atomic_load32(&daemon->stop))
+    {
+        struct timespec timeout;
+        struct timespec *wait = NULL;
+        uint64_t deadline;
+        if (!daemon->replay && evdev_filter_deadline(&stream->filter, &deadline))
+        {
+            uint64_t now = time_manager_now_us();
+            uint64_t us = deadline > now ? deadline - now : 0;
+            timeout.tv_sec = (time_t)(us / 1000000u);
+            timeout.tv_nsec = (long)(us % 1000000u) * 1000;
+            wait = &timeout;
+        }
+
+        int ready = ppoll(fds, 2, wait, NULL);
+        daemon->wakeups++;
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+
+        if (fds[1].revents & POLLIN)
+        {
+            uint64_t count;
+            ssize_t ignored = read(daemon->wake_fd, &count, sizeof(count));
+            (void)ignored;
+        }
+
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR))
+        {
+            int status = evdev_stream_read(stream);
+            if (status < 0)
+                return -1;
+            if (status == 0)
+                break;
+        }
+
+        if (!daemon->replay && !evdev_stream_advance(stream, time_manager_now_us()))
+            return -1;
+        if (stream->output.count > 0 && !evdev_stream_flush(stream))
+            return -1;
+    }
+
+    /* End of input or stopped: nothing may stay held downstream */
+    if (!evdev_stream_advance(stream, UINT64_MAX) || !evdev_stream_flush(stream))
+        return -1;
+    return 0;
+}
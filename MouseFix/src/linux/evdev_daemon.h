@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "evdev_stream.h"
+
+/*
+ * Headless debounce loop over one evdev stream: reads struct input_event
+ * frames from in_fd (a device node, a recorded file or a pipe), runs them
+ * through an EvdevFilter and writes the filtered frames to out_fd. Several
+ * devices on one thread are evdev_loop.h's job.
+ *
+ * The loop sleeps in ppoll on the input and a wake eventfd. Live, the
+ * timeout is the next deferred release's deadline on time_manager_now_us,
+ * so frame times must be on that clock: CLOCK_MONOTONIC for a device node
+ * (see evdev_daemon_use_monotonic) or EVDEV_CLOCK_HOST for anything else.
+ * In replay mode deadlines only fire when later frames pass them, as in
+ * trace replay, which makes a recorded file filter the same on every run.
+ *
+ * Filtered frames are written once per wakeup. At end of input, and
+ * when stopped, every pending release is emitted at its deadline, so no
+ * button is left held.
+ */
+
+typedef struct
+{
+    EvdevStream stream;
+    int wake_fd;
+    bool replay;
+    MfAtomic32 stop;
+    uint64_t wakeups; /* returns from ppoll */
+} EvdevDaemon;
+
+/* Configure the engine afterwards on &daemon->stream.filter.pipeline.debounce; false if the wake eventfd fails */
+bool evdev_daemon_init(EvdevDaemon *daemon, int in_fd, int out_fd, EvdevClock clock, bool replay);
+void evdev_daemon_cleanup(EvdevDaemon *daemon);
+
+/* Asks a device node for CLOCK_MONOTONIC timestamps; false for files and pipes */
+bool evdev_daemon_use_monotonic(int fd);
+
+/* Until end of input or evdev_daemon_stop: 0 then, -1 with errno set on an I/O error */
+int evdev_daemon_run(EvdevDaemon *daemon);
+
+/* Any thread, or a signal handler */
+void evdev_daemon_stop(EvdevDaemon *daemon);
@@ -0,0 +1,237 @@
+#include "evdev_filter.h"
+#include <string.h>
+
+/* Older headers lack the hi-res wheel */
+#ifndef REL_WHEEL_HI_RES
+#define REL_WHEEL_HI_RES 0x0b
+#endif
+
+#define WHEEL_NOTCH 120
+
+void evdev_filter_init(EvdevFilter *filter)
+{
+    if (!filter)
+        return;
+
+    memset(filter, 0, sizeof(EvdevFilter));
+    mouse_pipeline_init(&filter->pipeline);
+    filter->key_codes[MOUSE_BUTTON_LEFT] = BTN_LEFT;
+    filter->key_codes[MOUSE_BUTTON_RIGHT] = BTN_RIGHT;
+    filter->key_codes[MOUSE_BUTTON_MIDDLE] = BTN_MIDDLE;
+    filter->key_codes[MOUSE_BUTTON_X1] = BTN_SIDE;
+    filter->key_codes[MOUSE_BUTTON_X2] = BTN_EXTRA;
+}
+
+MouseButton evdev_key_button(uint16_t code)
+{
+    switch (code)
+    {
+    case BTN_LEFT:
+        return MOUSE_BUTTON_LEFT;
+    case BTN_RIGHT:
+        return MOUSE_BUTTON_RIGHT;
+    case BTN_MIDDLE:
+        return MOUSE_BUTTON_MIDDLE;
+    case BTN_SIDE:
+    case BTN_BACK:
+        return MOUSE_BUTTON_X1;
+    case BTN_EXTRA:
+    case BTN_FORWARD:
+        return MOUSE_BUTTON_X2;
+    default:
+        return MOUSE_BUTTON_UNKNOWN;
+    }
+}
+
+static void emit(EvdevFilter *filter, EvdevOutput *output, const struct input_event *frame)
+{
+    if (output->count < output->capacity)
+    {
+        output->frames[output->count++] = *frame;
+        filter->stats.frames_out++;
+    }
+}
+
+static void emit_syn(EvdevFilter *filter, EvdevOutput *output, uint64_t at)
+{
+    struct input_event syn;
+    memset(&syn, 0, sizeof(syn));
+    evdev_frame_set_time(&syn, at);
+    syn.type = EV_SYN;
+    syn.code = SYN_REPORT;
+    emit(filter, output, &syn);
+}
+
+uint32_t evdev_filter_advance(EvdevFilter *filter, uint64_t now, EvdevOutput *output)
+{
+    uint32_t released = 0;
+    uint64_t deadline;
+
+    while (mouse_pipeline_deadline(&filter->pipeline, &deadline) && deadline <= now)
+    {
+        uint32_t mask = mouse_pipeline_advance(&filter->pipeline, deadline);
+        /* Nothing claimed means the deadline moved under us; the next call sees the new one */
+        if (mask == 0)
+            break;
+
+        for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
+        {
+            if (!(mask & (1u << i)))
+                continue;
+
+            struct input_event up;
+            memset(&up, 0, sizeof(up));
+            evdev_frame_set_time(&up, deadline);
+            up.type = EV_KEY;
+            up.code = filter->key_codes[i];
+            up.value = 0;
+            emit(filter, output, &up);
+            emit_syn(filter, output, deadline);
+            released++;
+        }
+    }
+
+    filter->stats.releases += released;
+    return released;
+}
+
+bool evdev_filter_deadline(EvdevFilter *filter, uint64_t *deadline)
+{
+    return mouse_pipeline_deadline(&filter->pipeline, deadline);
+}
+
+/* The frame's MouseEvent, if the engine cares about it */
+static bool frame_event(EvdevFilter *filter, const struct input_event *frame, uint64_t now, MouseEvent *event)
+{
+    memset(event, 0, sizeof(MouseEvent));
+    event->timestamp = now;
+    event->x = filter->x;
+    event->y = filter->y;
+
+    /* value 2 is autorepeat, which the engine never sees on Windows either */
+    if (frame->type == EV_KEY && frame->value != 2)
+    {
+        event->button = evdev_key_button(frame->code);
+        if (event->button == MOUSE_BUTTON_UNKNOWN)
+            return false;
+        filter->key_codes[event->button] = frame->code;
+        event->is_down = frame->value != 0;
+        return true;
+    }
+
+    if (frame->type == EV_REL && frame->code == REL_WHEEL && frame->value != 0)
+    {
+        event->button = MOUSE_BUTTON_WHEEL;
+        event->data = frame->value * WHEEL_NOTCH;
+        return true;
+    }
+    return false;
+}
+
+/* A scan code belongs to the first key after it, unless another scan code comes first */
+static bool scan_key_kept(const struct input_event *report, const bool *keep, size_t scan, size_t count)
+{
+    for (size_t i = scan + 1; i < count; i++)
+    {
+        if (report[i].type == EV_KEY)
+            return keep[i];
+        if (report[i].type == EV_MSC && report[i].code == MSC_SCAN)
+            break;
+    }
+    return true;
+}
+
+/* Filters the collected report and emits what is left of it, then syn if there is one */
+static void filter_report(EvdevFilter *filter, const struct input_event *syn, uint64_t now, EvdevOutput *output)
+{
+    struct input_event *report = filter->report;
+    size_t count = filter->report_count;
+    bool keep[EVDEV_REPORT_FRAMES];
+
+    /* Moves first: button events carry the position the report ends at */
+    bool moved = false;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (report[i].type != EV_REL || (report[i].code != REL_X && report[i].code != REL_Y))
+            continue;
+        if (report[i].code == REL_X)
+            filter->x += report[i].value;
+        else
+            filter->y += report[i].value;
+        moved = true;
+    }
+    if (moved)
+        mouse_pipeline_move(&filter->pipeline, filter->x, filter->y);
+
+    bool wheel_blocked = false;
+    for (size_t i = 0; i < count; i++)
+    {
+        keep[i] = true;
+
+        MouseEvent event;
+        if (!frame_event(filter, &report[i], now, &event))
+            continue;
+
+        filter->stats.events++;
+        if (mouse_pipeline_process(&filter->pipeline, &event))
+        {
+            keep[i] = false;
+            filter->stats.blocked++;
+            wheel_blocked |= event.button == MOUSE_BUTTON_WHEEL;
+        }
+    }
+
+    size_t meaningful = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        /* A blocked key takes its scan code along, a blocked notch its hi-res twin */
+        if (report[i].type == EV_MSC && report[i].code == MSC_SCAN && !scan_key_kept(report, keep, i, count))
+            keep[i] = false;
+        if (wheel_blocked && report[i].type == EV_REL && report[i].code == REL_WHEEL_HI_RES)
+            keep[i] = false;
+        meaningful += keep[i] && report[i].type != EV_MSC;
+    }
+    if (meaningful == 0)
+        return;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (keep[i])
+            emit(filter, output, &report[i]);
+    }
+    if (syn)
+        emit(filter, output, syn);
+}
+
+void evdev_filter_frame(EvdevFilter *filter, const struct input_event *frame, uint64_t now, EvdevOutput *output)
+{
+    filter->stats.frames_in++;
+    evdev_filter_advance(filter, now, output);
+
+    if (frame->type == EV_SYN && frame->code == SYN_DROPPED)
+    {
+        filter->resyncing = true;
+        filter->report_count = 0;
+        filter->stats.dropped++;
+        return;
+    }
+
+    if (frame->type == EV_SYN && frame->code == SYN_REPORT)
+    {
+        if (!filter->resyncing)
+            filter_report(filter, frame, now, output);
+        filter->resyncing = false;
+        filter->report_count = 0;
+        return;
+    }
+
+    if (filter->resyncing)
+        return;
+
+    if (filter->report_count == EVDEV_REPORT_FRAMES)
+    {
+        filter_report(filter, NULL, now, output);
+        filter->report_count = 0;
+    }
+    filter->report[filter->report_count++] = *frame;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <linux/input.h>
+#include "../core/filter_pipeline.h"
+
+/*
+ * The debounce engine over a Linux evdev stream.
+ *
+ * Frames (struct input_event) are collected into reports up to
+ * SYN_REPORT. Each report is then filtered as a unit: REL_X/REL_Y move
+ * the pointer the engine tracks for Smart Drag, button keys and REL_WHEEL
+ * notches become MouseEvents for the pipeline, and blocked frames are
+ * removed, along with the MSC_SCAN just before a blocked key and any
+ * REL_WHEEL_HI_RES in the same report as a blocked notch. Everything else (other keys, absolute axes, a hi-res
+ * wheel report without a notch) passes unchanged. A report left with
+ * nothing but EV_MSC and the SYN_REPORT is dropped whole.
+ *
+ *   BTN_LEFT, BTN_RIGHT, BTN_MIDDLE       Left, Right, Middle
+ *   BTN_SIDE or BTN_BACK                  4th (X1)
+ *   BTN_EXTRA or BTN_FORWARD              5th (X2)
+ *   REL_WHEEL                             Wheel, 120 per notch as on Windows
+ *
+ * Event times are the frames' own timestamps (EVDEV_CLOCK_FRAME) or the
+ * time the caller read them (EVDEV_CLOCK_HOST), in microseconds. The
+ * engine, its deadlines and the synthesized releases all use that clock.
+ * A deferred release comes out as its key-up frame and a SYN_REPORT,
+ * stamped with its deadline.
+ *
+ * SYN_DROPPED means the kernel lost frames: the partial report is thrown
+ * away and nothing is emitted until the next SYN_REPORT, as the evdev
+ * protocol asks of clients.
+ */
+
+#define EVDEV_REPORT_FRAMES 64 /* longer reports are filtered in pieces */
+/* Most frames one call to evdev_filter_frame can append: a report and a release per button */
+#define EVDEV_FRAME_OUTPUT_MAX (EVDEV_REPORT_FRAMES + 1 + 2 * MOUSE_BUTTON_COUNT)
+
+typedef enum
+{
+    EVDEV_CLOCK_FRAME = 0,
+    EVDEV_CLOCK_HOST
+} EvdevClock;
+
+/* Filtered frames waiting to be written; the caller empties it */
+typedef struct
+{
+    struct input_event *frames;
+    size_t count;
+    size_t capacity; /* at least EVDEV_FRAME_OUTPUT_MAX */
+} EvdevOutput;
+
+typedef struct
+{
+    uint64_t frames_in;
+    uint64_t frames_out;
+    uint64_t events;   /* MouseEvents run through the engine */
+    uint64_t blocked;
+    uint64_t releases; /* deferred releases synthesized */
+    uint64_t dropped;  /* reports lost to SYN_DROPPED */
+} EvdevFilterStats;
+
+typedef struct
+{
+    MousePipeline pipeline;
+    struct input_event report[EVDEV_REPORT_FRAMES];
+    size_t report_count;
+    bool resyncing; /* after SYN_DROPPED, until the next SYN_REPORT */
+    long x, y;      /* pointer position, summed from REL_X/REL_Y */
+    uint16_t key_codes[MOUSE_BUTTON_COUNT]; /* code each button last used, for its releases */
+    EvdevFilterStats stats;
+} EvdevFilter;
+
+/* Configure the engine afterwards through the debounce_* setters on &filter->pipeline.debounce */
+void evdev_filter_init(EvdevFilter *filter);
+
+/* Microseconds of a frame's timestamp */
+static inline uint64_t evdev_frame_time(const struct input_event *frame)
+{
+    return (uint64_t)frame->input_event_sec * 1000000u + (uint64_t)frame->input_event_usec;
+}
+
+static inline void evdev_frame_set_time(struct input_event *frame, uint64_t us)
+{
+    frame->input_event_sec = (time_t)(us / 1000000u);
+    frame->input_event_usec = (suseconds_t)(us % 1000000u);
+}
+
+/* Engine button for a key code, MOUSE_BUTTON_UNKNOWN for keys the engine leaves alone */
+MouseButton evdev_key_button(uint16_t code);
+
+/*
+ * One frame at now (the frame's time or the read time, per the caller's
+ * clock). Releases due by now are emitted first. Appends at most
+ * EVDEV_FRAME_OUTPUT_MAX frames to output.
+ */
+void evdev_filter_frame(EvdevFilter *filter, const struct input_event *frame, uint64_t now, EvdevOutput *output);
+
+/* Emits the deferred releases due by now, each at its deadline; returns how many */
+uint32_t evdev_filter_advance(EvdevFilter *filter, uint64_t now, EvdevOutput *output);
+
+/* Time of the next deferred release; false when none is pending */
+bool evdev_filter_deadline(EvdevFilter *filter, uint64_t *deadline);
@@ -0,0 +1,621 @@
+#include "evdev_loop.h"
+#include "rt_mode.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+/* epoll tags and io_uring user_data besides device ids */
+#define TAG_TIMER UINT32_MAX
+#define TAG_WAKE  (UINT32_MAX - 1)
+#define TAG_WRITE  (1ull << 32) /* with the device id: its output write */
+#define TAG_HANGUP (2ull << 32) /* with the device id: its hangup poll */
+#define TAG_SEEN   UINT64_MAX   /* nothing to do: a queued completion already handled, or a cancel */
+
+/* Room for a write, a read re-post and a cancel per device besides the timer and wake reads */
+#define URING_ENTRIES    256
+#define URING_CQ_ENTRIES 1024
+
+static bool watch(int epoll_fd, int fd, uint32_t tag)
+{
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u32 = tag;
+    return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+/* One 8-byte read of the timerfd or eventfd, re-posted after each completion */
+static bool post_counter_read(EvdevLoop *loop, int fd, uint64_t *target, uint32_t tag)
+{
+    struct io_uring_sqe *sqe = evdev_uring_sqe(&loop->uring);
+    if (!sqe)
+        return false;
+
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)target;
+    sqe->len = sizeof(*target);
+    sqe->user_data = tag;
+    return true;
+}
+
+static bool init_uring(EvdevLoop *loop)
+{
+    if (!evdev_uring_init(&loop->uring, URING_ENTRIES, URING_CQ_ENTRIES, EVDEV_URING_BUFFERS,
+                          EVDEV_READ_FRAMES * sizeof(struct input_event)))
+        return false;
+
+    loop->io = EVDEV_IO_URING;
+    loop->queue = malloc(URING_CQ_ENTRIES * sizeof(struct io_uring_cqe));
+    if (!loop->queue)
+        return false;
+    return post_counter_read(loop, loop->timer_fd, &loop->timer_expirations, TAG_TIMER) &&
+           post_counter_read(loop, loop->wake_fd, &loop->wake_count, TAG_WAKE);
+}
+
+bool evdev_loop_init(EvdevLoop *loop, EvdevIo io)
+{
+    if (!loop)
+        return false;
+
+    memset(loop, 0, sizeof(EvdevLoop));
+    loop->io = EVDEV_IO_EPOLL;
+    loop->epoll_fd = -1;
+    /* Blocking: io_uring hands O_NONBLOCK reads back as EAGAIN, and epoll only reads them when ready */
+    loop->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    loop->wake_fd = eventfd(0, EFD_CLOEXEC);
+    bool ok = loop->timer_fd >= 0 && loop->wake_fd >= 0;
+
+    if (ok && io != EVDEV_IO_EPOLL && !init_uring(loop))
+    {
+        int error = errno;
+        if (loop->io == EVDEV_IO_URING)
+        {
+            evdev_uring_cleanup(&loop->uring);
+            free(loop->queue);
+            loop->queue = NULL;
+            loop->io = EVDEV_IO_EPOLL;
+        }
+        ok = io == EVDEV_IO_AUTO;
+        errno = error;
+    }
+
+    if (ok && loop->io == EVDEV_IO_EPOLL)
+    {
+        loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        ok = loop->epoll_fd >= 0 && watch(loop->epoll_fd, loop->timer_fd, TAG_TIMER) &&
+             watch(loop->epoll_fd, loop->wake_fd, TAG_WAKE);
+    }
+
+    if (!ok)
+    {
+        int error = errno;
+        evdev_loop_cleanup(loop);
+        errno = error;
+    }
+    return ok;
+}
+
+void evdev_loop_cleanup(EvdevLoop *loop)
+{
+    if (!loop)
+        return;
+
+    /* The ring goes first: the kernel may still be reading into the devices' memory */
+    if (loop->io == EVDEV_IO_URING)
+    {
+        evdev_uring_cleanup(&loop->uring);
+        loop->io = EVDEV_IO_EPOLL;
+    }
+    free(loop->queue);
+    loop->queue = NULL;
+
+    for (int i = 0; i < loop->device_count; i++)
+    {
+        free(loop->devices[i]);
+        loop->devices[i] = NULL;
+    }
+    loop->device_count = 0;
+    loop->open_count = 0;
+
+    int *fds[] = {&loop->epoll_fd, &loop->timer_fd, &loop->wake_fd};
+    for (size_t i = 0; i < sizeof(fds) / sizeof(fds[0]); i++)
+    {
+        if (*fds[i] >= 0)
+            close(*fds[i]);
+        *fds[i] = -1;
+    }
+}
+
+int evdev_loop_add(EvdevLoop *loop, int in_fd, int out_fd, EvdevClock clock)
+{
+    if (!loop || loop->device_count == EVDEV_LOOP_MAX_DEVICES)
+        return -1;
+
+    /* Each one is ~45KB of engine and buffers, so they live on the heap */
+    EvdevLoopDevice *device = calloc(1, sizeof(EvdevLoopDevice));
+    if (!device)
+        return -1;
+
+    int id = loop->device_count;
+    evdev_stream_init(&device->stream, in_fd, out_fd, clock);
+    bool ok = loop->io == EVDEV_IO_URING
+                  ? evdev_uring_read_multishot(&loop->uring, in_fd, (uint64_t)id) &&
+                        evdev_uring_poll_hangup(&loop->uring, in_fd, TAG_HANGUP | (uint64_t)id)
+                  : watch(loop->epoll_fd, in_fd, (uint32_t)id);
+    if (!ok)
+    {
+        free(device);
+        return -1;
+    }
+
+    device->open = true;
+    loop->devices[id] = device;
+    loop->device_count++;
+    loop->open_count++;
+    return id;
+}
+
+EvdevFilter *evdev_loop_filter(EvdevLoop *loop, int device)
+{
+    if (!loop || device < 0 || device >= loop->device_count)
+        return NULL;
+    return &loop->devices[device]->stream.filter;
+}
+
+const EvdevStream *evdev_loop_stream(const EvdevLoop *loop, int device)
+{
+    if (!loop || device < 0 || device >= loop->device_count)
+        return NULL;
+    return &loop->devices[device]->stream;
+}
+
+void evdev_loop_prefault(EvdevLoop *loop)
+{
+    if (!loop)
+        return;
+
+    for (int i = 0; i < loop->device_count; i++)
+        rt_mode_prefault(loop->devices[i], sizeof(EvdevLoopDevice));
+    if (loop->io != EVDEV_IO_URING)
+        return;
+
+    rt_mode_prefault(loop->queue, URING_CQ_ENTRIES * sizeof(struct io_uring_cqe));
+    rt_mode_prefault(loop->uring.buffers, (size_t)loop->uring.buffer_count * loop->uring.buffer_size);
+}
+
+uint64_t evdev_loop_syscalls(const EvdevLoop *loop)
+{
+    uint64_t total = loop->stats.syscalls;
+    if (loop->io == EVDEV_IO_URING)
+        return total + loop->uring.enters;
+
+    for (int i = 0; i < loop->device_count; i++)
+        total += loop->devices[i]->stream.stats.reads + loop->devices[i]->stream.stats.writes;
+    return total;
+}
+
+const char *evdev_io_name(EvdevIo io)
+{
+    switch (io)
+    {
+    case EVDEV_IO_EPOLL:
+        return "epoll";
+    case EVDEV_IO_URING:
+        return "io_uring";
+    default:
+        return "auto";
+    }
+}
+
+void evdev_loop_stop(EvdevLoop *loop)
+{
+    uint64_t one = 1;
+    mf_atomic_store32(&loop->stop, 1);
+    /* Only to wake the loop; a full counter already does */
+    ssize_t ignored = write(loop->wake_fd, &one, sizeof(one));
+    (void)ignored;
+}
+
+/* io_uring output */
+
+static bool post_write(EvdevLoop *loop, int id)
+{
+    EvdevLoopDevice *device = loop->devices[id];
+    struct io_uring_sqe *sqe = evdev_uring_sqe(&loop->uring);
+    if (!sqe)
+        return false;
+
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = device->stream.out_fd;
+    sqe->off = (uint64_t)-1;
+    sqe->addr = (uint64_t)(uintptr_t)((uint8_t *)device->writing + device->written);
+    sqe->len = (uint32_t)(device->write_bytes - device->written);
+    sqe->user_data = TAG_WRITE | (uint64_t)id;
+    device->stream.stats.writes++;
+    loop->writes_posted++;
+    return true;
+}
+
+/* Moves the device's output into its write buffer and queues the write; one in flight at a time */
+static bool submit_write(EvdevLoop *loop, int id)
+{
+    EvdevLoopDevice *device = loop->devices[id];
+    EvdevOutput *output = &device->stream.output;
+
+    device->write_bytes = output->count * sizeof(struct input_event);
+    device->written = 0;
+    memcpy(device->writing, output->frames, device->write_bytes);
+    output->count = 0;
+    device->write_pending = true;
+    return post_write(loop, id);
+}
+
+static bool write_done(EvdevLoop *loop, int id, int32_t result)
+{
+    EvdevLoopDevice *device = loop->devices[id];
+    if (result <= 0)
+    {
+        errno = result < 0 ? -result : EIO;
+        return false;
+    }
+
+    device->written += (size_t)result;
+    if (device->written < device->write_bytes)
+        return post_write(loop, id);
+
+    device->write_pending = false;
+    return true;
+}
+
+/* Moves every completion the kernel has posted into the loop's queue */
+static bool reap(EvdevLoop *loop)
+{
+    if (loop->queue_head == loop->queue_tail)
+        loop->queue_head = loop->queue_tail = 0;
+
+    struct io_uring_cqe *cqe;
+    while ((cqe = evdev_uring_peek(&loop->uring)) != NULL)
+    {
+        if (loop->queue_tail == URING_CQ_ENTRIES)
+        {
+            if (loop->queue_head == 0)
+            {
+                errno = EOVERFLOW;
+                return false;
+            }
+            size_t count = loop->queue_tail - loop->queue_head;
+            memmove(loop->queue, loop->queue + loop->queue_head, count * sizeof(struct io_uring_cqe));
+            loop->queue_head = 0;
+            loop->queue_tail = count;
+        }
+        loop->queue[loop->queue_tail++] = *cqe;
+        evdev_uring_seen(&loop->uring);
+    }
+    return true;
+}
+
+/*
+ * Blocks until the device's write in flight completes. Other writes that
+ * complete meanwhile are settled too; anything else stays queued, in
+ * order, for the main pass.
+ */
+static bool wait_write(EvdevLoop *loop, int id)
+{
+    while (loop->devices[id]->write_pending)
+    {
+        loop->stats.wakeups++;
+        loop->writes_posted = 0;
+        if (!evdev_uring_enter(&loop->uring, 1) || !reap(loop))
+            return false;
+
+        for (size_t i = loop->queue_head; i < loop->queue_tail; i++)
+        {
+            struct io_uring_cqe *cqe = &loop->queue[i];
+            if (cqe->user_data == TAG_SEEN || !(cqe->user_data & TAG_WRITE))
+                continue;
+            if (!write_done(loop, (int)(uint32_t)cqe->user_data, cqe->res))
+                return false;
+            cqe->user_data = TAG_SEEN;
+        }
+    }
+    return true;
+}
+
+/*
+ * Empties the device's output into a write, waiting out the one in flight
+ * if need be. An empty output has room already; a zero-length write would
+ * complete with 0, which write_done takes for an error.
+ */
+static bool make_room(EvdevLoop *loop, int id)
+{
+    if (loop->devices[id]->stream.output.count == 0)
+        return true;
+    if (loop->devices[id]->write_pending && !wait_write(loop, id))
+        return false;
+    return submit_write(loop, id);
+}
+
+/* Room for whatever one more filter call may emit, so the stream never writes on its own */
+static bool ensure_room(EvdevLoop *loop, int id)
+{
+    const EvdevOutput *output = &loop->devices[id]->stream.output;
+    if (loop->io == EVDEV_IO_EPOLL || output->capacity - output->count >= EVDEV_FRAME_OUTPUT_MAX)
+        return true;
+    return make_room(loop, id);
+}
+
+/* Shared by both paths */
+
+/* Emits what is due by now and refreshes the cached deadline; epoll writes it out too */
+static bool service(EvdevLoop *loop, int id, uint64_t now)
+{
+    EvdevLoopDevice *device = loop->devices[id];
+    EvdevStream *stream = &device->stream;
+    if (!ensure_room(loop, id) || !evdev_stream_advance(stream, now))
+        return false;
+    if (loop->io == EVDEV_IO_EPOLL && stream->output.count > 0 && !evdev_stream_flush(stream))
+        return false;
+
+    device->has_deadline = evdev_filter_deadline(&stream->filter, &device->deadline);
+    device->touched = false;
+    return true;
+}
+
+/* Input ended: release everything now and stop watching it */
+static bool close_device(EvdevLoop *loop, int id)
+{
+    EvdevLoopDevice *device = loop->devices[id];
+    if (loop->io == EVDEV_IO_EPOLL)
+        epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, device->stream.in_fd, NULL);
+    device->open = false;
+    loop->open_count--;
+    return service(loop, id, UINT64_MAX);
+}
+
+/* Points the timerfd at the earliest cached deadline, touching it only when that moved */
+static bool arm_timer(EvdevLoop *loop)
+{
+    uint64_t earliest = 0;
+    for (int i = 0; i < loop->device_count; i++)
+    {
+        const EvdevLoopDevice *device = loop->devices[i];
+        if (device->open && device->has_deadline && (earliest == 0 || device->deadline < earliest))
+            earliest = device->deadline;
+    }
+
+    if (earliest == loop->armed)
+        return true;
+
+    /* An all-zero it_value disarms */
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = (time_t)(earliest / 1000000u);
+    spec.it_value.tv_nsec = (long)(earliest % 1000000u) * 1000;
+
+    loop->stats.timer_sets++;
+    loop->stats.syscalls++;
+    loop->armed = earliest;
+    return timerfd_settime(loop->timer_fd, TFD_TIMER_ABSTIME, &spec, NULL) == 0;
+}
+
+/* Advances the devices that read frames or reached their deadline, then re-arms */
+static bool service_due(EvdevLoop *loop)
+{
+    uint64_t now = time_manager_now_us();
+    for (int i = 0; i < loop->device_count; i++)
+    {
+        EvdevLoopDevice *device = loop->devices[i];
+        bool due = device->has_deadline && device->deadline <= now;
+        if (device->open && (device->touched || due) && !service(loop, i, now))
+            return false;
+    }
+    return arm_timer(loop);
+}
+
+/* epoll and plain read/write */
+
+static int run_epoll(EvdevLoop *loop)
+{
+    struct epoll_event events[EVDEV_LOOP_MAX_DEVICES + 2];
+
+    while (loop->open_count > 0 && !mf_atomic_load32(&loop->stop))
+    {
+        int ready = epoll_wait(loop->epoll_fd, events, EVDEV_LOOP_MAX_DEVICES + 2, -1);
+        loop->stats.wakeups++;
+        loop->stats.syscalls++;
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+
+        for (int i = 0; i < ready; i++)
+        {
+            uint32_t tag = events[i].data.u32;
+            uint64_t count;
+
+            if (tag == TAG_TIMER || tag == TAG_WAKE)
+            {
+                ssize_t ignored = read(tag == TAG_TIMER ? loop->timer_fd : loop->wake_fd, &count, sizeof(count));
+                (void)ignored;
+                loop->stats.syscalls++;
+                if (tag == TAG_TIMER)
+                {
+                    loop->stats.timer_fires++;
+                    loop->armed = 0;
+                }
+                continue;
+            }
+
+            EvdevLoopDevice *device = loop->devices[tag];
+            int status = evdev_stream_read(&device->stream);
+            /* An unplugged device node reads ENODEV: it ends like a closed pipe */
+            if (status < 0 && errno != ENODEV)
+                return -1;
+            if (status <= 0)
+            {
+                if (!close_device(loop, (int)tag))
+                    return -1;
+                continue;
+            }
+            device->touched = true;
+        }
+
+        if (!service_due(loop))
+            return -1;
+    }
+    return 0;
+}
+
+/* io_uring */
+
+/* Feeds one read completion to its device */
+static bool read_done(EvdevLoop *loop, int id, const struct io_uring_cqe *cqe)
+{
+    EvdevLoopDevice *device = loop->devices[id];
+    EvdevStream *stream = &device->stream;
+    uint16_t buffer = (uint16_t)(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+
+    if (cqe->res > 0)
+    {
+        const uint8_t *bytes = evdev_uring_buffer(&loop->uring, buffer);
+        size_t length = (size_t)cqe->res, fed = 0;
+
+        for (;;)
+        {
+            fed += evdev_stream_feed(stream, bytes + fed, length - fed);
+            if (fed == length && !evdev_stream_held(stream))
+                break;
+            if (!make_room(loop, id))
+                return false;
+        }
+        stream->stats.reads++;
+        device->touched = true;
+    }
+    /* A plain read that hit the end still took a buffer */
+    if (cqe->flags & IORING_CQE_F_BUFFER)
+        evdev_uring_recycle(&loop->uring, buffer);
+
+    if (cqe->flags & IORING_CQE_F_MORE)
+        return true;
+
+    /*
+     * The read ended: out of buffers for a moment, cancelled on a hangup,
+     * or the input ended. Once hung up, plain reads drain what is left,
+     * since a multishot read would wait on a hangup it cannot see.
+     */
+    if (cqe->res > 0 || cqe->res == -ENOBUFS || cqe->res == -ECANCELED)
+        return device->hung_up ? evdev_uring_read(&loop->uring, stream->in_fd, (uint64_t)id)
+                               : evdev_uring_read_multishot(&loop->uring, stream->in_fd, (uint64_t)id);
+    if (cqe->res == 0 || cqe->res == -ENODEV)
+        return close_device(loop, id);
+    errno = -cqe->res;
+    return false;
+}
+
+static bool handle(EvdevLoop *loop, const struct io_uring_cqe *cqe)
+{
+    uint64_t tag = cqe->user_data;
+    if (tag == TAG_SEEN)
+        return true;
+
+    if (tag == TAG_TIMER || tag == TAG_WAKE)
+    {
+        if (cqe->res < 0)
+        {
+            errno = -cqe->res;
+            return false;
+        }
+        if (tag == TAG_TIMER)
+        {
+            loop->stats.timer_fires++;
+            loop->armed = 0;
+            return post_counter_read(loop, loop->timer_fd, &loop->timer_expirations, TAG_TIMER);
+        }
+        return post_counter_read(loop, loop->wake_fd, &loop->wake_count, TAG_WAKE);
+    }
+
+    if (tag & TAG_HANGUP)
+    {
+        /* The multishot read would wait on past it: cancel it, and the re-post reads to the end */
+        EvdevLoopDevice *device = loop->devices[(uint32_t)tag];
+        device->hung_up = true;
+        return !device->open || evdev_uring_cancel(&loop->uring, (uint32_t)tag, TAG_SEEN);
+    }
+    if (tag & TAG_WRITE)
+        return write_done(loop, (int)(uint32_t)tag, cqe->res);
+    return read_done(loop, (int)tag, cqe);
+}
+
+/* Queues a write for every device with output and none in flight */
+static bool submit_writes(EvdevLoop *loop)
+{
+    for (int i = 0; i < loop->device_count; i++)
+    {
+        EvdevLoopDevice *device = loop->devices[i];
+        if (device->stream.output.count > 0 && !device->write_pending && !submit_write(loop, i))
+            return false;
+    }
+    return true;
+}
+
+static int run_uring(EvdevLoop *loop)
+{
+    while (loop->open_count > 0 && !mf_atomic_load32(&loop->stop))
+    {
+        /*
+         * Submits last iteration's writes and re-posts, and sleeps, in one
+         * call. Writes mostly complete during the submit, so the wait counts
+         * them and still sleeps until there is input, a deadline or a stop.
+         */
+        bool idle = loop->queue_head == loop->queue_tail && !evdev_uring_peek(&loop->uring);
+        unsigned wait = idle ? 1 + loop->writes_posted : 0;
+        loop->stats.wakeups += idle;
+        loop->writes_posted = 0;
+        if (!evdev_uring_enter(&loop->uring, wait) || !reap(loop))
+            return -1;
+
+        while (loop->queue_head < loop->queue_tail)
+        {
+            struct io_uring_cqe cqe = loop->queue[loop->queue_head++];
+            if (!handle(loop, &cqe))
+                return -1;
+        }
+
+        if (!service_due(loop) || !submit_writes(loop))
+            return -1;
+    }
+    return 0;
+}
+
+int evdev_loop_run(EvdevLoop *loop)
+{
+    int status = loop->io == EVDEV_IO_URING ? run_uring(loop) : run_epoll(loop);
+    if (status < 0)
+        return -1;
+
+    /* Stopped: nothing may stay held downstream */
+    for (int i = 0; i < loop->device_count; i++)
+    {
+        if (loop->devices[i]->open && !service(loop, i, UINT64_MAX))
+            return -1;
+    }
+    if (loop->io == EVDEV_IO_EPOLL)
+        return 0;
+
+    /* And everything reaches its output before returning */
+    for (int i = 0; i < loop->device_count; i++)
+    {
+        if (loop->devices[i]->stream.output.count > 0 && !make_room(loop, i))
+            return -1;
+        if (!wait_write(loop, i))
+            return -1;
+    }
+    return 0;
+}
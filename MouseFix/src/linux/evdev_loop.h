@@ -0,0 +1,120 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "evdev_stream.h"
+#include "evdev_uring.h"
+
+/*
+ * Many evdev devices on one thread, each with its own engine.
+ *
+ * Every device is an EvdevStream (its own EvdevFilter, so its own
+ * DebounceManager), all watched by the one thread. Smart Drag
+ * deadlines from all devices share a single timerfd on CLOCK_MONOTONIC,
+ * armed for the earliest one and re-armed only when that changes. Each
+ * device caches its next deadline, refreshed after its own frames or
+ * releases, so finding the earliest is one pass over cached values. The
+ * thread blocks between frames and deadlines with no timeout, so an idle
+ * loop takes no wakeups at all.
+ *
+ * I/O goes through io_uring where the kernel has multishot reads (6.7):
+ * each input keeps one multishot read posted into a shared ring of
+ * provided buffers, so a completion carries every frame that arrived,
+ * and each device's filtered frames go out as one write SQE per loop
+ * iteration, submitted with the next wait. A busy iteration then costs
+ * one io_uring_enter, against epoll_wait plus a read and a write per
+ * device. A device keeps at most one write in flight, from its own copy
+ * of the frames, so its writes stay in order while filtering goes on.
+ * Elsewhere, or with EVDEV_IO_EPOLL, the loop uses epoll and plain
+ * read/write.
+ *
+ * The loop runs live: frame times must be on time_manager_now_us
+ * (CLOCK_MONOTONIC device nodes, or EVDEV_CLOCK_HOST). A device whose
+ * input ends has its pending releases emitted at once and leaves the
+ * loop; evdev_loop_run returns when the last one has, or when stopped.
+ * Add devices before evdev_loop_run. The loop does not own the device fds.
+ */
+
+#define EVDEV_LOOP_MAX_DEVICES 64
+#define EVDEV_URING_BUFFERS    256
+
+typedef enum
+{
+    EVDEV_IO_AUTO,  /* io_uring if available, else epoll */
+    EVDEV_IO_EPOLL,
+    EVDEV_IO_URING, /* fail rather than fall back */
+} EvdevIo;
+
+typedef struct
+{
+    EvdevStream stream;
+    uint64_t deadline;
+    bool has_deadline;
+    bool open;
+    bool touched; /* read or advanced this wakeup */
+    bool hung_up; /* io_uring: reads to the end with plain reads */
+
+    /* io_uring: the write in flight */
+    struct input_event writing[EVDEV_OUTPUT_FRAMES];
+    size_t write_bytes;
+    size_t written;
+    bool write_pending;
+} EvdevLoopDevice;
+
+typedef struct
+{
+    uint64_t wakeups;    /* returns from epoll_wait, or io_uring_enter calls that waited */
+    uint64_t timer_fires;
+    uint64_t timer_sets; /* timerfd_settime calls */
+    uint64_t syscalls;   /* the loop's own: waits, timerfd and eventfd; see evdev_loop_syscalls */
+} EvdevLoopStats;
+
+typedef struct
+{
+    EvdevIo io; /* the one in use, never EVDEV_IO_AUTO */
+    int epoll_fd;
+    int timer_fd;
+    int wake_fd;
+    MfAtomic32 stop;
+
+    EvdevUring uring;
+    uint64_t timer_expirations; /* read targets for the timerfd and eventfd */
+    uint64_t wake_count;
+    struct io_uring_cqe *queue; /* reaped completions not yet handled */
+    size_t queue_head;
+    size_t queue_tail;
+    unsigned writes_posted; /* write SQEs not yet submitted */
+
+    EvdevLoopDevice *devices[EVDEV_LOOP_MAX_DEVICES];
+    int device_count;
+    int open_count;
+    uint64_t armed; /* deadline the timerfd is set for, 0 when disarmed */
+    EvdevLoopStats stats;
+} EvdevLoop;
+
+/* False with errno set, and nothing left open, if the I/O asked for or the timerfd or eventfd fails */
+bool evdev_loop_init(EvdevLoop *loop, EvdevIo io);
+void evdev_loop_cleanup(EvdevLoop *loop);
+
+/* Device id, or -1 when full or out of memory. Configure its engine through evdev_loop_filter */
+int evdev_loop_add(EvdevLoop *loop, int in_fd, int out_fd, EvdevClock clock);
+EvdevFilter *evdev_loop_filter(EvdevLoop *loop, int device);
+const EvdevStream *evdev_loop_stream(const EvdevLoop *loop, int device);
+
+/*
+ * Writes to every page of the devices' state and buffers, the completion
+ * queue and the provided buffers, so none faults on first use. For a
+ * low-latency setup (rt_mode.h) after the last evdev_loop_add.
+ */
+void evdev_loop_prefault(EvdevLoop *loop);
+
+/* Every syscall the loop has made: its own plus plain reads and writes, or io_uring enters */
+uint64_t evdev_loop_syscalls(const EvdevLoop *loop);
+
+const char *evdev_io_name(EvdevIo io);
+
+/* Until every input has ended or evdev_loop_stop: 0 then, -1 with errno set on an error */
+int evdev_loop_run(EvdevLoop *loop);
+
+/* Any thread, or a signal handler */
+void evdev_loop_stop(EvdevLoop *loop);
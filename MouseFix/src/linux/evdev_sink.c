@@ -0,0 +1,65 @@
+#include "evdev_sink.h"
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+static void add_frame(struct input_event *frame, uint64_t time, uint16_t type, uint16_t code, int32_t value)
+{
+    memset(frame, 0, sizeof(*frame));
+    evdev_frame_set_time(frame, time);
+    frame->type = type;
+    frame->code = code;
+    frame->value = value;
+}
+
+static bool sink_flush(const PackedEvent *events, size_t count, void *user_data)
+{
+    EvdevSink *sink = (EvdevSink *)user_data;
+    struct input_event frames[EVDEV_SINK_FRAMES];
+    size_t used = 0;
+
+    for (size_t i = 0; i < count && used + 2 <= EVDEV_SINK_FRAMES; i++)
+    {
+        MouseButton button = packed_event_button(&events[i]);
+        uint16_t code = button >= 0 && button < MOUSE_BUTTON_COUNT ? sink->key_codes[button] : 0;
+        uint64_t time = packed_event_time(&events[i]);
+        if (code != 0)
+            add_frame(&frames[used++], time, EV_KEY, code, packed_event_is_down(&events[i]));
+
+        /* A report ends where the time changes, and at the end of the batch */
+        bool last = i + 1 == count || packed_event_time(&events[i + 1]) != time;
+        if (last && used > 0 && frames[used - 1].type != EV_SYN)
+            add_frame(&frames[used++], time, EV_SYN, SYN_REPORT, 0);
+    }
+
+    const uint8_t *bytes = (const uint8_t *)frames;
+    size_t left = used * sizeof(struct input_event);
+    while (left > 0)
+    {
+        ssize_t written = write(sink->fd, bytes, left);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        sink->writes++;
+        bytes += written;
+        left -= (size_t)written;
+    }
+    return true;
+}
+
+OutputSink evdev_sink(EvdevSink *sink, int fd)
+{
+    memset(sink, 0, sizeof(EvdevSink));
+    sink->fd = fd;
+    sink->key_codes[MOUSE_BUTTON_LEFT] = BTN_LEFT;
+    sink->key_codes[MOUSE_BUTTON_RIGHT] = BTN_RIGHT;
+    sink->key_codes[MOUSE_BUTTON_MIDDLE] = BTN_MIDDLE;
+    sink->key_codes[MOUSE_BUTTON_X1] = BTN_SIDE;
+    sink->key_codes[MOUSE_BUTTON_X2] = BTN_EXTRA;
+
+    OutputSink output = {sink_flush, sink};
+    return output;
+}
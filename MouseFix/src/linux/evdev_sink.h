@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdint.h>
+#include "../core/output_sink.h"
+#include "evdev_filter.h"
+
+/*
+ * An OutputSink that writes a batch to an fd as evdev frames, the way a
+ * uinput device takes them: each button event becomes its key frame, and
+ * events sharing a timestamp share one SYN_REPORT. A whole batch goes out
+ * in a single write. Frames carry their event's time; uinput ignores it,
+ * a pipe to another filter keeps it.
+ */
+
+#define EVDEV_SINK_FRAMES (2 * OUTPUT_BATCH_CAPACITY)
+
+typedef struct
+{
+    int fd;
+    uint16_t key_codes[MOUSE_BUTTON_COUNT]; /* 0 drops the button (the wheel) */
+    uint64_t writes;
+} EvdevSink;
+
+/* Codes start as BTN_LEFT, BTN_RIGHT, BTN_MIDDLE, BTN_SIDE and BTN_EXTRA. The fd stays the caller's */
+OutputSink evdev_sink(EvdevSink *sink, int fd);
@@ -0,0 +1,114 @@
+#include "evdev_stream.h"
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+void evdev_stream_init(EvdevStream *stream, int in_fd, int out_fd, EvdevClock clock)
+{
+    if (!stream)
+        return;
+
+    memset(stream, 0, sizeof(EvdevStream));
+    evdev_filter_init(&stream->filter);
+    stream->in_fd = in_fd;
+    stream->out_fd = out_fd;
+    stream->clock = clock;
+    stream->output.frames = stream->frames;
+    stream->output.capacity = EVDEV_OUTPUT_FRAMES;
+}
+
+bool evdev_stream_flush(EvdevStream *stream)
+{
+    const uint8_t *bytes = (const uint8_t *)stream->output.frames;
+    size_t left = stream->output.count * sizeof(struct input_event);
+
+    while (left > 0)
+    {
+        ssize_t written = write(stream->out_fd, bytes, left);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        stream->stats.writes++;
+        bytes += written;
+        left -= (size_t)written;
+    }
+
+    stream->output.count = 0;
+    return true;
+}
+
+/* Keeps room for whatever the next filter call may append */
+static bool reserve_output(EvdevStream *stream)
+{
+    if (stream->output.capacity - stream->output.count >= EVDEV_FRAME_OUTPUT_MAX)
+        return true;
+    return evdev_stream_flush(stream);
+}
+
+/* Filters the whole frames buffered; without may_flush it stops short where the output runs out of room */
+static bool filter_input(EvdevStream *stream, bool may_flush)
+{
+    size_t frames = stream->input_bytes / sizeof(struct input_event);
+    uint64_t read_time = stream->clock == EVDEV_CLOCK_HOST ? time_manager_now_us() : 0;
+    size_t done = 0;
+
+    for (; done < frames; done++)
+    {
+        if (stream->output.capacity - stream->output.count < EVDEV_FRAME_OUTPUT_MAX)
+        {
+            if (!may_flush)
+                break;
+            if (!evdev_stream_flush(stream))
+                return false;
+        }
+
+        struct input_event frame;
+        memcpy(&frame, stream->input + done * sizeof(struct input_event), sizeof(frame));
+        if (stream->clock == EVDEV_CLOCK_HOST)
+            evdev_frame_set_time(&frame, read_time);
+        evdev_filter_frame(&stream->filter, &frame, evdev_frame_time(&frame), &stream->output);
+    }
+
+    size_t used = done * sizeof(struct input_event);
+    memmove(stream->input, stream->input + used, stream->input_bytes - used);
+    stream->input_bytes -= used;
+    return true;
+}
+
+size_t evdev_stream_feed(EvdevStream *stream, const void *bytes, size_t length)
+{
+    /* Frames held back last time go first */
+    filter_input(stream, false);
+
+    size_t space = sizeof(stream->input) - stream->input_bytes;
+    size_t taken = length < space ? length : space;
+    memcpy(stream->input + stream->input_bytes, bytes, taken);
+    stream->input_bytes += taken;
+    filter_input(stream, false);
+    return taken;
+}
+
+int evdev_stream_read(EvdevStream *stream)
+{
+    ssize_t got = read(stream->in_fd, stream->input + stream->input_bytes,
+                       sizeof(stream->input) - stream->input_bytes);
+    stream->stats.reads++;
+    if (got < 0)
+        return errno == EAGAIN || errno == EINTR ? 1 : -1;
+    if (got == 0)
+        return 0;
+
+    stream->input_bytes += (size_t)got;
+    return filter_input(stream, true) ? 1 : -1;
+}
+
+bool evdev_stream_advance(EvdevStream *stream, uint64_t now)
+{
+    if (!reserve_output(stream))
+        return false;
+    evdev_filter_advance(&stream->filter, now, &stream->output);
+    return true;
+}
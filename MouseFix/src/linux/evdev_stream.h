@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "evdev_filter.h"
+
+/*
+ * One evdev input fd, its EvdevFilter and its output fd: the buffering
+ * shared by the single-device daemon and the multi-device loop.
+ *
+ * Reads may end mid-frame on pipes; the remainder is kept for the next
+ * read. Filtered frames collect in a fixed buffer that is written out by
+ * evdev_stream_flush, or early when it runs short of room. Callers that
+ * do their own reads and writes (io_uring) hand bytes to
+ * evdev_stream_feed instead, which never writes.
+ */
+
+#define EVDEV_READ_FRAMES   64
+#define EVDEV_OUTPUT_FRAMES 256
+
+typedef struct
+{
+    uint64_t reads;
+    uint64_t writes;
+} EvdevStreamStats;
+
+typedef struct
+{
+    EvdevFilter filter;
+    int in_fd;
+    int out_fd;
+    EvdevClock clock;
+
+    uint8_t input[EVDEV_READ_FRAMES * sizeof(struct input_event)];
+    size_t input_bytes; /* a partial frame left over from the last read */
+    struct input_event frames[EVDEV_OUTPUT_FRAMES];
+    EvdevOutput output;
+    EvdevStreamStats stats;
+} EvdevStream;
+
+/* Configure the engine afterwards on &stream->filter.pipeline.debounce */
+void evdev_stream_init(EvdevStream *stream, int in_fd, int out_fd, EvdevClock clock);
+
+/* One read, filtered: 1 after data (or EAGAIN/EINTR), 0 at end of input, -1 with errno set on an error */
+int evdev_stream_read(EvdevStream *stream);
+
+/*
+ * Filters bytes read elsewhere and returns how many were taken. Stops
+ * short, without writing, once the output lacks room for another frame's
+ * worth (EVDEV_FRAME_OUTPUT_MAX): empty the output and feed the rest.
+ */
+size_t evdev_stream_feed(EvdevStream *stream, const void *bytes, size_t length);
+
+/* Whole frames evdev_stream_feed held back for lack of output room */
+static inline bool evdev_stream_held(const EvdevStream *stream)
+{
+    return stream->input_bytes >= sizeof(struct input_event);
+}
+
+/* Releases due by now; UINT64_MAX drains them all. False on a write error */
+bool evdev_stream_advance(EvdevStream *stream, uint64_t now);
+
+/* Writes out what is buffered; false with errno set on an error */
+bool evdev_stream_flush(EvdevStream *stream);
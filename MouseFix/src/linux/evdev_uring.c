@@ -0,0 +1,271 @@
+#include "evdev_uring.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define BUFFER_GROUP 0
+
+static int uring_setup(unsigned entries, struct io_uring_params *params)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int uring_register(int fd, unsigned opcode, void *arg, unsigned count)
+{
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, count);
+}
+
+/* Multishot reads need 6.7, well after provided buffer rings (5.19) */
+static bool supports_multishot_read(int fd)
+{
+    size_t size = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe *probe = calloc(1, size);
+    if (!probe)
+        return false;
+
+    bool supported = uring_register(fd, IORING_REGISTER_PROBE, probe, 256) == 0 &&
+                     probe->last_op >= EVDEV_URING_OP_READ_MULTISHOT &&
+                     (probe->ops[EVDEV_URING_OP_READ_MULTISHOT].flags & IO_URING_OP_SUPPORTED);
+    free(probe);
+    return supported;
+}
+
+static bool map_rings(EvdevUring *uring, const struct io_uring_params *params)
+{
+    size_t sq_size = params->sq_off.array + params->sq_entries * sizeof(unsigned);
+    size_t cq_size = params->cq_off.cqes + params->cq_entries * sizeof(struct io_uring_cqe);
+
+    /* Every kernel with provided buffer rings maps both rings at once */
+    if (!(params->features & IORING_FEAT_SINGLE_MMAP))
+    {
+        errno = ENOSYS;
+        return false;
+    }
+
+    uring->ring_size = sq_size > cq_size ? sq_size : cq_size;
+    uring->ring = mmap(NULL, uring->ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->fd,
+                       IORING_OFF_SQ_RING);
+    if (uring->ring == MAP_FAILED)
+    {
+        uring->ring = NULL;
+        return false;
+    }
+
+    uring->sqes_size = params->sq_entries * sizeof(struct io_uring_sqe);
+    uring->sqes = mmap(NULL, uring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->fd,
+                       IORING_OFF_SQES);
+    if (uring->sqes == MAP_FAILED)
+    {
+        uring->sqes = NULL;
+        return false;
+    }
+
+    uint8_t *ring = uring->ring;
+    uring->sq_head = (unsigned *)(ring + params->sq_off.head);
+    uring->sq_tail = (unsigned *)(ring + params->sq_off.tail);
+    uring->sq_array = (unsigned *)(ring + params->sq_off.array);
+    uring->sq_mask = *(unsigned *)(ring + params->sq_off.ring_mask);
+    uring->sq_entries = params->sq_entries;
+    uring->sq_local_tail = *uring->sq_tail;
+
+    uring->cq_head = (unsigned *)(ring + params->cq_off.head);
+    uring->cq_tail = (unsigned *)(ring + params->cq_off.tail);
+    uring->cq_mask = *(unsigned *)(ring + params->cq_off.ring_mask);
+    uring->cqes = (struct io_uring_cqe *)(ring + params->cq_off.cqes);
+    return true;
+}
+
+static bool register_buffers(EvdevUring *uring, unsigned buffer_count, unsigned buffer_size)
+{
+    uring->buffer_count = buffer_count;
+    uring->buffer_size = buffer_size;
+    uring->buf_ring_size = buffer_count * sizeof(struct io_uring_buf);
+    uring->buf_ring = mmap(NULL, uring->buf_ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (uring->buf_ring == MAP_FAILED)
+    {
+        uring->buf_ring = NULL;
+        return false;
+    }
+
+    uring->buffers = malloc((size_t)buffer_count * buffer_size);
+    if (!uring->buffers)
+        return false;
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uint64_t)(uintptr_t)uring->buf_ring;
+    reg.ring_entries = buffer_count;
+    reg.bgid = BUFFER_GROUP;
+    if (uring_register(uring->fd, IORING_REGISTER_PBUF_RING, &reg, 1) != 0)
+        return false;
+
+    for (unsigned i = 0; i < buffer_count; i++)
+        evdev_uring_recycle(uring, (uint16_t)i);
+    return true;
+}
+
+bool evdev_uring_init(EvdevUring *uring, unsigned entries, unsigned cq_entries, unsigned buffer_count,
+                      unsigned buffer_size)
+{
+    if (!uring || buffer_count == 0 || (buffer_count & (buffer_count - 1)) != 0 || buffer_count > 32768)
+    {
+        errno = EINVAL;
+        return false;
+    }
+
+    memset(uring, 0, sizeof(EvdevUring));
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = cq_entries;
+
+    uring->fd = uring_setup(entries, &params);
+    if (uring->fd < 0)
+        return false;
+
+    bool ok = supports_multishot_read(uring->fd);
+    if (!ok)
+        errno = ENOSYS;
+    ok = ok && map_rings(uring, &params) && register_buffers(uring, buffer_count, buffer_size);
+    if (!ok)
+    {
+        int error = errno;
+        evdev_uring_cleanup(uring);
+        errno = error;
+    }
+    return ok;
+}
+
+void evdev_uring_cleanup(EvdevUring *uring)
+{
+    if (!uring)
+        return;
+
+    /* Closing the ring cancels what is still posted, before its memory goes */
+    if (uring->fd >= 0)
+        close(uring->fd);
+    if (uring->ring)
+        munmap(uring->ring, uring->ring_size);
+    if (uring->sqes)
+        munmap(uring->sqes, uring->sqes_size);
+    if (uring->buf_ring)
+        munmap(uring->buf_ring, uring->buf_ring_size);
+    free(uring->buffers);
+    memset(uring, 0, sizeof(EvdevUring));
+    uring->fd = -1;
+}
+
+bool evdev_uring_enter(EvdevUring *uring, unsigned wait)
+{
+    /* Publish the SQEs taken since the last call */
+    unsigned tail = *uring->sq_tail;
+    for (; tail != uring->sq_local_tail; tail++)
+        uring->sq_array[tail & uring->sq_mask] = tail & uring->sq_mask;
+    __atomic_store_n(uring->sq_tail, tail, __ATOMIC_RELEASE);
+
+    for (;;)
+    {
+        unsigned pending = tail - __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE);
+        if (pending == 0 && wait == 0)
+            return true;
+
+        uring->enters++;
+        int result = (int)syscall(__NR_io_uring_enter, uring->fd, pending, wait, wait ? IORING_ENTER_GETEVENTS : 0,
+                                  NULL, 0);
+        if (result >= 0)
+        {
+            /* Short submits only happen when the CQ is full; the caller reaps and comes back */
+            return true;
+        }
+        if (errno != EINTR)
+            return false;
+        if (wait && evdev_uring_peek(uring))
+            return true;
+    }
+}
+
+struct io_uring_sqe *evdev_uring_sqe(EvdevUring *uring)
+{
+    unsigned head = __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE);
+    if (uring->sq_local_tail - head >= uring->sq_entries)
+    {
+        if (!evdev_uring_enter(uring, 0))
+            return NULL;
+        head = __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE);
+        if (uring->sq_local_tail - head >= uring->sq_entries)
+        {
+            errno = EBUSY;
+            return NULL;
+        }
+    }
+
+    struct io_uring_sqe *sqe = &uring->sqes[uring->sq_local_tail & uring->sq_mask];
+    uring->sq_local_tail++;
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+void evdev_uring_recycle(EvdevUring *uring, uint16_t id)
+{
+    struct io_uring_buf *buf = &uring->buf_ring->bufs[uring->buf_local_tail & (uring->buffer_count - 1)];
+    buf->addr = (uint64_t)(uintptr_t)evdev_uring_buffer(uring, id);
+    buf->len = uring->buffer_size;
+    buf->bid = id;
+    uring->buf_local_tail++;
+    /* The tail shares its slot with bufs[0].resv */
+    __atomic_store_n(&uring->buf_ring->tail, uring->buf_local_tail, __ATOMIC_RELEASE);
+}
+
+static bool post_read(EvdevUring *uring, uint8_t opcode, int fd, uint64_t user_data)
+{
+    struct io_uring_sqe *sqe = evdev_uring_sqe(uring);
+    if (!sqe)
+        return false;
+
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->off = (uint64_t)-1;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP;
+    sqe->user_data = user_data;
+    return true;
+}
+
+bool evdev_uring_read_multishot(EvdevUring *uring, int fd, uint64_t user_data)
+{
+    return post_read(uring, EVDEV_URING_OP_READ_MULTISHOT, fd, user_data);
+}
+
+bool evdev_uring_read(EvdevUring *uring, int fd, uint64_t user_data)
+{
+    return post_read(uring, IORING_OP_READ, fd, user_data);
+}
+
+bool evdev_uring_poll_hangup(EvdevUring *uring, int fd, uint64_t user_data)
+{
+    struct io_uring_sqe *sqe = evdev_uring_sqe(uring);
+    if (!sqe)
+        return false;
+
+    /* No events asked for: the kernel always adds POLLERR and POLLHUP */
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->user_data = user_data;
+    return true;
+}
+
+bool evdev_uring_cancel(EvdevUring *uring, uint64_t target, uint64_t user_data)
+{
+    struct io_uring_sqe *sqe = evdev_uring_sqe(uring);
+    if (!sqe)
+        return false;
+
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = target;
+    sqe->user_data = user_data;
+    return true;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <linux/io_uring.h>
+
+/*
+ * Minimal io_uring ring over the raw syscalls (no liburing): one SQ/CQ
+ * pair and one ring of provided buffers (group 0) for multishot reads.
+ *
+ * SQEs taken with evdev_uring_sqe are submitted by the next
+ * evdev_uring_enter, which can also wait for completions, so a loop
+ * iteration that submits and then sleeps costs a single syscall.
+ * Completions are read in order with evdev_uring_peek/evdev_uring_seen.
+ * A read that picked a provided buffer owns it until
+ * evdev_uring_recycle hands it back.
+ *
+ * Single-threaded: one thread takes SQEs, enters and reaps.
+ */
+
+/* Added in 6.7; older uapi headers lack it */
+#define EVDEV_URING_OP_READ_MULTISHOT 49
+
+typedef struct
+{
+    int fd;
+
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_array;
+    unsigned sq_mask;
+    unsigned sq_entries;
+    unsigned sq_local_tail; /* SQEs taken, published to *sq_tail on enter */
+    struct io_uring_sqe *sqes;
+
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned cq_mask;
+    struct io_uring_cqe *cqes;
+
+    void *ring;
+    size_t ring_size;
+    size_t sqes_size;
+
+    struct io_uring_buf_ring *buf_ring;
+    size_t buf_ring_size;
+    uint8_t *buffers;
+    unsigned buffer_count; /* a power of two */
+    unsigned buffer_size;
+    uint16_t buf_local_tail;
+
+    uint64_t enters; /* io_uring_enter calls, the ring's only syscalls once running */
+} EvdevUring;
+
+/* False with errno set when io_uring, provided buffer rings or multishot reads are missing */
+bool evdev_uring_init(EvdevUring *uring, unsigned entries, unsigned cq_entries, unsigned buffer_count,
+                      unsigned buffer_size);
+void evdev_uring_cleanup(EvdevUring *uring);
+
+/* A zeroed SQE; submits what is queued first when the SQ is full. NULL on error */
+struct io_uring_sqe *evdev_uring_sqe(EvdevUring *uring);
+
+/* Submits queued SQEs and waits until at least wait completions are ready; false with errno set */
+bool evdev_uring_enter(EvdevUring *uring, unsigned wait);
+
+/* Oldest unseen completion, or NULL */
+static inline struct io_uring_cqe *evdev_uring_peek(EvdevUring *uring)
+{
+    unsigned head = *uring->cq_head;
+    if (head == __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE))
+        return NULL;
+    return &uring->cqes[head & uring->cq_mask];
+}
+
+static inline void evdev_uring_seen(EvdevUring *uring)
+{
+    __atomic_store_n(uring->cq_head, *uring->cq_head + 1, __ATOMIC_RELEASE);
+}
+
+static inline const uint8_t *evdev_uring_buffer(const EvdevUring *uring, uint16_t id)
+{
+    return uring->buffers + (size_t)id * uring->buffer_size;
+}
+
+/* Gives a provided buffer back to the kernel */
+void evdev_uring_recycle(EvdevUring *uring, uint16_t id);
+
+/* Posts a multishot read on fd from the provided buffers; false when the SQ cannot take it */
+bool evdev_uring_read_multishot(EvdevUring *uring, int fd, uint64_t user_data);
+
+/* Posts one plain read from the provided buffers; blocks in a kernel worker until there is data or an end */
+bool evdev_uring_read(EvdevUring *uring, int fd, uint64_t user_data);
+
+/*
+ * Posts a one-shot poll that completes on POLLHUP or POLLERR only. A
+ * multishot read already waiting on an input misses a hangup that comes
+ * without POLLIN (a pipe's last writer closing, an unplugged device), so
+ * this is what notices the input is gone.
+ */
+bool evdev_uring_poll_hangup(EvdevUring *uring, int fd, uint64_t user_data);
+
+/* Cancels the request posted with target; its completion then says -ECANCELED */
+bool evdev_uring_cancel(EvdevUring *uring, uint64_t target, uint64_t user_data);
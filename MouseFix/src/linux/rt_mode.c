@@ -0,0 +1,216 @@
+/* sched_setaffinity, gettid, RUSAGE_THREAD */
+#define _GNU_SOURCE
+#include "rt_mode.h"
+#include <alloca.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+void rt_mode_defaults(RtModeOptions *options)
+{
+    options->policy = SCHED_FIFO;
+    options->priority = 50;
+    options->cpu = -1;
+    options->lock_memory = true;
+    options->stack_bytes = RT_MODE_STACK_PREFAULT;
+}
+
+static bool set_policy(const RtModeOptions *options, RtModeReport *report)
+{
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = options->priority;
+    int error = pthread_setschedparam(pthread_self(), options->policy, &param);
+    if (error == 0)
+        return true;
+    report->sched_error = error;
+
+    /* Unprivileged: RLIMIT_RTPRIO may still allow a lower real-time priority */
+    struct rlimit limit;
+    if (error == EPERM && getrlimit(RLIMIT_RTPRIO, &limit) == 0 && limit.rlim_cur > 0)
+    {
+        param.sched_priority = limit.rlim_cur < (rlim_t)options->priority ? (int)limit.rlim_cur : options->priority;
+        if (pthread_setschedparam(pthread_self(), options->policy, &param) == 0)
+            return false;
+    }
+
+    /* Then the lowest nice value RLIMIT_NICE allows (20 - limit), on this thread alone */
+    int lowest = -20;
+    if (getrlimit(RLIMIT_NICE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY && limit.rlim_cur < 40)
+        lowest = 20 - (int)limit.rlim_cur;
+    errno = 0;
+    int current = getpriority(PRIO_PROCESS, (id_t)gettid());
+    if (errno == 0 && lowest < current)
+        setpriority(PRIO_PROCESS, (id_t)gettid(), lowest);
+    return false;
+}
+
+static bool pin(int cpu, RtModeReport *report)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (cpu >= CPU_SETSIZE)
+    {
+        report->cpu_error = EINVAL;
+        return false;
+    }
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0)
+    {
+        report->cpu_error = errno;
+        return false;
+    }
+    return true;
+}
+
+/* Not inlined, so the alloca'd stretch lies below the caller's frame and is released on return */
+static __attribute__((noinline)) size_t prefault_stack(size_t bytes)
+{
+    volatile uint8_t *stack = alloca(bytes);
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    for (size_t i = 0; i < bytes; i += page)
+        stack[i] = 0;
+    stack[bytes - 1] = 0;
+    return bytes;
+}
+
+/* Locked memory as the kernel counts it: VmLck in /proc/self/status */
+static bool memory_locked(void)
+{
+    FILE *status = fopen("/proc/self/status", "r");
+    if (!status)
+        return false;
+
+    char line[128];
+    unsigned long kb = 0;
+    while (fgets(line, sizeof(line), status))
+    {
+        if (sscanf(line, "VmLck: %lu", &kb) == 1)
+            break;
+    }
+    fclose(status);
+    return kb > 0;
+}
+
+static void read_back(RtModeReport *report)
+{
+    struct sched_param param;
+    if (pthread_getschedparam(pthread_self(), &report->policy, &param) == 0)
+        report->priority = param.sched_priority;
+    errno = 0;
+    report->nice = getpriority(PRIO_PROCESS, (id_t)gettid());
+    if (errno != 0)
+        report->nice = 0;
+
+    cpu_set_t set;
+    report->cpu = -1;
+    if (sched_getaffinity(0, sizeof(set), &set) == 0 && CPU_COUNT(&set) == 1)
+    {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+            if (CPU_ISSET(cpu, &set))
+            {
+                report->cpu = cpu;
+                break;
+            }
+        }
+    }
+    report->memory_locked = memory_locked();
+}
+
+bool rt_mode_apply(const RtModeOptions *options, RtModeReport *report)
+{
+    if (!options || !report)
+        return false;
+
+    memset(report, 0, sizeof(RtModeReport));
+    report->options = *options;
+    bool ok = true;
+
+    if (options->policy != SCHED_OTHER)
+        ok = set_policy(options, report) && ok;
+    if (options->cpu >= 0)
+        ok = pin(options->cpu, report) && ok;
+    /* Stack first, so mlockall's MCL_CURRENT locks the pages just touched */
+    if (options->stack_bytes > 0)
+        report->stack_prefaulted = prefault_stack(options->stack_bytes);
+    if (options->lock_memory && mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+    {
+        report->lock_error = errno;
+        ok = false;
+    }
+
+    read_back(report);
+    return ok;
+}
+
+static const char *policy_name(int policy)
+{
+    switch (policy)
+    {
+    case SCHED_FIFO:
+        return "SCHED_FIFO";
+    case SCHED_RR:
+        return "SCHED_RR";
+    case SCHED_OTHER:
+        return "SCHED_OTHER";
+    default:
+        return "other";
+    }
+}
+
+void rt_mode_print(const RtModeReport *report, FILE *out)
+{
+    const RtModeOptions *asked = &report->options;
+
+    if (report->policy == SCHED_FIFO || report->policy == SCHED_RR)
+        fprintf(out, "rt: scheduling %s priority %d", policy_name(report->policy), report->priority);
+    else
+        fprintf(out, "rt: scheduling %s nice %d", policy_name(report->policy), report->nice);
+    if (report->sched_error)
+        fprintf(out, " (%s %d: %s)", policy_name(asked->policy), asked->priority, strerror(report->sched_error));
+    fprintf(out, "\n");
+
+    if (report->cpu_error)
+        fprintf(out, "rt: cpu        not pinned (cpu %d: %s)\n", asked->cpu, strerror(report->cpu_error));
+    else if (report->cpu >= 0 && report->cpu == asked->cpu)
+        fprintf(out, "rt: cpu        pinned to %d\n", report->cpu);
+    else if (report->cpu >= 0)
+        fprintf(out, "rt: cpu        only %d allowed\n", report->cpu);
+    else
+        fprintf(out, "rt: cpu        not pinned\n");
+
+    if (report->memory_locked)
+        fprintf(out, "rt: memory     locked\n");
+    else if (report->lock_error)
+        fprintf(out, "rt: memory     not locked (mlockall: %s)\n", strerror(report->lock_error));
+    else
+        fprintf(out, "rt: memory     not locked\n");
+
+    fprintf(out, "rt: stack      %zu KB pre-faulted\n", report->stack_prefaulted / 1024);
+}
+
+void rt_mode_prefault(void *memory, size_t size)
+{
+    volatile uint8_t *bytes = (volatile uint8_t *)memory;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    if (!bytes || size == 0)
+        return;
+
+    /* Writes, not reads: a read of a fresh anonymous page maps the shared zero page */
+    for (size_t i = 0; i < size; i += page)
+        bytes[i] = bytes[i];
+    bytes[size - 1] = bytes[size - 1];
+}
+
+uint64_t rt_mode_page_faults(void)
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_THREAD, &usage) != 0)
+        return 0;
+    return (uint64_t)usage.ru_minflt + (uint64_t)usage.ru_majflt;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <sched.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Opt-in low-latency mode for the thread that filters input.
+ *
+ * rt_mode_apply puts the calling thread on a real-time policy, pins it to
+ * a CPU, locks the process's memory and touches a stretch of stack, each
+ * as far as the system allows: SCHED_FIFO falls back to the highest
+ * priority RLIMIT_RTPRIO permits, then to the lowest nice value, and a
+ * failed mlockall still leaves the stack pre-faulted. Nothing is fatal.
+ * The report is then read back from the kernel (policy, affinity, locked
+ * memory), not taken from what was asked, and rt_mode_print states which
+ * guarantees hold.
+ *
+ * Apply after the buffers and rings the thread will use exist: mlockall
+ * faults in everything mapped at that point and everything mapped after.
+ * Where it fails, rt_mode_prefault touches a buffer so at least its first
+ * use does not fault.
+ */
+
+#define RT_MODE_STACK_PREFAULT (256 * 1024)
+
+typedef struct
+{
+    int policy;          /* SCHED_FIFO or SCHED_RR; SCHED_OTHER leaves scheduling alone */
+    int priority;        /* 1..99 */
+    int cpu;             /* CPU to pin to, -1 for none */
+    bool lock_memory;    /* mlockall(MCL_CURRENT | MCL_FUTURE) */
+    size_t stack_bytes;  /* stack to pre-fault, 0 for none */
+} RtModeOptions;
+
+typedef struct
+{
+    /* Asked for */
+    RtModeOptions options;
+
+    /* Obtained, as read back */
+    int policy;
+    int priority;
+    int nice;            /* when the policy stayed SCHED_OTHER */
+    int cpu;             /* the one CPU the thread may run on, -1 if more */
+    bool memory_locked;
+    size_t stack_prefaulted;
+
+    /* Why a step fell short, 0 if it did not */
+    int sched_error;
+    int cpu_error;
+    int lock_error;
+} RtModeReport;
+
+/* SCHED_FIFO at 50, no pinning, memory locked, RT_MODE_STACK_PREFAULT of stack */
+void rt_mode_defaults(RtModeOptions *options);
+
+/* Applies options to the calling thread and the process; true if every guarantee asked for holds */
+bool rt_mode_apply(const RtModeOptions *options, RtModeReport *report);
+
+/* One line per guarantee, as obtained, with the reason for any shortfall */
+void rt_mode_print(const RtModeReport *report, FILE *out);
+
+/* Writes to every page of memory so none faults on first use */
+void rt_mode_prefault(void *memory, size_t size);
+
+/* Page faults (minor and major) the calling thread has taken so far */
+uint64_t rt_mode_page_faults(void);
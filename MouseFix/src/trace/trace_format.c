@@ -0,0 +1,321 @@
+#include "trace_format.h"
+#include <string.h>
+#include "../core/platform.h"
+
+/*
+ * Records starting at least this far from the end of the buffer cannot run
+ * past it, even malformed ones, so they are decoded without bounds checks.
+ * The worst case is an injected prefix followed by a config record with
+ * every varint at its longest; the assert below keeps the slack above it
+ * as config fields are added.
+ */
+#define TRACE_DECODE_SLACK 160
+
+#define TRACE_VARINT_MAX 10 /* 64 bits at 7 per byte */
+#define TRACE_DRAG_FIELDS 3 /* hold us, distance squared, confirm us */
+#define TRACE_ADAPTIVE_FIELDS 2 /* min us, max us */
+/* Time delta, flags, thresholds, then the flagged groups */
+#define TRACE_CONFIG_VARINTS (2 + MOUSE_BUTTON_COUNT + TRACE_DRAG_FIELDS + TRACE_ADAPTIVE_FIELDS)
+/* Time delta, dx, dy, wheel */
+#define TRACE_EVENT_VARINTS 4
+#define TRACE_INJECTED_SIZE (1 + TRACE_VARINT_MAX)
+
+_Static_assert(TRACE_DECODE_SLACK >= TRACE_INJECTED_SIZE + 1 + TRACE_CONFIG_VARINTS * TRACE_VARINT_MAX &&
+                   TRACE_DECODE_SLACK >= TRACE_INJECTED_SIZE + 1 + TRACE_EVENT_VARINTS * TRACE_VARINT_MAX,
+               "TRACE_DECODE_SLACK below the longest record the decoder accepts");
+
+/* Encoded config values are uint32 (at most 5 bytes) and the flags fit in 2 */
+_Static_assert(TRACE_MAX_RECORD_SIZE >= 1 + TRACE_VARINT_MAX + 2 + (TRACE_CONFIG_VARINTS - 2) * 5,
+               "TRACE_MAX_RECORD_SIZE below the longest config record");
+
+static size_t put_varint(uint8_t *out, uint64_t value)
+{
+    size_t n = 0;
+    while (value >= 0x80)
+    {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+/* Returns bytes read, 0 if truncated, -1 if longer than 64 bits (at most 10 bytes) */
+static MF_FORCE_INLINE int get_varint(const uint8_t *data, const uint8_t *end, uint64_t *value, bool checked)
+{
+    uint64_t result = 0;
+    int shift = 0;
+    const uint8_t *p = data;
+
+    while (!checked || p < end)
+    {
+        uint8_t byte = *p++;
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            *value = result;
+            return (int)(p - data);
+        }
+        shift += 7;
+        if (shift >= 64)
+            return -1;
+    }
+    return 0;
+}
+
+static uint64_t zigzag_encode(int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t zigzag_decode(uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+/* Timestamps come from one monotonic clock; a backwards step is recorded as zero */
+static uint64_t take_delta(TraceCodec *codec, uint64_t timestamp)
+{
+    uint64_t delta = timestamp > codec->last_time ? timestamp - codec->last_time : 0;
+    codec->last_time += delta;
+    return delta;
+}
+
+void trace_codec_init(TraceCodec *codec, uint64_t start_time)
+{
+    memset(codec, 0, sizeof(TraceCodec));
+    codec->last_time = start_time;
+}
+
+size_t trace_encode_event(TraceCodec *codec, uint8_t *out, const MouseEvent *event)
+{
+    size_t n = 0;
+
+    /* Injected prefix carries a zero delta; the event record holds the time */
+    if (event->is_injected)
+    {
+        out[n++] = TRACE_KIND_META | (TRACE_META_INJECTED << 3);
+        out[n++] = 0;
+    }
+
+    uint64_t delta = take_delta(codec, event->timestamp);
+    bool has_xy = event->x != codec->last_x || event->y != codec->last_y;
+    bool bit3 = event->button == MOUSE_BUTTON_WHEEL ? event->data < 0 : event->is_down;
+
+    out[n++] = (uint8_t)(event->button | (bit3 << 3) | (has_xy << 4) | ((delta & 7) << 5));
+    n += put_varint(out + n, delta >> 3);
+
+    if (has_xy)
+    {
+        n += put_varint(out + n, zigzag_encode((int64_t)event->x - codec->last_x));
+        n += put_varint(out + n, zigzag_encode((int64_t)event->y - codec->last_y));
+        codec->last_x = event->x;
+        codec->last_y = event->y;
+    }
+
+    if (event->button == MOUSE_BUTTON_WHEEL)
+    {
+        int64_t data = event->data;
+        n += put_varint(out + n, (uint64_t)(data < 0 ? -data : data));
+    }
+
+    return n;
+}
+
+size_t trace_encode_config(TraceCodec *codec, uint8_t *out, uint64_t timestamp, const DebounceConfig *config)
+{
+    size_t n = 0;
+    out[n++] = TRACE_KIND_META | (TRACE_META_CONFIG << 3);
+    n += put_varint(out + n, take_delta(codec, timestamp));
+    uint64_t flags = (config->monitored_mask & 0x3F) | ((uint64_t)config->hybrid << 6) | TRACE_CONFIG_SMART_DRAG | TRACE_CONFIG_ADAPTIVE;
+    if (config->adaptive.enabled)
+        flags |= TRACE_CONFIG_ADAPTIVE_ON;
+    n += put_varint(out + n, flags);
+    for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
+        n += put_varint(out + n, config->threshold_us[i]);
+    n += put_varint(out + n, config->smart_drag.hold_us);
+    n += put_varint(out + n, config->smart_drag.dist_sq);
+    n += put_varint(out + n, config->smart_drag.confirm_us);
+    n += put_varint(out + n, config->adaptive.min_us);
+    n += put_varint(out + n, config->adaptive.max_us);
+    return n;
+}
+
+size_t trace_encode_reset(TraceCodec *codec, uint8_t *out, uint64_t timestamp)
+{
+    size_t n = 0;
+    out[n++] = TRACE_KIND_META | (TRACE_META_RESET << 3);
+    n += put_varint(out + n, take_delta(codec, timestamp));
+    return n;
+}
+
+static MF_FORCE_INLINE int decode_record(TraceCodec *codec, const uint8_t *data, const uint8_t *end, TraceRecord *record, bool checked)
+{
+    /* Decode into a copy so a truncated record leaves the codec untouched */
+    TraceCodec state = *codec;
+    const uint8_t *p = data;
+    uint64_t value;
+    int used;
+
+    for (;;)
+    {
+        if (checked && p >= end)
+            return 0;
+
+        uint8_t tag = *p++;
+        uint8_t kind = tag & 7;
+
+        if (kind == TRACE_KIND_META)
+        {
+            uint8_t meta = tag >> 3;
+            if ((used = get_varint(p, end, &value, checked)) <= 0)
+                return used;
+            p += used;
+            state.last_time += value;
+            record->timestamp = state.last_time;
+
+            switch (meta)
+            {
+            case TRACE_META_INJECTED:
+                /* One prefix per event keeps the unchecked path inside TRACE_DECODE_SLACK */
+                if (state.next_injected)
+                    return -1;
+                state.next_injected = true;
+                continue;
+
+            case TRACE_META_CONFIG:
+                if ((used = get_varint(p, end, &value, checked)) <= 0)
+                    return used;
+                p += used;
+                record->type = TRACE_RECORD_CONFIG;
+                record->config.monitored_mask = (uint32_t)(value & 0x3F);
+                record->config.hybrid = (value >> 6) & 1;
+                bool has_drag = (value & TRACE_CONFIG_SMART_DRAG) != 0;
+                bool has_adaptive = (value & TRACE_CONFIG_ADAPTIVE) != 0;
+                record->config.adaptive.enabled = (value & TRACE_CONFIG_ADAPTIVE_ON) != 0;
+                for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
+                {
+                    if ((used = get_varint(p, end, &value, checked)) <= 0)
+                        return used;
+                    p += used;
+                    record->config.threshold_us[i] = (uint32_t)value;
+                }
+
+                /* Zero means default to debounce_set_smart_drag */
+                uint32_t drag[TRACE_DRAG_FIELDS] = {0, 0, 0};
+                for (int i = 0; has_drag && i < TRACE_DRAG_FIELDS; i++)
+                {
+                    if ((used = get_varint(p, end, &value, checked)) <= 0)
+                        return used;
+                    p += used;
+                    drag[i] = (uint32_t)value;
+                }
+                record->config.smart_drag.hold_us = drag[0];
+                record->config.smart_drag.dist_sq = drag[1];
+                record->config.smart_drag.confirm_us = drag[2];
+
+                uint32_t bounds[TRACE_ADAPTIVE_FIELDS] = {0, 0};
+                for (int i = 0; has_adaptive && i < TRACE_ADAPTIVE_FIELDS; i++)
+                {
+                    if ((used = get_varint(p, end, &value, checked)) <= 0)
+                        return used;
+                    p += used;
+                    bounds[i] = (uint32_t)value;
+                }
+                record->config.adaptive.min_us = bounds[0];
+                record->config.adaptive.max_us = bounds[1];
+                *codec = state;
+                return (int)(p - data);
+
+            case TRACE_META_RESET:
+                record->type = TRACE_RECORD_RESET;
+                *codec = state;
+                return (int)(p - data);
+
+            default:
+                return -1;
+            }
+        }
+
+        if (kind >= MOUSE_BUTTON_COUNT)
+            return -1;
+
+        if ((used = get_varint(p, end, &value, checked)) <= 0)
+            return used;
+        p += used;
+
+        MouseEvent *event = &record->event;
+        state.last_time += (value << 3) | (tag >> 5);
+        event->button = (MouseButton)kind;
+        event->timestamp = state.last_time;
+        event->is_down = kind != MOUSE_BUTTON_WHEEL && (tag & 0x08);
+        event->is_injected = state.next_injected;
+        event->data = 0;
+
+        if (tag & 0x10)
+        {
+            uint64_t dx, dy;
+            if ((used = get_varint(p, end, &dx, checked)) <= 0)
+                return used;
+            p += used;
+            if ((used = get_varint(p, end, &dy, checked)) <= 0)
+                return used;
+            p += used;
+            state.last_x += (long)zigzag_decode(dx);
+            state.last_y += (long)zigzag_decode(dy);
+        }
+        event->x = state.last_x;
+        event->y = state.last_y;
+
+        if (kind == MOUSE_BUTTON_WHEEL)
+        {
+            if ((used = get_varint(p, end, &value, checked)) <= 0)
+                return used;
+            p += used;
+            event->data = (tag & 0x08) ? -(int32_t)value : (int32_t)value;
+        }
+
+        state.next_injected = false;
+        record->type = TRACE_RECORD_EVENT;
+        record->timestamp = event->timestamp;
+        *codec = state;
+        return (int)(p - data);
+    }
+}
+
+int trace_decode_record(TraceCodec *codec, const uint8_t *data, const uint8_t *end, TraceRecord *record)
+{
+    if (end - data >= TRACE_DECODE_SLACK)
+        return decode_record(codec, data, end, record, false);
+    return decode_record(codec, data, end, record, true);
+}
+
+void trace_encode_header(uint8_t *out, uint64_t start_time)
+{
+    out[0] = TRACE_MAGIC_0;
+    out[1] = TRACE_MAGIC_1;
+    out[2] = TRACE_MAGIC_2;
+    out[3] = TRACE_MAGIC_3;
+    out[4] = TRACE_VERSION & 0xFF;
+    out[5] = TRACE_VERSION >> 8;
+    out[6] = TRACE_HEADER_SIZE;
+    out[7] = 0;
+    for (int i = 0; i < 8; i++)
+        out[8 + i] = (uint8_t)(start_time >> (8 * i));
+}
+
+bool trace_decode_header(const uint8_t *data, size_t size, uint64_t *start_time)
+{
+    if (size < TRACE_HEADER_SIZE)
+        return false;
+    if (data[0] != TRACE_MAGIC_0 || data[1] != TRACE_MAGIC_1 || data[2] != TRACE_MAGIC_2 || data[3] != TRACE_MAGIC_3)
+        return false;
+    if ((data[4] | (data[5] << 8)) != TRACE_VERSION || data[6] != TRACE_HEADER_SIZE || data[7] != 0)
+        return false;
+
+    uint64_t time = 0;
+    for (int i = 0; i < 8; i++)
+        time |= (uint64_t)data[8 + i] << (8 * i);
+    *start_time = time;
+    return true;
+}
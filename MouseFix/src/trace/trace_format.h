@@ -0,0 +1,105 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../core/debouncer.h"
+
+/*
+ * MouseFix input trace format, version 1
+ *
+ * File header (16 bytes, little endian):
+ *   char     magic[4]     "MFTR"
+ *   uint16_t version      TRACE_VERSION
+ *   uint16_t header_size  16
+ *   uint64_t start_time   microseconds, base for the first record delta
+ *
+ * Records follow back to back. Every record starts with a tag byte and
+ * carries the time since the previous record in microseconds:
+ *
+ *   Button / wheel record (tag bits 0-2 = MouseButton 0..5)
+ *     bit 3     is_down for buttons, negative delta for the wheel
+ *     bit 4     has_xy: zigzag varint dx, dy from the previous point follow
+ *     bits 5-7  low 3 bits of the time delta
+ *     varint    time delta >> 3
+ *     [varint dx, varint dy]   when has_xy
+ *     [varint |wheel delta|]   wheel only
+ *
+ *   Meta record (tag bits 0-2 = TRACE_KIND_META, bits 3-7 = TraceMetaType)
+ *     varint    time delta
+ *     payload   depends on the meta type
+ *
+ * A click that does not move the pointer costs 3 bytes for gaps under
+ * ~131ms and 4 bytes up to ~16s. Deferred releases are not recorded: the
+ * replayer fires them at the engine's own deadlines.
+ */
+
+#define TRACE_MAGIC_0 'M'
+#define TRACE_MAGIC_1 'F'
+#define TRACE_MAGIC_2 'T'
+#define TRACE_MAGIC_3 'R'
+#define TRACE_VERSION 1
+#define TRACE_HEADER_SIZE 16
+
+/* Upper bound of one encoded record (a config record: tag, time, flags and 11 uint32 varints) */
+#define TRACE_MAX_RECORD_SIZE 80
+
+#define TRACE_KIND_META 6
+
+typedef enum
+{
+    TRACE_META_INJECTED = 0, /* next event record is injected; no payload */
+    TRACE_META_CONFIG,       /* varint flags (monitored mask | hybrid << 6 | TRACE_CONFIG_*),
+                                6 varint thresholds in us, then when flagged varint hold us,
+                                distance squared and confirm us, then when flagged varint
+                                adaptive min us and max us */
+    TRACE_META_RESET         /* debounce_reset_statistics; no payload */
+} TraceMetaType;
+
+/* Config flag: Smart Drag tuning follows the thresholds (absent in older traces) */
+#define TRACE_CONFIG_SMART_DRAG 0x80
+/* Config flags: adaptive threshold bounds follow, and whether adaptation is on */
+#define TRACE_CONFIG_ADAPTIVE    0x100
+#define TRACE_CONFIG_ADAPTIVE_ON 0x200
+
+typedef enum
+{
+    TRACE_RECORD_EVENT = 0,
+    TRACE_RECORD_CONFIG,
+    TRACE_RECORD_RESET
+} TraceRecordType;
+
+/* One decoded record */
+typedef struct
+{
+    TraceRecordType type;
+    uint64_t timestamp;
+    MouseEvent event;
+    DebounceConfig config;
+} TraceRecord;
+
+/* Delta-coding state, one per direction (writer or reader) */
+typedef struct
+{
+    uint64_t last_time;
+    long last_x;
+    long last_y;
+    bool next_injected;
+} TraceCodec;
+
+void trace_codec_init(TraceCodec *codec, uint64_t start_time);
+
+/* Encoders return the number of bytes written to out (at most TRACE_MAX_RECORD_SIZE) */
+size_t trace_encode_event(TraceCodec *codec, uint8_t *out, const MouseEvent *event);
+size_t trace_encode_config(TraceCodec *codec, uint8_t *out, uint64_t timestamp, const DebounceConfig *config);
+size_t trace_encode_reset(TraceCodec *codec, uint8_t *out, uint64_t timestamp);
+
+/*
+ * Decode one record from [data, end). Returns the number of bytes consumed,
+ * 0 if the buffer ends mid-record, or -1 if the data is malformed.
+ * TRACE_META_INJECTED prefixes are folded into the following event.
+ */
+int trace_decode_record(TraceCodec *codec, const uint8_t *data, const uint8_t *end, TraceRecord *record);
+
+void trace_encode_header(uint8_t *out, uint64_t start_time);
+bool trace_decode_header(const uint8_t *data, size_t size, uint64_t *start_time);
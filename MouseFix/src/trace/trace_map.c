@@ -0,0 +1,217 @@
+#include "trace_map.h"
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* Consumed bytes handed back to the OS at a time */
+#define TRACE_MAP_RELEASE_CHUNK ((size_t)16 * 1024 * 1024)
+
+/* Events decoded per trace_replayer_apply_packed call */
+#define TRACE_MAP_BATCH 256
+
+static void unmap_window(TraceMap *map)
+{
+    if (!map->base)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(map->base);
+#else
+    munmap((void *)map->base, map->mapped);
+#endif
+    map->base = NULL;
+    map->mapped = 0;
+}
+
+/* Map the window starting at the aligned offset at or below file_offset */
+static bool map_window(TraceMap *map, uint64_t file_offset)
+{
+    uint64_t offset = file_offset & ~(uint64_t)(TRACE_MAP_ALIGN - 1);
+    uint64_t length = map->file_size - offset;
+    if (length > map->window_size)
+        length = map->window_size;
+
+    unmap_window(map);
+
+#ifdef _WIN32
+    void *base = MapViewOfFile(map->mapping, FILE_MAP_READ, (DWORD)(offset >> 32), (DWORD)offset, (SIZE_T)length);
+    if (!base)
+        return false;
+#else
+    void *base = mmap(NULL, (size_t)length, PROT_READ, MAP_PRIVATE, map->fd, (off_t)offset);
+    if (base == MAP_FAILED)
+        return false;
+    madvise(base, (size_t)length, MADV_SEQUENTIAL);
+#endif
+
+    map->base = base;
+    map->mapped = (size_t)length;
+    map->base_offset = offset;
+    map->pos = map->base + (file_offset - offset);
+    map->released = map->base;
+    return true;
+}
+
+/* Drop already decoded pages from the process so RSS stays bounded on huge traces */
+static void release_consumed(TraceMap *map)
+{
+#ifdef _WIN32
+    (void)map; /* Windows trims mapped views from the working set on its own */
+#else
+    size_t consumed = (size_t)(map->pos - map->released);
+    if (consumed < TRACE_MAP_RELEASE_CHUNK)
+        return;
+
+    consumed &= ~(TRACE_MAP_ALIGN - 1);
+    madvise((void *)map->released, consumed, MADV_DONTNEED);
+    map->released += consumed;
+#endif
+}
+
+bool trace_map_open(TraceMap *map, const char *path, size_t window_size)
+{
+    if (!map || !path)
+        return false;
+
+    memset(map, 0, sizeof(TraceMap));
+#ifndef _WIN32
+    map->fd = -1;
+#endif
+    if (window_size == 0)
+        window_size = TRACE_MAP_DEFAULT_WINDOW;
+    /* At least one aligned step plus a full record, so every remap advances */
+    if (window_size < 2 * TRACE_MAP_ALIGN)
+        window_size = 2 * TRACE_MAP_ALIGN;
+    map->window_size = (window_size + TRACE_MAP_ALIGN - 1) & ~(TRACE_MAP_ALIGN - 1);
+
+#ifdef _WIN32
+    /* FILE_SHARE_WRITE so a trace still being recorded can be inspected */
+    map->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (map->file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(map->file, &size) || size.QuadPart < TRACE_HEADER_SIZE)
+    {
+        CloseHandle(map->file);
+        return false;
+    }
+    map->file_size = (uint64_t)size.QuadPart;
+
+    map->mapping = CreateFileMappingA(map->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!map->mapping)
+    {
+        CloseHandle(map->file);
+        return false;
+    }
+#else
+    map->fd = open(path, O_RDONLY);
+    if (map->fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(map->fd, &st) != 0 || st.st_size < TRACE_HEADER_SIZE)
+    {
+        close(map->fd);
+        return false;
+    }
+    map->file_size = (uint64_t)st.st_size;
+    posix_fadvise(map->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    if (!map_window(map, 0) || !trace_decode_header(map->base, map->mapped, &map->start_time))
+    {
+        trace_map_close(map);
+        return false;
+    }
+
+    map->pos += TRACE_HEADER_SIZE;
+    trace_codec_init(&map->codec, map->start_time);
+    return true;
+}
+
+void trace_map_close(TraceMap *map)
+{
+    if (!map)
+        return;
+
+    unmap_window(map);
+#ifdef _WIN32
+    if (map->mapping)
+        CloseHandle(map->mapping);
+    if (map->file && map->file != INVALID_HANDLE_VALUE)
+        CloseHandle(map->file);
+    map->mapping = NULL;
+    map->file = NULL;
+#else
+    if (map->fd >= 0)
+        close(map->fd);
+    map->fd = -1;
+#endif
+}
+
+int trace_map_next(TraceMap *map, TraceRecord *record)
+{
+    if (!map || !map->base || !record)
+        return -1;
+
+    for (;;)
+    {
+        int used = trace_decode_record(&map->codec, map->pos, map->base + map->mapped, record);
+        if (used > 0)
+        {
+            map->pos += used;
+            release_consumed(map);
+            return 1;
+        }
+        if (used < 0)
+            return -1;
+
+        /* Record runs past the window: slide it forward, or stop at end of file */
+        uint64_t offset = trace_map_tell(map);
+        if (map->base_offset + map->mapped >= map->file_size)
+            return offset == map->file_size ? 0 : -1;
+        if (!map_window(map, offset))
+            return -1;
+    }
+}
+
+uint64_t trace_map_tell(const TraceMap *map)
+{
+    return map->base_offset + (uint64_t)(map->pos - map->base);
+}
+
+int trace_map_replay(TraceMap *map, TraceReplayer *replayer)
+{
+    PackedEvent events[TRACE_MAP_BATCH];
+    size_t count = 0;
+    TraceRecord record;
+    int status;
+
+    while ((status = trace_map_next(map, &record)) == 1)
+    {
+        if (record.type == TRACE_RECORD_EVENT)
+        {
+            events[count++] = mouse_event_pack(&record.event);
+            if (count == TRACE_MAP_BATCH)
+            {
+                trace_replayer_apply_packed(replayer, events, count);
+                count = 0;
+            }
+            continue;
+        }
+
+        /* Config and reset records apply between events, in order */
+        trace_replayer_apply_packed(replayer, events, count);
+        count = 0;
+        trace_replayer_apply(replayer, &record);
+    }
+
+    trace_replayer_apply_packed(replayer, events, count);
+    return status < 0 ? -1 : 0;
+}
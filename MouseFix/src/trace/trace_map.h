@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "trace_format.h"
+#include "trace_replay.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+/*
+ * Memory-mapped trace reader.
+ *
+ * Records are decoded in place from a read-only mapping, with no stdio
+ * buffer in between. The file is mapped through a sliding window
+ * (TRACE_MAP_DEFAULT_WINDOW by default), so traces larger than RAM or than
+ * the address space of a 32-bit build work. Windows slide over each other
+ * by at most one record so nothing straddles a boundary. Pages behind the
+ * read position are handed back to the OS as the reader advances.
+ */
+
+#define TRACE_MAP_DEFAULT_WINDOW ((size_t)256 * 1024 * 1024)
+/* Mapping offsets are multiples of this (Windows allocation granularity) */
+#define TRACE_MAP_ALIGN ((size_t)64 * 1024)
+
+typedef struct
+{
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int fd;
+#endif
+    uint64_t file_size;
+    size_t window_size;
+
+    /* Current window: [base, base + mapped) at file offset base_offset */
+    const uint8_t *base;
+    size_t mapped;
+    uint64_t base_offset;
+    const uint8_t *pos;
+    const uint8_t *released; /* pages before this were handed back */
+
+    TraceCodec codec;
+    uint64_t start_time;
+} TraceMap;
+
+/* window_size 0 selects TRACE_MAP_DEFAULT_WINDOW; it is rounded up to TRACE_MAP_ALIGN */
+bool trace_map_open(TraceMap *map, const char *path, size_t window_size);
+void trace_map_close(TraceMap *map);
+
+/* Returns 1 and fills record, 0 at a clean end of trace, -1 on malformed or truncated data */
+int trace_map_next(TraceMap *map, TraceRecord *record);
+
+/* File offset of the next record */
+uint64_t trace_map_tell(const TraceMap *map);
+
+/*
+ * Replays the rest of the trace, decoding events into a small stack batch
+ * of PackedEvent and handing them to trace_replayer_apply_packed. Returns 0 at a clean
+ * end of trace or -1 on malformed data.
+ */
+int trace_map_replay(TraceMap *map, TraceReplayer *replayer);
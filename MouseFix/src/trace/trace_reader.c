@@ -0,0 +1,85 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "trace_reader.h"
+#include <string.h>
+
+/* Move the unread tail to the front and top the buffer up */
+static void refill(TraceReader *reader)
+{
+    size_t remaining = reader->size - reader->pos;
+    memmove(reader->buffer, reader->buffer + reader->pos, remaining);
+    reader->pos = 0;
+    reader->size = remaining;
+
+    size_t n = fread(reader->buffer + remaining, 1, TRACE_READER_BUFFER_SIZE - remaining, reader->file);
+    reader->size += n;
+    if (reader->size < TRACE_READER_BUFFER_SIZE)
+        reader->eof = true;
+}
+
+bool trace_reader_open(TraceReader *reader, const char *path)
+{
+    if (!reader || !path)
+        return false;
+
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return false;
+
+    return trace_reader_open_file(reader, file);
+}
+
+bool trace_reader_open_file(TraceReader *reader, FILE *file)
+{
+    if (!reader || !file)
+        return false;
+
+    reader->file = file;
+    reader->pos = 0;
+    reader->size = 0;
+    reader->eof = false;
+    refill(reader);
+
+    if (!trace_decode_header(reader->buffer, reader->size, &reader->start_time))
+    {
+        fclose(file);
+        reader->file = NULL;
+        return false;
+    }
+
+    reader->pos = TRACE_HEADER_SIZE;
+    trace_codec_init(&reader->codec, reader->start_time);
+    return true;
+}
+
+int trace_reader_next(TraceReader *reader, TraceRecord *record)
+{
+    if (!reader || !reader->file || !record)
+        return -1;
+
+    for (;;)
+    {
+        const uint8_t *data = reader->buffer + reader->pos;
+        int used = trace_decode_record(&reader->codec, data, reader->buffer + reader->size, record);
+        if (used > 0)
+        {
+            reader->pos += used;
+            return 1;
+        }
+        if (used < 0)
+            return -1;
+
+        /* Incomplete record: read more, or report a truncated tail */
+        if (reader->eof)
+            return reader->pos == reader->size ? 0 : -1;
+        refill(reader);
+    }
+}
+
+void trace_reader_close(TraceReader *reader)
+{
+    if (!reader || !reader->file)
+        return;
+
+    fclose(reader->file);
+    reader->file = NULL;
+}
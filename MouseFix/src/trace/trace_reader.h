@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "trace_format.h"
+
+#define TRACE_READER_BUFFER_SIZE (64 * 1024)
+
+/* Streaming trace reader over stdio */
+typedef struct
+{
+    FILE *file;
+    TraceCodec codec;
+    uint64_t start_time;
+    size_t pos;
+    size_t size;
+    bool eof;
+    uint8_t buffer[TRACE_READER_BUFFER_SIZE];
+} TraceReader;
+
+bool trace_reader_open(TraceReader *reader, const char *path);
+/* Takes ownership of file; it is closed by trace_reader_close */
+bool trace_reader_open_file(TraceReader *reader, FILE *file);
+
+/* Returns 1 and fills record, 0 at a clean end of trace, -1 on malformed or truncated data */
+int trace_reader_next(TraceReader *reader, TraceRecord *record);
+void trace_reader_close(TraceReader *reader);
@@ -0,0 +1,137 @@
+#include "trace_replay.h"
+#include <string.h>
+
+#define TRACE_REPLAY_BATCH 256
+
+/* Fire deferred releases whose deadline is at or before now */
+static void run_releases(TraceReplayer *replayer, uint64_t now)
+{
+    uint64_t deadline;
+
+    while (debounce_get_next_deadline(replayer->manager, &deadline) && deadline <= now)
+    {
+        uint32_t mask = debounce_collect_deferred_releases(replayer->manager, deadline);
+        for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
+        {
+            if (!(mask & (1u << i)))
+                continue;
+            replayer->stats.releases++;
+            if (replayer->callbacks.on_release)
+                replayer->callbacks.on_release(i, deadline, replayer->callbacks.user_data);
+        }
+    }
+}
+
+void trace_replayer_init(TraceReplayer *replayer, DebounceManager *manager, const TraceReplayCallbacks *callbacks)
+{
+    memset(replayer, 0, sizeof(TraceReplayer));
+    replayer->manager = manager;
+    if (callbacks)
+        replayer->callbacks = *callbacks;
+}
+
+void trace_replayer_apply(TraceReplayer *replayer, const TraceRecord *record)
+{
+    if (!replayer || !record)
+        return;
+
+    run_releases(replayer, record->timestamp);
+
+    switch (record->type)
+    {
+    case TRACE_RECORD_EVENT:
+    {
+        bool blocked = debounce_process_event(replayer->manager, &record->event);
+        replayer->stats.events++;
+        if (blocked)
+            replayer->stats.blocked++;
+        if (replayer->callbacks.on_event)
+            replayer->callbacks.on_event(&record->event, blocked, replayer->callbacks.user_data);
+        break;
+    }
+
+    case TRACE_RECORD_CONFIG:
+        debounce_set_config(replayer->manager, &record->config);
+        replayer->stats.configs++;
+        break;
+
+    case TRACE_RECORD_RESET:
+        debounce_reset_statistics(replayer->manager);
+        replayer->stats.resets++;
+        break;
+    }
+}
+
+void trace_replayer_apply_packed(TraceReplayer *replayer, const PackedEvent *events, size_t count)
+{
+    if (!replayer || !events)
+        return;
+
+    bool verdicts[TRACE_REPLAY_BATCH];
+    bool hybrid = debounce_get_hybrid_heuristic(replayer->manager);
+    SmartDragParams drag;
+    debounce_get_smart_drag(replayer->manager, &drag);
+    size_t done = 0;
+
+    while (done < count)
+    {
+        run_releases(replayer, packed_event_time(&events[done]));
+
+        /*
+         * Only a button UP can start a confirm window, and its release is
+         * due CONFIRM_TIMEOUT later at the earliest. The span runs until
+         * then or until an already pending deadline, whichever comes first.
+         */
+        uint64_t limit = UINT64_MAX;
+        debounce_get_next_deadline(replayer->manager, &limit);
+
+        size_t n = 0;
+        while (done + n < count && n < TRACE_REPLAY_BATCH && packed_event_time(&events[done + n]) < limit)
+        {
+            const PackedEvent *event = &events[done + n++];
+            uint64_t timestamp = packed_event_time(event);
+            if (hybrid && packed_event_button(event) != MOUSE_BUTTON_WHEEL && !packed_event_is_down(event) &&
+                timestamp + drag.confirm_us < limit)
+                limit = timestamp + drag.confirm_us;
+        }
+
+        size_t blocked = debounce_process_packed_batch(replayer->manager, events + done, n, verdicts);
+        replayer->stats.events += n;
+        replayer->stats.blocked += blocked;
+
+        if (replayer->callbacks.on_event)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                MouseEvent event;
+                mouse_event_unpack(&events[done + i], &event);
+                replayer->callbacks.on_event(&event, verdicts[i], replayer->callbacks.user_data);
+            }
+        }
+        done += n;
+    }
+}
+
+void trace_replayer_apply_events(TraceReplayer *replayer, const MouseEvent *events, size_t count)
+{
+    if (!replayer || !events)
+        return;
+
+    PackedEvent packed[TRACE_REPLAY_BATCH];
+    for (size_t done = 0; done < count;)
+    {
+        size_t n = count - done < TRACE_REPLAY_BATCH ? count - done : TRACE_REPLAY_BATCH;
+        for (size_t i = 0; i < n; i++)
+            packed[i] = mouse_event_pack(&events[done + i]);
+        trace_replayer_apply_packed(replayer, packed, n);
+        done += n;
+    }
+}
+
+void trace_replayer_finish(TraceReplayer *replayer)
+{
+    if (!replayer)
+        return;
+
+    run_releases(replayer, UINT64_MAX);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "../core/debouncer.h"
+#include "trace_format.h"
+
+/*
+ * Deterministic replay of trace records through a DebounceManager.
+ *
+ * Events go through debounce_process_event exactly as the hook delivered
+ * them. Deferred Smart Drag releases are fired at the engine's own
+ * deadlines (debounce_get_next_deadline) before any later record is
+ * applied, i.e. as an ideal, zero-lateness release scheduler would.
+ */
+
+typedef struct
+{
+    /* Called for each replayed event with the engine's verdict */
+    void (*on_event)(const MouseEvent *event, bool blocked, void *user_data);
+    /* Called for each deferred release, at its deadline */
+    void (*on_release)(MouseButton button, uint64_t timestamp, void *user_data);
+    void *user_data;
+} TraceReplayCallbacks;
+
+typedef struct
+{
+    uint64_t events;
+    uint64_t blocked;
+    uint64_t releases;
+    uint64_t configs;
+    uint64_t resets;
+} TraceReplayStats;
+
+typedef struct
+{
+    DebounceManager *manager;
+    TraceReplayCallbacks callbacks;
+    TraceReplayStats stats;
+} TraceReplayer;
+
+/* callbacks may be NULL */
+void trace_replayer_init(TraceReplayer *replayer, DebounceManager *manager, const TraceReplayCallbacks *callbacks);
+void trace_replayer_apply(TraceReplayer *replayer, const TraceRecord *record);
+/*
+ * Equivalent to trace_replayer_apply on each event in turn, but runs the
+ * events through debounce_process_batch in spans that no deferred release
+ * can fall inside of.
+ */
+void trace_replayer_apply_events(TraceReplayer *replayer, const MouseEvent *events, size_t count);
+/* The same over PackedEvent batches; on_event still receives unpacked events */
+void trace_replayer_apply_packed(TraceReplayer *replayer, const PackedEvent *events, size_t count);
+/* Fire every release still pending at the end of the trace */
+void trace_replayer_finish(TraceReplayer *replayer);
@@ -0,0 +1,119 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "trace_writer.h"
+#include <string.h>
+
+static void reserve(TraceWriter *writer)
+{
+    if (writer->used + TRACE_MAX_RECORD_SIZE > TRACE_WRITER_BUFFER_SIZE)
+        trace_writer_flush(writer);
+}
+
+bool trace_writer_open(TraceWriter *writer, const char *path, uint64_t start_time)
+{
+    if (!writer || !path)
+        return false;
+
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return false;
+
+    return trace_writer_open_file(writer, file, start_time);
+}
+
+bool trace_writer_open_file(TraceWriter *writer, FILE *file, uint64_t start_time)
+{
+    if (!writer || !file)
+        return false;
+
+    writer->file = file;
+    writer->used = 0;
+    writer->bytes_written = 0;
+    writer->events = 0;
+    writer->failed = false;
+    trace_codec_init(&writer->codec, start_time);
+
+    trace_encode_header(writer->buffer, start_time);
+    writer->used = TRACE_HEADER_SIZE;
+    return true;
+}
+
+void trace_writer_event(TraceWriter *writer, const MouseEvent *event)
+{
+    if (!writer || !writer->file || !event)
+        return;
+
+    reserve(writer);
+    writer->used += trace_encode_event(&writer->codec, writer->buffer + writer->used, event);
+    writer->events++;
+}
+
+void trace_writer_packed_event(TraceWriter *writer, const PackedEvent *event)
+{
+    if (!event)
+        return;
+
+    MouseEvent unpacked;
+    mouse_event_unpack(event, &unpacked);
+    trace_writer_event(writer, &unpacked);
+}
+
+void trace_writer_config(TraceWriter *writer, uint64_t timestamp, const DebounceConfig *config)
+{
+    if (!writer || !writer->file || !config)
+        return;
+
+    reserve(writer);
+    writer->used += trace_encode_config(&writer->codec, writer->buffer + writer->used, timestamp, config);
+}
+
+void trace_writer_reset(TraceWriter *writer, uint64_t timestamp)
+{
+    if (!writer || !writer->file)
+        return;
+
+    reserve(writer);
+    writer->used += trace_encode_reset(&writer->codec, writer->buffer + writer->used, timestamp);
+}
+
+bool trace_writer_flush(TraceWriter *writer)
+{
+    if (!writer || !writer->file)
+        return false;
+
+    if (writer->used > 0)
+    {
+        /* A failed write drops the chunk; the trace stays decodable up to it */
+        if (!writer->failed && fwrite(writer->buffer, 1, writer->used, writer->file) != writer->used)
+            writer->failed = true;
+        if (!writer->failed)
+            writer->bytes_written += writer->used;
+        writer->used = 0;
+    }
+    return !writer->failed;
+}
+
+bool trace_writer_close(TraceWriter *writer)
+{
+    if (!writer || !writer->file)
+        return false;
+
+    bool ok = trace_writer_flush(writer);
+    if (fclose(writer->file) != 0)
+        ok = false;
+    writer->file = NULL;
+    return ok;
+}
+
+static bool sink_flush(const PackedEvent *events, size_t count, void *user_data)
+{
+    TraceWriter *writer = (TraceWriter *)user_data;
+    for (size_t i = 0; i < count; i++)
+        trace_writer_packed_event(writer, &events[i]);
+    return !writer->failed;
+}
+
+OutputSink trace_writer_sink(TraceWriter *writer)
+{
+    OutputSink sink = {sink_flush, writer};
+    return sink;
+}
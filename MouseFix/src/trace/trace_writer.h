@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "trace_format.h"
+#include "../core/output_sink.h"
+
+#define TRACE_WRITER_BUFFER_SIZE (64 * 1024)
+
+/*
+ * Buffered trace writer. Records are encoded straight into an in-memory
+ * buffer and written out in 64KB chunks, so the per-event cost is the
+ * encoding itself. Not thread-safe: one thread at a time; MouseFix opens
+ * it before event_tap_start and closes it after event_tap_stop, and writes
+ * only from the tap consumer.
+ */
+typedef struct
+{
+    FILE *file;
+    TraceCodec codec;
+    size_t used;
+    uint64_t bytes_written;
+    uint64_t events;
+    bool failed;
+    uint8_t buffer[TRACE_WRITER_BUFFER_SIZE];
+} TraceWriter;
+
+bool trace_writer_open(TraceWriter *writer, const char *path, uint64_t start_time);
+/* Takes ownership of file; it is closed by trace_writer_close */
+bool trace_writer_open_file(TraceWriter *writer, FILE *file, uint64_t start_time);
+void trace_writer_event(TraceWriter *writer, const MouseEvent *event);
+void trace_writer_packed_event(TraceWriter *writer, const PackedEvent *event);
+void trace_writer_config(TraceWriter *writer, uint64_t timestamp, const DebounceConfig *config);
+void trace_writer_reset(TraceWriter *writer, uint64_t timestamp);
+bool trace_writer_flush(TraceWriter *writer);
+bool trace_writer_close(TraceWriter *writer);
+
+/* Records a batch's events into writer; fails once the writer has. Same thread rules as the writer */
+OutputSink trace_writer_sink(TraceWriter *writer);
@@ -0,0 +1,274 @@
+#include "algo_compare.h"
+#include "tune_pool.h"
+#include "../trace/trace_map.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* One candidate on one button: the filter and the scoring state around it */
+typedef struct
+{
+    DebounceFilter filter;
+    uint64_t last_up;      /* switch */
+    uint64_t genuine_down; /* latest genuine DOWN still waiting for its press, 0 when none */
+    uint64_t first_up;     /* first UP since the output press, 0 when none */
+} AlgoLane;
+
+typedef struct
+{
+    AlgoLane *lanes;  /* [candidate][button] */
+    AlgoStats *stats; /* this worker's [candidate][button] */
+    uint64_t events;
+    size_t failed_traces;
+} AlgoWorker;
+
+typedef struct
+{
+    const AlgoJob *job;
+    AlgoWorker *workers;
+} AlgoContext;
+
+static void on_output(AlgoLane *lane, AlgoStats *stats, bool down, uint64_t at)
+{
+    if (down)
+    {
+        if (lane->genuine_down != 0)
+            latency_histogram_record(&stats->press_us, at - lane->genuine_down);
+        else
+            stats->passed++;
+        lane->genuine_down = 0;
+        lane->first_up = 0;
+        return;
+    }
+
+    if (lane->first_up != 0)
+        latency_histogram_record(&stats->release_us, at - lane->first_up);
+    lane->first_up = 0;
+}
+
+/* Output changes due before now, at their own times */
+static void drain(AlgoLane *lane, AlgoStats *stats, uint64_t now)
+{
+    uint64_t deadline;
+    bool down;
+    while (debounce_filter_deadline(&lane->filter, &deadline) && deadline <= now)
+    {
+        debounce_filter_advance(&lane->filter, deadline, &down);
+        on_output(lane, stats, down, deadline);
+    }
+}
+
+static void replay_edge(AlgoLane *lane, AlgoStats *stats, const MouseEvent *event, uint32_t bounce_us)
+{
+    uint64_t now = event->timestamp;
+    drain(lane, stats, now);
+
+    if (event->is_down)
+    {
+        if (lane->last_up != 0 && now - lane->last_up < bounce_us)
+        {
+            stats->bounces++;
+        }
+        else
+        {
+            stats->genuine++;
+            if (lane->genuine_down != 0)
+                stats->suppressed++;
+            lane->genuine_down = now;
+        }
+    }
+    else
+    {
+        lane->last_up = now;
+        if (lane->first_up == 0)
+            lane->first_up = now;
+    }
+
+    if (debounce_filter_edge(&lane->filter, event->is_down, now))
+        on_output(lane, stats, event->is_down, now);
+}
+
+static void run_task(size_t task, int worker_index, void *context)
+{
+    AlgoContext *ctx = (AlgoContext *)context;
+    const AlgoJob *job = ctx->job;
+    AlgoWorker *worker = &ctx->workers[worker_index];
+
+    TraceMap map;
+    if (!trace_map_open(&map, job->traces[task], 0))
+    {
+        worker->failed_traces++;
+        return;
+    }
+
+    for (size_t c = 0; c < job->candidate_count; c++)
+    {
+        for (int b = 0; b < MOUSE_BUTTON_COUNT; b++)
+        {
+            AlgoLane *lane = &worker->lanes[c * MOUSE_BUTTON_COUNT + b];
+            memset(lane, 0, sizeof(AlgoLane));
+            debounce_filter_init(&lane->filter, &job->candidates[c]);
+        }
+    }
+
+    TraceRecord record;
+    int status;
+    uint64_t replayed = 0;
+    while ((status = trace_map_next(&map, &record)) == 1)
+    {
+        const MouseEvent *event = &record.event;
+        /* Config and reset records belong to the engine, not to these filters */
+        if (record.type != TRACE_RECORD_EVENT || event->is_injected || (unsigned)event->button >= MOUSE_BUTTON_WHEEL)
+            continue;
+
+        for (size_t c = 0; c < job->candidate_count; c++)
+        {
+            size_t cell = c * MOUSE_BUTTON_COUNT + event->button;
+            replay_edge(&worker->lanes[cell], &worker->stats[cell], event, job->bounce_us);
+        }
+        replayed++;
+    }
+    trace_map_close(&map);
+
+    /* Whatever is still pending happens; a genuine DOWN still waiting never got its press */
+    size_t cells = job->candidate_count * MOUSE_BUTTON_COUNT;
+    for (size_t cell = 0; cell < cells; cell++)
+    {
+        AlgoLane *lane = &worker->lanes[cell];
+        drain(lane, &worker->stats[cell], UINT64_MAX);
+        worker->stats[cell].suppressed += lane->genuine_down != 0;
+    }
+
+    worker->events += replayed;
+    if (status < 0)
+        worker->failed_traces++;
+}
+
+void algo_stats_merge(AlgoStats *dst, const AlgoStats *src)
+{
+    if (!dst || !src)
+        return;
+
+    dst->genuine += src->genuine;
+    dst->suppressed += src->suppressed;
+    dst->bounces += src->bounces;
+    dst->passed += src->passed;
+
+    /* The workers have finished, so plain sums are fine */
+    LatencyHistogram *d[2] = {&dst->press_us, &dst->release_us};
+    const LatencyHistogram *s[2] = {&src->press_us, &src->release_us};
+    for (int h = 0; h < 2; h++)
+    {
+        for (int i = 0; i < LATENCY_BUCKET_COUNT; i++)
+            d[h]->counts[i] += s[h]->counts[i];
+        d[h]->total += s[h]->total;
+        if (s[h]->max > d[h]->max)
+            d[h]->max = s[h]->max;
+    }
+}
+
+bool algo_compare_run(const AlgoJob *job, AlgoResults *results)
+{
+    if (!job || !results || !job->traces || !job->candidates || job->candidate_count == 0)
+        return false;
+
+    memset(results, 0, sizeof(AlgoResults));
+    size_t cells = job->candidate_count * MOUSE_BUTTON_COUNT;
+    results->stats = calloc(cells, sizeof(AlgoStats));
+    if (!results->stats)
+        return false;
+
+    int worker_count = job->workers > 0 ? job->workers : mf_cpu_count();
+    if (job->trace_count < (size_t)worker_count)
+        worker_count = job->trace_count > 0 ? (int)job->trace_count : 1;
+
+    AlgoContext ctx;
+    ctx.job = job;
+    ctx.workers = calloc((size_t)worker_count, sizeof(AlgoWorker));
+    bool ok = ctx.workers != NULL;
+
+    for (int w = 0; ok && w < worker_count; w++)
+    {
+        ctx.workers[w].lanes = calloc(cells, sizeof(AlgoLane));
+        ctx.workers[w].stats = calloc(cells, sizeof(AlgoStats));
+        ok = ctx.workers[w].lanes && ctx.workers[w].stats;
+    }
+
+    if (ok)
+        ok = tune_pool_run(job->trace_count, worker_count, run_task, &ctx);
+
+    for (int w = 0; ctx.workers && w < worker_count; w++)
+    {
+        AlgoWorker *worker = &ctx.workers[w];
+        if (ok)
+        {
+            for (size_t i = 0; i < cells; i++)
+                algo_stats_merge(&results->stats[i], &worker->stats[i]);
+            results->events += worker->events;
+            results->failed_traces += worker->failed_traces;
+        }
+        free(worker->lanes);
+        free(worker->stats);
+    }
+
+    free(ctx.workers);
+    if (!ok)
+        algo_results_free(results);
+    return ok;
+}
+
+void algo_results_free(AlgoResults *results)
+{
+    if (!results)
+        return;
+
+    free(results->stats);
+    results->stats = NULL;
+}
+
+const AlgoStats *algo_stats_at(const AlgoJob *job, const AlgoResults *results, size_t candidate, MouseButton button)
+{
+    if (!job || !results || !results->stats || candidate >= job->candidate_count ||
+        (unsigned)button >= MOUSE_BUTTON_COUNT)
+        return NULL;
+
+    return &results->stats[candidate * MOUSE_BUTTON_COUNT + button];
+}
+
+uint64_t algo_stats_latency(const AlgoStats *stats)
+{
+    uint64_t press = latency_histogram_percentile(&stats->press_us, 0.99);
+    uint64_t release = latency_histogram_percentile(&stats->release_us, 0.99);
+    return press > release ? press : release;
+}
+
+bool algo_stats_within(const AlgoStats *stats, double max_pass, double max_suppress)
+{
+    if (stats->bounces && (double)stats->passed > max_pass * (double)stats->bounces)
+        return false;
+    return !stats->genuine || (double)stats->suppressed <= max_suppress * (double)stats->genuine;
+}
+
+size_t algo_compare_pick(const AlgoJob *job, const AlgoResults *results, MouseButton button, double max_pass,
+                         double max_suppress)
+{
+    size_t best = job ? job->candidate_count : 0;
+    uint64_t best_latency = 0;
+
+    for (size_t c = 0; job && c < job->candidate_count; c++)
+    {
+        const AlgoStats *s = algo_stats_at(job, results, c, button);
+        if (!s)
+            break;
+        if (!algo_stats_within(s, max_pass, max_suppress))
+            continue;
+
+        uint64_t latency = algo_stats_latency(s);
+        /* Ties go to the candidate listed first */
+        if (best == job->candidate_count || latency < best_latency)
+        {
+            best = c;
+            best_latency = latency;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../core/debounce_algo.h"
+#include "../core/latency_histogram.h"
+#include "../core/mouse_event.h"
+
+/*
+ * Replays recorded traces through candidate debounce algorithms
+ * (src/core/debounce_algo.h) and measures what each costs and catches,
+ * per button. Wheel events are left out because the algorithms are for
+ * buttons.
+ *
+ * Edges are labelled as in tune.h: a DOWN less than bounce_us after the
+ * button's previous UP is a bounce, every other DOWN is genuine. An
+ * output press is credited to the latest genuine DOWN that has not
+ * produced one yet, and its added latency is the time from that DOWN. An
+ * output press with no such DOWN is a bounce let through (false pass). A
+ * genuine DOWN that never produces a press before the next genuine DOWN,
+ * or before the end of the trace, is suppressed (false block). An output
+ * release adds the time from the first UP since the output press.
+ *
+ * One trace is one task on the tuning pool; workers accumulate into their
+ * own stats, which are summed once at the end.
+ */
+
+typedef struct
+{
+    uint64_t genuine;    /* labelled genuine DOWNs */
+    uint64_t suppressed; /* ...that never became a press */
+    uint64_t bounces;    /* labelled bounce DOWNs */
+    uint64_t passed;     /* presses caused by bounces */
+    LatencyHistogram press_us;
+    LatencyHistogram release_us;
+} AlgoStats;
+
+typedef struct
+{
+    const char *const *traces;
+    size_t trace_count;
+    const DebounceAlgoParams *candidates;
+    size_t candidate_count;
+    uint32_t bounce_us;
+    int workers; /* 0 = one per CPU */
+} AlgoJob;
+
+typedef struct
+{
+    AlgoStats *stats; /* [candidate][button] */
+    uint64_t events;  /* button events replayed per candidate */
+    size_t failed_traces;
+} AlgoResults;
+
+/* Fills results (free with algo_results_free); false on bad arguments or allocation failure */
+bool algo_compare_run(const AlgoJob *job, AlgoResults *results);
+void algo_results_free(AlgoResults *results);
+const AlgoStats *algo_stats_at(const AlgoJob *job, const AlgoResults *results, size_t candidate, MouseButton button);
+
+/* Adds src into dst, for totals over buttons */
+void algo_stats_merge(AlgoStats *dst, const AlgoStats *src);
+
+/* What candidates are ranked by: the worse of the press and release p99 added latency */
+uint64_t algo_stats_latency(const AlgoStats *stats);
+
+/* False passes and false blocks within limits, as fractions of bounces and of genuine DOWNs */
+bool algo_stats_within(const AlgoStats *stats, double max_pass, double max_suppress);
+
+/* The lowest-latency candidate within the limits on one button; candidate_count when none is */
+size_t algo_compare_pick(const AlgoJob *job, const AlgoResults *results, MouseButton button, double max_pass,
+                         double max_suppress);
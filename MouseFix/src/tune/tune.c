@@ -0,0 +1,397 @@
+#include "tune.h"
+#include "tune_pool.h"
+#include "../trace/trace_map.h"
+#include "../trace/trace_replay.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define TUNE_BATCH 256
+
+/* Per-configuration scoring state, fed by the replayer callbacks */
+typedef struct
+{
+    TuneStats *stats; /* [button] */
+    uint32_t bounce_us;
+    uint64_t last_up[MOUSE_BUTTON_COUNT];
+    uint64_t blocked_up[MOUSE_BUTTON_COUNT];
+    uint64_t last_notch;
+    int32_t last_direction;
+} TuneScorer;
+
+typedef struct
+{
+    DebounceManager managers[TUNE_MAX_THRESHOLDS];
+    TraceReplayer replayers[TUNE_MAX_THRESHOLDS];
+    TuneScorer scorers[TUNE_MAX_THRESHOLDS];
+    TuneStats *stats; /* this worker's [variant][threshold][button] */
+    uint64_t events;
+    size_t failed_traces;
+} MF_ALIGN(MF_CACHE_LINE) TuneWorker;
+
+typedef struct
+{
+    const TuneJob *job;
+    size_t *trace_order; /* largest trace first */
+    TuneWorker **workers;
+} TuneContext;
+
+static void on_event(const MouseEvent *event, bool blocked, void *user_data)
+{
+    TuneScorer *scorer = (TuneScorer *)user_data;
+    MouseButton button = event->button;
+
+    if (event->is_injected)
+        return;
+
+    if (button == MOUSE_BUTTON_WHEEL)
+    {
+        int32_t direction = event->data > 0 ? 1 : event->data < 0 ? -1 : 0;
+        if (direction == 0)
+            return;
+
+        if (scorer->last_direction != 0 && direction != scorer->last_direction)
+        {
+            TuneStats *stats = &scorer->stats[button];
+            if (event->timestamp - scorer->last_notch < scorer->bounce_us)
+            {
+                stats->bounces++;
+                stats->caught += blocked;
+            }
+            else
+            {
+                stats->genuine++;
+                stats->suppressed += blocked;
+            }
+        }
+        scorer->last_direction = direction;
+        scorer->last_notch = event->timestamp;
+        return;
+    }
+
+    if (!event->is_down)
+    {
+        scorer->last_up[button] = event->timestamp;
+        if (blocked)
+            scorer->blocked_up[button] = event->timestamp;
+        return;
+    }
+
+    TuneStats *stats = &scorer->stats[button];
+    if (scorer->last_up[button] != 0 && event->timestamp - scorer->last_up[button] < scorer->bounce_us)
+    {
+        stats->bounces++;
+        stats->caught += blocked;
+    }
+    else
+    {
+        stats->genuine++;
+        stats->suppressed += blocked;
+    }
+}
+
+static void on_release(MouseButton button, uint64_t timestamp, void *user_data)
+{
+    TuneScorer *scorer = (TuneScorer *)user_data;
+    TuneStats *stats = &scorer->stats[button];
+
+    stats->deferred++;
+    stats->latency_us += timestamp - scorer->blocked_up[button];
+}
+
+static void run_task(size_t task, int worker_index, void *context)
+{
+    TuneContext *ctx = (TuneContext *)context;
+    const TuneJob *job = ctx->job;
+    TuneWorker *worker = ctx->workers[worker_index];
+    size_t trace = ctx->trace_order[task / job->variant_count];
+    size_t variant = task % job->variant_count;
+    const TuneVariant *v = &job->variants[variant];
+
+    TraceMap map;
+    if (!trace_map_open(&map, job->traces[trace], 0))
+    {
+        /* Count a failed trace once, not once per variant */
+        if (variant == 0)
+            worker->failed_traces++;
+        return;
+    }
+
+    size_t count = job->threshold_count;
+    for (size_t t = 0; t < count; t++)
+    {
+        DebounceManager *manager = &worker->managers[t];
+        debounce_init(manager);
+        for (int b = 0; b < MOUSE_BUTTON_COUNT; b++)
+        {
+            debounce_set_monitored(manager, b, true);
+            debounce_set_threshold_us(manager, b, job->thresholds_us[t]);
+        }
+        debounce_set_hybrid_heuristic(manager, v->hybrid);
+        debounce_set_smart_drag(manager, &v->smart_drag);
+
+        TuneScorer *scorer = &worker->scorers[t];
+        memset(scorer, 0, sizeof(TuneScorer));
+        scorer->stats = worker->stats + (variant * count + t) * MOUSE_BUTTON_COUNT;
+        scorer->bounce_us = job->bounce_us;
+
+        TraceReplayCallbacks callbacks = {on_event, on_release, scorer};
+        trace_replayer_init(&worker->replayers[t], manager, &callbacks);
+    }
+
+    /* Decode each batch once and run it through every candidate threshold */
+    PackedEvent events[TUNE_BATCH];
+    size_t pending = 0;
+    uint64_t replayed = 0;
+    TraceRecord record;
+    int status;
+
+    for (;;)
+    {
+        status = trace_map_next(&map, &record);
+        bool flush = status != 1 || record.type != TRACE_RECORD_EVENT || pending == TUNE_BATCH;
+
+        if (flush && pending > 0)
+        {
+            for (size_t t = 0; t < count; t++)
+                trace_replayer_apply_packed(&worker->replayers[t], events, pending);
+            replayed += pending;
+            pending = 0;
+        }
+        if (status != 1)
+            break;
+
+        if (record.type == TRACE_RECORD_EVENT)
+            events[pending++] = mouse_event_pack(&record.event);
+        else if (record.type == TRACE_RECORD_RESET)
+        {
+            for (size_t t = 0; t < count; t++)
+                trace_replayer_apply(&worker->replayers[t], &record);
+        }
+        /* Config records are ignored: the grid decides the configuration */
+    }
+
+    for (size_t t = 0; t < count; t++)
+        trace_replayer_finish(&worker->replayers[t]);
+    trace_map_close(&map);
+
+    if (variant == 0)
+    {
+        worker->events += replayed;
+        if (status < 0)
+            worker->failed_traces++;
+    }
+}
+
+static uint64_t trace_size(const char *path)
+{
+    TraceMap map;
+    if (!trace_map_open(&map, path, TRACE_MAP_ALIGN))
+        return 0;
+    uint64_t size = map.file_size;
+    trace_map_close(&map);
+    return size;
+}
+
+typedef struct
+{
+    uint64_t size;
+    size_t index;
+} TraceEntry;
+
+static int by_size_descending(const void *a, const void *b)
+{
+    const TraceEntry *ea = (const TraceEntry *)a;
+    const TraceEntry *eb = (const TraceEntry *)b;
+    if (ea->size != eb->size)
+        return ea->size < eb->size ? 1 : -1;
+    return ea->index < eb->index ? -1 : ea->index > eb->index ? 1 : 0;
+}
+
+static void *alloc_aligned(size_t size)
+{
+#ifdef _WIN32
+    return _aligned_malloc(size, MF_CACHE_LINE);
+#else
+    return aligned_alloc(MF_CACHE_LINE, (size + MF_CACHE_LINE - 1) / MF_CACHE_LINE * MF_CACHE_LINE);
+#endif
+}
+
+static void free_aligned(void *p)
+{
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+bool tune_run(const TuneJob *job, TuneResults *results)
+{
+    if (!job || !results || !job->traces || !job->thresholds_us || !job->variants)
+        return false;
+    if (job->threshold_count == 0 || job->threshold_count > TUNE_MAX_THRESHOLDS || job->variant_count == 0)
+        return false;
+
+    memset(results, 0, sizeof(TuneResults));
+    size_t cells = job->variant_count * job->threshold_count * MOUSE_BUTTON_COUNT;
+    results->stats = calloc(cells, sizeof(TuneStats));
+    if (!results->stats)
+        return false;
+
+    int worker_count = job->workers > 0 ? job->workers : mf_cpu_count();
+    size_t task_count = job->trace_count * job->variant_count;
+    if (task_count < (size_t)worker_count)
+        worker_count = task_count > 0 ? (int)task_count : 1;
+
+    TuneContext ctx;
+    ctx.job = job;
+    ctx.trace_order = malloc((job->trace_count + 1) * sizeof(size_t));
+    ctx.workers = calloc((size_t)worker_count, sizeof(TuneWorker *));
+    TraceEntry *entries = malloc((job->trace_count + 1) * sizeof(TraceEntry));
+    bool ok = ctx.trace_order && ctx.workers && entries;
+
+    for (int w = 0; ok && w < worker_count; w++)
+    {
+        ctx.workers[w] = alloc_aligned(sizeof(TuneWorker));
+        if (!ctx.workers[w])
+        {
+            ok = false;
+            break;
+        }
+        memset(ctx.workers[w], 0, sizeof(TuneWorker));
+        ctx.workers[w]->stats = calloc(cells, sizeof(TuneStats));
+        ok = ctx.workers[w]->stats != NULL;
+    }
+
+    if (ok)
+    {
+        /* Longest traces first so the last tasks to finish are short ones */
+        for (size_t i = 0; i < job->trace_count; i++)
+        {
+            entries[i].size = trace_size(job->traces[i]);
+            entries[i].index = i;
+        }
+        qsort(entries, job->trace_count, sizeof(TraceEntry), by_size_descending);
+        for (size_t i = 0; i < job->trace_count; i++)
+            ctx.trace_order[i] = entries[i].index;
+
+        ok = tune_pool_run(task_count, worker_count, run_task, &ctx);
+    }
+
+    for (int w = 0; ctx.workers && w < worker_count; w++)
+    {
+        TuneWorker *worker = ctx.workers[w];
+        if (!worker)
+            continue;
+        if (ok)
+        {
+            for (size_t i = 0; i < cells; i++)
+            {
+                TuneStats *dst = &results->stats[i];
+                const TuneStats *src = &worker->stats[i];
+                dst->bounces += src->bounces;
+                dst->caught += src->caught;
+                dst->genuine += src->genuine;
+                dst->suppressed += src->suppressed;
+                dst->deferred += src->deferred;
+                dst->latency_us += src->latency_us;
+            }
+            results->events += worker->events;
+            results->failed_traces += worker->failed_traces;
+        }
+        free(worker->stats);
+        free_aligned(worker);
+    }
+
+    free(ctx.workers);
+    free(ctx.trace_order);
+    free(entries);
+    if (!ok)
+        tune_results_free(results);
+    return ok;
+}
+
+void tune_results_free(TuneResults *results)
+{
+    if (!results)
+        return;
+
+    free(results->stats);
+    results->stats = NULL;
+}
+
+const TuneStats *tune_stats_at(const TuneJob *job, const TuneResults *results, size_t variant, size_t threshold, MouseButton button)
+{
+    if (!job || !results || !results->stats || variant >= job->variant_count || threshold >= job->threshold_count ||
+        (unsigned)button >= MOUSE_BUTTON_COUNT)
+        return NULL;
+
+    return &results->stats[(variant * job->threshold_count + threshold) * MOUSE_BUTTON_COUNT + button];
+}
+
+static int by_score(const void *a, const void *b)
+{
+    const TuneCandidate *ca = (const TuneCandidate *)a;
+    const TuneCandidate *cb = (const TuneCandidate *)b;
+    if (ca->score != cb->score)
+        return ca->score < cb->score ? -1 : 1;
+    return ca->variant < cb->variant ? -1 : ca->variant > cb->variant ? 1 : 0;
+}
+
+void tune_rank(const TuneJob *job, const TuneResults *results, const TuneWeights *weights, TuneCandidate *out)
+{
+    if (!job || !results || !results->stats || !weights || !out)
+        return;
+
+    /* Labels do not depend on the configuration, so any cell gives the totals */
+    uint64_t bounces = 0, genuine = 0;
+    for (int b = 0; b < MOUSE_BUTTON_COUNT; b++)
+    {
+        const TuneStats *s = tune_stats_at(job, results, 0, 0, b);
+        bounces += s->bounces;
+        genuine += s->genuine;
+    }
+
+    for (size_t v = 0; v < job->variant_count; v++)
+    {
+        TuneCandidate *c = &out[v];
+        memset(c, 0, sizeof(TuneCandidate));
+        c->variant = v;
+
+        for (int b = 0; b < MOUSE_BUTTON_COUNT; b++)
+        {
+            double best = 0.0;
+            size_t best_t = 0;
+            for (size_t t = 0; t < job->threshold_count; t++)
+            {
+                const TuneStats *s = tune_stats_at(job, results, v, t, b);
+                double cost = 0.0;
+                if (bounces)
+                    cost += weights->miss * (double)(s->bounces - s->caught) / (double)bounces;
+                if (genuine)
+                {
+                    cost += weights->suppress * (double)s->suppressed / (double)genuine;
+                    cost += weights->latency * ((double)s->latency_us / 1000.0) / (double)genuine;
+                }
+                /* Ties go to the threshold listed first */
+                if (t == 0 || cost < best)
+                {
+                    best = cost;
+                    best_t = t;
+                }
+            }
+
+            const TuneStats *s = tune_stats_at(job, results, v, best_t, b);
+            c->threshold_us[b] = job->thresholds_us[best_t];
+            c->score += best;
+            c->total.bounces += s->bounces;
+            c->total.caught += s->caught;
+            c->total.genuine += s->genuine;
+            c->total.suppressed += s->suppressed;
+            c->total.deferred += s->deferred;
+            c->total.latency_us += s->latency_us;
+        }
+    }
+
+    qsort(out, job->variant_count, sizeof(TuneCandidate), by_score);
+}
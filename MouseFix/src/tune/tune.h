@@ -0,0 +1,88 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../core/debouncer.h"
+
+/*
+ * Offline threshold tuning over recorded traces.
+ *
+ * Every trace is replayed through the real engine once per variant
+ * (Smart Drag on/off and its hold/distance/confirm tuning), with one
+ * DebounceManager per candidate threshold fed from the same decoded
+ * batch. Traces are replayed with every button monitored; their own
+ * config records are ignored so the grid decides.
+ *
+ * Ground truth is a timing label, independent of the configuration under
+ * test: a button DOWN less than bounce_us after that button's previous UP,
+ * or a wheel reversal less than bounce_us after the previous notch, is a
+ * bounce; every other DOWN and reversal is genuine. Blocking a bounce is
+ * a catch; blocking a genuine edge is a suppression. Deferred Smart Drag
+ * releases add latency from the blocked UP to the release.
+ *
+ * Buttons never influence each other in the engine, so the best threshold
+ * is chosen per button within each variant. One (trace, variant) pair is
+ * one task on a work-stealing pool; every worker accumulates into its own
+ * stats, which are summed once at the end.
+ */
+
+#define TUNE_MAX_THRESHOLDS 64
+
+typedef struct
+{
+    bool hybrid;
+    SmartDragParams smart_drag;
+} TuneVariant;
+
+typedef struct
+{
+    uint64_t bounces;    /* labelled bounce edges */
+    uint64_t caught;     /* ...of which blocked */
+    uint64_t genuine;    /* labelled genuine edges */
+    uint64_t suppressed; /* ...of which blocked */
+    uint64_t deferred;   /* Smart Drag releases */
+    uint64_t latency_us; /* total delay of those releases */
+} TuneStats;
+
+typedef struct
+{
+    double miss;     /* cost of missing every bounce */
+    double suppress; /* cost of suppressing every genuine edge */
+    double latency;  /* cost per ms of release delay, averaged over genuine edges */
+} TuneWeights;
+
+typedef struct
+{
+    const char *const *traces;
+    size_t trace_count;
+    const uint32_t *thresholds_us;
+    size_t threshold_count; /* at most TUNE_MAX_THRESHOLDS */
+    const TuneVariant *variants;
+    size_t variant_count;
+    uint32_t bounce_us;
+    int workers; /* 0 = one per CPU */
+} TuneJob;
+
+typedef struct
+{
+    TuneStats *stats; /* [variant][threshold][button] */
+    uint64_t events;  /* events replayed per configuration */
+    size_t failed_traces;
+} TuneResults;
+
+typedef struct
+{
+    size_t variant;
+    uint32_t threshold_us[MOUSE_BUTTON_COUNT];
+    double score; /* lower is better */
+    TuneStats total;
+} TuneCandidate;
+
+/* Fills results (free with tune_results_free); false on bad arguments or allocation failure */
+bool tune_run(const TuneJob *job, TuneResults *results);
+void tune_results_free(TuneResults *results);
+const TuneStats *tune_stats_at(const TuneJob *job, const TuneResults *results, size_t variant, size_t threshold, MouseButton button);
+
+/* Best per-button thresholds for every variant, best first; out holds variant_count entries */
+void tune_rank(const TuneJob *job, const TuneResults *results, const TuneWeights *weights, TuneCandidate *out);
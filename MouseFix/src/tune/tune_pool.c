@@ -0,0 +1,160 @@
+#include "tune_pool.h"
+#include <stdlib.h>
+
+typedef struct
+{
+    MfAtomic64 range; /* (begin << 32) | end, in slots */
+} MF_ALIGN(MF_CACHE_LINE) PoolQueue;
+
+typedef struct
+{
+    PoolQueue *queues;
+    uint32_t *order; /* slot -> task */
+    int worker_count;
+    TunePoolFunc func;
+    void *context;
+} Pool;
+
+typedef struct
+{
+    Pool *pool;
+    int worker;
+    MfThread thread;
+} PoolWorker;
+
+static uint64_t pack(uint32_t begin, uint32_t end)
+{
+    return ((uint64_t)begin << 32) | end;
+}
+
+/* Take the first slot of the worker's own range */
+static bool pop(PoolQueue *queue, uint32_t *slot)
+{
+    for (;;)
+    {
+        uint64_t range = mf_atomic_load64(&queue->range);
+        uint32_t begin = (uint32_t)(range >> 32);
+        uint32_t end = (uint32_t)range;
+        if (begin >= end)
+            return false;
+        if (mf_atomic_cas64(&queue->range, range, pack(begin + 1, end)))
+        {
+            *slot = begin;
+            return true;
+        }
+    }
+}
+
+/* Move the back half of some other worker's range into our own (empty) one */
+static bool steal(Pool *pool, int thief)
+{
+    for (int i = 1; i < pool->worker_count; i++)
+    {
+        PoolQueue *victim = &pool->queues[(thief + i) % pool->worker_count];
+        for (;;)
+        {
+            uint64_t range = mf_atomic_load64(&victim->range);
+            uint32_t begin = (uint32_t)(range >> 32);
+            uint32_t end = (uint32_t)range;
+            if (begin >= end)
+                break;
+
+            uint32_t take = (end - begin + 1) / 2;
+            if (mf_atomic_cas64(&victim->range, range, pack(begin, end - take)))
+            {
+                mf_atomic_store64(&pool->queues[thief].range, pack(end - take, end));
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static void worker_main(void *arg)
+{
+    PoolWorker *self = (PoolWorker *)arg;
+    Pool *pool = self->pool;
+    PoolQueue *queue = &pool->queues[self->worker];
+    uint32_t slot;
+
+    for (;;)
+    {
+        while (pop(queue, &slot))
+            pool->func(pool->order[slot], self->worker, pool->context);
+
+        /* Every range empty: remaining slots are already owned by running workers */
+        if (!steal(pool, self->worker))
+            return;
+    }
+}
+
+bool tune_pool_run(size_t task_count, int worker_count, TunePoolFunc func, void *context)
+{
+    if (!func || task_count > UINT32_MAX)
+        return false;
+    if (task_count == 0)
+        return true;
+    if (worker_count < 1)
+        worker_count = 1;
+    if ((size_t)worker_count > task_count)
+        worker_count = (int)task_count;
+
+    Pool pool;
+    pool.worker_count = worker_count;
+    pool.func = func;
+    pool.context = context;
+    pool.order = malloc(task_count * sizeof(uint32_t));
+    PoolWorker *workers = calloc((size_t)worker_count, sizeof(PoolWorker));
+#ifdef _WIN32
+    pool.queues = _aligned_malloc((size_t)worker_count * sizeof(PoolQueue), MF_CACHE_LINE);
+#else
+    pool.queues = aligned_alloc(MF_CACHE_LINE, (size_t)worker_count * sizeof(PoolQueue));
+#endif
+    if (!pool.order || !workers || !pool.queues)
+    {
+        free(pool.order);
+        free(workers);
+#ifdef _WIN32
+        _aligned_free(pool.queues);
+#else
+        free(pool.queues);
+#endif
+        return false;
+    }
+
+    /* Worker w gets tasks w, w + W, w + 2W, ... as its contiguous slot range */
+    uint32_t slot = 0;
+    for (int w = 0; w < worker_count; w++)
+    {
+        uint32_t begin = slot;
+        for (size_t task = (size_t)w; task < task_count; task += (size_t)worker_count)
+            pool.order[slot++] = (uint32_t)task;
+        mf_atomic_store64(&pool.queues[w].range, pack(begin, slot));
+    }
+
+    int started = 1;
+    for (int w = 0; w < worker_count; w++)
+    {
+        workers[w].pool = &pool;
+        workers[w].worker = w;
+    }
+    for (; started < worker_count; started++)
+    {
+        if (!mf_thread_start(&workers[started].thread, worker_main, &workers[started]))
+            break;
+    }
+
+    /* Worker 0 is the caller; if a thread failed to start, its range gets stolen */
+    worker_main(&workers[0]);
+    for (int w = 1; w < started; w++)
+        mf_thread_join(&workers[w].thread);
+
+    free(pool.order);
+    free(workers);
+#ifdef _WIN32
+    _aligned_free(pool.queues);
+#else
+    free(pool.queues);
+#endif
+    return true;
+}
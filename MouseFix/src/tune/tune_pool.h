@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "../core/platform.h"
+
+/*
+ * Work-stealing pool for a fixed set of independent tasks.
+ *
+ * Task indices are dealt round-robin into one contiguous slot range per
+ * worker, so each worker starts with a mix of the caller's order (put the
+ * expensive tasks first). A worker pops from the front of its own range;
+ * once that is empty it steals the back half of another worker's range.
+ * Ranges are a packed (begin, end) pair updated by compare-exchange, and
+ * a slot is handed out exactly once, so there is no ABA and no lock.
+ *
+ * The calling thread runs as worker 0. func must be safe to call
+ * concurrently for different tasks; worker is a stable index in
+ * [0, worker_count) for per-worker scratch space.
+ */
+
+typedef void (*TunePoolFunc)(size_t task, int worker, void *context);
+
+/*
+ * Runs func once for every task in [0, task_count). Returns false only if
+ * the pool cannot be allocated; a worker thread that fails to start just
+ * leaves its share to be stolen by the others.
+ */
+bool tune_pool_run(size_t task_count, int worker_count, TunePoolFunc func, void *context);
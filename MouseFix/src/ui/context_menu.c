@@ -24,6 +24,80 @@ static const MouseButton BUTTON_TYPES[] = {
 	MOUSE_BUTTON_X2};
 static const int BUTTON_TYPE_COUNT = 5;
 
+// Add one grayed line per button that has latency samples
+// Parameters:
+//   hMenu - Handle to the submenu to add items to
+//   latency - Hook latency histograms
+static void AddLatencyMenuItems(HMENU hMenu, HookLatency *latency)
+{
+	bool any = false;
+	for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
+	{
+		LatencySummary summary;
+		if (!hook_latency_get_button(latency, (MouseButton)i, &summary) || summary.count == 0)
+			continue;
+
+		wchar_t text[STATISTICS_BUFFER_SIZE];
+		StringCchPrintf(text, STATISTICS_BUFFER_SIZE, L"%S: p50 %.1fus  p99 %.1fus  p99.9 %.1fus  max %.1fus",
+						debounce_get_button_name((MouseButton)i),
+						summary.p50_ns / 1000.0, summary.p99_ns / 1000.0,
+						summary.p999_ns / 1000.0, summary.max_ns / 1000.0);
+		InsertMenu(hMenu, -1, MF_BYPOSITION | MF_STRING | MF_GRAYED, 0, text);
+		any = true;
+	}
+
+	if (!any)
+		InsertMenu(hMenu, -1, MF_BYPOSITION | MF_STRING | MF_GRAYED, 0, L"No samples yet");
+}
+
+// Add one grayed line per button and kind of delayed release, with totals first
+// Parameters:
+//   hMenu - Handle to the submenu to add items to
+//   debounce - Pointer to DebounceManager for the added latency histograms
+static void AddAddedLatencyMenuItems(HMENU hMenu, DebounceManager *debounce)
+{
+	static const wchar_t *KIND_NAMES[ADDED_LATENCY_KIND_COUNT] = {L"deferred", L"cancelled"};
+	AddedLatencySummary summaries[MOUSE_BUTTON_COUNT][ADDED_LATENCY_KIND_COUNT];
+	uint32_t total_count = 0;
+	uint64_t total_us = 0;
+
+	for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
+	{
+		for (int k = 0; k < ADDED_LATENCY_KIND_COUNT; k++)
+		{
+			if (!debounce_get_added_latency(debounce, (MouseButton)i, (AddedLatencyKind)k, &summaries[i][k]))
+				summaries[i][k].count = 0;
+			total_count += summaries[i][k].count;
+			total_us += summaries[i][k].count ? summaries[i][k].total_us : 0;
+		}
+	}
+
+	if (total_count == 0)
+	{
+		InsertMenu(hMenu, -1, MF_BYPOSITION | MF_STRING | MF_GRAYED, 0, L"No delayed releases yet");
+		return;
+	}
+
+	wchar_t text[STATISTICS_BUFFER_SIZE];
+	StringCchPrintf(text, STATISTICS_BUFFER_SIZE, L"Total: %I32u releases, %.1fs added", total_count, total_us / 1e6);
+	InsertMenu(hMenu, -1, MF_BYPOSITION | MF_STRING | MF_GRAYED, 0, text);
+
+	for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
+	{
+		for (int k = 0; k < ADDED_LATENCY_KIND_COUNT; k++)
+		{
+			const AddedLatencySummary *summary = &summaries[i][k];
+			if (summary->count == 0)
+				continue;
+
+			StringCchPrintf(text, STATISTICS_BUFFER_SIZE, L"%S %s: %I32u, p50 %.1fms  p99 %.1fms  max %.1fms",
+							debounce_get_button_name((MouseButton)i), KIND_NAMES[k], summary->count,
+							summary->p50_us / 1000.0, summary->p99_us / 1000.0, summary->max_us / 1000.0);
+			InsertMenu(hMenu, -1, MF_BYPOSITION | MF_STRING | MF_GRAYED, 0, text);
+		}
+	}
+}
+
 // Add threshold menu items to a submenu
 // Parameters:
 //   hMenu - Handle to the submenu to add items to
@@ -31,7 +105,7 @@ static const int BUTTON_TYPE_COUNT = 5;
 //   thresholds - Array of threshold values in milliseconds
 //   threshold_count - Number of thresholds in the array
 //   debounce - Pointer to DebounceManager for current threshold values
-static void AddThresholdMenuItems(HMENU hMenu, MouseButton button, const int *thresholds, int threshold_count, const DebounceManager *debounce)
+static void AddThresholdMenuItems(HMENU hMenu, MouseButton button, const int *thresholds, int threshold_count, DebounceManager *debounce)
 {
 	for (int i = 0; i < threshold_count; i++)
 	{
@@ -40,7 +114,7 @@ static void AddThresholdMenuItems(HMENU hMenu, MouseButton button, const int *th
 		StringCchPrintf(threshold_text, THRESHOLD_TEXT_BUFFER_SIZE, L"%dms", thresholds[i]);
 
 		UINT flags = MF_BYPOSITION | MF_STRING;
-		if (debounce->buttons[button].thresholdMs == thresholds[i])
+		if (debounce_get_threshold(debounce, button) == thresholds[i])
 			flags |= MF_CHECKED;
 		InsertMenu(hMenu, -1, flags, threshold_id + button * MENU_ID_BUTTON_MULTIPLIER, threshold_text);
 	}
@@ -53,13 +127,13 @@ static void AddThresholdMenuItems(HMENU hMenu, MouseButton button, const int *th
 //   thresholds - Array of predefined threshold values in milliseconds
 //   threshold_count - Number of thresholds in the array
 //   debounce - Pointer to DebounceManager for current threshold values
-static void AddCustomThresholdOption(HMENU hMenu, MouseButton button, const int *thresholds, int threshold_count, const DebounceManager *debounce)
+static void AddCustomThresholdOption(HMENU hMenu, MouseButton button, const int *thresholds, int threshold_count, DebounceManager *debounce)
 {
 	UINT flags = MF_BYPOSITION | MF_STRING;
 	bool is_custom = true;
 	for (int i = 0; i < threshold_count; i++)
 	{
-		if (debounce->buttons[button].thresholdMs == thresholds[i])
+		if (debounce_get_threshold(debounce, button) == thresholds[i])
 		{
 			is_custom = false;
 			break;
@@ -84,7 +158,7 @@ bool context_menu_init(ContextMenuManager *manager, ContextMenuCallback callback
 }
 
 // Create and populate menu items
-bool context_menu_create(ContextMenuManager *manager, DebounceManager *debounce)
+bool context_menu_create(ContextMenuManager *manager, DebounceManager *debounce, HookLatency *latency)
 {
 	if (!manager || !debounce)
 		return false;
@@ -104,6 +178,25 @@ bool context_menu_create(ContextMenuManager *manager, DebounceManager *debounce)
 	StringCchPrintf(buffer, STATISTICS_BUFFER_SIZE, L"Total Blocked: %I32u events", total_blocks);
 	InsertMenu(manager->menu, -1, MF_BYPOSITION | MF_STRING | MF_GRAYED, 0, buffer);
 
+	// Add hook latency percentiles
+	if (latency)
+	{
+		HMENU hLatencyMenu = CreatePopupMenu();
+		if (hLatencyMenu)
+		{
+			AddLatencyMenuItems(hLatencyMenu, latency);
+			InsertMenu(manager->menu, -1, MF_BYPOSITION | MF_POPUP, (UINT_PTR)hLatencyMenu, L"Hook Latency");
+		}
+	}
+
+	// Add latency that Smart Drag added to releases
+	HMENU hAddedMenu = CreatePopupMenu();
+	if (hAddedMenu)
+	{
+		AddAddedLatencyMenuItems(hAddedMenu, debounce);
+		InsertMenu(manager->menu, -1, MF_BYPOSITION | MF_POPUP, (UINT_PTR)hAddedMenu, L"Added Latency");
+	}
+
 	InsertMenu(manager->menu, -1, MF_BYPOSITION | MF_SEPARATOR, 0, NULL);
 
 	// Add button submenus with threshold settings
@@ -161,12 +254,12 @@ bool context_menu_create(ContextMenuManager *manager, DebounceManager *debounce)
 	InsertMenu(hX2Menu, 0, MF_BYPOSITION | MF_SEPARATOR, 0, NULL);
 	InsertMenu(hWheelMenu, 0, MF_BYPOSITION | MF_SEPARATOR, 0, NULL);
 
-	UINT left_toggle_flags = MF_BYPOSITION | MF_STRING | (debounce->buttons[MOUSE_BUTTON_LEFT].isMonitored ? MF_CHECKED : 0);
-	UINT right_toggle_flags = MF_BYPOSITION | MF_STRING | (debounce->buttons[MOUSE_BUTTON_RIGHT].isMonitored ? MF_CHECKED : 0);
-	UINT middle_toggle_flags = MF_BYPOSITION | MF_STRING | (debounce->buttons[MOUSE_BUTTON_MIDDLE].isMonitored ? MF_CHECKED : 0);
-	UINT x1_toggle_flags = MF_BYPOSITION | MF_STRING | (debounce->buttons[MOUSE_BUTTON_X1].isMonitored ? MF_CHECKED : 0);
-	UINT x2_toggle_flags = MF_BYPOSITION | MF_STRING | (debounce->buttons[MOUSE_BUTTON_X2].isMonitored ? MF_CHECKED : 0);
-	UINT wheel_toggle_flags = MF_BYPOSITION | MF_STRING | (debounce->buttons[MOUSE_BUTTON_WHEEL].isMonitored ? MF_CHECKED : 0);
+	UINT left_toggle_flags = MF_BYPOSITION | MF_STRING | (debounce_is_monitored(debounce, MOUSE_BUTTON_LEFT) ? MF_CHECKED : 0);
+	UINT right_toggle_flags = MF_BYPOSITION | MF_STRING | (debounce_is_monitored(debounce, MOUSE_BUTTON_RIGHT) ? MF_CHECKED : 0);
+	UINT middle_toggle_flags = MF_BYPOSITION | MF_STRING | (debounce_is_monitored(debounce, MOUSE_BUTTON_MIDDLE) ? MF_CHECKED : 0);
+	UINT x1_toggle_flags = MF_BYPOSITION | MF_STRING | (debounce_is_monitored(debounce, MOUSE_BUTTON_X1) ? MF_CHECKED : 0);
+	UINT x2_toggle_flags = MF_BYPOSITION | MF_STRING | (debounce_is_monitored(debounce, MOUSE_BUTTON_X2) ? MF_CHECKED : 0);
+	UINT wheel_toggle_flags = MF_BYPOSITION | MF_STRING | (debounce_is_monitored(debounce, MOUSE_BUTTON_WHEEL) ? MF_CHECKED : 0);
 
 	InsertMenu(hLeftMenu, 0, left_toggle_flags, IDM_TOGGLE_LEFT, L"Enable");
 	InsertMenu(hRightMenu, 0, right_toggle_flags, IDM_TOGGLE_RIGHT, L"Enable");
@@ -177,44 +270,44 @@ bool context_menu_create(ContextMenuManager *manager, DebounceManager *debounce)
 
 	// Add button submenus to main menu with current threshold display and checkmark for enabled state
 	wchar_t left_text[64];
-	StringCchPrintf(left_text, 64, L"Left (%dms)", debounce->buttons[MOUSE_BUTTON_LEFT].thresholdMs);
+	StringCchPrintf(left_text, 64, L"Left (%dms)", debounce_get_threshold(debounce, MOUSE_BUTTON_LEFT));
 	UINT left_menu_flags = MF_BYPOSITION | MF_POPUP;
-	if (debounce->buttons[MOUSE_BUTTON_LEFT].isMonitored)
+	if (debounce_is_monitored(debounce, MOUSE_BUTTON_LEFT))
 		left_menu_flags |= MF_CHECKED;
 	InsertMenu(manager->menu, -1, left_menu_flags, (UINT_PTR)hLeftMenu, left_text);
 
 	wchar_t right_text[64];
-	StringCchPrintf(right_text, 64, L"Right (%dms)", debounce->buttons[MOUSE_BUTTON_RIGHT].thresholdMs);
+	StringCchPrintf(right_text, 64, L"Right (%dms)", debounce_get_threshold(debounce, MOUSE_BUTTON_RIGHT));
 	UINT right_menu_flags = MF_BYPOSITION | MF_POPUP;
-	if (debounce->buttons[MOUSE_BUTTON_RIGHT].isMonitored)
+	if (debounce_is_monitored(debounce, MOUSE_BUTTON_RIGHT))
 		right_menu_flags |= MF_CHECKED;
 	InsertMenu(manager->menu, -1, right_menu_flags, (UINT_PTR)hRightMenu, right_text);
 
 	wchar_t middle_text[64];
-	StringCchPrintf(middle_text, 64, L"Middle (%dms)", debounce->buttons[MOUSE_BUTTON_MIDDLE].thresholdMs);
+	StringCchPrintf(middle_text, 64, L"Middle (%dms)", debounce_get_threshold(debounce, MOUSE_BUTTON_MIDDLE));
 	UINT middle_menu_flags = MF_BYPOSITION | MF_POPUP;
-	if (debounce->buttons[MOUSE_BUTTON_MIDDLE].isMonitored)
+	if (debounce_is_monitored(debounce, MOUSE_BUTTON_MIDDLE))
 		middle_menu_flags |= MF_CHECKED;
 	InsertMenu(manager->menu, -1, middle_menu_flags, (UINT_PTR)hMiddleMenu, middle_text);
 
 	wchar_t x1_text[64];
-	StringCchPrintf(x1_text, 64, L"X1 (%dms)", debounce->buttons[MOUSE_BUTTON_X1].thresholdMs);
+	StringCchPrintf(x1_text, 64, L"X1 (%dms)", debounce_get_threshold(debounce, MOUSE_BUTTON_X1));
 	UINT x1_menu_flags = MF_BYPOSITION | MF_POPUP;
-	if (debounce->buttons[MOUSE_BUTTON_X1].isMonitored)
+	if (debounce_is_monitored(debounce, MOUSE_BUTTON_X1))
 		x1_menu_flags |= MF_CHECKED;
 	InsertMenu(manager->menu, -1, x1_menu_flags, (UINT_PTR)hX1Menu, x1_text);
 
 	wchar_t x2_text[64];
-	StringCchPrintf(x2_text, 64, L"X2 (%dms)", debounce->buttons[MOUSE_BUTTON_X2].thresholdMs);
+	StringCchPrintf(x2_text, 64, L"X2 (%dms)", debounce_get_threshold(debounce, MOUSE_BUTTON_X2));
 	UINT x2_menu_flags = MF_BYPOSITION | MF_POPUP;
-	if (debounce->buttons[MOUSE_BUTTON_X2].isMonitored)
+	if (debounce_is_monitored(debounce, MOUSE_BUTTON_X2))
 		x2_menu_flags |= MF_CHECKED;
 	InsertMenu(manager->menu, -1, x2_menu_flags, (UINT_PTR)hX2Menu, x2_text);
 
 	wchar_t wheel_text[64];
-	StringCchPrintf(wheel_text, 64, L"Wheel (%dms)", debounce->buttons[MOUSE_BUTTON_WHEEL].thresholdMs);
+	StringCchPrintf(wheel_text, 64, L"Wheel (%dms)", debounce_get_threshold(debounce, MOUSE_BUTTON_WHEEL));
 	UINT wheel_menu_flags = MF_BYPOSITION | MF_POPUP;
-	if (debounce->buttons[MOUSE_BUTTON_WHEEL].isMonitored)
+	if (debounce_is_monitored(debounce, MOUSE_BUTTON_WHEEL))
 		wheel_menu_flags |= MF_CHECKED;
 	InsertMenu(manager->menu, -1, wheel_menu_flags, (UINT_PTR)hWheelMenu, wheel_text);
 
@@ -225,11 +318,18 @@ bool context_menu_create(ContextMenuManager *manager, DebounceManager *debounce)
 			   is_enabled ? L"Disable All" : L"Enable All");
 
 	UINT hybrid_flags = MF_BYPOSITION | MF_STRING;
-	if (debounce->use_hybrid_heuristic)
+	if (debounce_get_hybrid_heuristic(debounce))
 		hybrid_flags |= MF_CHECKED;
 	// Use a simple, user-friendly name "Smart Drag Protection"
 	InsertMenu(manager->menu, -1, hybrid_flags, IDM_TOGGLE_HYBRID, L"Smart Drag Protection");
 
+	AdaptiveParams adaptive;
+	debounce_get_adaptive(debounce, &adaptive);
+	UINT adaptive_flags = MF_BYPOSITION | MF_STRING;
+	if (adaptive.enabled)
+		adaptive_flags |= MF_CHECKED;
+	InsertMenu(manager->menu, -1, adaptive_flags, IDM_TOGGLE_ADAPTIVE, L"Adaptive Thresholds");
+
 	InsertMenu(manager->menu, -1, MF_BYPOSITION | MF_STRING, IDM_RESET_STATS, L"Reset Statistics");
 
 	InsertMenu(manager->menu, -1, MF_BYPOSITION | MF_SEPARATOR, 0, NULL);
@@ -262,12 +362,12 @@ bool context_menu_create(ContextMenuManager *manager, DebounceManager *debounce)
 }
 
 // Show context menu at specified position
-bool context_menu_show(ContextMenuManager *manager, HWND hwnd, int x, int y, DebounceManager *debounce)
+bool context_menu_show(ContextMenuManager *manager, HWND hwnd, int x, int y, DebounceManager *debounce, HookLatency *latency)
 {
 	if (!manager || !hwnd)
 		return false;
 
-	if (!context_menu_create(manager, debounce))
+	if (!context_menu_create(manager, debounce, latency))
 		return false;
 
 	SetForegroundWindow(hwnd);
@@ -277,13 +377,13 @@ bool context_menu_show(ContextMenuManager *manager, HWND hwnd, int x, int y, Deb
 }
 
 // Update menu with current statistics
-bool context_menu_update(ContextMenuManager *manager, DebounceManager *debounce)
+bool context_menu_update(ContextMenuManager *manager, DebounceManager *debounce, HookLatency *latency)
 {
 	if (!manager || !debounce)
 		return false;
 
 	context_menu_destroy(manager);
-	return context_menu_create(manager, debounce);
+	return context_menu_create(manager, debounce, latency);
 }
 
 // Destroy context menu
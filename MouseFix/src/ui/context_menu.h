@@ -2,6 +2,7 @@
 
 #include <windows.h>
 #include "../core/debouncer.h"
+#include "../core/hook_latency.h"
 
 // Menu identifiers
 #define IDM_EXIT (WM_USER + 10)
@@ -33,13 +34,13 @@ typedef struct
 bool context_menu_init(ContextMenuManager *manager, ContextMenuCallback callback, void *user_data);
 
 // Show context menu at specified position
-bool context_menu_show(ContextMenuManager *manager, HWND hwnd, int x, int y, DebounceManager *debounce);
+bool context_menu_show(ContextMenuManager *manager, HWND hwnd, int x, int y, DebounceManager *debounce, HookLatency *latency);
 
 // Create and populate menu items
-bool context_menu_create(ContextMenuManager *manager, DebounceManager *debounce);
+bool context_menu_create(ContextMenuManager *manager, DebounceManager *debounce, HookLatency *latency);
 
 // Destroy context menu
 void context_menu_destroy(ContextMenuManager *manager);
 
 // Update menu with current statistics
-bool context_menu_update(ContextMenuManager *manager, DebounceManager *debounce);
\ No newline at end of file
+bool context_menu_update(ContextMenuManager *manager, DebounceManager *debounce, HookLatency *latency);
\ No newline at end of file
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "../src/core/debouncer.h"
+
+/* Minimal test harness shared by the test executables */
+
+static int test_count = 0;
+static int pass_count = 0;
+static int fail_count = 0;
+
+#define TEST(name) \
+    do { printf("\n[TEST] %s\n", name); test_count++; } while(0)
+
+#define CHECK(condition, msg) \
+    do { \
+        if (condition) { \
+            printf("  PASS: %s\n", msg); \
+            pass_count++; \
+        } else { \
+            printf("  FAIL: %s\n", msg); \
+            fail_count++; \
+        } \
+    } while(0)
+
+/* Deterministic xorshift so failures reproduce */
+static inline uint64_t test_rand(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+/*
+ * Mixed stream over every button: clean clicks, bounces, long holds and
+ * drags, wheel reversals and the occasional injected event. Timestamps
+ * are microseconds.
+ */
+static inline void test_build_stream(MouseEvent *events, size_t count, uint64_t seed)
+{
+    uint64_t rng = seed;
+    uint64_t now = 1000000;
+    bool down[MOUSE_BUTTON_COUNT] = {false};
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t r = test_rand(&rng);
+        MouseEvent *e = &events[i];
+        memset(e, 0, sizeof(*e));
+
+        e->button = (MouseButton)(r % MOUSE_BUTTON_COUNT);
+        if (e->button == MOUSE_BUTTON_WHEEL)
+        {
+            e->data = (r >> 8) & 1 ? 120 : -120;
+        }
+        else
+        {
+            down[e->button] = !down[e->button];
+            e->is_down = down[e->button];
+        }
+
+        switch ((r >> 12) & 3)
+        {
+        case 0:
+            now += 1000 + (r >> 16) % 9000; /* bounce range */
+            break;
+        case 1:
+            now += 250000 + (r >> 16) % 100000; /* long hold */
+            break;
+        default:
+            now += 40000 + (r >> 16) % 120000; /* human pace */
+            break;
+        }
+
+        e->timestamp = now;
+        e->x = 500 + (long)((r >> 24) % 16);
+        e->y = 500 + (long)((r >> 32) % 16);
+        e->is_injected = ((r >> 40) & 63) == 0;
+    }
+}
+
+/* Every button debounced except X2, which exercises the pass-through path */
+static inline void test_configure(DebounceManager *manager)
+{
+    debounce_init(manager);
+    for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
+    {
+        debounce_set_monitored(manager, i, i != MOUSE_BUTTON_X2);
+        debounce_set_threshold(manager, i, i == MOUSE_BUTTON_WHEEL ? 30 : 50, 1, 200);
+    }
+}
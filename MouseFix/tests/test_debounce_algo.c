@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <string.h>
+#include "../src/core/debounce_algo.h"
+#include "../src/core/debouncer.h"
+#include "test_common.h"
+
+/* Debounce algorithm family */
+
+#define MAX_OUTPUTS 32
+
+typedef struct
+{
+    bool down;
+    uint64_t at;
+} Output;
+
+typedef struct
+{
+    Output outputs[MAX_OUTPUTS];
+    int count;
+} Trace;
+
+static void record(Trace *trace, bool down, uint64_t at)
+{
+    if (trace->count < MAX_OUTPUTS)
+    {
+        trace->outputs[trace->count].down = down;
+        trace->outputs[trace->count].at = at;
+    }
+    trace->count++;
+}
+
+static void drain(DebounceFilter *filter, Trace *trace, uint64_t now)
+{
+    uint64_t deadline;
+    bool down;
+    while (debounce_filter_deadline(filter, &deadline) && deadline <= now)
+    {
+        debounce_filter_advance(filter, deadline, &down);
+        record(trace, down, deadline);
+    }
+}
+
+/* Edges alternate down, up, down... starting at times[0] (ms); outputs drained to the end */
+static Trace run(DebounceAlgo algo, uint32_t press_ms, uint32_t release_ms, const uint32_t *times, int count)
+{
+    DebounceAlgoParams params = {algo, press_ms * 1000, release_ms * 1000, 1000};
+    DebounceFilter filter;
+    debounce_filter_init(&filter, &params);
+
+    Trace trace;
+    memset(&trace, 0, sizeof(trace));
+    for (int i = 0; i < count; i++)
+    {
+        uint64_t now = 1000000 + (uint64_t)times[i] * 1000;
+        bool down = i % 2 == 0;
+        drain(&filter, &trace, now);
+        if (debounce_filter_edge(&filter, down, now))
+            record(&trace, down, now);
+    }
+    drain(&filter, &trace, UINT64_MAX);
+    return trace;
+}
+
+/* Output i is the given level at the given ms */
+static bool output_is(const Trace *trace, int i, bool down, uint32_t at_ms)
+{
+    return i < trace->count && trace->outputs[i].down == down && trace->outputs[i].at == 1000000 + (uint64_t)at_ms * 1000;
+}
+
+static void test_clean_click(void)
+{
+    TEST("Clean click: the latency each algorithm adds");
+
+    static const uint32_t click[] = {0, 80};
+    Trace t = run(DEBOUNCE_ALGO_LOCKOUT, 10, 10, click, 2);
+    CHECK(t.count == 2 && output_is(&t, 0, true, 0) && output_is(&t, 1, false, 80), "Lockout passes both edges at once");
+    t = run(DEBOUNCE_ALGO_ASYMMETRIC, 20, 5, click, 2);
+    CHECK(t.count == 2 && output_is(&t, 0, true, 0) && output_is(&t, 1, false, 80), "Asymmetric passes both edges at once");
+    t = run(DEBOUNCE_ALGO_TRAILING, 8, 4, click, 2);
+    CHECK(t.count == 2 && output_is(&t, 0, true, 8) && output_is(&t, 1, false, 84), "Trailing waits press then release window");
+    t = run(DEBOUNCE_ALGO_INTEGRATOR, 5, 5, click, 2);
+    CHECK(t.count == 2 && output_is(&t, 0, true, 4) && output_is(&t, 1, false, 84),
+          "Integrator changes on the fifth equal sample");
+    t = run(DEBOUNCE_ALGO_HYSTERESIS, 6, 6, click, 2);
+    CHECK(t.count == 2 && output_is(&t, 0, true, 6) && output_is(&t, 1, false, 86), "Hysteresis counts up then back down");
+}
+
+static void test_bounce_burst(void)
+{
+    TEST("Bounce burst after the press becomes one click");
+
+    /* Press at 0, contacts open twice for 1ms, release at 80 */
+    static const uint32_t burst[] = {0, 3, 4, 7, 8, 80};
+    Trace t = run(DEBOUNCE_ALGO_LOCKOUT, 10, 10, burst, 6);
+    CHECK(t.count == 2 && output_is(&t, 0, true, 0) && output_is(&t, 1, false, 3),
+          "Lockout lets the first opening through as the release");
+    t = run(DEBOUNCE_ALGO_ASYMMETRIC, 10, 10, burst, 6);
+    CHECK(t.count == 2 && output_is(&t, 0, true, 0) && output_is(&t, 1, false, 80), "Asymmetric holds the press");
+    t = run(DEBOUNCE_ALGO_TRAILING, 5, 5, burst, 6);
+    CHECK(t.count == 2 && output_is(&t, 0, true, 13) && output_is(&t, 1, false, 85), "Trailing waits out the last bounce");
+    t = run(DEBOUNCE_ALGO_HYSTERESIS, 10, 10, burst, 6);
+    CHECK(t.count == 2 && output_is(&t, 0, true, 14) && output_is(&t, 1, false, 90),
+          "Hysteresis: an opening takes back only its own length (trailing 10ms would wait until 18)");
+
+    /* Opening from 1.2 to 1.7ms, between two samples */
+    DebounceAlgoParams params = {DEBOUNCE_ALGO_INTEGRATOR, 3000, 3000, 1000};
+    DebounceFilter filter;
+    debounce_filter_init(&filter, &params);
+    debounce_filter_edge(&filter, true, 1000000);
+    debounce_filter_edge(&filter, false, 1001200);
+    debounce_filter_edge(&filter, true, 1001700);
+    uint64_t deadline = 0;
+    CHECK(debounce_filter_deadline(&filter, &deadline) && deadline == 1002000,
+          "Integrator never sees an opening between samples");
+}
+
+static void test_asymmetric_resync(void)
+{
+    TEST("Asymmetric catches up with a level that changed in its window");
+
+    /* Released 3ms into a 10ms press window: the release comes out when the window ends */
+    static const uint32_t tap[] = {0, 3};
+    Trace t = run(DEBOUNCE_ALGO_ASYMMETRIC, 10, 5, tap, 2);
+    CHECK(t.count == 2 && output_is(&t, 0, true, 0) && output_is(&t, 1, false, 10), "Release emitted at 10ms");
+
+    /* Pressed again 2ms into the 5ms release window that follows */
+    static const uint32_t again[] = {0, 3, 12};
+    t = run(DEBOUNCE_ALGO_ASYMMETRIC, 10, 5, again, 3);
+    CHECK(t.count == 3 && output_is(&t, 2, true, 15), "Second press emitted when the release window ends");
+}
+
+static void test_lockout_matches_engine(void)
+{
+    TEST("Lockout matches the engine with Smart Drag off");
+
+    static const uint32_t thresholds_ms[] = {5, 20, 50};
+    uint64_t rng = 0x9E3779B97F4A7C15ull;
+    int mismatches = 0;
+
+    for (int t = 0; t < 3; t++)
+    {
+        DebounceManager manager;
+        debounce_init(&manager);
+        debounce_set_hybrid_heuristic(&manager, false);
+        debounce_set_monitored(&manager, MOUSE_BUTTON_LEFT, true);
+        debounce_set_threshold(&manager, MOUSE_BUTTON_LEFT, thresholds_ms[t], 1, 200);
+
+        DebounceAlgoParams params = {DEBOUNCE_ALGO_LOCKOUT, thresholds_ms[t] * 1000, 0, 0};
+        DebounceFilter filter;
+        debounce_filter_init(&filter, &params);
+
+        MouseEvent e;
+        memset(&e, 0, sizeof(e));
+        e.button = MOUSE_BUTTON_LEFT;
+        e.timestamp = 1000000;
+        for (int i = 0; i < 20000; i++)
+        {
+            rng ^= rng << 13;
+            rng ^= rng >> 7;
+            rng ^= rng << 17;
+            /* Mostly alternating, with the odd repeated edge */
+            e.is_down = (rng >> 20) % 8 == 0 ? e.is_down : !e.is_down;
+            e.timestamp += 500 + rng % 80000;
+            bool blocked = debounce_process_event(&manager, &e);
+            mismatches += blocked == debounce_filter_edge(&filter, e.is_down, e.timestamp);
+        }
+    }
+    CHECK(mismatches == 0, "Same verdict on 60000 edges at three thresholds");
+}
+
+static void test_names(void)
+{
+    TEST("Algorithm names");
+
+    bool round_trip = true;
+    for (int a = 0; a < DEBOUNCE_ALGO_COUNT; a++)
+        round_trip = round_trip && debounce_algo_from_name(debounce_algo_name((DebounceAlgo)a)) == (DebounceAlgo)a;
+    CHECK(round_trip, "Every name maps back to its algorithm");
+    CHECK(debounce_algo_from_name("nope") == DEBOUNCE_ALGO_COUNT, "Unknown name rejected");
+}
+
+int main(void)
+{
+    printf("================================================\n");
+    printf("Debounce Algorithm Tests\n");
+    printf("================================================\n");
+
+    test_clean_click();
+    test_bounce_burst();
+    test_asymmetric_resync();
+    test_lockout_matches_engine();
+    test_names();
+
+    printf("\n================================================\n");
+    printf("Result: %d/%d passed", pass_count, test_count);
+    if (fail_count > 0)
+        printf(" (%d failed)", fail_count);
+    printf("\n================================================\n");
+
+    return fail_count > 0 ? 1 : 0;
+}
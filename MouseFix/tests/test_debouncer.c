@@ -0,0 +1,359 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/core/debouncer.h"
+#include "test_common.h"
+
+/* Engine API tests beyond the Smart Drag state machine */
+
+#define STREAM_LENGTH 20000
+
+static void test_batch_matches_single(void)
+{
+    TEST("Batch verdicts match one-at-a-time processing");
+
+    MouseEvent *events = calloc(STREAM_LENGTH, sizeof(MouseEvent));
+    bool *verdicts = calloc(STREAM_LENGTH, sizeof(bool));
+    if (!events || !verdicts)
+    {
+        CHECK(false, "allocation");
+        return;
+    }
+    test_build_stream(events, STREAM_LENGTH, 0x1234567887654321ull);
+
+    DebounceManager single, batch;
+    test_configure(&single);
+    test_configure(&batch);
+
+    size_t mismatches = 0;
+    size_t single_blocked = 0;
+    for (size_t i = 0; i < STREAM_LENGTH; i++)
+        single_blocked += debounce_process_event(&single, &events[i]);
+
+    /* Uneven chunks so batch boundaries land everywhere */
+    size_t batch_blocked = 0;
+    size_t offset = 0;
+    size_t chunk = 1;
+    while (offset < STREAM_LENGTH)
+    {
+        size_t n = STREAM_LENGTH - offset < chunk ? STREAM_LENGTH - offset : chunk;
+        batch_blocked += debounce_process_batch(&batch, events + offset, n, verdicts + offset);
+        offset += n;
+        chunk = chunk * 3 % 257 + 1;
+    }
+
+    DebounceManager replay;
+    test_configure(&replay);
+    for (size_t i = 0; i < STREAM_LENGTH; i++)
+    {
+        if (debounce_process_event(&replay, &events[i]) != verdicts[i])
+            mismatches++;
+    }
+
+    CHECK(mismatches == 0, "Per-event verdicts identical");
+    CHECK(single_blocked == batch_blocked, "Blocked counts identical");
+    CHECK(single_blocked > 0 && single_blocked < STREAM_LENGTH, "Stream exercises both verdicts");
+    CHECK(debounce_get_total_blocks(&single) == debounce_get_total_blocks(&batch), "Statistics identical");
+
+    free(verdicts);
+    free(events);
+}
+
+static void test_packed_events(void)
+{
+    TEST("Packed events round-trip and give the same verdicts");
+
+    MouseEvent e = {MOUSE_BUTTON_X2, 0x123456789ABCull, true, -1920, 40000, true, -240};
+    PackedEvent packed = mouse_event_pack(&e);
+    MouseEvent back;
+    mouse_event_unpack(&packed, &back);
+    CHECK(sizeof(PackedEvent) == 16, "16 bytes");
+    CHECK(back.button == MOUSE_BUTTON_X2 && back.timestamp == e.timestamp && back.is_down && back.is_injected &&
+              back.x == -1920 && back.data == -240,
+          "Fields survive packing");
+    CHECK(back.y == INT16_MAX, "Out-of-range coordinate clamped");
+    e.button = MOUSE_BUTTON_UNKNOWN;
+    packed = mouse_event_pack(&e);
+    CHECK(packed_event_button(&packed) == MOUSE_BUTTON_UNKNOWN, "Unknown button preserved");
+
+    MouseEvent *events = calloc(STREAM_LENGTH, sizeof(MouseEvent));
+    PackedEvent *packed_events = calloc(STREAM_LENGTH, sizeof(PackedEvent));
+    bool *verdicts = calloc(STREAM_LENGTH, sizeof(bool));
+    bool *packed_verdicts = calloc(STREAM_LENGTH, sizeof(bool));
+    if (!events || !packed_events || !verdicts || !packed_verdicts)
+    {
+        CHECK(false, "allocation");
+        return;
+    }
+    test_build_stream(events, STREAM_LENGTH, 0x0F1E2D3C4B5A6978ull);
+    for (size_t i = 0; i < STREAM_LENGTH; i++)
+        packed_events[i] = mouse_event_pack(&events[i]);
+
+    DebounceManager plain, batch, single;
+    test_configure(&plain);
+    test_configure(&batch);
+    test_configure(&single);
+    debounce_process_batch(&plain, events, STREAM_LENGTH, verdicts);
+    debounce_process_packed_batch(&batch, packed_events, STREAM_LENGTH, packed_verdicts);
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < STREAM_LENGTH; i++)
+    {
+        mismatches += verdicts[i] != packed_verdicts[i];
+        mismatches += verdicts[i] != debounce_process_packed(&single, &packed_events[i]);
+    }
+    CHECK(mismatches == 0, "Packed batch and single verdicts match the MouseEvent batch");
+    CHECK(debounce_get_total_blocks(&plain) == debounce_get_total_blocks(&batch), "Statistics identical");
+
+    free(packed_verdicts);
+    free(verdicts);
+    free(packed_events);
+    free(events);
+}
+
+/* Apply configuration number index (of 16) to a manager */
+static void apply_variant(DebounceManager *manager, int index)
+{
+    static const uint32_t MASKS[4] = {
+        0x3F,                               /* everything */
+        0x3F & ~(1u << MOUSE_BUTTON_WHEEL), /* buttons only */
+        1u << MOUSE_BUTTON_WHEEL,           /* wheel only */
+        (1u << MOUSE_BUTTON_LEFT) | (1u << MOUSE_BUTTON_X1) | (1u << MOUSE_BUTTON_WHEEL),
+    };
+
+    debounce_set_hybrid_heuristic(manager, index & 1);
+    AdaptiveParams adaptive = {(index & 2) != 0, 0, 0};
+    debounce_set_adaptive(manager, &adaptive);
+    for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
+        debounce_set_monitored(manager, i, (MASKS[index >> 2] >> i) & 1);
+}
+
+static void test_specialized_matches_generic(void)
+{
+    TEST("Specialised handlers match the generic path under every configuration");
+
+    MouseEvent *events = calloc(STREAM_LENGTH, sizeof(MouseEvent));
+    if (!events)
+    {
+        CHECK(false, "allocation");
+        return;
+    }
+    test_build_stream(events, STREAM_LENGTH, 0x5555AAAA3333CCCCull);
+
+    /* Each configuration alone, then all of them switched mid-stream */
+    size_t mismatches = 0;
+    size_t blocked = 0;
+    for (int variant = 0; variant <= 16; variant++)
+    {
+        DebounceManager specialized, generic;
+        test_configure(&specialized);
+        test_configure(&generic);
+
+        for (size_t i = 0; i < STREAM_LENGTH; i++)
+        {
+            if (variant < 16 ? i == 0 : i % 1000 == 0)
+            {
+                int index = variant < 16 ? variant : (int)(i / 1000) % 16;
+                apply_variant(&specialized, index);
+                apply_variant(&generic, index);
+            }
+            bool verdict = debounce_process_event(&specialized, &events[i]);
+            mismatches += verdict != debounce_process_event_generic(&generic, &events[i]);
+            blocked += verdict;
+        }
+
+        for (int b = 0; b < MOUSE_BUTTON_COUNT; b++)
+        {
+            mismatches += debounce_get_button_blocks(&specialized, b) != debounce_get_button_blocks(&generic, b);
+            mismatches += debounce_get_threshold_us(&specialized, b) != debounce_get_threshold_us(&generic, b);
+        }
+    }
+
+    CHECK(mismatches == 0, "Verdicts, block counts and adapted thresholds identical");
+    CHECK(blocked > 0, "Streams exercise blocking");
+
+    free(events);
+}
+
+static void test_batch_applies_reset(void)
+{
+    TEST("Batch picks up a pending statistics reset");
+
+    DebounceManager manager;
+    test_configure(&manager);
+
+    MouseEvent events[3] = {
+        {MOUSE_BUTTON_LEFT, 1000000, true, 0, 0, false, 0},
+        {MOUSE_BUTTON_LEFT, 1060000, false, 0, 0, false, 0},
+        {MOUSE_BUTTON_LEFT, 1070000, true, 0, 0, false, 0},
+    };
+    bool verdicts[3];
+
+    CHECK(debounce_process_batch(&manager, events, 3, verdicts) == 1, "Bounce blocked");
+    CHECK(verdicts[2] && !verdicts[0] && !verdicts[1], "Only the bounce DOWN blocked");
+    CHECK(debounce_get_button_blocks(&manager, MOUSE_BUTTON_LEFT) == 1, "One block counted");
+
+    debounce_reset_statistics(&manager);
+    CHECK(debounce_get_button_blocks(&manager, MOUSE_BUTTON_LEFT) == 0, "Counter cleared");
+
+    MouseEvent up = {MOUSE_BUTTON_LEFT, 1200000, false, 0, 0, false, 0};
+    CHECK(debounce_process_batch(&manager, &up, 1, verdicts) == 0, "UP after reset passes (state IDLE)");
+}
+
+static void test_smart_drag_tuning(void)
+{
+    TEST("Smart Drag tuning changes hold and confirm timing");
+
+    DebounceManager manager;
+    test_configure(&manager);
+    debounce_set_hybrid_heuristic(&manager, true);
+
+    /* A 150ms hold is a click with the stock 200ms hold threshold */
+    MouseEvent down = {MOUSE_BUTTON_LEFT, 1000000, true, 100, 100, false, 0};
+    MouseEvent up = {MOUSE_BUTTON_LEFT, 1150000, false, 100, 100, false, 0};
+    debounce_process_event(&manager, &down);
+    CHECK(!debounce_process_event(&manager, &up), "Default: 150ms hold passes");
+
+    SmartDragParams params = {100000, 4, 80000};
+    debounce_set_smart_drag(&manager, &params);
+    down.timestamp = 2000000;
+    up.timestamp = 2150000;
+    debounce_process_event(&manager, &down);
+    CHECK(debounce_process_event(&manager, &up), "100ms hold threshold: UP deferred");
+
+    uint64_t deadline = 0;
+    CHECK(debounce_get_next_deadline(&manager, &deadline) && deadline == 2150000 + 80000, "Deadline uses confirm_us");
+    CHECK(debounce_collect_deferred_releases(&manager, 2150000 + 79999) == 0, "Not released early");
+    CHECK(debounce_collect_deferred_releases(&manager, 2150000 + 80000) == 1u << MOUSE_BUTTON_LEFT, "Released at confirm_us");
+
+    DebounceConfig config;
+    debounce_get_config(&manager, &config);
+    CHECK(config.smart_drag.hold_us == 100000 && config.smart_drag.dist_sq == 4 && config.smart_drag.confirm_us == 80000,
+          "Config snapshot carries the tuning");
+
+    SmartDragParams defaults = {0, 0, 0};
+    debounce_set_smart_drag(&manager, &defaults);
+    debounce_get_smart_drag(&manager, &params);
+    CHECK(params.hold_us == SMART_DRAG_HOLD_THRESHOLD_US && params.dist_sq == SMART_DRAG_DIST_THRESHOLD_SQ &&
+              params.confirm_us == SMART_DRAG_CONFIRM_TIMEOUT_US,
+          "Zero fields restore the defaults");
+}
+
+/*
+ * Left-button clicks held 60ms, a quarter of them double clicks 80-120ms
+ * after the release, a third followed by chatter bounce_min..+4ms after
+ * the release. Returns the number of events written.
+ */
+static size_t build_wearing_clicks(MouseEvent *events, size_t clicks, uint64_t *now, uint64_t *rng, uint32_t bounce_min_us)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < clicks; i++)
+    {
+        uint64_t r = test_rand(rng);
+        *now += (r & 3) == 0 ? 80000 + (r >> 8) % 40000 : 150000 + (r >> 8) % 250000;
+        events[n++] = (MouseEvent){MOUSE_BUTTON_LEFT, *now, true, 100, 100, false, 0};
+        *now += 60000;
+        events[n++] = (MouseEvent){MOUSE_BUTTON_LEFT, *now, false, 100, 100, false, 0};
+
+        if ((r >> 32) % 3 == 0)
+        {
+            *now += bounce_min_us + (r >> 40) % 4000;
+            events[n++] = (MouseEvent){MOUSE_BUTTON_LEFT, *now, true, 100, 100, false, 0};
+            *now += 2000;
+            events[n++] = (MouseEvent){MOUSE_BUTTON_LEFT, *now, false, 100, 100, false, 0};
+        }
+    }
+    return n;
+}
+
+static void test_adaptive_thresholds(void)
+{
+    TEST("Adaptive thresholds follow bounce and click gaps");
+
+    static MouseEvent events[4 * 3000];
+    static bool single[4 * 3000];
+    static bool batch[4 * 3000];
+    uint64_t now = 1000000, rng = 0x2545F4914F6CDD1Dull;
+
+    DebounceManager manager, batched;
+    test_configure(&manager);
+    AdaptiveParams adaptive = {true, 10000, 100000};
+    debounce_set_adaptive(&manager, &adaptive);
+    debounce_set_threshold(&manager, MOUSE_BUTTON_LEFT, 20, 1, 200);
+    batched = manager;
+
+    /* Fresh switch: 2-6ms chatter, double clicks from 80ms */
+    size_t count = build_wearing_clicks(events, 3000, &now, &rng, 2000);
+    for (size_t i = 0; i < count; i++)
+        single[i] = debounce_process_event(&manager, &events[i]);
+    uint32_t fresh = debounce_get_threshold_us(&manager, MOUSE_BUTTON_LEFT);
+    CHECK(fresh > 20000 && fresh < 80000, "Moves from 20ms into the gap between chatter and double clicks");
+
+    debounce_process_batch(&batched, events, count, batch);
+    CHECK(memcmp(single, batch, count * sizeof(bool)) == 0 &&
+              debounce_get_threshold_us(&batched, MOUSE_BUTTON_LEFT) == fresh,
+          "Batch path learns identically");
+
+    /* Worn switch: chatter now 15-19ms after the release */
+    count = build_wearing_clicks(events, 3000, &now, &rng, 15000);
+    uint32_t missed = 0, suppressed = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        bool blocked = debounce_process_event(&manager, &events[i]);
+        bool bounce = i > 0 && events[i].is_down && events[i].timestamp - events[i - 1].timestamp < 25000;
+        if (i >= count / 2 && events[i].is_down)
+        {
+            missed += bounce && !blocked;
+            suppressed += !bounce && blocked;
+        }
+    }
+    uint32_t worn = debounce_get_threshold_us(&manager, MOUSE_BUTTON_LEFT);
+    CHECK(worn > fresh && worn < 80000, "Rises with the chatter, stays under double clicks");
+    CHECK(missed == 0 && suppressed == 0, "Second half: every bounce caught, no click suppressed");
+
+    /* A manual setting wins and restarts learning from there */
+    debounce_set_threshold(&manager, MOUSE_BUTTON_LEFT, 30, 1, 200);
+    CHECK(debounce_get_threshold_us(&manager, MOUSE_BUTTON_LEFT) == 30000, "Manual threshold applied");
+    debounce_process_event(&manager, &(MouseEvent){MOUSE_BUTTON_LEFT, now + 300000, true, 100, 100, false, 0});
+    uint32_t restarted = debounce_get_threshold_us(&manager, MOUSE_BUTTON_LEFT);
+    CHECK(restarted >= 29000 && restarted <= 31000, "One gap moves it by a single step");
+
+    adaptive.max_us = 25000;
+    debounce_set_adaptive(&manager, &adaptive);
+    debounce_process_event(&manager, &(MouseEvent){MOUSE_BUTTON_LEFT, now + 360000, false, 100, 100, false, 0});
+    debounce_process_event(&manager, &(MouseEvent){MOUSE_BUTTON_LEFT, now + 700000, true, 100, 100, false, 0});
+    CHECK(debounce_get_threshold_us(&manager, MOUSE_BUTTON_LEFT) == 25000, "Clamped to the upper bound");
+
+    adaptive.enabled = false;
+    debounce_set_adaptive(&manager, &adaptive);
+    debounce_process_event(&manager, &(MouseEvent){MOUSE_BUTTON_LEFT, now + 760000, false, 100, 100, false, 0});
+    debounce_process_event(&manager, &(MouseEvent){MOUSE_BUTTON_LEFT, now + 765000, true, 100, 100, false, 0});
+    CHECK(debounce_get_threshold_us(&manager, MOUSE_BUTTON_LEFT) == 25000, "Frozen when disabled");
+
+    DebounceConfig config;
+    debounce_get_config(&manager, &config);
+    CHECK(!config.adaptive.enabled && config.adaptive.min_us == 10000 && config.adaptive.max_us == 25000,
+          "Config snapshot carries the bounds");
+}
+
+int main(void)
+{
+    printf("================================================\n");
+    printf("Debouncer API Tests\n");
+    printf("================================================\n");
+
+    test_batch_matches_single();
+    test_packed_events();
+    test_specialized_matches_generic();
+    test_batch_applies_reset();
+    test_smart_drag_tuning();
+    test_adaptive_thresholds();
+
+    printf("\n================================================\n");
+    printf("Result: %d/%d passed", pass_count, test_count);
+    if (fail_count > 0)
+        printf(" (%d failed)", fail_count);
+    printf("\n================================================\n");
+
+    return fail_count > 0 ? 1 : 0;
+}
@@ -0,0 +1,423 @@
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../src/linux/evdev_daemon.h"
+#include "../src/linux/evdev_sink.h"
+#include "test_common.h"
+
+/* evdev filter and the headless daemon loop, on recorded frames, files and pipes */
+
+#define IN_PATH     "test_evdev_in.bin"
+#define OUT_PATH    "test_evdev_out.bin"
+#define MAX_FRAMES  32768
+#define CLICKS      1000
+
+#include "test_evdev_common.h"
+
+static Frames g_input, g_output, g_expected;
+
+static void setup(EvdevFilter *filter, bool smart_drag)
+{
+    DebounceManager *debounce = &filter->pipeline.debounce;
+    for (int b = 0; b < MOUSE_BUTTON_COUNT; b++)
+    {
+        debounce_set_monitored(debounce, b, true);
+        debounce_set_threshold(debounce, b, b == MOUSE_BUTTON_WHEEL ? 30 : 50, 1, 200);
+    }
+    debounce_set_hybrid_heuristic(debounce, smart_drag);
+}
+
+/* Runs input through a fresh filter on frame time, draining releases at the end */
+static EvdevFilterStats run_filter(const Frames *input, Frames *output, bool smart_drag)
+{
+    static EvdevFilter filter;
+    evdev_filter_init(&filter);
+    setup(&filter, smart_drag);
+
+    EvdevOutput out = {output->frames, 0, MAX_FRAMES};
+    for (size_t i = 0; i < input->count; i++)
+        evdev_filter_frame(&filter, &input->frames[i], evdev_frame_time(&input->frames[i]), &out);
+    evdev_filter_advance(&filter, UINT64_MAX, &out);
+    output->count = out.count;
+    return filter.stats;
+}
+
+static bool frame_is(const struct input_event *e, uint16_t type, uint16_t code, int32_t value)
+{
+    return e->type == type && e->code == code && e->value == value;
+}
+
+static void test_click(void)
+{
+    TEST("Clean click passes frame for frame");
+
+    g_input.count = 0;
+    add_key(&g_input, 1000000, BTN_LEFT, 1);
+    add_key(&g_input, 1080000, BTN_LEFT, 0);
+    EvdevFilterStats stats = run_filter(&g_input, &g_output, true);
+
+    CHECK(g_output.count == g_input.count &&
+              memcmp(g_output.frames, g_input.frames, g_input.count * sizeof(struct input_event)) == 0,
+          "Output identical to input");
+    CHECK(stats.events == 2 && stats.blocked == 0, "Two events, none blocked");
+}
+
+static void test_bounce(void)
+{
+    TEST("Bounce press is removed, moves in its report are kept");
+
+    g_input.count = 0;
+    add_key(&g_input, 1000000, BTN_LEFT, 1);
+    add_key(&g_input, 1060000, BTN_LEFT, 0);
+    add(&g_input, 1070000, EV_MSC, MSC_SCAN, 0x90001);
+    add(&g_input, 1070000, EV_KEY, BTN_LEFT, 1);
+    add(&g_input, 1070000, EV_REL, REL_X, 3);
+    add(&g_input, 1070000, EV_SYN, SYN_REPORT, 0);
+    add_key(&g_input, 1075000, BTN_LEFT, 0);
+    EvdevFilterStats stats = run_filter(&g_input, &g_output, true);
+
+    CHECK(stats.blocked == 2, "Bounce press and its release blocked");
+    CHECK(g_output.count == 8 && frame_is(&g_output.frames[6], EV_REL, REL_X, 3) &&
+              frame_is(&g_output.frames[7], EV_SYN, SYN_REPORT, 0),
+          "Bounce report reduced to the move");
+}
+
+static void test_scan_codes(void)
+{
+    TEST("A blocked key takes only its own scan code");
+
+    g_input.count = 0;
+    add_key(&g_input, 1000000, BTN_LEFT, 1);
+    add_key(&g_input, 1060000, BTN_LEFT, 0);
+    /* Left bounces in the same report as a genuine right press */
+    add(&g_input, 1070000, EV_MSC, MSC_SCAN, 0x90001);
+    add(&g_input, 1070000, EV_KEY, BTN_LEFT, 1);
+    add(&g_input, 1070000, EV_MSC, MSC_SCAN, 0x90002);
+    add(&g_input, 1070000, EV_KEY, BTN_RIGHT, 1);
+    add(&g_input, 1070000, EV_SYN, SYN_REPORT, 0);
+    EvdevFilterStats stats = run_filter(&g_input, &g_output, true);
+
+    CHECK(stats.blocked == 1, "Left bounce blocked, right press kept");
+    CHECK(g_output.count == 9 && frame_is(&g_output.frames[6], EV_MSC, MSC_SCAN, 0x90002) &&
+              frame_is(&g_output.frames[7], EV_KEY, BTN_RIGHT, 1) && frame_is(&g_output.frames[8], EV_SYN, SYN_REPORT, 0),
+          "Right press keeps its scan code; left's is gone");
+}
+
+static void test_wheel(void)
+{
+    TEST("Wheel reversal inside the threshold is removed with its hi-res frame");
+
+    g_input.count = 0;
+    add(&g_input, 1000000, EV_REL, REL_WHEEL, 1);
+    add(&g_input, 1000000, EV_REL, REL_WHEEL_HI_RES, 120);
+    add(&g_input, 1000000, EV_SYN, SYN_REPORT, 0);
+    add(&g_input, 1010000, EV_REL, REL_WHEEL, -1);
+    add(&g_input, 1010000, EV_REL, REL_WHEEL_HI_RES, -120);
+    add(&g_input, 1010000, EV_SYN, SYN_REPORT, 0);
+    add(&g_input, 1015000, EV_REL, REL_WHEEL_HI_RES, 60);
+    add(&g_input, 1015000, EV_SYN, SYN_REPORT, 0);
+    add(&g_input, 1100000, EV_REL, REL_WHEEL, 1);
+    add(&g_input, 1100000, EV_SYN, SYN_REPORT, 0);
+    EvdevFilterStats stats = run_filter(&g_input, &g_output, true);
+
+    CHECK(stats.events == 3 && stats.blocked == 1, "One reversal blocked");
+    CHECK(g_output.count == 7 && frame_is(&g_output.frames[3], EV_REL, REL_WHEEL_HI_RES, 60) &&
+              frame_is(&g_output.frames[5], EV_REL, REL_WHEEL, 1),
+          "Reversal report gone; a notch-less hi-res report passes");
+}
+
+static void test_deferred_release(void)
+{
+    TEST("Smart Drag release comes out at its deadline with the key code it was pressed with");
+
+    g_input.count = 0;
+    add_key(&g_input, 1000000, BTN_BACK, 1);
+    add_key(&g_input, 1300000, BTN_BACK, 0);
+    add(&g_input, 1500000, EV_REL, REL_X, 1);
+    add(&g_input, 1500000, EV_SYN, SYN_REPORT, 0);
+    EvdevFilterStats stats = run_filter(&g_input, &g_output, true);
+
+    CHECK(stats.blocked == 1 && stats.releases == 1, "Release deferred, then synthesized");
+    CHECK(g_output.count == 7 && frame_is(&g_output.frames[3], EV_KEY, BTN_BACK, 0) &&
+              frame_is(&g_output.frames[4], EV_SYN, SYN_REPORT, 0),
+          "BTN_BACK up and SYN_REPORT, before the next report");
+    CHECK(evdev_frame_time(&g_output.frames[3]) == 1450000, "Stamped with the deadline (up + 150ms)");
+
+    g_input.count = 2 * 3;
+    run_filter(&g_input, &g_output, true);
+    CHECK(g_output.count == 5 && frame_is(&g_output.frames[3], EV_KEY, BTN_BACK, 0),
+          "Still released when the input ends first");
+}
+
+static void test_syn_dropped(void)
+{
+    TEST("SYN_DROPPED discards frames up to the next SYN_REPORT");
+
+    g_input.count = 0;
+    add(&g_input, 1000000, EV_KEY, BTN_LEFT, 1);
+    add(&g_input, 1000000, EV_SYN, SYN_DROPPED, 0);
+    add(&g_input, 1000000, EV_KEY, BTN_RIGHT, 1);
+    add(&g_input, 1000000, EV_SYN, SYN_REPORT, 0);
+    add_key(&g_input, 1100000, BTN_MIDDLE, 1);
+    EvdevFilterStats stats = run_filter(&g_input, &g_output, true);
+
+    CHECK(stats.dropped == 1 && stats.events == 1, "Only the report after the resync reaches the engine");
+    CHECK(g_output.count == 3 && frame_is(&g_output.frames[1], EV_KEY, BTN_MIDDLE, 1), "And only it is written");
+}
+
+/* Clicks with chatter, drags, wheel turns and reversals, as a recorded evdev file would hold */
+static void make_recording(Frames *f)
+{
+    uint64_t rng = 0x2545F4914F6CDD1Dull;
+    uint64_t now = 1000000;
+    f->count = 0;
+
+    for (int i = 0; i < CLICKS; i++)
+    {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        uint16_t code = (rng >> 8) % 4 == 0 ? BTN_RIGHT : BTN_LEFT;
+
+        now += 200000 + rng % 100000;
+        add_key(f, now, code, 1);
+        for (int m = 0; m < (int)(rng % 5); m++)
+        {
+            now += 1000;
+            add(f, now, EV_REL, REL_X, 4);
+            add(f, now, EV_REL, REL_Y, -2);
+            add(f, now, EV_SYN, SYN_REPORT, 0);
+        }
+        now += (rng >> 16) % 3 == 0 ? 350000 : 60000;
+        add_key(f, now, code, 0);
+        if ((rng >> 24) % 3 == 0)
+        {
+            add_key(f, now + 4000, code, 1);
+            add_key(f, now + 7000, code, 0);
+        }
+        if ((rng >> 32) % 4 == 0)
+        {
+            add(f, now + 20000, EV_REL, REL_WHEEL, 1);
+            add(f, now + 20000, EV_SYN, SYN_REPORT, 0);
+            add(f, now + 25000, EV_REL, REL_WHEEL, -1);
+            add(f, now + 25000, EV_SYN, SYN_REPORT, 0);
+            now += 25000;
+        }
+    }
+}
+
+static bool write_file(const char *path, const Frames *f)
+{
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return false;
+    bool ok = fwrite(f->frames, sizeof(struct input_event), f->count, file) == f->count;
+    return fclose(file) == 0 && ok;
+}
+
+static bool read_file(const char *path, Frames *f)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return false;
+    f->count = fread(f->frames, sizeof(struct input_event), MAX_FRAMES, file);
+    fclose(file);
+    return true;
+}
+
+static void test_recorded_file(void)
+{
+    TEST("Daemon on a recorded file matches the filter run directly");
+
+    make_recording(&g_input);
+    EvdevFilterStats direct = run_filter(&g_input, &g_expected, true);
+    CHECK(write_file(IN_PATH, &g_input), "Recording written");
+
+    int in_fd = open(IN_PATH, O_RDONLY);
+    int out_fd = open(OUT_PATH, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    static EvdevDaemon daemon;
+    bool ok = in_fd >= 0 && out_fd >= 0 && evdev_daemon_init(&daemon, in_fd, out_fd, EVDEV_CLOCK_FRAME, true);
+    setup(&daemon.stream.filter, true);
+    CHECK(ok && evdev_daemon_run(&daemon) == 0, "Ran to end of file");
+    close(in_fd);
+    close(out_fd);
+    evdev_daemon_cleanup(&daemon);
+
+    CHECK(direct.blocked > 0 && direct.releases > 0, "Recording has bounces and drags");
+    CHECK(read_file(OUT_PATH, &g_output) && g_output.count == g_expected.count &&
+              memcmp(g_output.frames, g_expected.frames, g_expected.count * sizeof(struct input_event)) == 0,
+          "Same frames written");
+    CHECK(daemon.stream.stats.writes <= daemon.stream.stats.reads, "At most one write per read");
+}
+
+typedef struct
+{
+    int fd;
+    const Frames *frames;
+    size_t chunk;
+} PipeWriter;
+
+/* Odd-sized chunks, so reads end mid-frame */
+static void pipe_writer(void *arg)
+{
+    PipeWriter *writer = (PipeWriter *)arg;
+    const uint8_t *bytes = (const uint8_t *)writer->frames->frames;
+    size_t left = writer->frames->count * sizeof(struct input_event);
+
+    while (left > 0)
+    {
+        size_t n = left < writer->chunk ? left : writer->chunk;
+        ssize_t written = write(writer->fd, bytes, n);
+        if (written <= 0)
+            break;
+        bytes += written;
+        left -= (size_t)written;
+    }
+    close(writer->fd);
+}
+
+static void test_pipe(void)
+{
+    TEST("Daemon on a pipe written in odd-sized chunks");
+
+    int fds[2];
+    CHECK(pipe(fds) == 0, "Pipe created");
+
+    PipeWriter writer = {fds[1], &g_input, 1000};
+    MfThread thread;
+    mf_thread_start(&thread, pipe_writer, &writer);
+
+    int out_fd = open(OUT_PATH, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    static EvdevDaemon daemon;
+    bool ok = out_fd >= 0 && evdev_daemon_init(&daemon, fds[0], out_fd, EVDEV_CLOCK_FRAME, true);
+    setup(&daemon.stream.filter, true);
+    CHECK(ok && evdev_daemon_run(&daemon) == 0, "Ran to end of pipe");
+    mf_thread_join(&thread);
+    close(fds[0]);
+    close(out_fd);
+    evdev_daemon_cleanup(&daemon);
+
+    CHECK(read_file(OUT_PATH, &g_output) && g_output.count == g_expected.count &&
+              memcmp(g_output.frames, g_expected.frames, g_expected.count * sizeof(struct input_event)) == 0,
+          "Same frames as from the file");
+}
+
+typedef struct
+{
+    EvdevDaemon *daemon;
+    int status;
+} DaemonThread;
+
+static void daemon_thread(void *arg)
+{
+    DaemonThread *ctx = (DaemonThread *)arg;
+    ctx->status = evdev_daemon_run(ctx->daemon);
+}
+
+static void test_live_deadline(void)
+{
+    TEST("Live mode releases on the host clock while the input is idle");
+
+    int in[2], out[2];
+    CHECK(pipe(in) == 0 && pipe(out) == 0, "Pipes created");
+
+    static EvdevDaemon daemon;
+    evdev_daemon_init(&daemon, in[0], out[1], EVDEV_CLOCK_FRAME, false);
+    setup(&daemon.stream.filter, true);
+    DaemonThread ctx = {&daemon, -1};
+    MfThread thread;
+    mf_thread_start(&thread, daemon_thread, &ctx);
+
+    /* A 300ms hold ending now: the release is due 150ms from now */
+    uint64_t now = time_manager_now_us();
+    Frames *f = &g_input;
+    f->count = 0;
+    add_key(f, now - 300000, BTN_LEFT, 1);
+    add_key(f, now, BTN_LEFT, 0);
+    ssize_t ignored = write(in[1], f->frames, f->count * sizeof(struct input_event));
+    (void)ignored;
+
+    struct input_event report[8];
+    size_t pressed = read_report(out[0], report, 8, 1000);
+    size_t released = read_report(out[0], report, 8, 1000);
+    uint64_t arrived = time_manager_now_us();
+    CHECK(pressed == 3, "Press forwarded");
+    CHECK(released == 2 && frame_is(&report[0], EV_KEY, BTN_LEFT, 0) &&
+              evdev_frame_time(&report[0]) == now + 150000 && arrived >= now + 150000,
+          "Release written once its deadline passed, with the input still open");
+
+    evdev_daemon_stop(&daemon);
+    mf_thread_join(&thread);
+    CHECK(ctx.status == 0, "Stopped cleanly");
+    close(in[0]);
+    close(in[1]);
+    close(out[0]);
+    close(out[1]);
+    evdev_daemon_cleanup(&daemon);
+}
+
+static void test_sink(void)
+{
+    TEST("evdev sink writes a batch as key frames and reports, in one write");
+
+    int fds[2];
+    CHECK(pipe(fds) == 0, "Pipe created");
+
+    EvdevSink sink;
+    OutputBatch batch;
+    output_batch_init(&batch, evdev_sink(&sink, fds[1]));
+    output_batch_push_releases(&batch, (1u << MOUSE_BUTTON_LEFT) | (1u << MOUSE_BUTTON_X1), 2000000);
+    MouseEvent wheel = {MOUSE_BUTTON_WHEEL, 2000000, false, 0, 0, false, 120};
+    MouseEvent press = {MOUSE_BUTTON_RIGHT, 2000500, true, 0, 0, false, 0};
+    PackedEvent packed = mouse_event_pack(&wheel);
+    output_batch_push(&batch, &packed);
+    packed = mouse_event_pack(&press);
+    output_batch_push(&batch, &packed);
+
+    CHECK(output_batch_flush(&batch) && sink.writes == 1, "One write for the batch");
+
+    struct input_event frames[8];
+    ssize_t got = read(fds[0], frames, sizeof(frames));
+    CHECK(got == 5 * (ssize_t)sizeof(struct input_event), "Five frames: two keys and SYN, a key and SYN");
+    CHECK(frames[0].code == BTN_LEFT && frames[0].value == 0 && frames[1].code == BTN_SIDE && frames[2].type == EV_SYN &&
+              evdev_frame_time(&frames[2]) == 2000000,
+          "Releases at one time share a report; the wheel is dropped");
+    CHECK(frames[3].code == BTN_RIGHT && frames[3].value == 1 && frames[4].type == EV_SYN &&
+              evdev_frame_time(&frames[4]) == 2000500,
+          "A later event gets its own report");
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+int main(void)
+{
+    printf("================================================\n");
+    printf("evdev Daemon Tests\n");
+    printf("================================================\n");
+
+    test_click();
+    test_bounce();
+    test_scan_codes();
+    test_wheel();
+    test_deferred_release();
+    test_syn_dropped();
+    test_recorded_file();
+    test_pipe();
+    test_live_deadline();
+    test_sink();
+
+    remove(IN_PATH);
+    remove(OUT_PATH);
+
+    printf("\n================================================\n");
+    printf("Result: %d/%d passed", pass_count, test_count);
+    if (fail_count > 0)
+        printf(" (%d failed)", fail_count);
+    printf("\n================================================\n");
+
+    return fail_count > 0 ? 1 : 0;
+}
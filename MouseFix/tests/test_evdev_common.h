@@ -0,0 +1,51 @@
+#pragma once
+
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include "../src/linux/evdev_filter.h"
+
+/* Frame building and reading shared by the evdev tests; define MAX_FRAMES first to size Frames */
+
+#ifndef MAX_FRAMES
+#define MAX_FRAMES 64
+#endif
+
+typedef struct
+{
+    struct input_event frames[MAX_FRAMES];
+    size_t count;
+} Frames;
+
+static inline void add(Frames *f, uint64_t at, uint16_t type, uint16_t code, int32_t value)
+{
+    struct input_event *e = &f->frames[f->count++];
+    memset(e, 0, sizeof(*e));
+    evdev_frame_set_time(e, at);
+    e->type = type;
+    e->code = code;
+    e->value = value;
+}
+
+/* MSC_SCAN, the key and SYN_REPORT, as a mouse reports a button */
+static inline void add_key(Frames *f, uint64_t at, uint16_t code, int32_t value)
+{
+    add(f, at, EV_MSC, MSC_SCAN, 0x90001 + (code - BTN_LEFT));
+    add(f, at, EV_KEY, code, value);
+    add(f, at, EV_SYN, SYN_REPORT, 0);
+}
+
+/* Reads one report from fd, waiting up to timeout_ms; its frame count, or 0 */
+static inline size_t read_report(int fd, struct input_event *frames, size_t max, int timeout_ms)
+{
+    size_t count = 0;
+    while (count < max)
+    {
+        struct pollfd p = {fd, POLLIN, 0};
+        if (poll(&p, 1, timeout_ms) <= 0 || read(fd, &frames[count], sizeof(frames[0])) != sizeof(frames[0]))
+            return 0;
+        if (frames[count++].type == EV_SYN)
+            return count;
+    }
+    return 0;
+}
@@ -0,0 +1,379 @@
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../src/linux/evdev_loop.h"
+#include "test_common.h"
+
+/* Several evdev devices on one epoll loop, fed and read through pipes */
+
+#define MAX_FRAMES   64
+#define LOAD_DEVICES 16
+#define LOAD_MS      300
+#define UNALIGNED_FRAMES 100 /* more than one read's worth */
+
+#include "test_evdev_common.h"
+
+typedef struct
+{
+    int in[2];
+    int out[2];
+} DevicePipes;
+
+/* Each test runs on every I/O path the kernel has */
+static EvdevIo g_io;
+
+static bool open_pipes(DevicePipes *pipes, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (pipe(pipes[i].in) != 0 || pipe(pipes[i].out) != 0)
+            return false;
+    }
+    return true;
+}
+
+static void close_pipes(DevicePipes *pipes, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        close(pipes[i].in[0]);
+        if (pipes[i].in[1] >= 0)
+            close(pipes[i].in[1]);
+        close(pipes[i].out[0]);
+        close(pipes[i].out[1]);
+    }
+}
+
+static void close_input(DevicePipes *pipes)
+{
+    close(pipes->in[1]);
+    pipes->in[1] = -1;
+}
+
+static void send_frames(const DevicePipes *pipes, const Frames *f)
+{
+    ssize_t ignored = write(pipes->in[1], f->frames, f->count * sizeof(struct input_event));
+    (void)ignored;
+}
+
+static int add_device(EvdevLoop *loop, const DevicePipes *pipes, bool smart_drag, uint32_t confirm_ms)
+{
+    int id = evdev_loop_add(loop, pipes->in[0], pipes->out[1], EVDEV_CLOCK_FRAME);
+    DebounceManager *debounce = &evdev_loop_filter(loop, id)->pipeline.debounce;
+    for (int b = 0; b < MOUSE_BUTTON_COUNT; b++)
+    {
+        debounce_set_monitored(debounce, b, true);
+        debounce_set_threshold(debounce, b, b == MOUSE_BUTTON_WHEEL ? 30 : 50, 1, 200);
+    }
+    debounce_set_hybrid_heuristic(debounce, smart_drag);
+
+    SmartDragParams drag;
+    debounce_get_smart_drag(debounce, &drag);
+    drag.confirm_us = confirm_ms * 1000;
+    debounce_set_smart_drag(debounce, &drag);
+    return id;
+}
+
+/* Frames written so far, without waiting */
+static size_t drain(int fd)
+{
+    struct input_event frames[MAX_FRAMES];
+    size_t total = 0;
+    struct pollfd p = {fd, POLLIN, 0};
+    while (poll(&p, 1, 0) > 0)
+    {
+        ssize_t got = read(fd, frames, sizeof(frames));
+        if (got <= 0)
+            break;
+        total += (size_t)got / sizeof(struct input_event);
+    }
+    return total;
+}
+
+typedef struct
+{
+    EvdevLoop *loop;
+    int status;
+} LoopThread;
+
+static void loop_thread(void *arg)
+{
+    LoopThread *ctx = (LoopThread *)arg;
+    ctx->status = evdev_loop_run(ctx->loop);
+}
+
+static void test_separate_engines(void)
+{
+    TEST("Each device has its own engine");
+
+    static EvdevLoop loop;
+    DevicePipes pipes[2];
+    CHECK(evdev_loop_init(&loop, g_io) && open_pipes(pipes, 2), "Loop and pipes created");
+    add_device(&loop, &pipes[0], false, 150);
+    add_device(&loop, &pipes[1], false, 150);
+
+    /* A bounce on device 0 at the same moment as a press on device 1 */
+    uint64_t now = time_manager_now_us();
+    Frames f = {.count = 0};
+    add_key(&f, now - 100000, BTN_LEFT, 1);
+    add_key(&f, now - 40000, BTN_LEFT, 0);
+    add_key(&f, now - 35000, BTN_LEFT, 1);
+    send_frames(&pipes[0], &f);
+    f.count = 0;
+    add_key(&f, now - 35000, BTN_LEFT, 1);
+    send_frames(&pipes[1], &f);
+    close_input(&pipes[0]);
+    close_input(&pipes[1]);
+
+    CHECK(evdev_loop_run(&loop) == 0, "Returns once both inputs end");
+    CHECK(drain(pipes[0].out[0]) == 6, "Device 0: the bounce report dropped");
+    CHECK(drain(pipes[1].out[0]) == 3, "Device 1: the same press passes");
+    CHECK(evdev_loop_stream(&loop, 0)->filter.stats.blocked == 1 &&
+              evdev_loop_stream(&loop, 1)->filter.stats.blocked == 0,
+          "Blocks counted per device");
+
+    close_pipes(pipes, 2);
+    evdev_loop_cleanup(&loop);
+}
+
+static void test_shared_timer(void)
+{
+    TEST("One timerfd fires each device's deferred release at its deadline");
+
+    static EvdevLoop loop;
+    DevicePipes pipes[3];
+    CHECK(evdev_loop_init(&loop, g_io) && open_pipes(pipes, 3), "Loop and pipes created");
+    for (int i = 0; i < 3; i++)
+        add_device(&loop, &pipes[i], true, 60 + 40 * (uint32_t)i);
+
+    LoopThread ctx = {&loop, -1};
+    MfThread thread;
+    mf_thread_start(&thread, loop_thread, &ctx);
+
+    /* Drags ending now: releases due in 60, 100 and 140ms, with every input idle */
+    uint64_t now = time_manager_now_us();
+    for (int i = 0; i < 3; i++)
+    {
+        Frames f = {.count = 0};
+        add_key(&f, now - 300000, BTN_LEFT, 1);
+        add_key(&f, now, BTN_LEFT, 0);
+        send_frames(&pipes[i], &f);
+    }
+
+    bool on_time = true;
+    for (int i = 0; i < 3; i++)
+    {
+        struct input_event report[8];
+        uint64_t deadline = now + (60 + 40 * (uint64_t)i) * 1000;
+        bool pressed = read_report(pipes[i].out[0], report, 8, 1000) == 3;
+        bool released = read_report(pipes[i].out[0], report, 8, 1000) == 2 && report[0].value == 0;
+        on_time &= pressed && released && evdev_frame_time(&report[0]) == deadline &&
+                   time_manager_now_us() >= deadline;
+    }
+    CHECK(on_time, "Each release stamped with, and written after, its own deadline");
+
+    evdev_loop_stop(&loop);
+    mf_thread_join(&thread);
+    CHECK(ctx.status == 0, "Stopped cleanly");
+    CHECK(loop.stats.timer_fires >= 3 && loop.stats.timer_fires <= 4, "One timer expiry per deadline");
+
+    close_pipes(pipes, 3);
+    evdev_loop_cleanup(&loop);
+}
+
+static void test_device_end(void)
+{
+    TEST("A device whose input ends releases at once and leaves the loop");
+
+    static EvdevLoop loop;
+    DevicePipes pipes[2];
+    CHECK(evdev_loop_init(&loop, g_io) && open_pipes(pipes, 2), "Loop and pipes created");
+    add_device(&loop, &pipes[0], true, 150);
+    add_device(&loop, &pipes[1], true, 150);
+
+    LoopThread ctx = {&loop, -1};
+    MfThread thread;
+    mf_thread_start(&thread, loop_thread, &ctx);
+
+    uint64_t now = time_manager_now_us();
+    Frames f = {.count = 0};
+    add_key(&f, now - 300000, BTN_LEFT, 1);
+    add_key(&f, now, BTN_LEFT, 0);
+    send_frames(&pipes[0], &f);
+    close_input(&pipes[0]);
+
+    struct input_event report[8];
+    read_report(pipes[0].out[0], report, 8, 1000);
+    size_t released = read_report(pipes[0].out[0], report, 8, 1000);
+    CHECK(released == 2 && evdev_frame_time(&report[0]) == now + 150000 && time_manager_now_us() < now + 150000,
+          "Pending release written at end of input, before its deadline");
+
+    f.count = 0;
+    add_key(&f, time_manager_now_us(), BTN_RIGHT, 1);
+    send_frames(&pipes[1], &f);
+    CHECK(read_report(pipes[1].out[0], report, 8, 1000) == 3, "The other device still runs");
+
+    close_input(&pipes[1]);
+    mf_thread_join(&thread);
+    CHECK(ctx.status == 0 && loop.open_count == 0, "Loop returns after the last device ends");
+
+    close_pipes(pipes, 2);
+    evdev_loop_cleanup(&loop);
+}
+
+static void test_unaligned_reads(void)
+{
+    TEST("Reads cut mid-frame, filtered to nothing, keep the loop running");
+
+    static EvdevLoop loop;
+    DevicePipes pipes[1];
+    CHECK(evdev_loop_init(&loop, g_io) && open_pipes(pipes, 1), "Loop and pipes created");
+    add_device(&loop, &pipes[0], false, 150);
+
+    LoopThread ctx = {&loop, -1};
+    MfThread thread;
+    mf_thread_start(&thread, loop_thread, &ctx);
+
+    /* SYN_DROPPED, then more moves than one read holds, all discarded by the resync, then a click */
+    uint64_t now = time_manager_now_us();
+    struct input_event frames[UNALIGNED_FRAMES + 5];
+    Frames f = {.count = 0};
+    add(&f, now, EV_SYN, SYN_DROPPED, 0);
+    memcpy(&frames[0], &f.frames[0], sizeof(frames[0]));
+    for (size_t i = 1; i <= UNALIGNED_FRAMES; i++)
+    {
+        f.count = 0;
+        add(&f, now, EV_REL, REL_X, 1);
+        frames[i] = f.frames[0];
+    }
+    f.count = 0;
+    add(&f, now, EV_SYN, SYN_REPORT, 0);
+    add_key(&f, now, BTN_LEFT, 1);
+    memcpy(&frames[UNALIGNED_FRAMES + 1], f.frames, 4 * sizeof(frames[0]));
+
+    /* Half a frame first, so every later read starts mid-frame and a full one leaves bytes over */
+    const uint8_t *bytes = (const uint8_t *)frames;
+    size_t half = sizeof(struct input_event) / 2;
+    ssize_t ignored = write(pipes[0].in[1], bytes, half);
+    struct timespec pause = {0, 50000000};
+    nanosleep(&pause, NULL);
+    ignored = write(pipes[0].in[1], bytes + half, sizeof(frames) - half);
+    (void)ignored;
+
+    struct input_event report[8];
+    CHECK(read_report(pipes[0].out[0], report, 8, 1000) == 3 && report[1].code == BTN_LEFT,
+          "The click after the resync comes out");
+
+    close_input(&pipes[0]);
+    mf_thread_join(&thread);
+    CHECK(ctx.status == 0, "Loop ran to the end of the input");
+
+    close_pipes(pipes, 1);
+    evdev_loop_cleanup(&loop);
+}
+
+typedef struct
+{
+    DevicePipes *pipes;
+} LoadWriter;
+
+/* A report per device per millisecond: moves, and a 40ms click every 100ms */
+static void load_writer(void *arg)
+{
+    LoadWriter *writer = (LoadWriter *)arg;
+    for (uint32_t ms = 0; ms < LOAD_MS; ms++)
+    {
+        uint64_t now = time_manager_now_us();
+        for (int d = 0; d < LOAD_DEVICES; d++)
+        {
+            Frames f = {.count = 0};
+            add(&f, now, EV_REL, REL_X, 1);
+            if (ms % 100 == 0 || ms % 100 == 40)
+                add(&f, now, EV_KEY, BTN_LEFT, ms % 100 == 0);
+            add(&f, now, EV_SYN, SYN_REPORT, 0);
+            send_frames(&writer->pipes[d], &f);
+        }
+        struct timespec tick = {0, 1000000};
+        nanosleep(&tick, NULL);
+    }
+    for (int d = 0; d < LOAD_DEVICES; d++)
+        close_input(&writer->pipes[d]);
+}
+
+static void test_load(void)
+{
+    TEST("16 devices at 1 kHz on one thread");
+
+    static EvdevLoop loop;
+    static DevicePipes pipes[LOAD_DEVICES];
+    CHECK(evdev_loop_init(&loop, g_io) && open_pipes(pipes, LOAD_DEVICES), "Loop and pipes created");
+    for (int d = 0; d < LOAD_DEVICES; d++)
+        add_device(&loop, &pipes[d], false, 150);
+
+    LoopThread ctx = {&loop, -1};
+    LoadWriter writer = {pipes};
+    MfThread loop_handle, writer_handle;
+    mf_thread_start(&loop_handle, loop_thread, &ctx);
+    mf_thread_start(&writer_handle, load_writer, &writer);
+    mf_thread_join(&writer_handle);
+    mf_thread_join(&loop_handle);
+
+    uint64_t frames_in = 0, frames_out = 0, reads = 0;
+    size_t read_back = 0;
+    for (int d = 0; d < LOAD_DEVICES; d++)
+    {
+        const EvdevStream *stream = evdev_loop_stream(&loop, d);
+        frames_in += stream->filter.stats.frames_in;
+        frames_out += stream->filter.stats.frames_out;
+        reads += stream->stats.reads;
+        read_back += drain(pipes[d].out[0]);
+    }
+
+    CHECK(ctx.status == 0, "Ran to the end of every input");
+    CHECK(frames_in == (uint64_t)LOAD_DEVICES * (LOAD_MS * 2 + LOAD_MS / 50) && frames_out == frames_in &&
+              read_back == frames_out,
+          "Every frame through and written to its own output");
+    /* Each wakeup reads at least one device or fires the timer */
+    CHECK(loop.stats.wakeups <= reads + loop.stats.timer_fires, "No wakeups without work");
+
+    close_pipes(pipes, LOAD_DEVICES);
+    evdev_loop_cleanup(&loop);
+}
+
+int main(void)
+{
+    printf("================================================\n");
+    printf("evdev Multi-Device Loop Tests\n");
+    printf("================================================\n");
+
+    EvdevIo paths[] = {EVDEV_IO_EPOLL, EVDEV_IO_URING};
+    for (size_t i = 0; i < sizeof(paths) / sizeof(paths[0]); i++)
+    {
+        static EvdevLoop probe;
+        g_io = paths[i];
+        if (!evdev_loop_init(&probe, g_io))
+        {
+            printf("\n(%s unavailable here, skipped)\n", evdev_io_name(g_io));
+            continue;
+        }
+        evdev_loop_cleanup(&probe);
+        printf("\n--- %s ---\n", evdev_io_name(g_io));
+
+        test_separate_engines();
+        test_shared_timer();
+        test_device_end();
+        test_unaligned_reads();
+        test_load();
+    }
+
+    printf("\n================================================\n");
+    printf("Result: %d/%d passed", pass_count, test_count);
+    if (fail_count > 0)
+        printf(" (%d failed)", fail_count);
+    printf("\n================================================\n");
+
+    return fail_count > 0 ? 1 : 0;
+}
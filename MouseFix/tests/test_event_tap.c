@@ -0,0 +1,189 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/core/event_tap.h"
+#include "test_common.h"
+
+/* SPSC event tap: ordering, overflow accounting and the consumer thread */
+
+#define THREADED_RECORDS 200000
+
+static MouseEvent make_event(uint64_t sequence)
+{
+    MouseEvent event = {MOUSE_BUTTON_LEFT, sequence, (sequence & 1) != 0, (long)sequence, -(long)sequence, false, 0};
+    return event;
+}
+
+static void test_order_and_overflow(void)
+{
+    TEST("Records drain in order and overflow is counted");
+
+    EventTap *tap = malloc(sizeof(EventTap));
+    EventTapRecord *out = malloc(sizeof(EventTapRecord) * EVENT_TAP_CAPACITY);
+    if (!tap || !out)
+    {
+        CHECK(false, "allocation");
+        return;
+    }
+    event_tap_init(tap);
+
+    size_t accepted = 0;
+    for (uint64_t i = 0; i < EVENT_TAP_CAPACITY + 10; i++)
+    {
+        MouseEvent event = make_event(i);
+        accepted += event_tap_publish(tap, &event, i % 3 == 0);
+    }
+    CHECK(accepted == EVENT_TAP_CAPACITY, "Ring accepts exactly its capacity");
+    CHECK(event_tap_get_dropped(tap) == 10, "Ten records counted as dropped");
+
+    size_t drained = event_tap_drain(tap, out, 100);
+    bool ordered = drained == 100;
+    for (size_t i = 0; i < drained; i++)
+        ordered = ordered && out[i].type == EVENT_TAP_EVENT && packed_event_time(&out[i].event) == i && out[i].blocked == (i % 3 == 0);
+    CHECK(ordered, "First 100 records in publish order with verdicts");
+
+    /* Freed slots are reusable and markers interleave in order */
+    DebounceConfig config = {0x3F, true, {1, 2, 3, 4, 5, 6}, {7, 8, 9}, {true, 10, 11}};
+    CHECK(event_tap_publish_config(tap, 777, &config), "Config marker accepted after drain");
+    CHECK(event_tap_publish_reset(tap, 778), "Reset marker accepted");
+
+    drained = event_tap_drain(tap, out, EVENT_TAP_CAPACITY);
+    CHECK(drained == EVENT_TAP_CAPACITY - 100 + 2, "Rest of the ring drained");
+    CHECK(packed_event_time(&out[drained - 3].event) == EVENT_TAP_CAPACITY - 1, "Last event before markers");
+    CHECK(out[drained - 2].type == EVENT_TAP_CONFIG && out[drained - 2].mark.timestamp == 777 &&
+              memcmp(&out[drained - 2].mark.config, &config, sizeof(config)) == 0,
+          "Config marker carries its snapshot");
+    CHECK(out[drained - 1].type == EVENT_TAP_RESET && out[drained - 1].mark.timestamp == 778, "Reset marker last");
+    CHECK(event_tap_drain(tap, out, EVENT_TAP_CAPACITY) == 0, "Ring empty");
+
+    /* Config snapshots live in their own small ring */
+    size_t configs = 0;
+    for (int i = 0; i < EVENT_TAP_CONFIG_SLOTS + 1; i++)
+        configs += event_tap_publish_config(tap, 800 + i, &config);
+    CHECK(configs == EVENT_TAP_CONFIG_SLOTS && event_tap_get_dropped(tap) == 11, "Config side ring full is a drop");
+    drained = event_tap_drain(tap, out, 4);
+    config.threshold_us[0] = 99;
+    CHECK(drained == 4 && event_tap_publish_config(tap, 900, &config), "Drained config slots are reused");
+    drained = event_tap_drain(tap, out, EVENT_TAP_CAPACITY);
+    CHECK(drained == EVENT_TAP_CONFIG_SLOTS - 3 && out[drained - 2].mark.config.threshold_us[0] == 1 &&
+              out[drained - 1].mark.timestamp == 900 && out[drained - 1].mark.config.threshold_us[0] == 99,
+          "Snapshots stay paired with their markers");
+
+    free(out);
+    free(tap);
+}
+
+typedef struct
+{
+    uint64_t expected;
+    uint64_t received;
+    uint64_t out_of_order;
+} ConsumerState;
+
+static void consume(const EventTapRecord *records, size_t count, void *user_data)
+{
+    ConsumerState *state = user_data;
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t sequence = packed_event_time(&records[i].event);
+        if (sequence != state->expected)
+            state->out_of_order++;
+        state->expected = sequence + 1;
+        state->received++;
+    }
+}
+
+static void test_consumer_thread(void)
+{
+    TEST("Consumer thread receives every record of a stream that waits on a full ring");
+
+    EventTap *tap = malloc(sizeof(EventTap));
+    if (!tap)
+    {
+        CHECK(false, "allocation");
+        return;
+    }
+
+    ConsumerState state = {0, 0, 0};
+    CHECK(event_tap_start(tap, consume, &state), "Consumer thread started");
+
+    /* Unlike the hook, retry when full so the consumer must keep up */
+    for (uint64_t i = 0; i < THREADED_RECORDS; i++)
+    {
+        MouseEvent event = make_event(i);
+        while (!event_tap_publish(tap, &event, false))
+        {
+            event_tap_kick(tap);
+            mf_thread_yield();
+        }
+    }
+    event_tap_stop(tap);
+
+    printf("  %u full-ring retries\n", event_tap_get_dropped(tap));
+    CHECK(state.received == THREADED_RECORDS, "Every record consumed (stop drains the tail)");
+    CHECK(state.out_of_order == 0 && state.expected == THREADED_RECORDS, "Records arrive in order without gaps");
+
+    free(tap);
+}
+
+/* Counts records and markers; read from the test thread while the consumer runs */
+static void count_records(const EventTapRecord *records, size_t count, void *user_data)
+{
+    (void)records;
+    mf_atomic_fetch_add32((MfAtomic32 *)user_data, (uint32_t)count);
+}
+
+static void test_flush_without_doorbell(void)
+{
+    TEST("Records short of the doorbell are drained within EVENT_TAP_FLUSH_MS");
+
+    EventTap *tap = malloc(sizeof(EventTap));
+    if (!tap)
+    {
+        CHECK(false, "allocation");
+        return;
+    }
+
+    MfAtomic32 received;
+    mf_atomic_store32(&received, 0);
+    CHECK(event_tap_start(tap, count_records, (void *)&received), "Consumer thread started");
+
+    /* Let the consumer reach its wait first, so the records below arrive while it sleeps */
+    uint64_t start = mf_ticks();
+    while (mf_ticks() - start < mf_ticks_per_second() / 10)
+        mf_thread_yield();
+
+    for (uint64_t i = 0; i < 10; i++)
+    {
+        MouseEvent event = make_event(i);
+        event_tap_publish(tap, &event, false);
+    }
+
+    start = mf_ticks();
+    uint64_t limit = mf_ticks_per_second() * 3 * EVENT_TAP_FLUSH_MS / 1000;
+    while (mf_atomic_load32(&received) < 10 && mf_ticks() - start < limit)
+        mf_thread_yield();
+    CHECK(mf_atomic_load32(&received) == 10, "Ten records drained with no doorbell and no kick");
+
+    event_tap_stop(tap);
+    free(tap);
+}
+
+int main(void)
+{
+    printf("================================================\n");
+    printf("Event Tap Tests\n");
+    printf("================================================\n");
+
+    test_order_and_overflow();
+    test_consumer_thread();
+    test_flush_without_doorbell();
+
+    printf("\n================================================\n");
+    printf("Result: %d/%d passed", pass_count, test_count);
+    if (fail_count > 0)
+        printf(" (%d failed)", fail_count);
+    printf("\n================================================\n");
+
+    return fail_count > 0 ? 1 : 0;
+}
@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <string.h>
+#include "../src/core/input_decode.h"
+#include "test_common.h"
+
+/* Raw hook record decoding and dispatch */
+
+typedef struct
+{
+    int events;
+    int moves;
+    MouseEvent last;
+    long move_x;
+    long move_y;
+    bool block;
+} Sink;
+
+static bool on_event(const MouseEvent *event, void *user_data)
+{
+    Sink *sink = (Sink *)user_data;
+    sink->events++;
+    sink->last = *event;
+    return sink->block;
+}
+
+static void on_move(long x, long y, void *user_data)
+{
+    Sink *sink = (Sink *)user_data;
+    sink->moves++;
+    sink->move_x = x;
+    sink->move_y = y;
+}
+
+static uint64_t fixed_clock(void)
+{
+    return 123456789;
+}
+
+static RawMouseRecord record(uint32_t message, uint32_t mouse_data, uint32_t flags)
+{
+    RawMouseRecord raw = {message, mouse_data, flags, 640, 480};
+    return raw;
+}
+
+static void test_decode(void)
+{
+    TEST("Messages decode to buttons, edges and wheel deltas");
+
+    MouseEvent e;
+    RawMouseRecord raw = record(INPUT_MSG_LBUTTONDOWN, 0, 0);
+    CHECK(input_decode_event(&raw, &e) && e.button == MOUSE_BUTTON_LEFT && e.is_down && e.x == 640 && e.y == 480,
+          "Left down");
+    raw = record(INPUT_MSG_RBUTTONUP, 0, 0);
+    CHECK(input_decode_event(&raw, &e) && e.button == MOUSE_BUTTON_RIGHT && !e.is_down, "Right up");
+    raw = record(INPUT_MSG_MBUTTONDOWN, 0, 0);
+    CHECK(input_decode_event(&raw, &e) && e.button == MOUSE_BUTTON_MIDDLE && e.is_down, "Middle down");
+    raw = record(INPUT_MSG_XBUTTONDOWN, INPUT_XBUTTON1 << 16, 0);
+    CHECK(input_decode_event(&raw, &e) && e.button == MOUSE_BUTTON_X1 && e.is_down, "X1 from the high word");
+    raw = record(INPUT_MSG_XBUTTONUP, INPUT_XBUTTON2 << 16, 0);
+    CHECK(input_decode_event(&raw, &e) && e.button == MOUSE_BUTTON_X2 && !e.is_down, "X2 up");
+
+    raw = record(INPUT_MSG_MOUSEWHEEL, 120u << 16, 0);
+    CHECK(input_decode_event(&raw, &e) && e.button == MOUSE_BUTTON_WHEEL && e.data == 120 && !e.is_down, "Wheel forward");
+    raw = record(INPUT_MSG_MOUSEWHEEL, (uint32_t)(uint16_t)-240 << 16, 0);
+    CHECK(input_decode_event(&raw, &e) && e.data == -240, "Wheel backward is sign-extended");
+
+    raw = record(INPUT_MSG_LBUTTONUP, 0, INPUT_FLAG_LOWER_IL_INJECTED);
+    CHECK(input_decode_event(&raw, &e) && e.is_injected, "Lower-integrity injection flagged");
+    raw = record(INPUT_MSG_MOUSEMOVE, 0, 0);
+    CHECK(!input_decode_event(&raw, &e), "Move is not a button event");
+    raw = record(0x020E, 120u << 16, 0);
+    CHECK(!input_decode_event(&raw, &e), "Horizontal wheel is not handled");
+}
+
+static void test_dispatch(void)
+{
+    TEST("Dispatch routes moves and events");
+
+    Sink sink;
+    memset(&sink, 0, sizeof(sink));
+    InputDispatcher dispatcher;
+    input_dispatcher_init(&dispatcher, on_event, &sink);
+    dispatcher.clock = fixed_clock;
+
+    RawMouseRecord raw = record(INPUT_MSG_MOUSEMOVE, 0, 0);
+    CHECK(!input_dispatch(&dispatcher, &raw) && sink.moves == 0 && sink.events == 0, "Moves ignored without a move handler");
+
+    dispatcher.on_move = on_move;
+    raw.x = 10;
+    raw.y = -20;
+    CHECK(!input_dispatch(&dispatcher, &raw) && sink.moves == 1 && sink.move_x == 10 && sink.move_y == -20,
+          "Move forwarded, never blocked");
+    raw.flags = INPUT_FLAG_INJECTED;
+    input_dispatch(&dispatcher, &raw);
+    CHECK(sink.moves == 1, "Injected move dropped");
+
+    raw = record(INPUT_MSG_LBUTTONDOWN, 0, 0);
+    CHECK(!input_dispatch(&dispatcher, &raw) && sink.events == 1 && sink.last.timestamp == 123456789,
+          "Button event stamped by the dispatcher clock");
+    sink.block = true;
+    CHECK(input_dispatch(&dispatcher, &raw), "Handler verdict returned");
+
+    raw = record(0x020E, 0, 0);
+    CHECK(!input_dispatch(&dispatcher, &raw) && sink.events == 2, "Unhandled message passes untouched");
+}
+
+int main(void)
+{
+    printf("================================================\n");
+    printf("Input Decode Tests\n");
+    printf("================================================\n");
+
+    test_decode();
+    test_dispatch();
+
+    printf("\n================================================\n");
+    printf("Result: %d/%d passed", pass_count, test_count);
+    if (fail_count > 0)
+        printf(" (%d failed)", fail_count);
+    printf("\n================================================\n");
+
+    return fail_count > 0 ? 1 : 0;
+}
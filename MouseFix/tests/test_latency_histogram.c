@@ -0,0 +1,105 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/core/latency_histogram.h"
+#include "../src/core/hook_latency.h"
+#include "test_common.h"
+
+/* Latency histogram bucketing, percentiles and the hook latency reset handoff */
+
+static LatencyHistogram histogram;
+static HookLatency latency;
+
+static void test_bucket_accuracy(void)
+{
+    TEST("Buckets are monotonic and within 1/16 of the value");
+
+    uint32_t previous = 0;
+    bool monotonic = true;
+    bool accurate = true;
+    for (uint64_t v = 0; v < (1ull << 36); v = v < 64 ? v + 1 : v + v / 7)
+    {
+        uint32_t index = latency_bucket_index(v);
+        if (index < previous)
+            monotonic = false;
+        previous = index;
+
+        latency_histogram_reset(&histogram);
+        latency_histogram_record(&histogram, v);
+        /* Single sample: percentile reports its bucket bound clamped to max, i.e. v itself */
+        if (latency_histogram_percentile(&histogram, 0.5) != v)
+            accurate = false;
+    }
+
+    CHECK(monotonic, "Bucket index never decreases");
+    CHECK(accurate, "Single-sample percentile is exact (clamped to max)");
+    CHECK(latency_bucket_index(31) == 31, "Values below 32 map one-to-one");
+    CHECK(latency_bucket_index(UINT64_MAX) == LATENCY_BUCKET_COUNT - 1, "Huge values clamp to the last bucket");
+}
+
+static void test_percentiles(void)
+{
+    TEST("Percentiles over a uniform distribution");
+
+    latency_histogram_reset(&histogram);
+    for (uint64_t v = 1; v <= 100000; v++)
+        latency_histogram_record(&histogram, v);
+
+    uint64_t p50 = latency_histogram_percentile(&histogram, 0.50);
+    uint64_t p99 = latency_histogram_percentile(&histogram, 0.99);
+    uint64_t p999 = latency_histogram_percentile(&histogram, 0.999);
+
+    CHECK(latency_histogram_count(&histogram) == 100000, "Count matches");
+    CHECK(latency_histogram_max(&histogram) == 100000, "Max is exact");
+    CHECK(p50 >= 50000 && p50 <= 50000 + 50000 / 16, "p50 within bucket error");
+    CHECK(p99 >= 99000 && p99 <= 99000 + 99000 / 16, "p99 within bucket error");
+    CHECK(p999 >= 99900 && p999 <= 100000, "p99.9 within bucket error and below max");
+    CHECK(latency_histogram_percentile(&histogram, 1.0) == 100000, "p100 is max");
+
+    latency_histogram_reset(&histogram);
+    CHECK(latency_histogram_count(&histogram) == 0, "Reset clears count");
+    CHECK(latency_histogram_percentile(&histogram, 0.99) == 0, "Empty histogram reports 0");
+}
+
+static void test_hook_latency_reset(void)
+{
+    TEST("Hook latency records per button and transition, reset is deferred");
+
+    hook_latency_init(&latency);
+    for (int i = 0; i < 1000; i++)
+        hook_latency_record(&latency, MOUSE_BUTTON_LEFT, BTN_STATE_IDLE, BTN_STATE_PRESSED, 100 + i);
+    hook_latency_record(&latency, MOUSE_BUTTON_RIGHT, BTN_STATE_PRESSED, BTN_STATE_IDLE, 5000);
+
+    LatencySummary summary;
+    CHECK(hook_latency_get_button(&latency, MOUSE_BUTTON_LEFT, &summary) && summary.count == 1000, "Left has 1000 samples");
+    CHECK(summary.p50_ns > 0 && summary.p50_ns <= summary.p99_ns && summary.p99_ns <= summary.max_ns, "Percentiles ordered");
+    CHECK(hook_latency_get_transition(&latency, BTN_STATE_IDLE, BTN_STATE_PRESSED, &summary) && summary.count == 1000, "IDLE->PRESSED has 1000 samples");
+    CHECK(hook_latency_get_transition(&latency, BTN_STATE_PRESSED, BTN_STATE_IDLE, &summary) && summary.count == 1, "PRESSED->IDLE has 1 sample");
+    CHECK(!hook_latency_get_button(&latency, MOUSE_BUTTON_COUNT, &summary), "Out-of-range button rejected");
+
+    hook_latency_reset(&latency);
+    CHECK(hook_latency_get_button(&latency, MOUSE_BUTTON_LEFT, &summary) && summary.count == 0, "Pending reset reads as empty");
+
+    hook_latency_record(&latency, MOUSE_BUTTON_LEFT, BTN_STATE_IDLE, BTN_STATE_PRESSED, 42);
+    CHECK(hook_latency_get_button(&latency, MOUSE_BUTTON_LEFT, &summary) && summary.count == 1, "Next record applies the reset");
+    CHECK(hook_latency_get_button(&latency, MOUSE_BUTTON_RIGHT, &summary) && summary.count == 0, "Other buttons cleared too");
+}
+
+int main(void)
+{
+    printf("================================================\n");
+    printf("Latency Histogram Tests\n");
+    printf("================================================\n");
+
+    test_bucket_accuracy();
+    test_percentiles();
+    test_hook_latency_reset();
+
+    printf("\n================================================\n");
+    printf("Result: %d/%d passed", pass_count, test_count);
+    if (fail_count > 0)
+        printf(" (%d failed)", fail_count);
+    printf("\n================================================\n");
+
+    return fail_count > 0 ? 1 : 0;
+}
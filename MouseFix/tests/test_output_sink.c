@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "../src/core/debouncer.h"
+#include "../src/core/output_sink.h"
+#include "../src/core/release_scheduler.h"
+#include "test_common.h"
+
+/* Output batches, the in-memory sink, and deferred releases reaching a sink */
+
+static PackedEvent make_event(MouseButton button, bool down, uint64_t timestamp)
+{
+    MouseEvent e = {button, timestamp, down, 0, 0, false, 0};
+    return mouse_event_pack(&e);
+}
+
+static void test_flush_once(void)
+{
+    TEST("A batch reaches its sink in one call per flush");
+
+    PackedEvent stored[16];
+    OutputMemorySink memory;
+    OutputBatch batch;
+    output_batch_init(&batch, output_memory_sink(&memory, stored, 16));
+
+    for (int i = 0; i < 3; i++)
+    {
+        PackedEvent e = make_event((MouseButton)i, i == 1, 1000 + (uint64_t)i);
+        output_batch_push(&batch, &e);
+    }
+    CHECK(memory.flushes == 0 && batch.count == 3, "Nothing goes out before the flush");
+
+    CHECK(output_batch_flush(&batch) && memory.flushes == 1 && memory.count == 3, "One sink call for three events");
+    CHECK(packed_event_button(&stored[0]) == MOUSE_BUTTON_LEFT && packed_event_is_down(&stored[1]) &&
+              packed_event_time(&stored[2]) == 1002,
+          "Events arrive in order and intact");
+
+    CHECK(output_batch_flush(&batch) && memory.flushes == 1, "An empty flush does not call the sink");
+    CHECK(batch.flushes == 1 && batch.events_out == 3 && batch.failed == 0, "Batch counts its output");
+}
+
+static void test_full_batch(void)
+{
+    TEST("A full batch flushes before taking more");
+
+    PackedEvent stored[OUTPUT_BATCH_CAPACITY * 2];
+    OutputMemorySink memory;
+    OutputBatch batch;
+    output_batch_init(&batch, output_memory_sink(&memory, stored, OUTPUT_BATCH_CAPACITY * 2));
+
+    for (uint64_t i = 0; i < OUTPUT_BATCH_CAPACITY + 5; i++)
+    {
+        PackedEvent e = make_event(MOUSE_BUTTON_LEFT, (i & 1) == 0, i);
+        output_batch_push(&batch, &e);
+    }
+    CHECK(memory.flushes == 1 && memory.count == OUTPUT_BATCH_CAPACITY && batch.count == 5,
+          "Capacity went out in one call, the rest is queued");
+
+    output_batch_flush(&batch);
+    bool ordered = memory.count == OUTPUT_BATCH_CAPACITY + 5;
+    for (size_t i = 0; ordered && i < memory.count; i++)
+        ordered = packed_event_time(&stored[i]) == i;
+    CHECK(ordered, "No event lost or reordered across the early flush");
+}
+
+static void test_sink_failure(void)
+{
+    TEST("A sink that cannot take everything fails the flush");
+
+    PackedEvent stored[4];
+    OutputMemorySink memory;
+    OutputBatch batch;
+    output_batch_init(&batch, output_memory_sink(&memory, stored, 4));
+
+    output_batch_push_releases(&batch, (1u << MOUSE_BUTTON_LEFT) | (1u << MOUSE_BUTTON_X2), 5000);
+    CHECK(batch.count == 2 && !packed_event_is_down(&batch.events[0]) && packed_event_is_injected(&batch.events[1]) &&
+              packed_event_button(&batch.events[1]) == MOUSE_BUTTON_X2,
+          "A release mask becomes injected button-ups");
+
+    for (int i = 0; i < 4; i++)
+    {
+        PackedEvent e = make_event(MOUSE_BUTTON_RIGHT, true, 6000);
+        output_batch_push(&batch, &e);
+    }
+    CHECK(!output_batch_flush(&batch) && memory.count == 4 && memory.dropped == 2, "Overflow is dropped and reported");
+    CHECK(batch.failed == 6 && batch.count == 0, "The failed batch is counted and cleared");
+
+    OutputBatch discard;
+    OutputSink none = {NULL, NULL};
+    output_batch_init(&discard, none);
+    output_batch_push_releases(&discard, 1u << MOUSE_BUTTON_MIDDLE, 7000);
+    CHECK(output_batch_flush(&discard) && discard.events_out == 1, "No sink discards");
+}
+
+static void test_scheduler_batch(void)
+{
+    TEST("Releases due together leave the scheduler as one batch");
+
+    DebounceManager debounce;
+    debounce_init(&debounce);
+    debounce_set_monitored(&debounce, MOUSE_BUTTON_LEFT, true);
+    debounce_set_monitored(&debounce, MOUSE_BUTTON_RIGHT, true);
+
+    PackedEvent stored[8];
+    OutputMemorySink memory;
+    ReleaseScheduler scheduler;
+    CHECK(release_scheduler_start(&scheduler, &debounce, output_memory_sink(&memory, stored, 8)), "Scheduler started");
+
+    /* Two drags let go at the same instant: both confirm windows end together */
+    uint64_t now = time_manager_now_us();
+    bool held = true;
+    for (int b = MOUSE_BUTTON_LEFT; b <= MOUSE_BUTTON_RIGHT; b++)
+    {
+        MouseEvent down = {(MouseButton)b, now - 400000, true, 100, 100, false, 0};
+        MouseEvent up = {(MouseButton)b, now, false, 200, 100, false, 0};
+        debounce_process_event(&debounce, &down);
+        held = debounce_process_event(&debounce, &up) && held;
+    }
+    CHECK(held, "Both drag releases held back");
+    release_scheduler_notify(&scheduler);
+
+    struct timespec wait = {0, (long)(SMART_DRAG_CONFIRM_TIMEOUT_US + 100000) * 1000};
+    nanosleep(&wait, NULL);
+    release_scheduler_stop(&scheduler);
+
+    CHECK(memory.count == 2 && memory.flushes == 1, "Both releases in one sink call");
+    CHECK(packed_event_button(&stored[0]) == MOUSE_BUTTON_LEFT && packed_event_button(&stored[1]) == MOUSE_BUTTON_RIGHT &&
+              !packed_event_is_down(&stored[0]) && packed_event_is_injected(&stored[1]),
+          "Injected button-ups for left and right");
+    CHECK(packed_event_time(&stored[0]) >= now + SMART_DRAG_CONFIRM_TIMEOUT_US, "Stamped when claimed, not before the deadline");
+
+    debounce_cleanup(&debounce);
+}
+
+int main(void)
+{
+    printf("================================================\n");
+    printf("Output Sink Tests\n");
+    printf("================================================\n");
+
+    test_flush_once();
+    test_full_batch();
+    test_sink_failure();
+    test_scheduler_batch();
+
+    printf("\n================================================\n");
+    printf("Result: %d/%d passed", pass_count, test_count);
+    if (fail_count > 0)
+        printf(" (%d failed)", fail_count);
+    printf("\n================================================\n");
+
+    return fail_count > 0 ? 1 : 0;
+}
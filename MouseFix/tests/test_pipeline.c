@@ -0,0 +1,235 @@
+#include <stdio.h>
+#include <string.h>
+#include "../src/core/filter_pipeline.h"
+#include "test_common.h"
+
+/* Filter pipeline: the stock pipeline and stages chained around the engine */
+
+#define STREAM_LENGTH 4000
+
+/* Test stages: one that counts what reaches it, one that blocks wheel notches, one with a timer */
+typedef struct
+{
+    int events;
+    int moves;
+    MouseButton last;
+} CountState;
+
+static inline void count_stage_init(CountState *state)
+{
+    memset(state, 0, sizeof(*state));
+}
+
+static inline bool count_stage_process(CountState *state, const MouseEvent *event)
+{
+    state->events++;
+    state->last = event->button;
+    return false;
+}
+
+static inline void count_stage_move(CountState *state, long x, long y)
+{
+    (void)x;
+    (void)y;
+    state->moves++;
+}
+
+MF_STAGE_NO_TIME(count, CountState)
+
+typedef struct
+{
+    int blocked;
+} NoWheelState;
+
+static inline void no_wheel_stage_init(NoWheelState *state)
+{
+    state->blocked = 0;
+}
+
+static inline bool no_wheel_stage_process(NoWheelState *state, const MouseEvent *event)
+{
+    bool block = event->button == MOUSE_BUTTON_WHEEL;
+    state->blocked += block;
+    return block;
+}
+
+MF_STAGE_NO_MOVE(no_wheel, NoWheelState)
+MF_STAGE_NO_TIME(no_wheel, NoWheelState)
+
+typedef struct
+{
+    uint64_t due; /* 0 when idle */
+} TimerState;
+
+static inline void timer_stage_init(TimerState *state)
+{
+    state->due = 0;
+}
+
+static inline bool timer_stage_process(TimerState *state, const MouseEvent *event)
+{
+    if (event->button == MOUSE_BUTTON_MIDDLE && event->is_down)
+        state->due = event->timestamp + 1000;
+    return false;
+}
+
+MF_STAGE_NO_MOVE(timer, TimerState)
+
+static inline uint32_t timer_stage_advance(TimerState *state, uint64_t now)
+{
+    if (state->due == 0 || now < state->due)
+        return 0;
+    state->due = 0;
+    return 1u << MOUSE_BUTTON_MIDDLE;
+}
+
+static inline bool timer_stage_deadline(TimerState *state, uint64_t *deadline)
+{
+    if (state->due == 0)
+        return false;
+    if (state->due < *deadline)
+        *deadline = state->due;
+    return true;
+}
+
+#define CHAIN_STAGES(X)                    \
+    X(count, count, CountState)            \
+    X(debounce, debounce, DebounceManager) \
+    X(no_wheel, no_wheel, NoWheelState)    \
+    X(timer, timer, TimerState)
+
+MF_PIPELINE_DEFINE(ChainPipeline, chain_pipeline, CHAIN_STAGES)
+
+static void test_stock_matches_engine(void)
+{
+    TEST("Stock pipeline matches the engine it wraps");
+
+    static MouseEvent events[STREAM_LENGTH];
+    test_build_stream(events, STREAM_LENGTH, 0x2545F4914F6CDD1Dull);
+
+    DebounceManager manager;
+    test_configure(&manager);
+    MousePipeline pipeline;
+    mouse_pipeline_init(&pipeline);
+    test_configure(&pipeline.debounce);
+
+    int mismatches = 0;
+    int deadline_mismatches = 0;
+    for (size_t i = 0; i < STREAM_LENGTH; i++)
+    {
+        const MouseEvent *e = &events[i];
+        uint64_t expected_deadline = 0, deadline = 0;
+        bool expected_found = debounce_get_next_deadline(&manager, &expected_deadline);
+        bool found = mouse_pipeline_deadline(&pipeline, &deadline);
+        deadline_mismatches += expected_found != found || (found && expected_deadline != deadline);
+
+        /* Let due releases fire before the next event, as the host timer would */
+        if (found && deadline <= e->timestamp)
+            mismatches += debounce_collect_deferred_releases(&manager, deadline) != mouse_pipeline_advance(&pipeline, deadline);
+
+        debounce_process_move(&manager, e->x, e->y);
+        mouse_pipeline_move(&pipeline, e->x, e->y);
+        mismatches += debounce_process_event(&manager, e) != mouse_pipeline_process(&pipeline, e);
+    }
+
+    CHECK(mismatches == 0, "Same verdicts and releases over a mixed stream");
+    CHECK(deadline_mismatches == 0, "Same deadlines");
+    CHECK(debounce_get_total_blocks(&manager) == debounce_get_total_blocks(&pipeline.debounce) &&
+              debounce_get_total_blocks(&manager) > 0,
+          "Same block count");
+
+    uint64_t deadline = 42;
+    mouse_pipeline_init(&pipeline);
+    CHECK(!mouse_pipeline_deadline(&pipeline, &deadline) && deadline == 42, "No deadline leaves the output alone");
+}
+
+static void test_chain(void)
+{
+    TEST("Stages run in order and a block stops the chain");
+
+    ChainPipeline pipeline;
+    chain_pipeline_init(&pipeline);
+    test_configure(&pipeline.debounce);
+
+    MouseEvent e;
+    memset(&e, 0, sizeof(e));
+    e.button = MOUSE_BUTTON_LEFT;
+    e.is_down = true;
+    e.timestamp = 1000000;
+    CHECK(!chain_pipeline_process(&pipeline, &e) && pipeline.count.events == 1, "Click passes every stage");
+
+    e.is_down = false;
+    e.timestamp += 5000;
+    chain_pipeline_process(&pipeline, &e);
+    e.is_down = true;
+    e.timestamp += 5000;
+    CHECK(chain_pipeline_process(&pipeline, &e), "Bounce blocked by the engine");
+    CHECK(pipeline.count.events == 3, "Stage ahead of the engine saw the bounce");
+
+    e.button = MOUSE_BUTTON_WHEEL;
+    e.is_down = false;
+    e.data = 120;
+    e.timestamp += 100000;
+    CHECK(chain_pipeline_process(&pipeline, &e) && pipeline.no_wheel.blocked == 1, "Later stage blocks what the engine passed");
+
+    e.timestamp += 5000;
+    e.data = -120;
+    chain_pipeline_process(&pipeline, &e);
+    CHECK(pipeline.no_wheel.blocked == 1, "Reversal blocked by the engine never reaches the later stage");
+
+    chain_pipeline_move(&pipeline, 10, 10);
+    CHECK(pipeline.count.moves == 1, "Moves reach every stage");
+}
+
+static void test_chain_time(void)
+{
+    TEST("Deadlines and releases combine across stages");
+
+    ChainPipeline pipeline;
+    chain_pipeline_init(&pipeline);
+    test_configure(&pipeline.debounce);
+
+    uint64_t deadline = 0;
+    CHECK(!chain_pipeline_deadline(&pipeline, &deadline), "Nothing pending");
+
+    /* Smart Drag: a 300ms hold defers its release by 150ms */
+    MouseEvent e;
+    memset(&e, 0, sizeof(e));
+    e.button = MOUSE_BUTTON_LEFT;
+    e.is_down = true;
+    e.timestamp = 1000000;
+    chain_pipeline_process(&pipeline, &e);
+    e.is_down = false;
+    e.timestamp = 1300000;
+    CHECK(chain_pipeline_process(&pipeline, &e), "Drag release deferred");
+
+    e.button = MOUSE_BUTTON_MIDDLE;
+    e.is_down = true;
+    e.timestamp = 1400000;
+    chain_pipeline_process(&pipeline, &e);
+
+    CHECK(chain_pipeline_deadline(&pipeline, &deadline) && deadline == 1401000, "Earliest of both stages' deadlines");
+    CHECK(chain_pipeline_advance(&pipeline, 1401000) == 1u << MOUSE_BUTTON_MIDDLE, "Timer stage fires first");
+    CHECK(chain_pipeline_deadline(&pipeline, &deadline) && deadline == 1450000, "Engine deadline next");
+    CHECK(chain_pipeline_advance(&pipeline, 1450000) == 1u << MOUSE_BUTTON_LEFT, "Engine releases the drag");
+    CHECK(!chain_pipeline_deadline(&pipeline, &deadline), "Nothing left");
+}
+
+int main(void)
+{
+    printf("================================================\n");
+    printf("Filter Pipeline Tests\n");
+    printf("================================================\n");
+
+    test_stock_matches_engine();
+    test_chain();
+    test_chain_time();
+
+    printf("\n================================================\n");
+    printf("Result: %d/%d passed", pass_count, test_count);
+    if (fail_count > 0)
+        printf(" (%d failed)", fail_count);
+    printf("\n================================================\n");
+
+    return fail_count > 0 ? 1 : 0;
+}
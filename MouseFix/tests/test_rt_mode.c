@@ -0,0 +1,122 @@
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "../src/core/platform.h"
+#include "../src/linux/rt_mode.h"
+#include "test_common.h"
+
+/*
+ * Low-latency mode on threads of its own, so the test process keeps its
+ * scheduling. Memory is never locked here: under the sanitizers mlockall
+ * would try to fault in their whole shadow.
+ */
+
+#define PREFAULT_BYTES (4 * 1024 * 1024)
+#define MISSING_CPU    1000 /* beyond any CPU the test runs on */
+
+typedef struct
+{
+    RtModeOptions options;
+    RtModeReport report;
+    bool ok;
+    int policy; /* as the kernel reports it afterwards */
+} ApplyContext;
+
+static void apply_thread(void *arg)
+{
+    ApplyContext *ctx = (ApplyContext *)arg;
+    ctx->ok = rt_mode_apply(&ctx->options, &ctx->report);
+    ctx->policy = sched_getscheduler(0);
+}
+
+static void apply(ApplyContext *ctx)
+{
+    MfThread thread;
+    mf_thread_start(&thread, apply_thread, ctx);
+    mf_thread_join(&thread);
+}
+
+static void options_without_lock(RtModeOptions *options)
+{
+    rt_mode_defaults(options);
+    options->lock_memory = false;
+}
+
+static void test_policy(void)
+{
+    TEST("Real-time policy is obtained or reported as missing");
+
+    ApplyContext ctx;
+    options_without_lock(&ctx.options);
+    ctx.options.policy = SCHED_RR;
+    ctx.options.priority = 10;
+    apply(&ctx);
+
+    if (ctx.ok)
+        CHECK(ctx.report.policy == SCHED_RR && ctx.report.priority == 10 && ctx.report.sched_error == 0,
+              "SCHED_RR 10 read back");
+    else
+        CHECK(ctx.report.sched_error != 0, "Shortfall carries its reason");
+    CHECK(ctx.report.policy == ctx.policy, "Report agrees with the kernel");
+    CHECK(ctx.report.stack_prefaulted == RT_MODE_STACK_PREFAULT, "Stack pre-faulted");
+    CHECK(!ctx.report.memory_locked && ctx.report.lock_error == 0, "Memory left alone when not asked");
+}
+
+static void test_pinning(void)
+{
+    TEST("Pinning to CPU 0 holds; a missing CPU is reported, not fatal");
+
+    ApplyContext ctx;
+    options_without_lock(&ctx.options);
+    ctx.options.policy = SCHED_OTHER;
+    ctx.options.cpu = 0;
+    apply(&ctx);
+    CHECK(ctx.ok && ctx.report.cpu == 0 && ctx.report.cpu_error == 0, "Pinned to CPU 0");
+
+    ctx.options.cpu = MISSING_CPU;
+    apply(&ctx);
+    CHECK(!ctx.ok && ctx.report.cpu_error != 0 && ctx.report.cpu != MISSING_CPU, "Missing CPU reported");
+    CHECK(ctx.report.policy == SCHED_OTHER && ctx.report.sched_error == 0, "SCHED_OTHER asked, nothing changed");
+}
+
+static void test_prefault(void)
+{
+    TEST("Pre-faulted memory takes no faults on first use");
+
+    uint8_t *memory = mmap(NULL, PREFAULT_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    CHECK(memory != MAP_FAILED, "Memory mapped");
+    if (memory == MAP_FAILED)
+        return;
+
+    uint64_t before = rt_mode_page_faults();
+    rt_mode_prefault(memory, PREFAULT_BYTES);
+    uint64_t faulted = rt_mode_page_faults() - before;
+    CHECK(faulted > 0, "Pre-faulting took the faults");
+
+    before = rt_mode_page_faults();
+    memset(memory, 0x5A, PREFAULT_BYTES);
+    CHECK(rt_mode_page_faults() == before, "No faults writing it afterwards");
+
+    munmap(memory, PREFAULT_BYTES);
+}
+
+int main(void)
+{
+    printf("================================================\n");
+    printf("Low-Latency Mode Tests\n");
+    printf("================================================\n");
+
+    test_policy();
+    test_pinning();
+    test_prefault();
+
+    printf("\n================================================\n");
+    printf("Result: %d/%d passed", pass_count, test_count);
+    if (fail_count > 0)
+        printf(" (%d failed)", fail_count);
+    printf("\n================================================\n");
+
+    return fail_count > 0 ? 1 : 0;
+}
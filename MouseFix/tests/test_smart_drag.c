@@ -1,24 +1,170 @@
 #include <stdio.h>
-#include <assert.h>
 #include "../src/core/debouncer.h"
+#include "test_common.h"
 
-static int test_count = 0;
-static int pass_count = 0;
-static int fail_count = 0;
+/* What one button edge does, as seen from outside the engine */
+typedef struct
+{
+    bool blocked;
+    ButtonState state;
+    uint32_t counted;
+    uint64_t downTime;
+    long downX;
+    uint32_t maxDistSq;
+    uint64_t pending;
+    bool tracked;
+} EdgeOutcome;
+
+/*
+ * The button state machine as nested switches, the form it had before the
+ * transition table; the exhaustive test checks the engine against it.
+ */
+static EdgeOutcome reference_edge(const ButtonDebounceData *before, const MouseEvent *event, uint32_t threshold, bool hybrid)
+{
+    EdgeOutcome out = {false, before->state, 0, before->downTime, before->downPoint.x, before->maxDistSq,
+                       before->confirmPending, false};
+    uint64_t now = event->timestamp;
+    uint64_t elapsed = now - before->previousTime;
+
+    if (out.state == BTN_STATE_CONFIRMING)
+    {
+        uint64_t pending = out.pending;
+        if (event->is_down)
+            out.pending = 0;
+        if (pending == 0)
+            out.state = BTN_STATE_IDLE;
+    }
+
+    if (event->is_down)
+    {
+        switch (out.state)
+        {
+        case BTN_STATE_IDLE:
+        case BTN_STATE_PRESSED:
+        case BTN_STATE_DRAGGING:
+            if (elapsed <= threshold)
+            {
+                out.state = BTN_STATE_BLOCKED;
+                out.counted = 1;
+                out.blocked = true;
+            }
+            else
+            {
+                out.state = BTN_STATE_PRESSED;
+                out.downTime = now;
+                out.downX = event->x;
+                out.maxDistSq = 0;
+                out.tracked = hybrid;
+            }
+            break;
+        case BTN_STATE_CONFIRMING:
+            out.state = BTN_STATE_DRAGGING;
+            out.downTime = now;
+            out.downX = event->x;
+            out.counted = 1;
+            out.blocked = true;
+            break;
+        default:
+            out.counted = 1;
+            out.blocked = true;
+            break;
+        }
+        return out;
+    }
+
+    switch (out.state)
+    {
+    case BTN_STATE_BLOCKED:
+        out.state = BTN_STATE_IDLE;
+        out.counted = 1;
+        out.blocked = true;
+        break;
+    case BTN_STATE_PRESSED:
+    {
+        long dx = event->x - before->downPoint.x;
+        long dy = event->y - before->downPoint.y;
+        uint64_t distSq = (uint64_t)(dx * dx + dy * dy);
+        uint64_t travel = distSq > before->maxDistSq ? distSq : before->maxDistSq;
+        out.state = BTN_STATE_IDLE;
+        if (hybrid && (now - before->downTime > SMART_DRAG_HOLD_THRESHOLD_US || travel > SMART_DRAG_DIST_THRESHOLD_SQ))
+        {
+            out.state = BTN_STATE_CONFIRMING;
+            out.pending = (now << 1) | 1;
+            out.blocked = true;
+        }
+        break;
+    }
+    case BTN_STATE_DRAGGING:
+        out.state = BTN_STATE_IDLE;
+        if (hybrid)
+        {
+            out.state = BTN_STATE_CONFIRMING;
+            out.pending = (now << 1) | 1;
+            out.blocked = true;
+        }
+        break;
+    case BTN_STATE_CONFIRMING:
+        out.counted = 1;
+        out.blocked = true;
+        break;
+    default:
+        break;
+    }
+    return out;
+}
 
-#define TEST(name) \
-    do { printf("\n[TEST] %s\n", name); test_count++; } while(0)
+/* Every state, edge and input class, including each boundary; returns the number of mismatches */
+static int check_every_edge(void)
+{
+    static const uint64_t GAPS[] = {10000, 50000, 80000};   /* threshold 50ms */
+    static const uint64_t HOLDS[] = {100000, 200000, 300000}; /* hold limit 200ms */
+    static const long REACH[] = {1, 5, 10};                /* endpoint distance, limit 5px */
+    static const uint32_t PATHS[] = {0, 25, 100};          /* travel while held */
+    const uint64_t now = 10000000;
+    int mismatches = 0;
 
-#define CHECK(condition, msg) \
-    do { \
-        if (condition) { \
-            printf("  PASS: %s\n", msg); \
-            pass_count++; \
-        } else { \
-            printf("  FAIL: %s\n", msg); \
-            fail_count++; \
-        } \
-    } while(0)
+    for (int state = 0; state < BTN_STATE_COUNT; state++)
+    for (int down = 0; down < 2; down++)
+    for (int hybrid = 0; hybrid < 2; hybrid++)
+    for (int pending = 0; pending < 2; pending++)
+    for (int g = 0; g < 3; g++)
+    for (int h = 0; h < 3; h++)
+    for (int r = 0; r < 3; r++)
+    for (int t = 0; t < 3; t++)
+    {
+        DebounceManager manager;
+        debounce_init(&manager);
+        debounce_set_monitored(&manager, MOUSE_BUTTON_LEFT, true);
+        debounce_set_threshold(&manager, MOUSE_BUTTON_LEFT, 50, 1, 200);
+        debounce_set_hybrid_heuristic(&manager, hybrid);
+
+        ButtonDebounceData *data = &manager.buttons[MOUSE_BUTTON_LEFT];
+        data->state = (ButtonState)state;
+        data->previousTime = now - GAPS[g];
+        data->downTime = now - HOLDS[h];
+        data->downPoint.x = 100;
+        data->downPoint.y = 100;
+        data->maxDistSq = PATHS[t];
+        data->confirmPending = pending ? ((data->downTime << 1) | 1) : 0;
+        ButtonDebounceData before = *data;
+
+        MouseEvent event = {MOUSE_BUTTON_LEFT, now, down != 0, 100 + REACH[r], 100, false, 0};
+        EdgeOutcome expected = reference_edge(&before, &event, 50000, hybrid);
+        bool blocked = debounce_process_event(&manager, &event);
+
+        if (blocked != expected.blocked || data->state != expected.state ||
+            debounce_get_button_blocks(&manager, MOUSE_BUTTON_LEFT) != expected.counted ||
+            data->downTime != expected.downTime || data->downPoint.x != expected.downX ||
+            data->maxDistSq != expected.maxDistSq || data->confirmPending != expected.pending ||
+            (manager.move_mask != 0) != expected.tracked || data->previousTime != now)
+        {
+            if (mismatches++ < 5)
+                printf("  mismatch: state %d down %d hybrid %d pending %d gap %d hold %d reach %d path %d\n",
+                       state, down, hybrid, pending, g, h, r, t);
+        }
+    }
+    return mismatches;
+}
 
 int main(void)
 {
@@ -43,7 +189,7 @@ int main(void)
 
     MouseEvent down1 = {0};
     down1.button = MOUSE_BUTTON_LEFT;
-    down1.timestamp = 1000;
+    down1.timestamp = 1000000;
     down1.is_down = true;
     down1.x = 100;
     down1.y = 100;
@@ -51,7 +197,7 @@ int main(void)
 
     MouseEvent up1 = {0};
     up1.button = MOUSE_BUTTON_LEFT;
-    up1.timestamp = 1060;
+    up1.timestamp = 1060000;
     up1.is_down = false;
     up1.x = 100;
     up1.y = 100;
@@ -64,7 +210,7 @@ int main(void)
 
     MouseEvent down2a = {0};
     down2a.button = MOUSE_BUTTON_LEFT;
-    down2a.timestamp = 2000;
+    down2a.timestamp = 2000000;
     down2a.is_down = true;
     down2a.x = 100;
     down2a.y = 100;
@@ -72,7 +218,7 @@ int main(void)
 
     MouseEvent up2a = {0};
     up2a.button = MOUSE_BUTTON_LEFT;
-    up2a.timestamp = 2060;
+    up2a.timestamp = 2060000;
     up2a.is_down = false;
     up2a.x = 100;
     up2a.y = 100;
@@ -80,7 +226,7 @@ int main(void)
 
     MouseEvent down2b = {0};
     down2b.button = MOUSE_BUTTON_LEFT;
-    down2b.timestamp = 2080;
+    down2b.timestamp = 2080000;
     down2b.is_down = true;
     down2b.x = 100;
     down2b.y = 100;
@@ -88,7 +234,7 @@ int main(void)
 
     MouseEvent up2b = {0};
     up2b.button = MOUSE_BUTTON_LEFT;
-    up2b.timestamp = 2140;
+    up2b.timestamp = 2140000;
     up2b.is_down = false;
     up2b.x = 100;
     up2b.y = 100;
@@ -100,7 +246,7 @@ int main(void)
 
     MouseEvent down3 = {0};
     down3.button = MOUSE_BUTTON_LEFT;
-    down3.timestamp = 3000;
+    down3.timestamp = 3000000;
     down3.is_down = true;
     down3.x = 100;
     down3.y = 100;
@@ -108,11 +254,11 @@ int main(void)
 
     MouseEvent up3 = {0};
     up3.button = MOUSE_BUTTON_LEFT;
-    up3.timestamp = 3300;
+    up3.timestamp = 3300000;
     up3.is_down = false;
     up3.x = 100;
     up3.y = 100;
-    CHECK(debounce_process_event(&manager, &up3), "UP blocked (holdTime=300)");
+    CHECK(debounce_process_event(&manager, &up3), "UP blocked (holdTime=300ms)");
     CHECK(manager.buttons[MOUSE_BUTTON_LEFT].state == BTN_STATE_CONFIRMING, "State is CONFIRMING");
 
     /* Test 4: Move drag - Smart Drag */
@@ -121,7 +267,7 @@ int main(void)
 
     MouseEvent down4 = {0};
     down4.button = MOUSE_BUTTON_LEFT;
-    down4.timestamp = 4000;
+    down4.timestamp = 4000000;
     down4.is_down = true;
     down4.x = 100;
     down4.y = 100;
@@ -129,7 +275,7 @@ int main(void)
 
     MouseEvent up4 = {0};
     up4.button = MOUSE_BUTTON_LEFT;
-    up4.timestamp = 4100;
+    up4.timestamp = 4100000;
     up4.is_down = false;
     up4.x = 110;
     up4.y = 100;
@@ -142,7 +288,7 @@ int main(void)
 
     MouseEvent down5 = {0};
     down5.button = MOUSE_BUTTON_LEFT;
-    down5.timestamp = 5000;
+    down5.timestamp = 5000000;
     down5.is_down = true;
     down5.x = 100;
     down5.y = 100;
@@ -150,7 +296,7 @@ int main(void)
 
     MouseEvent up5 = {0};
     up5.button = MOUSE_BUTTON_LEFT;
-    up5.timestamp = 5300;
+    up5.timestamp = 5300000;
     up5.is_down = false;
     up5.x = 200;
     up5.y = 200;
@@ -159,13 +305,137 @@ int main(void)
 
     MouseEvent down5b = {0};
     down5b.button = MOUSE_BUTTON_LEFT;
-    down5b.timestamp = 5350;
+    down5b.timestamp = 5350000;
     down5b.is_down = true;
     down5b.x = 200;
     down5b.y = 200;
     CHECK(debounce_process_event(&manager, &down5b), "Bounce DOWN blocked");
     CHECK(manager.buttons[MOUSE_BUTTON_LEFT].state == BTN_STATE_DRAGGING, "Back to DRAGGING");
-    CHECK(manager.buttons[MOUSE_BUTTON_LEFT].downTime == 5350, "downTime updated");
+    CHECK(manager.buttons[MOUSE_BUTTON_LEFT].downTime == 5350000, "downTime updated");
+
+    /* Test 6: Deferred release fires on the microsecond deadline */
+    TEST("Deferred release - confirm timeout measured in microseconds");
+    debounce_reset_statistics(&manager);
+
+    MouseEvent down6 = {0};
+    down6.button = MOUSE_BUTTON_LEFT;
+    down6.timestamp = 6000000;
+    down6.is_down = true;
+    down6.x = 100;
+    down6.y = 100;
+    debounce_process_event(&manager, &down6);
+
+    MouseEvent up6 = {0};
+    up6.button = MOUSE_BUTTON_LEFT;
+    up6.timestamp = 6300000;
+    up6.is_down = false;
+    up6.x = 100;
+    up6.y = 100;
+    CHECK(debounce_process_event(&manager, &up6), "UP deferred");
+    uint64_t deadline6 = 0;
+    CHECK(debounce_get_next_deadline(&manager, &deadline6) && deadline6 == 6450000, "Next deadline is up + 150ms");
+    CHECK(debounce_collect_deferred_releases(&manager, 6449999) == 0, "Not released 1us before deadline");
+    CHECK(debounce_collect_deferred_releases(&manager, 6450000) == (1u << MOUSE_BUTTON_LEFT), "Released at 150ms");
+    CHECK(debounce_get_button_state(&manager, MOUSE_BUTTON_LEFT) == BTN_STATE_IDLE, "State back to IDLE");
+    CHECK(debounce_collect_deferred_releases(&manager, 6500000) == 0, "Released only once");
+    CHECK(!debounce_get_next_deadline(&manager, &deadline6), "No deadline left");
+
+    MouseEvent down6b = {0};
+    down6b.button = MOUSE_BUTTON_LEFT;
+    down6b.timestamp = 6600000;
+    down6b.is_down = true;
+    down6b.x = 100;
+    down6b.y = 100;
+    CHECK(!debounce_process_event(&manager, &down6b), "Next DOWN passes after release");
+
+    /* Test 7: Drag that returns to its origin */
+    TEST("Drag back to origin - path travel should trigger Smart Drag");
+    debounce_reset_statistics(&manager);
+
+    MouseEvent down7 = {0};
+    down7.button = MOUSE_BUTTON_LEFT;
+    down7.timestamp = 7000000;
+    down7.is_down = true;
+    down7.x = 100;
+    down7.y = 100;
+    debounce_process_event(&manager, &down7);
+    CHECK(manager.move_mask == (1u << MOUSE_BUTTON_LEFT), "Travel tracked while PRESSED");
+
+    for (long step = 0; step <= 40; step++)
+        debounce_process_move(&manager, 100 + (step <= 20 ? step : 40 - step), 100);
+    CHECK(manager.buttons[MOUSE_BUTTON_LEFT].maxDistSq > SMART_DRAG_DIST_THRESHOLD_SQ, "Max travel recorded");
+    CHECK(manager.move_mask == 0, "Tracking stops once past the drag distance");
+
+    MouseEvent up7 = {0};
+    up7.button = MOUSE_BUTTON_LEFT;
+    up7.timestamp = 7100000;
+    up7.is_down = false;
+    up7.x = 100;
+    up7.y = 100;
+    CHECK(debounce_process_event(&manager, &up7), "UP deferred (released at origin after 20px travel)");
+    CHECK(manager.buttons[MOUSE_BUTTON_LEFT].state == BTN_STATE_CONFIRMING, "State is CONFIRMING");
+    debounce_collect_deferred_releases(&manager, 7250000);
+
+    /* Test 8: Jitter within the drag distance is still a click */
+    TEST("Small jitter while pressed - click passes, moves ignored when idle");
+    MouseEvent down8 = down7;
+    down8.timestamp = 8000000;
+    debounce_process_event(&manager, &down8);
+    debounce_process_move(&manager, 103, 102);
+    debounce_process_move(&manager, 101, 99);
+
+    MouseEvent up8 = up7;
+    up8.timestamp = 8080000;
+    CHECK(!debounce_process_event(&manager, &up8), "UP passed (3.6px max travel)");
+    CHECK(manager.move_mask == 0, "Nothing tracked after release");
+    debounce_process_move(&manager, 500, 500);
+    CHECK(manager.buttons[MOUSE_BUTTON_LEFT].state == BTN_STATE_IDLE, "Idle moves change nothing");
+
+    /* Test 9: The transition table against the nested-switch reference */
+    TEST("Every state, edge and input boundary matches the reference state machine");
+    CHECK(check_every_edge() == 0, "3240 edges identical (verdict, state, counters, stamps, confirm, tracking)");
+
+    /* Test 10: Added latency of deferred and cancelled releases */
+    TEST("Added latency - deferred releases and confirm cancellations");
+    debounce_reset_statistics(&manager);
+
+    MouseEvent down10 = down7;
+    MouseEvent up10 = up7;
+    down10.timestamp = 10000000;
+    up10.timestamp = 10300000;
+    debounce_process_event(&manager, &down10);
+    debounce_process_event(&manager, &up10);
+    debounce_collect_deferred_releases(&manager, 10450000);
+
+    down10.timestamp = 10600000;
+    up10.timestamp = 10900000;
+    debounce_process_event(&manager, &down10);
+    debounce_process_event(&manager, &up10);
+    debounce_collect_deferred_releases(&manager, 11080000); /* collector 30ms late */
+
+    down10.timestamp = 11200000;
+    up10.timestamp = 11500000;
+    debounce_process_event(&manager, &down10);
+    debounce_process_event(&manager, &up10);
+    down10.timestamp = 11540000;
+    debounce_process_event(&manager, &down10);
+
+    AddedLatencySummary deferred10, cancelled10;
+    debounce_get_added_latency(&manager, MOUSE_BUTTON_LEFT, ADDED_LATENCY_DEFERRED, &deferred10);
+    debounce_get_added_latency(&manager, MOUSE_BUTTON_LEFT, ADDED_LATENCY_CANCELLED, &cancelled10);
+    CHECK(deferred10.count == 2 && deferred10.total_us == 330000 && deferred10.max_us == 180000,
+          "Two deferred releases: 150ms and 180ms");
+    CHECK(deferred10.p50_us >= 150000 && deferred10.p50_us <= 150000 * 17 / 16, "p50 within a bucket of 150ms");
+    CHECK(cancelled10.count == 1 && cancelled10.total_us == 40000, "Cancelled release held 40ms");
+    CHECK(debounce_get_button_blocks(&manager, MOUSE_BUTTON_LEFT) == 1, "The cancelling DOWN counts as a block");
+
+    debounce_reset_statistics(&manager);
+    debounce_get_added_latency(&manager, MOUSE_BUTTON_LEFT, ADDED_LATENCY_DEFERRED, &deferred10);
+    CHECK(deferred10.count == 0 && deferred10.total_us == 0, "Reset reads as empty before the hook applies it");
+    up10.timestamp = 12000000;
+    debounce_process_event(&manager, &up10);
+    debounce_get_added_latency(&manager, MOUSE_BUTTON_LEFT, ADDED_LATENCY_DEFERRED, &deferred10);
+    CHECK(deferred10.count == 0, "...and after");
 
     /* Summary */
     printf("\n================================================\n");
@@ -0,0 +1,532 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/core/debouncer.h"
+#include "../src/trace/trace_map.h"
+#include "../src/trace/trace_reader.h"
+#include "../src/trace/trace_replay.h"
+#include "../src/trace/trace_writer.h"
+#include "test_common.h"
+
+/* Trace format round trip and deterministic replay */
+
+#define STREAM_LENGTH 20000
+#define TRACE_PATH "test_trace.mft"
+
+/*
+ * Buttons, wheel and injected events with occasional large time gaps and
+ * pointer jumps (including negative multi-monitor coordinates).
+ */
+static void build_stream(MouseEvent *events, size_t count, uint64_t seed)
+{
+    uint64_t rng = seed;
+    uint64_t now = 5000000;
+    long x = 800, y = 600;
+    bool down[MOUSE_BUTTON_COUNT] = {false};
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t r = test_rand(&rng);
+        MouseEvent *e = &events[i];
+        memset(e, 0, sizeof(*e));
+
+        e->button = (MouseButton)(r % MOUSE_BUTTON_COUNT);
+        if (e->button == MOUSE_BUTTON_WHEEL)
+        {
+            e->data = (int32_t)((r >> 8) % 5 + 1) * ((r >> 11) & 1 ? 120 : -120);
+        }
+        else
+        {
+            down[e->button] = !down[e->button];
+            e->is_down = down[e->button];
+        }
+
+        switch ((r >> 12) & 7)
+        {
+        case 0:
+            now += (r >> 16) % 9000;
+            break;
+        case 1:
+            now += 250000 + (r >> 16) % 100000;
+            break;
+        case 2:
+            now += (r >> 16) % 4000000000ull; /* long idle */
+            break;
+        default:
+            now += 40000 + (r >> 16) % 120000;
+            break;
+        }
+
+        switch ((r >> 48) & 7)
+        {
+        case 0:
+            x += (long)((r >> 52) % 41) - 20;
+            y += (long)((r >> 56) % 41) - 20;
+            break;
+        case 1:
+            x = (long)((r >> 24) % 7680) - 3840;
+            y = (long)((r >> 36) % 2160) - 1080;
+            break;
+        default:
+            break;
+        }
+
+        e->timestamp = now;
+        e->x = x;
+        e->y = y;
+        e->is_injected = ((r >> 40) & 31) == 0;
+    }
+}
+
+static bool events_equal(const MouseEvent *a, const MouseEvent *b)
+{
+    return a->button == b->button && a->timestamp == b->timestamp && a->is_down == b->is_down &&
+           a->x == b->x && a->y == b->y && a->is_injected == b->is_injected && a->data == b->data;
+}
+
+static bool write_trace(const MouseEvent *events, size_t count, DebounceManager *config_source)
+{
+    TraceWriter *writer = malloc(sizeof(TraceWriter));
+    if (!writer || !trace_writer_open(writer, TRACE_PATH, events[0].timestamp))
+    {
+        free(writer);
+        return false;
+    }
+
+    DebounceConfig config;
+    debounce_get_config(config_source, &config);
+    trace_writer_config(writer, events[0].timestamp, &config);
+    for (size_t i = 0; i < count; i++)
+        trace_writer_event(writer, &events[i]);
+
+    bool ok = trace_writer_close(writer);
+    free(writer);
+    return ok;
+}
+
+static void test_round_trip(void)
+{
+    TEST("Events, config and reset records survive a round trip");
+
+    MouseEvent *events = calloc(STREAM_LENGTH, sizeof(MouseEvent));
+    TraceWriter *writer = malloc(sizeof(TraceWriter));
+    TraceReader *reader = malloc(sizeof(TraceReader));
+    if (!events || !writer || !reader)
+    {
+        CHECK(false, "allocation");
+        return;
+    }
+    build_stream(events, STREAM_LENGTH, 0x0123456789ABCDEFull);
+
+    DebounceConfig config = {0x1F, true, {50000, 40000, 60000, 1000, 200000, 30000}, {180000, 16, 120000}, {true, 15000, 90000}};
+    trace_writer_open(writer, TRACE_PATH, events[0].timestamp);
+    for (size_t i = 0; i < STREAM_LENGTH; i++)
+    {
+        if (i == 100)
+            trace_writer_config(writer, events[i].timestamp, &config);
+        if (i == 200)
+            trace_writer_reset(writer, events[i].timestamp);
+        trace_writer_event(writer, &events[i]);
+    }
+    CHECK(trace_writer_close(writer), "Writer closed cleanly");
+
+    CHECK(trace_reader_open(reader, TRACE_PATH), "Reader accepts header");
+
+    size_t matched = 0, configs = 0, resets = 0;
+    bool config_ok = false;
+    TraceRecord record;
+    int status;
+    while ((status = trace_reader_next(reader, &record)) == 1)
+    {
+        if (record.type == TRACE_RECORD_CONFIG)
+        {
+            configs++;
+            config_ok = memcmp(&record.config, &config, sizeof(config)) == 0 && record.timestamp == events[100].timestamp;
+        }
+        else if (record.type == TRACE_RECORD_RESET)
+        {
+            resets++;
+        }
+        else if (matched < STREAM_LENGTH && events_equal(&record.event, &events[matched]))
+        {
+            matched++;
+        }
+        else
+        {
+            break;
+        }
+    }
+    trace_reader_close(reader);
+
+    CHECK(status == 0, "Clean end of trace");
+    CHECK(matched == STREAM_LENGTH, "Every event decoded identically");
+    CHECK(configs == 1 && config_ok, "Config record decoded");
+    CHECK(resets == 1, "Reset record decoded");
+
+    remove(TRACE_PATH);
+    free(reader);
+    free(writer);
+    free(events);
+}
+
+static void test_truncated_records(void)
+{
+    TEST("Truncated records are reported, not misdecoded");
+
+    MouseEvent event = {MOUSE_BUTTON_WHEEL, 9000000, false, -1234, 5678, true, -360};
+    uint8_t buffer[TRACE_MAX_RECORD_SIZE];
+    TraceCodec codec;
+    trace_codec_init(&codec, 1000);
+    size_t size = trace_encode_event(&codec, buffer, &event);
+
+    bool all_incomplete = true;
+    for (size_t n = 0; n < size; n++)
+    {
+        TraceRecord record;
+        trace_codec_init(&codec, 1000);
+        if (trace_decode_record(&codec, buffer, buffer + n, &record) != 0 || codec.last_time != 1000)
+            all_incomplete = false;
+    }
+    CHECK(all_incomplete, "Every proper prefix decodes as incomplete and leaves the codec untouched");
+
+    TraceRecord record;
+    trace_codec_init(&codec, 1000);
+    CHECK(trace_decode_record(&codec, buffer, buffer + size, &record) == (int)size, "Full record consumed");
+    CHECK(events_equal(&record.event, &event), "Injected wheel event with negative coordinates");
+
+    uint8_t bad = 7;
+    CHECK(trace_decode_record(&codec, &bad, &bad + 1, &record) == -1, "Reserved kind rejected");
+}
+
+/* A varint of the longest form (10 bytes), padded with continuation bytes */
+static size_t put_long_varint(uint8_t *out, uint64_t value)
+{
+    for (int i = 0; i < 9; i++)
+        out[i] = 0x80 | (uint8_t)((value >> (7 * i)) & 0x7F);
+    out[9] = (uint8_t)(value >> 63);
+    return 10;
+}
+
+static void test_longest_record(void)
+{
+    TEST("Longest record decodes at the end of an exact-size buffer");
+
+    /* Injected prefix, then a config record with every field present and every varint 10 bytes */
+    uint8_t longest[256];
+    size_t size = 0;
+    longest[size++] = TRACE_KIND_META | (TRACE_META_INJECTED << 3);
+    size += put_long_varint(longest + size, 1);
+    longest[size++] = TRACE_KIND_META | (TRACE_META_CONFIG << 3);
+    size += put_long_varint(longest + size, 1);
+    size += put_long_varint(longest + size, 0x3F | TRACE_CONFIG_SMART_DRAG | TRACE_CONFIG_ADAPTIVE);
+    for (int i = 0; i < MOUSE_BUTTON_COUNT + 5; i++)
+        size += put_long_varint(longest + size, 1000 + (uint64_t)i);
+
+    /* Every tail of the record, each in a heap block of exactly its size so a read past it is caught */
+    bool truncated_ok = true;
+    bool full_ok = false;
+    for (size_t n = size > 64 ? size - 64 : 1; n <= size; n++)
+    {
+        uint8_t *buffer = malloc(n);
+        if (!buffer)
+            return;
+        memcpy(buffer, longest, n);
+
+        TraceCodec codec;
+        TraceRecord record;
+        trace_codec_init(&codec, 0);
+        int used = trace_decode_record(&codec, buffer, buffer + n, &record);
+        if (n < size && used != 0)
+            truncated_ok = false;
+        if (n == size)
+            full_ok = used == (int)size && record.type == TRACE_RECORD_CONFIG && record.config.monitored_mask == 0x3F &&
+                      record.config.threshold_us[0] == 1000 && record.config.adaptive.max_us == 1010;
+        free(buffer);
+    }
+    CHECK(truncated_ok, "Cut short anywhere, it decodes as incomplete");
+    CHECK(full_ok, "Whole, every field is read back");
+}
+
+static void test_compact_clicks(void)
+{
+    TEST("Clicks without movement stay under 4 bytes");
+
+    TraceCodec codec;
+    trace_codec_init(&codec, 0);
+    uint8_t buffer[TRACE_MAX_RECORD_SIZE];
+    size_t total = 0;
+    uint64_t now = 0;
+
+    for (int i = 0; i < 1000; i++)
+    {
+        now += i % 2 ? 90000 : 2500000; /* press lasts 90ms, next click 2.5s later */
+        MouseEvent e = {MOUSE_BUTTON_LEFT, now, i % 2 == 0, 0, 0, false, 0};
+        total += trace_encode_event(&codec, buffer, &e);
+    }
+
+    printf("  %.2f bytes/event\n", total / 1000.0);
+    CHECK(total < 4 * 1000, "Average below 4 bytes per button event");
+}
+
+typedef struct
+{
+    bool *verdicts;
+    size_t count;
+    size_t releases;
+} ReplayLog;
+
+static void on_event(const MouseEvent *event, bool blocked, void *user_data)
+{
+    ReplayLog *log = user_data;
+    (void)event;
+    log->verdicts[log->count++] = blocked;
+}
+
+static void on_release(MouseButton button, uint64_t timestamp, void *user_data)
+{
+    ReplayLog *log = user_data;
+    (void)button;
+    (void)timestamp;
+    log->releases++;
+}
+
+static bool replay_file(ReplayLog *log)
+{
+    TraceReader *reader = malloc(sizeof(TraceReader));
+    if (!reader || !trace_reader_open(reader, TRACE_PATH))
+    {
+        free(reader);
+        return false;
+    }
+
+    DebounceManager manager;
+    debounce_init(&manager);
+    TraceReplayCallbacks callbacks = {on_event, on_release, log};
+    TraceReplayer replayer;
+    trace_replayer_init(&replayer, &manager, &callbacks);
+
+    TraceRecord record;
+    int status;
+    while ((status = trace_reader_next(reader, &record)) == 1)
+        trace_replayer_apply(&replayer, &record);
+    trace_replayer_finish(&replayer);
+
+    trace_reader_close(reader);
+    free(reader);
+    return status == 0;
+}
+
+static void test_deterministic_replay(void)
+{
+    TEST("Replay reproduces live verdicts and deferred releases");
+
+    MouseEvent *events = calloc(STREAM_LENGTH, sizeof(MouseEvent));
+    bool *live = calloc(STREAM_LENGTH, sizeof(bool));
+    bool *first = calloc(STREAM_LENGTH, sizeof(bool));
+    bool *second = calloc(STREAM_LENGTH, sizeof(bool));
+    if (!events || !live || !first || !second)
+    {
+        CHECK(false, "allocation");
+        return;
+    }
+    build_stream(events, STREAM_LENGTH, 0xFEEDFACECAFEBEEFull);
+
+    /* Live run, with releases fired at their deadlines as the scheduler does */
+    DebounceManager manager;
+    test_configure(&manager);
+    debounce_set_hybrid_heuristic(&manager, true);
+    size_t live_releases = 0;
+    for (size_t i = 0; i < STREAM_LENGTH; i++)
+    {
+        uint64_t deadline;
+        while (debounce_get_next_deadline(&manager, &deadline) && deadline <= events[i].timestamp)
+        {
+            uint32_t mask = debounce_collect_deferred_releases(&manager, deadline);
+            for (; mask; mask &= mask - 1)
+                live_releases++;
+        }
+        live[i] = debounce_process_event(&manager, &events[i]);
+    }
+
+    DebounceManager config_source;
+    test_configure(&config_source);
+    debounce_set_hybrid_heuristic(&config_source, true);
+    CHECK(write_trace(events, STREAM_LENGTH, &config_source), "Trace written");
+
+    ReplayLog a = {first, 0, 0};
+    ReplayLog b = {second, 0, 0};
+    CHECK(replay_file(&a) && replay_file(&b), "Trace replayed twice");
+    CHECK(a.count == STREAM_LENGTH && b.count == STREAM_LENGTH, "Every event replayed");
+    CHECK(memcmp(first, live, STREAM_LENGTH * sizeof(bool)) == 0, "Replay verdicts match the live run");
+    CHECK(memcmp(first, second, STREAM_LENGTH * sizeof(bool)) == 0, "Replays are identical");
+    CHECK(a.releases >= live_releases && a.releases == b.releases, "Deferred releases reproduced");
+    CHECK(live_releases > 0, "Stream exercises Smart Drag releases");
+
+    remove(TRACE_PATH);
+    free(second);
+    free(first);
+    free(live);
+    free(events);
+}
+
+static void test_mapped_reader(void)
+{
+    TEST("Mapped reader matches the stdio reader across window slides");
+
+    const size_t length = 5 * STREAM_LENGTH;
+    MouseEvent *events = calloc(length, sizeof(MouseEvent));
+    TraceReader *reader = malloc(sizeof(TraceReader));
+    if (!events || !reader)
+    {
+        CHECK(false, "allocation");
+        return;
+    }
+    build_stream(events, length, 0x5555AAAA5555AAAAull);
+
+    DebounceManager config_source;
+    test_configure(&config_source);
+    CHECK(write_trace(events, length, &config_source), "Trace written");
+
+    /* Smallest window so records straddle many boundaries */
+    TraceMap map;
+    CHECK(trace_map_open(&map, TRACE_PATH, 1), "Mapped reader accepts header");
+    CHECK(map.file_size > 3 * map.window_size, "Trace spans several windows");
+    trace_reader_open(reader, TRACE_PATH);
+
+    size_t records = 0, mismatches = 0;
+    TraceRecord a, b;
+    int status_map, status_stdio;
+    for (;;)
+    {
+        status_map = trace_map_next(&map, &a);
+        status_stdio = trace_reader_next(reader, &b);
+        if (status_map != 1 || status_stdio != 1)
+            break;
+        records++;
+        if (a.type != b.type || a.timestamp != b.timestamp ||
+            (a.type == TRACE_RECORD_EVENT && !events_equal(&a.event, &b.event)))
+            mismatches++;
+    }
+
+    CHECK(status_map == 0 && status_stdio == 0, "Both readers end cleanly");
+    CHECK(records == length + 1 && mismatches == 0, "Identical record sequences");
+    CHECK(trace_map_tell(&map) == map.file_size, "Whole file consumed");
+
+    trace_map_close(&map);
+    trace_reader_close(reader);
+    remove(TRACE_PATH);
+    free(reader);
+    free(events);
+}
+
+static void test_mapped_batch_replay(void)
+{
+    TEST("Batched mapped replay matches record-at-a-time replay");
+
+    MouseEvent *events = calloc(STREAM_LENGTH, sizeof(MouseEvent));
+    bool *sequential = calloc(STREAM_LENGTH, sizeof(bool));
+    bool *batched = calloc(STREAM_LENGTH, sizeof(bool));
+    if (!events || !sequential || !batched)
+    {
+        CHECK(false, "allocation");
+        return;
+    }
+
+    /* Dense bursts so batches cover many events and Smart Drag windows */
+    build_stream(events, STREAM_LENGTH, 0x0F0F0F0F12345678ull);
+    uint64_t now = events[0].timestamp;
+    for (size_t i = 0; i < STREAM_LENGTH; i++)
+    {
+        uint64_t gap = (events[i].timestamp * 2654435761u >> 7) % 6;
+        now += gap == 0 ? 260000 : gap == 1 ? 150000 : 3000 + gap * 9000;
+        events[i].timestamp = now;
+    }
+
+    DebounceManager config_source;
+    test_configure(&config_source);
+    debounce_set_hybrid_heuristic(&config_source, true);
+    CHECK(write_trace(events, STREAM_LENGTH, &config_source), "Trace written");
+
+    ReplayLog a = {sequential, 0, 0};
+    CHECK(replay_file(&a), "Sequential replay");
+
+    TraceMap map;
+    DebounceManager manager;
+    debounce_init(&manager);
+    ReplayLog b = {batched, 0, 0};
+    TraceReplayCallbacks callbacks = {on_event, on_release, &b};
+    TraceReplayer replayer;
+    trace_replayer_init(&replayer, &manager, &callbacks);
+    CHECK(trace_map_open(&map, TRACE_PATH, 0), "Mapped reader opened");
+    CHECK(trace_map_replay(&map, &replayer) == 0, "Mapped replay ends cleanly");
+    trace_replayer_finish(&replayer);
+    trace_map_close(&map);
+
+    CHECK(b.count == STREAM_LENGTH, "Every event replayed");
+    CHECK(memcmp(sequential, batched, STREAM_LENGTH * sizeof(bool)) == 0, "Identical verdicts");
+    CHECK(a.releases == b.releases && a.releases > 0, "Identical deferred releases");
+
+    remove(TRACE_PATH);
+    free(batched);
+    free(sequential);
+    free(events);
+}
+
+static void test_sink(void)
+{
+    TEST("Trace sink records a batch of synthesized releases");
+
+    TraceWriter *writer = malloc(sizeof(TraceWriter));
+    TraceReader *reader = malloc(sizeof(TraceReader));
+    if (!writer || !reader)
+    {
+        CHECK(false, "allocation");
+        return;
+    }
+
+    OutputBatch batch;
+    trace_writer_open(writer, TRACE_PATH, 1000000);
+    output_batch_init(&batch, trace_writer_sink(writer));
+    output_batch_push_releases(&batch, (1u << MOUSE_BUTTON_RIGHT) | (1u << MOUSE_BUTTON_X2), 1150000);
+    CHECK(output_batch_flush(&batch), "Batch flushed to the writer");
+    CHECK(trace_writer_close(writer), "Writer closed cleanly");
+
+    MouseEvent expected[2] = {{MOUSE_BUTTON_RIGHT, 1150000, false, 0, 0, true, 0},
+                              {MOUSE_BUTTON_X2, 1150000, false, 0, 0, true, 0}};
+    size_t matched = 0;
+    TraceRecord record;
+    trace_reader_open(reader, TRACE_PATH);
+    while (trace_reader_next(reader, &record) == 1 && matched < 2 && record.type == TRACE_RECORD_EVENT &&
+           events_equal(&record.event, &expected[matched]))
+        matched++;
+    trace_reader_close(reader);
+    CHECK(matched == 2, "Both releases read back as injected button-ups");
+
+    remove(TRACE_PATH);
+    free(reader);
+    free(writer);
+}
+
+int main(void)
+{
+    printf("================================================\n");
+    printf("Input Trace Tests\n");
+    printf("================================================\n");
+
+    test_round_trip();
+    test_truncated_records();
+    test_longest_record();
+    test_compact_clicks();
+    test_deterministic_replay();
+    test_mapped_reader();
+    test_mapped_batch_replay();
+    test_sink();
+
+    printf("\n================================================\n");
+    printf("Result: %d/%d passed", pass_count, test_count);
+    if (fail_count > 0)
+        printf(" (%d failed)", fail_count);
+    printf("\n================================================\n");
+
+    return fail_count > 0 ? 1 : 0;
+}
@@ -0,0 +1,211 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/core/debouncer.h"
+#include "../src/trace/trace_writer.h"
+#include "../src/tune/algo_compare.h"
+#include "../src/tune/tune.h"
+#include "../src/tune/tune_pool.h"
+#include "test_common.h"
+
+/* Work-stealing pool, the offline threshold tuner and the algorithm comparison */
+
+#define TRACE_PATH_A "test_tune_a.mft"
+#define TRACE_PATH_B "test_tune_b.mft"
+#define POOL_TASKS   10000
+#define CLICKS       2000
+
+static MfAtomic32 task_runs[POOL_TASKS];
+static MfAtomic32 worker_tasks[8];
+
+static void count_task(size_t task, int worker, void *context)
+{
+    (void)context;
+    mf_atomic_fetch_add32(&task_runs[task], 1);
+    mf_atomic_fetch_add32(&worker_tasks[worker], 1);
+}
+
+static void test_pool(void)
+{
+    TEST("Pool runs every task exactly once");
+
+    CHECK(tune_pool_run(POOL_TASKS, 4, count_task, NULL), "Pool ran");
+    bool once = true;
+    for (int i = 0; i < POOL_TASKS; i++)
+        once = once && mf_atomic_load32(&task_runs[i]) == 1;
+    CHECK(once, "Each of 10000 tasks ran once with 4 workers");
+
+    uint32_t total = 0;
+    for (int w = 0; w < 8; w++)
+        total += mf_atomic_load32(&worker_tasks[w]);
+    CHECK(total == POOL_TASKS && mf_atomic_load32(&worker_tasks[4]) == 0, "Only worker indices 0-3 used");
+
+    memset((void *)task_runs, 0, sizeof(task_runs));
+    CHECK(tune_pool_run(3, 8, count_task, NULL), "More workers than tasks");
+    CHECK(task_runs[0] == 1 && task_runs[1] == 1 && task_runs[2] == 1 && task_runs[3] == 0, "Three tasks ran once");
+    CHECK(tune_pool_run(0, 4, count_task, NULL), "Empty task set is fine");
+}
+
+/*
+ * Left-button clicks: relaxed clicks, fast double clicks whose re-press
+ * comes 40ms after the release (genuine), 5ms chatter after a release
+ * (bounce), and long holds that Smart Drag defers.
+ */
+static bool write_trace(const char *path, uint64_t seed)
+{
+    TraceWriter *writer = malloc(sizeof(TraceWriter));
+    if (!writer || !trace_writer_open(writer, path, 1000000))
+    {
+        free(writer);
+        return false;
+    }
+
+    uint64_t rng = seed;
+    uint64_t now = 1000000;
+    MouseEvent e;
+    memset(&e, 0, sizeof(e));
+    e.button = MOUSE_BUTTON_LEFT;
+    e.x = 100;
+    e.y = 100;
+
+    for (int i = 0; i < CLICKS; i++)
+    {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        int kind = (int)(rng % 4);
+
+        now += 300000;
+        e.timestamp = now;
+        e.is_down = true;
+        trace_writer_event(writer, &e);
+
+        now += kind == 3 ? 400000 : 60000;
+        e.timestamp = now;
+        e.is_down = false;
+        trace_writer_event(writer, &e);
+
+        if (kind == 1 || kind == 2)
+        {
+            now += kind == 1 ? 40000 : 5000;
+            e.timestamp = now;
+            e.is_down = true;
+            trace_writer_event(writer, &e);
+            now += kind == 1 ? 60000 : 3000;
+            e.timestamp = now;
+            e.is_down = false;
+            trace_writer_event(writer, &e);
+        }
+    }
+
+    bool ok = trace_writer_close(writer);
+    free(writer);
+    return ok;
+}
+
+static void test_tuner(void)
+{
+    TEST("Tuner scores thresholds against labelled edges");
+
+    CHECK(write_trace(TRACE_PATH_A, 0x1234567887654321ull) && write_trace(TRACE_PATH_B, 0x0F0F0F0F12345678ull),
+          "Traces written");
+
+    const char *traces[] = {TRACE_PATH_A, TRACE_PATH_B, "missing.mft"};
+    const uint32_t thresholds[] = {2000, 10000, 30000, 50000};
+    TuneVariant variants[2];
+    memset(variants, 0, sizeof(variants));
+    variants[1].hybrid = true;
+    variants[1].smart_drag.hold_us = 200000;
+    variants[1].smart_drag.dist_sq = 25;
+    variants[1].smart_drag.confirm_us = 120000;
+
+    TuneJob job = {traces, 3, thresholds, 4, variants, 2, 25000, 3};
+    TuneResults results;
+    CHECK(tune_run(&job, &results), "Tuner ran");
+    CHECK(results.failed_traces == 1, "Missing trace reported once");
+
+    const TuneStats *low = tune_stats_at(&job, &results, 0, 0, MOUSE_BUTTON_LEFT);
+    const TuneStats *mid = tune_stats_at(&job, &results, 0, 1, MOUSE_BUTTON_LEFT);
+    const TuneStats *high = tune_stats_at(&job, &results, 0, 3, MOUSE_BUTTON_LEFT);
+    CHECK(low->bounces > 0 && low->bounces == mid->bounces && low->genuine == high->genuine, "Labels independent of threshold");
+    CHECK(low->caught == 0 && mid->caught == mid->bounces, "2ms misses the 5ms chatter, 10ms catches all of it");
+    CHECK(mid->suppressed == 0 && high->suppressed > 0, "50ms suppresses the 40ms double clicks");
+
+    const TuneStats *drag = tune_stats_at(&job, &results, 1, 1, MOUSE_BUTTON_LEFT);
+    CHECK(drag->deferred > 0 && drag->latency_us == drag->deferred * 120000, "Smart Drag releases add exactly confirm_us");
+    CHECK(mid->deferred == 0, "No deferred releases with Smart Drag off");
+
+    TuneWeights weights = {1.0, 4.0, 0.01};
+    TuneCandidate ranked[2];
+    tune_rank(&job, &results, &weights, ranked);
+    CHECK(ranked[0].variant == 0 && ranked[0].threshold_us[MOUSE_BUTTON_LEFT] == 10000, "Best: Smart Drag off, 10ms on left");
+    CHECK(ranked[0].score <= ranked[1].score, "Ranked best first");
+
+    /* Same answer regardless of how the work was split */
+    TuneResults single;
+    job.workers = 1;
+    CHECK(tune_run(&job, &single), "Single-threaded run");
+    CHECK(memcmp(single.stats, results.stats, 2 * 4 * MOUSE_BUTTON_COUNT * sizeof(TuneStats)) == 0 &&
+              single.events == results.events,
+          "Identical to the 3-worker run");
+
+    tune_results_free(&single);
+    tune_results_free(&results);
+    remove(TRACE_PATH_A);
+    remove(TRACE_PATH_B);
+}
+
+static void test_algo_compare(void)
+{
+    TEST("Algorithm comparison on the same traces");
+
+    CHECK(write_trace(TRACE_PATH_A, 0x1234567887654321ull) && write_trace(TRACE_PATH_B, 0x0F0F0F0F12345678ull),
+          "Traces written");
+
+    const char *traces[] = {TRACE_PATH_A, TRACE_PATH_B};
+    const DebounceAlgoParams candidates[] = {
+        {DEBOUNCE_ALGO_LOCKOUT, 10000, 10000, 0},
+        {DEBOUNCE_ALGO_LOCKOUT, 50000, 50000, 0},
+        {DEBOUNCE_ALGO_TRAILING, 10000, 10000, 0},
+        {DEBOUNCE_ALGO_ASYMMETRIC, 10000, 10000, 0},
+    };
+    AlgoJob job = {traces, 2, candidates, 4, 25000, 2};
+    AlgoResults results;
+    CHECK(algo_compare_run(&job, &results) && results.failed_traces == 0, "Comparison ran");
+
+    const AlgoStats *lockout = algo_stats_at(&job, &results, 0, MOUSE_BUTTON_LEFT);
+    const AlgoStats *wide = algo_stats_at(&job, &results, 1, MOUSE_BUTTON_LEFT);
+    const AlgoStats *trailing = algo_stats_at(&job, &results, 2, MOUSE_BUTTON_LEFT);
+    const AlgoStats *asymmetric = algo_stats_at(&job, &results, 3, MOUSE_BUTTON_LEFT);
+    CHECK(lockout->bounces > 0 && lockout->passed == 0 && lockout->suppressed == 0 && algo_stats_latency(lockout) == 0,
+          "Lockout at 10ms catches the chatter at no added latency");
+    CHECK(wide->suppressed > 0, "Lockout at 50ms swallows the 40ms double clicks");
+    CHECK(trailing->passed == 0 && latency_histogram_max(&trailing->press_us) == 10000 &&
+              latency_histogram_percentile(&trailing->press_us, 0.5) > 0,
+          "Trailing adds its window to every press");
+    CHECK(asymmetric->passed == 0 && asymmetric->suppressed == 0, "Asymmetric catches the chatter too");
+    CHECK(algo_compare_pick(&job, &results, MOUSE_BUTTON_LEFT, 0.01, 0.005) == 0, "Pick: lockout at 10ms");
+
+    algo_results_free(&results);
+    remove(TRACE_PATH_A);
+    remove(TRACE_PATH_B);
+}
+
+int main(void)
+{
+    printf("================================================\n");
+    printf("Tuner Tests\n");
+    printf("================================================\n");
+
+    test_pool();
+    test_tuner();
+    test_algo_compare();
+
+    printf("\n================================================\n");
+    printf("Result: %d/%d passed", pass_count, test_count);
+    if (fail_count > 0)
+        printf(" (%d failed)", fail_count);
+    printf("\n================================================\n");
+
+    return fail_count > 0 ? 1 : 0;
+}
@@ -0,0 +1,270 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/core/debouncer.h"
+#include "../src/tune/algo_compare.h"
+
+/*
+ * Compares button debounce algorithms on recorded traces.
+ *
+ *   mousefix_algos [options] <trace.mft>...
+ *
+ *   --threads N            worker threads (default: one per CPU)
+ *   --algos A,B,...        algorithms to try (default: all of lockout,
+ *                          asymmetric, trailing, integrator, hysteresis)
+ *   --windows LO:HI:ST     candidate windows in ms (default 2:40:2);
+ *                          asymmetric tries every press/release pair
+ *   --sample-us N          integrator sample period (default 1000)
+ *   --bounce-ms N          edges closer than this are labelled bounces (default 25)
+ *   --max-pass PCT         bounces a candidate may let through (default 1)
+ *   --max-suppress PCT     genuine presses it may swallow (default 0.5)
+ *   -v                     print every candidate, not only each algorithm's best
+ *
+ * For each algorithm the table shows the candidate with the lowest added
+ * latency within the limits over all buttons, then the pick per button.
+ * See src/tune/algo_compare.h for how edges are labelled and scored.
+ */
+
+#define MAX_RANGE 64
+
+typedef struct
+{
+    uint32_t values[MAX_RANGE];
+    size_t count;
+} Range;
+
+static bool parse_range(const char *text, Range *range)
+{
+    unsigned lo, hi, step;
+    int fields = sscanf(text, "%u:%u:%u", &lo, &hi, &step);
+    if (fields == 1)
+    {
+        hi = lo;
+        step = 1;
+    }
+    else if (fields != 3 || step == 0 || hi < lo)
+    {
+        return false;
+    }
+
+    range->count = 0;
+    for (unsigned v = lo; v <= hi && range->count < MAX_RANGE; v += step)
+        range->values[range->count++] = v;
+    return range->count > 0;
+}
+
+static bool parse_algos(const char *text, bool *enabled)
+{
+    char buffer[128];
+    snprintf(buffer, sizeof(buffer), "%s", text);
+    memset(enabled, 0, DEBOUNCE_ALGO_COUNT * sizeof(bool));
+
+    for (char *name = strtok(buffer, ","); name; name = strtok(NULL, ","))
+    {
+        DebounceAlgo algo = debounce_algo_from_name(name);
+        if (algo == DEBOUNCE_ALGO_COUNT)
+            return false;
+        enabled[algo] = true;
+    }
+    return true;
+}
+
+static void usage(const char *program)
+{
+    fprintf(stderr,
+            "usage: %s [--threads N] [--algos A,B,...] [--windows LO:HI:STEP] [--sample-us N]\n"
+            "          [--bounce-ms N] [--max-pass PCT] [--max-suppress PCT] [-v] <trace.mft>...\n",
+            program);
+}
+
+static double percent(uint64_t part, uint64_t whole)
+{
+    return whole ? 100.0 * (double)part / (double)whole : 0.0;
+}
+
+static double ms(uint64_t us)
+{
+    return (double)us / 1000.0;
+}
+
+static void describe(const DebounceAlgoParams *params, char *text, size_t size)
+{
+    if (params->algo == DEBOUNCE_ALGO_ASYMMETRIC)
+        snprintf(text, size, "%-10s %3u/%-3u ms", debounce_algo_name(params->algo), params->press_us / 1000,
+                 params->release_us / 1000);
+    else
+        snprintf(text, size, "%-10s %7u ms", debounce_algo_name(params->algo), params->press_us / 1000);
+}
+
+static void print_row(const char *label, const DebounceAlgoParams *params, const AlgoStats *s)
+{
+    char text[48];
+    describe(params, text, sizeof(text));
+    printf("%-8s %-22s %8.2f%% %10.3f%%   %6.2f %6.2f %7.2f   %6.2f %6.2f %7.2f\n", label, text,
+           percent(s->passed, s->bounces), percent(s->suppressed, s->genuine),
+           ms(latency_histogram_percentile(&s->press_us, 0.5)), ms(latency_histogram_percentile(&s->press_us, 0.99)),
+           ms(latency_histogram_max(&s->press_us)), ms(latency_histogram_percentile(&s->release_us, 0.5)),
+           ms(latency_histogram_percentile(&s->release_us, 0.99)), ms(latency_histogram_max(&s->release_us)));
+}
+
+int main(int argc, char **argv)
+{
+    Range windows;
+    parse_range("2:40:2", &windows);
+    bool enabled[DEBOUNCE_ALGO_COUNT];
+    for (int a = 0; a < DEBOUNCE_ALGO_COUNT; a++)
+        enabled[a] = true;
+
+    int threads = 0;
+    unsigned sample_us = 1000;
+    unsigned bounce_ms = 25;
+    double max_pass = 1.0, max_suppress = 0.5;
+    bool verbose = false;
+
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; i++)
+    {
+        const char *option = argv[i];
+        if (strcmp(option, "-v") == 0)
+        {
+            verbose = true;
+            continue;
+        }
+
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        bool ok = value != NULL;
+
+        if (ok && strcmp(option, "--threads") == 0)
+            threads = atoi(value);
+        else if (ok && strcmp(option, "--algos") == 0)
+            ok = parse_algos(value, enabled);
+        else if (ok && strcmp(option, "--windows") == 0)
+            ok = parse_range(value, &windows);
+        else if (ok && strcmp(option, "--sample-us") == 0)
+            ok = sscanf(value, "%u", &sample_us) == 1 && sample_us > 0;
+        else if (ok && strcmp(option, "--bounce-ms") == 0)
+            ok = sscanf(value, "%u", &bounce_ms) == 1;
+        else if (ok && strcmp(option, "--max-pass") == 0)
+            ok = sscanf(value, "%lf", &max_pass) == 1;
+        else if (ok && strcmp(option, "--max-suppress") == 0)
+            ok = sscanf(value, "%lf", &max_suppress) == 1;
+        else
+            ok = false;
+
+        if (!ok)
+        {
+            usage(argv[0]);
+            return 2;
+        }
+        i++;
+    }
+    if (i >= argc)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    /* One candidate per window, every press/release pair for asymmetric */
+    size_t capacity = DEBOUNCE_ALGO_COUNT * windows.count * windows.count;
+    DebounceAlgoParams *candidates = calloc(capacity, sizeof(DebounceAlgoParams));
+    if (!candidates)
+        return 1;
+
+    size_t count = 0;
+    for (int a = 0; a < DEBOUNCE_ALGO_COUNT; a++)
+    {
+        if (!enabled[a])
+            continue;
+        for (size_t p = 0; p < windows.count; p++)
+        {
+            size_t pairs = a == DEBOUNCE_ALGO_ASYMMETRIC ? windows.count : 1;
+            for (size_t r = 0; r < pairs; r++)
+            {
+                DebounceAlgoParams *c = &candidates[count++];
+                c->algo = (DebounceAlgo)a;
+                c->press_us = windows.values[p] * 1000;
+                c->release_us = windows.values[a == DEBOUNCE_ALGO_ASYMMETRIC ? r : p] * 1000;
+                c->sample_us = sample_us;
+            }
+        }
+    }
+
+    AlgoJob job;
+    job.traces = (const char *const *)&argv[i];
+    job.trace_count = (size_t)(argc - i);
+    job.candidates = candidates;
+    job.candidate_count = count;
+    job.bounce_us = bounce_ms * 1000;
+    job.workers = threads > 0 ? threads : mf_cpu_count();
+
+    uint64_t start = mf_clock_now_us();
+    AlgoResults results;
+    if (!algo_compare_run(&job, &results))
+    {
+        fprintf(stderr, "mousefix_algos: nothing to compare or out of memory\n");
+        return 1;
+    }
+    double seconds = (double)(mf_clock_now_us() - start) / 1e6;
+
+    if (results.failed_traces > 0)
+        fprintf(stderr, "mousefix_algos: %zu trace(s) missing or malformed\n", results.failed_traces);
+    if (results.events == 0)
+    {
+        fprintf(stderr, "mousefix_algos: no button events replayed\n");
+        return 1;
+    }
+    fprintf(stderr, "%llu button events x %zu candidates in %.2f s on %d threads\n",
+            (unsigned long long)results.events, count, seconds, job.workers);
+
+    /* Totals over buttons, per candidate */
+    AlgoStats *totals = calloc(count, sizeof(AlgoStats));
+    if (!totals)
+        return 1;
+    for (size_t c = 0; c < count; c++)
+    {
+        for (int b = 0; b < MOUSE_BUTTON_WHEEL; b++)
+            algo_stats_merge(&totals[c], algo_stats_at(&job, &results, c, b));
+    }
+
+    double pass_limit = max_pass / 100.0, suppress_limit = max_suppress / 100.0;
+    printf("                                  false      false      press ms added         release ms added\n");
+    printf("         algorithm  window          pass     block     p50    p99     max      p50    p99     max\n");
+    for (int a = 0; a < DEBOUNCE_ALGO_COUNT; a++)
+    {
+        size_t best = count;
+        for (size_t c = 0; c < count; c++)
+        {
+            if (candidates[c].algo != (DebounceAlgo)a)
+                continue;
+            if (verbose)
+                print_row("", &candidates[c], &totals[c]);
+            if (algo_stats_within(&totals[c], pass_limit, suppress_limit) &&
+                (best == count || algo_stats_latency(&totals[c]) < algo_stats_latency(&totals[best])))
+                best = c;
+        }
+        if (best < count)
+            print_row("best", &candidates[best], &totals[best]);
+        else if (enabled[a])
+            printf("best     %-22s no window within the limits\n", debounce_algo_name((DebounceAlgo)a));
+    }
+
+    printf("\nPer button (lowest p99 added latency within %.2f%% false pass, %.2f%% false block):\n", max_pass,
+           max_suppress);
+    for (int b = 0; b < MOUSE_BUTTON_WHEEL; b++)
+    {
+        const AlgoStats *any = algo_stats_at(&job, &results, 0, b);
+        if (any->genuine + any->bounces == 0)
+            continue;
+        size_t pick = algo_compare_pick(&job, &results, b, pass_limit, suppress_limit);
+        if (pick < count)
+            print_row(debounce_get_button_name(b), &candidates[pick], algo_stats_at(&job, &results, pick, b));
+        else
+            printf("%-8s no candidate within the limits\n", debounce_get_button_name(b));
+    }
+
+    free(totals);
+    algo_results_free(&results);
+    free(candidates);
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/core/debouncer.h"
+#include "../src/trace/trace_map.h"
+#include "../src/trace/trace_replay.h"
+
+/*
+ * Replays a recorded input trace through the debounce engine and prints
+ * what it would have blocked.
+ *
+ *   mousefix_replay [-v] <trace.mft>
+ *
+ * -v prints one line per event and per deferred release. The trace is
+ * memory-mapped and replayed in batches, so multi-gigabyte captures are
+ * limited by decode speed rather than I/O buffering.
+ */
+
+static void print_event(const MouseEvent *event, bool blocked, void *user_data)
+{
+    (void)user_data;
+    printf("%12llu  %-6s %-4s %6ld %6ld %5d%s  %s\n",
+           (unsigned long long)event->timestamp,
+           debounce_get_button_name(event->button),
+           event->button == MOUSE_BUTTON_WHEEL ? "" : event->is_down ? "down" : "up",
+           event->x, event->y, (int)event->data,
+           event->is_injected ? " inj" : "    ",
+           blocked ? "BLOCK" : "pass");
+}
+
+static void print_release(MouseButton button, uint64_t timestamp, void *user_data)
+{
+    (void)user_data;
+    printf("%12llu  %-6s release (deferred)\n", (unsigned long long)timestamp, debounce_get_button_name(button));
+}
+
+int main(int argc, char **argv)
+{
+    bool verbose = argc == 3 && strcmp(argv[1], "-v") == 0;
+    if (argc != 2 && !verbose)
+    {
+        fprintf(stderr, "usage: %s [-v] <trace.mft>\n", argv[0]);
+        return 2;
+    }
+
+    const char *path = argv[argc - 1];
+    TraceMap map;
+    if (!trace_map_open(&map, path, 0))
+    {
+        fprintf(stderr, "%s: not a readable MouseFix trace\n", path);
+        return 1;
+    }
+
+    DebounceManager manager;
+    debounce_init(&manager);
+    TraceReplayCallbacks callbacks = {print_event, print_release, NULL};
+    TraceReplayer replayer;
+    trace_replayer_init(&replayer, &manager, verbose ? &callbacks : NULL);
+
+    uint64_t start = debounce_get_timestamp(&manager);
+    int status = trace_map_replay(&map, &replayer);
+    trace_replayer_finish(&replayer);
+    uint64_t elapsed = debounce_get_timestamp(&manager) - start;
+    uint64_t bytes = trace_map_tell(&map);
+    uint64_t span = map.codec.last_time - map.start_time;
+    trace_map_close(&map);
+
+    if (status < 0)
+        fprintf(stderr, "%s: trace is truncated or corrupt, stopped early\n", path);
+
+    const TraceReplayStats *stats = &replayer.stats;
+    printf("events:   %llu over %.1fs of input\n", (unsigned long long)stats->events, span / 1e6);
+    printf("blocked:  %llu\n", (unsigned long long)stats->blocked);
+    printf("releases: %llu\n", (unsigned long long)stats->releases);
+    printf("configs:  %llu, resets: %llu\n", (unsigned long long)stats->configs, (unsigned long long)stats->resets);
+    for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
+    {
+        uint32_t blocks = debounce_get_button_blocks(&manager, i);
+        if (blocks)
+            printf("  %-6s %u\n", debounce_get_button_name(i), blocks);
+    }
+    for (int i = 0; i < MOUSE_BUTTON_COUNT; i++)
+    {
+        static const char *kinds[ADDED_LATENCY_KIND_COUNT] = {"deferred", "cancelled"};
+        for (int k = 0; k < ADDED_LATENCY_KIND_COUNT; k++)
+        {
+            AddedLatencySummary added;
+            if (!debounce_get_added_latency(&manager, i, (AddedLatencyKind)k, &added) || added.count == 0)
+                continue;
+            printf("  %-6s %-9s %u releases, %.1fs added, p50 %.1fms p99 %.1fms max %.1fms\n",
+                   debounce_get_button_name(i), kinds[k], added.count, added.total_us / 1e6, added.p50_us / 1e3,
+                   added.p99_us / 1e3, added.max_us / 1e3);
+        }
+    }
+    if (elapsed > 0)
+        fprintf(stderr, "replayed %.1f MB in %.3fs (%.1f M events/s)\n",
+                bytes / 1e6, elapsed / 1e6, stats->events / (double)elapsed);
+
+    return status < 0 ? 1 : 0;
+}
@@ -0,0 +1,259 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/core/debouncer.h"
+#include "../src/tune/tune.h"
+
+/*
+ * Picks debounce thresholds and Smart Drag tuning from recorded traces.
+ *
+ *   mousefix_tune [options] <trace.mft>...
+ *
+ *   --threads N            worker threads (default: one per CPU)
+ *   --thresholds LO:HI:ST  candidate thresholds in ms (default 10:80:5)
+ *   --hold LO:HI:ST        Smart Drag hold threshold in ms (default 100:300:50)
+ *   --distance LO:HI:ST    Smart Drag travel threshold in px (default 3:9:2)
+ *   --confirm LO:HI:ST     Smart Drag confirm window in ms (default 100:200:50)
+ *   --bounce-ms N          edges closer than this are labelled bounces (default 25)
+ *   --weights M,S,L        cost of all bounces missed, all genuine edges
+ *                          suppressed, and per ms of added latency per edge
+ *                          (default 1,4,0.01)
+ *   --top N                ranked variants to print (default 10)
+ *   --reg FILE             write the winner's thresholds and Smart Drag
+ *                          tuning as a .reg file for MouseFix
+ *
+ * A range may also be a single value. Smart Drag off is always one of the
+ * variants. See src/tune/tune.h for how edges are labelled and scored.
+ */
+
+#define MAX_RANGE 64
+
+typedef struct
+{
+    uint32_t values[MAX_RANGE];
+    size_t count;
+} Range;
+
+static bool parse_range(const char *text, Range *range)
+{
+    unsigned lo, hi, step;
+    int fields = sscanf(text, "%u:%u:%u", &lo, &hi, &step);
+    if (fields == 1)
+    {
+        hi = lo;
+        step = 1;
+    }
+    else if (fields != 3 || step == 0 || hi < lo)
+    {
+        return false;
+    }
+
+    range->count = 0;
+    for (unsigned v = lo; v <= hi && range->count < MAX_RANGE; v += step)
+        range->values[range->count++] = v;
+    return range->count > 0;
+}
+
+static uint32_t isqrt(uint32_t value)
+{
+    uint32_t root = 0;
+    while ((root + 1) * (root + 1) <= value)
+        root++;
+    return root;
+}
+
+static bool write_reg(const char *path, const TuneVariant *variant, const uint32_t *threshold_us)
+{
+    FILE *file = fopen(path, "w");
+    if (!file)
+        return false;
+
+    fprintf(file, "Windows Registry Editor Version 5.00\n\n");
+    fprintf(file, "[HKEY_CURRENT_USER\\Software\\MouseFix]\n");
+    fprintf(file, "\"HybridHeuristic\"=dword:%08x\n", variant->hybrid ? 1u : 0u);
+    /* Thresholds only: which buttons are debounced stays as the user set it */
+    for (int b = 0; b < MOUSE_BUTTON_COUNT; b++)
+        fprintf(file, "\"Btn%d_Threshold\"=dword:%08x\n", b, threshold_us[b] / 1000);
+    fprintf(file, "\"SmartDragHoldMs\"=dword:%08x\n", variant->smart_drag.hold_us / 1000);
+    fprintf(file, "\"SmartDragDistancePx\"=dword:%08x\n", isqrt(variant->smart_drag.dist_sq));
+    fprintf(file, "\"SmartDragConfirmMs\"=dword:%08x\n", variant->smart_drag.confirm_us / 1000);
+    return fclose(file) == 0;
+}
+
+static void usage(const char *program)
+{
+    fprintf(stderr,
+            "usage: %s [--threads N] [--thresholds LO:HI:STEP] [--hold LO:HI:STEP]\n"
+            "          [--distance LO:HI:STEP] [--confirm LO:HI:STEP] [--bounce-ms N]\n"
+            "          [--weights MISS,SUPPRESS,LATENCY] [--top N] [--reg FILE] <trace.mft>...\n",
+            program);
+}
+
+static double percent(uint64_t part, uint64_t whole)
+{
+    return whole ? 100.0 * (double)part / (double)whole : 0.0;
+}
+
+int main(int argc, char **argv)
+{
+    Range thresholds, hold, distance, confirm;
+    parse_range("10:80:5", &thresholds);
+    parse_range("100:300:50", &hold);
+    parse_range("3:9:2", &distance);
+    parse_range("100:200:50", &confirm);
+
+    TuneWeights weights = {1.0, 4.0, 0.01};
+    int threads = 0;
+    unsigned bounce_ms = 25;
+    size_t top = 10;
+    const char *reg_path = NULL;
+
+    int i = 1;
+    for (; i < argc && strncmp(argv[i], "--", 2) == 0; i++)
+    {
+        const char *option = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        bool ok = value != NULL;
+
+        if (ok && strcmp(option, "--threads") == 0)
+            threads = atoi(value);
+        else if (ok && strcmp(option, "--thresholds") == 0)
+            ok = parse_range(value, &thresholds) && thresholds.count <= TUNE_MAX_THRESHOLDS;
+        else if (ok && strcmp(option, "--hold") == 0)
+            ok = parse_range(value, &hold);
+        else if (ok && strcmp(option, "--distance") == 0)
+            ok = parse_range(value, &distance);
+        else if (ok && strcmp(option, "--confirm") == 0)
+            ok = parse_range(value, &confirm);
+        else if (ok && strcmp(option, "--bounce-ms") == 0)
+            ok = sscanf(value, "%u", &bounce_ms) == 1;
+        else if (ok && strcmp(option, "--weights") == 0)
+            ok = sscanf(value, "%lf,%lf,%lf", &weights.miss, &weights.suppress, &weights.latency) == 3;
+        else if (ok && strcmp(option, "--top") == 0)
+            top = (size_t)atoi(value);
+        else if (ok && strcmp(option, "--reg") == 0)
+            reg_path = value;
+        else
+            ok = false;
+
+        if (!ok)
+        {
+            usage(argv[0]);
+            return 2;
+        }
+        i++;
+    }
+    if (i >= argc)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    uint32_t threshold_us[MAX_RANGE];
+    for (size_t t = 0; t < thresholds.count; t++)
+        threshold_us[t] = thresholds.values[t] * 1000;
+
+    /* Smart Drag off, then every combination of the Smart Drag ranges */
+    size_t variant_count = 1 + hold.count * distance.count * confirm.count;
+    TuneVariant *variants = calloc(variant_count, sizeof(TuneVariant));
+    TuneCandidate *ranked = calloc(variant_count, sizeof(TuneCandidate));
+    if (!variants || !ranked)
+        return 1;
+
+    variants[0].hybrid = false;
+    variants[0].smart_drag.hold_us = SMART_DRAG_HOLD_THRESHOLD_US;
+    variants[0].smart_drag.dist_sq = SMART_DRAG_DIST_THRESHOLD_SQ;
+    variants[0].smart_drag.confirm_us = SMART_DRAG_CONFIRM_TIMEOUT_US;
+    size_t v = 1;
+    for (size_t h = 0; h < hold.count; h++)
+    {
+        for (size_t d = 0; d < distance.count; d++)
+        {
+            for (size_t c = 0; c < confirm.count; c++, v++)
+            {
+                variants[v].hybrid = true;
+                variants[v].smart_drag.hold_us = hold.values[h] * 1000;
+                variants[v].smart_drag.dist_sq = distance.values[d] * distance.values[d];
+                variants[v].smart_drag.confirm_us = confirm.values[c] * 1000;
+            }
+        }
+    }
+
+    TuneJob job;
+    job.traces = (const char *const *)&argv[i];
+    job.trace_count = (size_t)(argc - i);
+    job.thresholds_us = threshold_us;
+    job.threshold_count = thresholds.count;
+    job.variants = variants;
+    job.variant_count = variant_count;
+    job.bounce_us = bounce_ms * 1000;
+    job.workers = threads > 0 ? threads : mf_cpu_count();
+
+    uint64_t start = mf_clock_now_us();
+    TuneResults results;
+    if (!tune_run(&job, &results))
+    {
+        fprintf(stderr, "mousefix_tune: out of memory\n");
+        return 1;
+    }
+    double seconds = (double)(mf_clock_now_us() - start) / 1e6;
+
+    if (results.failed_traces > 0)
+        fprintf(stderr, "mousefix_tune: %zu trace(s) missing or malformed\n", results.failed_traces);
+    if (results.events == 0)
+    {
+        fprintf(stderr, "mousefix_tune: no events replayed\n");
+        return 1;
+    }
+
+    tune_rank(&job, &results, &weights, ranked);
+
+    size_t configurations = variant_count * thresholds.count;
+    fprintf(stderr, "%llu events x %zu configurations in %.2f s on %d threads (%.1f M event-configs/s)\n",
+            (unsigned long long)results.events, configurations, seconds, job.workers,
+            (double)results.events * (double)configurations / seconds / 1e6);
+
+    printf("rank  score     smart drag                left right middle  x1  x2 wheel  caught  suppressed  added latency\n");
+    for (size_t r = 0; r < variant_count && r < top; r++)
+    {
+        const TuneCandidate *c = &ranked[r];
+        const TuneVariant *variant = &variants[c->variant];
+        char drag[32];
+        if (variant->hybrid)
+            snprintf(drag, sizeof(drag), "on %3ums %2upx %3ums", variant->smart_drag.hold_us / 1000,
+                     isqrt(variant->smart_drag.dist_sq), variant->smart_drag.confirm_us / 1000);
+        else
+            snprintf(drag, sizeof(drag), "off");
+
+        printf("%4zu  %-8.5f  %-24s", r + 1, c->score, drag);
+        for (int b = 0; b < MOUSE_BUTTON_COUNT; b++)
+            printf(" %4u", c->threshold_us[b] / 1000);
+        printf("  %5.1f%%  %9.3f%%  %8.2f ms/edge\n",
+               percent(c->total.caught, c->total.bounces),
+               percent(c->total.suppressed, c->total.genuine),
+               c->total.genuine ? (double)c->total.latency_us / 1000.0 / (double)c->total.genuine : 0.0);
+    }
+
+    const TuneCandidate *best = &ranked[0];
+    printf("\nPresetConfig: {%u, %u, %u, %u, %u, %u}, Smart Drag %s\n",
+           best->threshold_us[MOUSE_BUTTON_LEFT] / 1000, best->threshold_us[MOUSE_BUTTON_RIGHT] / 1000,
+           best->threshold_us[MOUSE_BUTTON_MIDDLE] / 1000, best->threshold_us[MOUSE_BUTTON_X1] / 1000,
+           best->threshold_us[MOUSE_BUTTON_X2] / 1000, best->threshold_us[MOUSE_BUTTON_WHEEL] / 1000,
+           variants[best->variant].hybrid ? "on" : "off");
+
+    if (reg_path)
+    {
+        if (!write_reg(reg_path, &variants[best->variant], best->threshold_us))
+        {
+            fprintf(stderr, "mousefix_tune: cannot write %s\n", reg_path);
+            return 1;
+        }
+        printf("Wrote %s; import it and restart MouseFix to load the preset\n", reg_path);
+    }
+
+    tune_results_free(&results);
+    free(ranked);
+    free(variants);
+    return 0;
+}
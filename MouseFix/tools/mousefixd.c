@@ -0,0 +1,371 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../src/linux/evdev_daemon.h"
+#include "../src/linux/evdev_loop.h"
+#include "../src/linux/rt_mode.h"
+
+/*
+ * Headless debounce daemon for Linux evdev mice.
+ *
+ *   mousefixd [options] [input...]
+ *
+ *   input                  evdev device node, recorded evdev file or pipe
+ *                          (default: standard input)
+ *   -o PATH                write filtered frames here (default: standard output);
+ *                          with several inputs, one -o per input, in order
+ *   --grab                 take the device exclusively (EVIOCGRAB), so only
+ *                          the filtered stream reaches its reader
+ *   --replay               fire deferred releases on frame time only; the
+ *                          default when the input is a regular file
+ *   --host-clock           stamp frames with the time they are read, for
+ *                          pipes whose timestamps are not CLOCK_MONOTONIC
+ *   --threshold MS         button threshold (default 50)
+ *   --wheel MS             wheel threshold (default 30, 0 to leave the wheel alone)
+ *   --buttons L,R,M,4,5    buttons to debounce (default all)
+ *   --no-smart-drag        pass every release at once
+ *   --confirm-ms MS        Smart Drag confirm window (default 150)
+ *   --io auto|epoll|uring  live I/O path (default auto: io_uring where the
+ *                          kernel has multishot reads, else epoll)
+ *   --rt                   low-latency mode for live input: real-time
+ *                          scheduling, memory locked, stack and buffers
+ *                          pre-faulted; reports what it obtained, or
+ *                          that it was not applied when replaying
+ *   --rt-policy fifo|rr    real-time policy (default fifo); implies --rt
+ *   --rt-priority N        real-time priority 1-99 (default 50); implies --rt
+ *   --cpu N                pin the filtering thread to CPU N; implies --rt
+ *
+ * Live inputs, one or several, run on one loop (evdev_loop.h), each
+ * device with its own engine. A file to replay runs alone, on the
+ * single-device daemon.
+ *
+ * Counters go to standard error on exit (end of input, SIGINT or SIGTERM).
+ * Input and output are both struct input_event frames; the output is
+ * meant for a consumer that replays them into the input stack.
+ */
+
+#define MAX_INPUTS EVDEV_LOOP_MAX_DEVICES
+
+typedef struct
+{
+    unsigned threshold_ms;
+    unsigned wheel_ms;
+    unsigned confirm_ms;
+    bool smart_drag;
+    bool monitored[MOUSE_BUTTON_WHEEL];
+} EngineOptions;
+
+static EvdevDaemon g_daemon;
+static EvdevLoop g_loop;
+static bool g_use_loop;
+
+static void on_signal(int signal)
+{
+    (void)signal;
+    if (g_use_loop)
+        evdev_loop_stop(&g_loop);
+    else
+        evdev_daemon_stop(&g_daemon);
+}
+
+static bool parse_buttons(const char *text, bool *monitored)
+{
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%s", text);
+    memset(monitored, 0, MOUSE_BUTTON_WHEEL * sizeof(bool));
+
+    for (char *name = strtok(buffer, ","); name; name = strtok(NULL, ","))
+    {
+        if (strcmp(name, "L") == 0)
+            monitored[MOUSE_BUTTON_LEFT] = true;
+        else if (strcmp(name, "R") == 0)
+            monitored[MOUSE_BUTTON_RIGHT] = true;
+        else if (strcmp(name, "M") == 0)
+            monitored[MOUSE_BUTTON_MIDDLE] = true;
+        else if (strcmp(name, "4") == 0)
+            monitored[MOUSE_BUTTON_X1] = true;
+        else if (strcmp(name, "5") == 0)
+            monitored[MOUSE_BUTTON_X2] = true;
+        else
+            return false;
+    }
+    return true;
+}
+
+static bool parse_io(const char *text, EvdevIo *io)
+{
+    if (strcmp(text, "auto") == 0)
+        *io = EVDEV_IO_AUTO;
+    else if (strcmp(text, "epoll") == 0)
+        *io = EVDEV_IO_EPOLL;
+    else if (strcmp(text, "uring") == 0)
+        *io = EVDEV_IO_URING;
+    else
+        return false;
+    return true;
+}
+
+static bool parse_policy(const char *text, int *policy)
+{
+    if (strcmp(text, "fifo") == 0)
+        *policy = SCHED_FIFO;
+    else if (strcmp(text, "rr") == 0)
+        *policy = SCHED_RR;
+    else
+        return false;
+    return true;
+}
+
+static void usage(const char *program)
+{
+    fprintf(stderr,
+            "usage: %s [-o PATH]... [--grab] [--replay] [--host-clock] [--threshold MS] [--wheel MS]\n"
+            "          [--buttons L,R,M,4,5] [--no-smart-drag] [--confirm-ms MS] [--io auto|epoll|uring]\n"
+            "          [--rt] [--rt-policy fifo|rr] [--rt-priority N] [--cpu N] [input...]\n",
+            program);
+}
+
+static void configure(DebounceManager *debounce, const EngineOptions *options)
+{
+    for (int b = 0; b < MOUSE_BUTTON_WHEEL; b++)
+    {
+        debounce_set_monitored(debounce, b, options->monitored[b]);
+        debounce_set_threshold(debounce, b, options->threshold_ms, 1, 1000);
+    }
+    debounce_set_monitored(debounce, MOUSE_BUTTON_WHEEL, options->wheel_ms > 0);
+    debounce_set_threshold(debounce, MOUSE_BUTTON_WHEEL, options->wheel_ms, 1, 1000);
+    debounce_set_hybrid_heuristic(debounce, options->smart_drag);
+    SmartDragParams drag;
+    debounce_get_smart_drag(debounce, &drag);
+    drag.confirm_us = options->confirm_ms * 1000;
+    debounce_set_smart_drag(debounce, &drag);
+}
+
+static void print_stats(const char *name, const EvdevStream *stream)
+{
+    const EvdevFilterStats *stats = &stream->filter.stats;
+    if (name)
+        fprintf(stderr, "%s:\n", name);
+    fprintf(stderr, "frames:   %llu in, %llu out\n", (unsigned long long)stats->frames_in,
+            (unsigned long long)stats->frames_out);
+    fprintf(stderr, "events:   %llu, blocked %llu, releases %llu, dropped reports %llu\n",
+            (unsigned long long)stats->events, (unsigned long long)stats->blocked,
+            (unsigned long long)stats->releases, (unsigned long long)stats->dropped);
+    fprintf(stderr, "syscalls: %llu reads, %llu writes\n", (unsigned long long)stream->stats.reads,
+            (unsigned long long)stream->stats.writes);
+}
+
+/* Opens an input; sets *replay for regular files and *monotonic if a device node switched clocks */
+static int open_input(const char *input, bool grab, bool host_clock, bool *replay, bool *monotonic)
+{
+    int fd = STDIN_FILENO;
+    if (input && strcmp(input, "-") != 0 && (fd = open(input, O_RDONLY | O_CLOEXEC)) < 0)
+    {
+        fprintf(stderr, "mousefixd: %s: %s\n", input, strerror(errno));
+        return -1;
+    }
+
+    struct stat st;
+    memset(&st, 0, sizeof(st));
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+        *replay = true;
+    /* Only a device node can switch clocks; anything else keeps its own stamps */
+    *monotonic = !host_clock && S_ISCHR(st.st_mode) && evdev_daemon_use_monotonic(fd);
+    if (grab && ioctl(fd, EVIOCGRAB, 1) != 0)
+    {
+        fprintf(stderr, "mousefixd: cannot grab %s: %s\n", input ? input : "stdin", strerror(errno));
+        return -1;
+    }
+    return fd;
+}
+
+static int open_output(const char *output)
+{
+    int fd = STDOUT_FILENO;
+    if (output && (fd = open(output, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)) < 0)
+        fprintf(stderr, "mousefixd: %s: %s\n", output, strerror(errno));
+    return fd;
+}
+
+int main(int argc, char **argv)
+{
+    const char *inputs[MAX_INPUTS], *outputs[MAX_INPUTS];
+    int input_count = 0, output_count = 0;
+    bool grab = false, replay = false, host_clock = false;
+    EvdevIo io = EVDEV_IO_AUTO;
+    bool rt = false;
+    RtModeOptions rt_options;
+    rt_mode_defaults(&rt_options);
+    EngineOptions options = {50, 30, 150, true, {0}};
+    for (int b = 0; b < MOUSE_BUTTON_WHEEL; b++)
+        options.monitored[b] = true;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *option = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        bool ok = true, takes_value = false;
+
+        if (strcmp(option, "--grab") == 0)
+            grab = true;
+        else if (strcmp(option, "--replay") == 0)
+            replay = true;
+        else if (strcmp(option, "--host-clock") == 0)
+            host_clock = true;
+        else if (strcmp(option, "--no-smart-drag") == 0)
+            options.smart_drag = false;
+        else if (strcmp(option, "--rt") == 0)
+            rt = true;
+        else if (option[0] != '-' || strcmp(option, "-") == 0)
+        {
+            ok = input_count < MAX_INPUTS;
+            if (ok)
+                inputs[input_count++] = option;
+        }
+        else
+        {
+            takes_value = true;
+            ok = value != NULL;
+            if (ok && strcmp(option, "-o") == 0)
+            {
+                ok = output_count < MAX_INPUTS;
+                if (ok)
+                    outputs[output_count++] = value;
+            }
+            else if (ok && strcmp(option, "--threshold") == 0)
+                ok = sscanf(value, "%u", &options.threshold_ms) == 1;
+            else if (ok && strcmp(option, "--wheel") == 0)
+                ok = sscanf(value, "%u", &options.wheel_ms) == 1;
+            else if (ok && strcmp(option, "--buttons") == 0)
+                ok = parse_buttons(value, options.monitored);
+            else if (ok && strcmp(option, "--confirm-ms") == 0)
+                ok = sscanf(value, "%u", &options.confirm_ms) == 1;
+            else if (ok && strcmp(option, "--io") == 0)
+                ok = parse_io(value, &io);
+            else if (ok && strcmp(option, "--rt-policy") == 0)
+                ok = rt = parse_policy(value, &rt_options.policy);
+            else if (ok && strcmp(option, "--rt-priority") == 0)
+                ok = rt = sscanf(value, "%d", &rt_options.priority) == 1 && rt_options.priority >= 1 &&
+                          rt_options.priority <= 99;
+            else if (ok && strcmp(option, "--cpu") == 0)
+                ok = rt = sscanf(value, "%d", &rt_options.cpu) == 1 && rt_options.cpu >= 0;
+            else
+                ok = false;
+        }
+
+        if (!ok)
+        {
+            usage(argv[0]);
+            return 2;
+        }
+        i += takes_value;
+    }
+
+    if (input_count > 1 ? output_count != input_count : output_count > 1)
+    {
+        fprintf(stderr, "mousefixd: give one -o per input\n");
+        return 2;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = on_signal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    int in_fds[MAX_INPUTS], out_fds[MAX_INPUTS];
+    bool any_monotonic = false;
+    int open_count = input_count > 0 ? input_count : 1;
+    for (int i = 0; i < open_count; i++)
+    {
+        bool monotonic;
+        in_fds[i] = open_input(input_count ? inputs[i] : NULL, grab, host_clock, &replay, &monotonic);
+        out_fds[i] = in_fds[i] < 0 ? -1 : open_output(output_count ? outputs[i] : NULL);
+        if (out_fds[i] < 0)
+            return 1;
+        any_monotonic |= monotonic;
+    }
+    if (replay && open_count > 1)
+    {
+        fprintf(stderr, "mousefixd: files replay one at a time\n");
+        return 2;
+    }
+    if (!replay && !host_clock && !any_monotonic)
+        fprintf(stderr, "mousefixd: input is not a device; deadlines assume its frames are CLOCK_MONOTONIC\n");
+
+    EvdevClock clock = host_clock ? EVDEV_CLOCK_HOST : EVDEV_CLOCK_FRAME;
+    int status;
+
+    if (replay)
+    {
+        if (!evdev_daemon_init(&g_daemon, in_fds[0], out_fds[0], clock, true))
+        {
+            fprintf(stderr, "mousefixd: eventfd: %s\n", strerror(errno));
+            return 1;
+        }
+        configure(&g_daemon.stream.filter.pipeline.debounce, &options);
+        if (rt)
+            fprintf(stderr, "rt: not applied in replay mode\n");
+
+        status = evdev_daemon_run(&g_daemon);
+        if (status < 0)
+            fprintf(stderr, "mousefixd: %s\n", strerror(errno));
+        print_stats(NULL, &g_daemon.stream);
+        evdev_daemon_cleanup(&g_daemon);
+    }
+    else
+    {
+        /* Live input, one device or many, goes through the loop and its io_uring path */
+        if (!evdev_loop_init(&g_loop, io))
+        {
+            fprintf(stderr, "mousefixd: %s: %s\n", evdev_io_name(io), strerror(errno));
+            return 1;
+        }
+        g_use_loop = true;
+        for (int i = 0; i < open_count; i++)
+        {
+            if (evdev_loop_add(&g_loop, in_fds[i], out_fds[i], clock) < 0)
+            {
+                fprintf(stderr, "mousefixd: %s: %s\n", input_count ? inputs[i] : "stdin", strerror(errno));
+                return 1;
+            }
+            configure(&evdev_loop_filter(&g_loop, i)->pipeline.debounce, &options);
+        }
+
+        /* Everything the loop touches exists now: lock and fault it in before the first frame */
+        uint64_t faults = 0;
+        if (rt)
+        {
+            RtModeReport report;
+            evdev_loop_prefault(&g_loop);
+            rt_mode_apply(&rt_options, &report);
+            rt_mode_print(&report, stderr);
+            faults = rt_mode_page_faults();
+        }
+
+        status = evdev_loop_run(&g_loop);
+        if (status < 0)
+            fprintf(stderr, "mousefixd: %s\n", strerror(errno));
+        if (rt)
+            fprintf(stderr, "rt: %llu page faults while running\n",
+                    (unsigned long long)(rt_mode_page_faults() - faults));
+        for (int i = 0; i < open_count; i++)
+            print_stats(open_count > 1 ? inputs[i] : NULL, evdev_loop_stream(&g_loop, i));
+        fprintf(stderr, "loop:     %s, %llu syscalls, %llu wakeups, timer %llu fires, %llu re-arms\n",
+                evdev_io_name(g_loop.io), (unsigned long long)evdev_loop_syscalls(&g_loop),
+                (unsigned long long)g_loop.stats.wakeups, (unsigned long long)g_loop.stats.timer_fires,
+                (unsigned long long)g_loop.stats.timer_sets);
+        evdev_loop_cleanup(&g_loop);
+    }
+
+    for (int i = 0; grab && i < open_count; i++)
+        ioctl(in_fds[i], EVIOCGRAB, 0);
+    return status < 0 ? 1 : 0;
+}